@@ -0,0 +1,176 @@
+/*****************************************************************//**
+ * \file   bench.cpp
+ * \brief  Definition of BenchRunner and the JSON result files
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <map>
+
+#include "bench.h"
+#include "clock.h"
+
+static const void* volatile s_sink = nullptr;
+
+void DoNotOptimize(const void* p)
+{
+    s_sink = p;
+}
+
+std::string BENCH_RESULT::Key() const
+{
+    return Name + "/" + std::to_string(Size) + "/t" + std::to_string(Threads);
+}
+
+BenchRunner::BenchRunner(const BENCH_PARAMS& params)
+    : m_params(params)
+{
+    if (m_params.Repetitions == 0) m_params.Repetitions = 1;
+}
+
+bool BenchRunner::Selected(const std::string& name) const
+{
+    return m_params.Filter.empty() || name.find(m_params.Filter) != std::string::npos;
+}
+
+void BenchRunner::Run(const std::string& name, uint64_t size, uint32_t threads, uint64_t itemsPerOp,
+    const std::function<void()>& op)
+{
+    if (!Selected(name)) return;
+
+    // Warm up caches and allocations, and size the batches
+    uint64_t start = Clock::Now();
+    op();
+    double firstNs = static_cast<double>(Clock::ToNanoseconds(Clock::Now() - start));
+
+    double batchNs = m_params.MinSeconds * 1e9 / m_params.Repetitions;
+    uint64_t iterations = firstNs > 0.0 ? static_cast<uint64_t>(batchNs / firstNs) : 1;
+    if (iterations < 1) iterations = 1;
+
+    std::vector<double> nsPerOp;
+    for (uint32_t rep = 0; rep < m_params.Repetitions; rep++)
+    {
+        start = Clock::Now();
+        for (uint64_t i = 0; i < iterations; i++) op();
+        uint64_t ns = Clock::ToNanoseconds(Clock::Now() - start);
+        nsPerOp.push_back(static_cast<double>(ns) / iterations);
+    }
+    std::sort(nsPerOp.begin(), nsPerOp.end());
+
+    BENCH_RESULT result;
+    result.Name = name;
+    result.Size = size;
+    result.Threads = threads;
+    result.Iterations = iterations;
+    result.NsPerOp = nsPerOp[nsPerOp.size() / 2];
+    result.MinNsPerOp = nsPerOp.front();
+    result.ItemsPerSecond = itemsPerOp > 0 && result.NsPerOp > 0.0 ? itemsPerOp * 1e9 / result.NsPerOp : 0.0;
+    m_results.push_back(result);
+}
+
+void BenchRunner::WriteJson(std::ostream& stream, const std::vector<BENCH_RESULT>& results)
+{
+    // One result per line, so that ReadBenchJson needs no full parser
+    std::ios::fmtflags flags = stream.flags();
+    stream << "{\"clock\":\"" << (Clock::Source() == CLOCK_SOURCE_TSC ? "tsc" : "steady") <<
+        "\",\"benchmarks\":[\n";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const BENCH_RESULT& result = results[i];
+        stream << std::fixed << std::setprecision(3) <<
+            "{\"name\":\"" << result.Name << "\",\"size\":" << result.Size <<
+            ",\"threads\":" << result.Threads << ",\"iterations\":" << result.Iterations <<
+            ",\"ns_per_op\":" << result.NsPerOp << ",\"min_ns_per_op\":" << result.MinNsPerOp <<
+            ",\"items_per_second\":" << std::setprecision(0) << result.ItemsPerSecond << "}" <<
+            (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    stream << "]}\n";
+    stream.flags(flags);
+}
+
+// Value after "key": on a line, or empty
+static std::string json_field(const std::string& line, const char* key)
+{
+    std::string pattern = std::string("\"") + key + "\":";
+    size_t position = line.find(pattern);
+    if (position == std::string::npos) return std::string();
+    position += pattern.size();
+
+    if (position < line.size() && line[position] == '"')
+    {
+        size_t end = line.find('"', position + 1);
+        return end == std::string::npos ? std::string() : line.substr(position + 1, end - position - 1);
+    }
+    size_t end = line.find_first_of(",}", position);
+    return line.substr(position, end == std::string::npos ? std::string::npos : end - position);
+}
+
+bool ReadBenchJson(const std::string& filename, std::vector<BENCH_RESULT>& results, std::string& error)
+{
+    std::ifstream file(filename);
+    if (!file)
+    {
+        error = "cannot open " + filename;
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::string name = json_field(line, "name");
+        if (name.empty()) continue;
+
+        BENCH_RESULT result;
+        result.Name = name;
+        result.Size = std::strtoull(json_field(line, "size").c_str(), nullptr, 10);
+        result.Threads = static_cast<uint32_t>(std::strtoul(json_field(line, "threads").c_str(), nullptr, 10));
+        result.Iterations = std::strtoull(json_field(line, "iterations").c_str(), nullptr, 10);
+        result.NsPerOp = std::strtod(json_field(line, "ns_per_op").c_str(), nullptr);
+        result.MinNsPerOp = std::strtod(json_field(line, "min_ns_per_op").c_str(), nullptr);
+        result.ItemsPerSecond = std::strtod(json_field(line, "items_per_second").c_str(), nullptr);
+        results.push_back(result);
+    }
+
+    if (results.empty())
+    {
+        error = filename + " has no benchmark results";
+        return false;
+    }
+    return true;
+}
+
+uint32_t CompareToBaseline(const std::vector<BENCH_RESULT>& results,
+    const std::vector<BENCH_RESULT>& baseline, double threshold, std::ostream& report)
+{
+    std::map<std::string, const BENCH_RESULT*> baselineByKey;
+    for (const BENCH_RESULT& result : baseline) baselineByKey[result.Key()] = &result;
+
+    std::ios::fmtflags flags = report.flags();
+    report << std::fixed << std::setprecision(1);
+
+    uint32_t regressions = 0;
+    for (const BENCH_RESULT& result : results)
+    {
+        auto found = baselineByKey.find(result.Key());
+        if (found == baselineByKey.end() || found->second->NsPerOp <= 0.0) continue;
+
+        double change = result.NsPerOp / found->second->NsPerOp - 1.0;
+        if (change > threshold)
+        {
+            report << "REGRESSION " << result.Key() << ": " << found->second->NsPerOp << " -> " <<
+                result.NsPerOp << " ns (+" << change * 100.0 << "%)\n";
+            regressions++;
+        }
+        else if (change < -threshold)
+        {
+            report << "improved   " << result.Key() << ": " << found->second->NsPerOp << " -> " <<
+                result.NsPerOp << " ns (" << change * 100.0 << "%)\n";
+        }
+    }
+    report.flags(flags);
+    return regressions;
+}
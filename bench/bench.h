@@ -0,0 +1,93 @@
+/*****************************************************************//**
+ * \file   bench.h
+ * \brief  Timing harness of the benchmark executable
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct BENCH_PARAMS
+{
+	double MinSeconds = 0.25;				// Per benchmark, over all repetitions
+	uint32_t Repetitions = 5;				// Timed separately, the median is reported
+	std::string Filter;						// Substring of the names to run, empty runs all
+};
+
+struct BENCH_RESULT
+{
+	std::string Name;						// Suite and operation, "image/set_color_mode"
+	uint64_t Size = 0;						// Problem size, meaning depends on the benchmark
+	uint32_t Threads = 1;
+	uint64_t Iterations = 0;				// Operations per repetition
+	double NsPerOp = 0.0;					// Median over repetitions
+	double MinNsPerOp = 0.0;
+	double ItemsPerSecond = 0.0;			// Of the median, 0 if items were not given
+
+	// Identifies the result across runs
+	std::string Key() const;
+};
+
+/**
+ * Times operations and collects the results.
+ *
+ * An operation is run once to warm up and to choose a batch size, then in
+ * Repetitions batches that together take about MinSeconds. Each batch gives
+ * a time per operation; the median is robust to a batch disturbed by the
+ * system, the minimum shows the best case.
+ */
+class BenchRunner
+{
+public:
+	explicit BenchRunner(const BENCH_PARAMS& params);
+
+	bool Selected(const std::string& name) const;
+
+	// itemsPerOp counts work items such as pixels or vertices, for throughput
+	void Run(const std::string& name, uint64_t size, uint32_t threads, uint64_t itemsPerOp,
+		const std::function<void()>& op);
+
+	const std::vector<BENCH_RESULT>& Results() const { return m_results; }
+
+	static void WriteJson(std::ostream& stream, const std::vector<BENCH_RESULT>& results);
+
+private:
+	BENCH_PARAMS m_params;
+	std::vector<BENCH_RESULT> m_results;
+};
+
+// Reads results written by WriteJson. Returns false with a message on failure.
+bool ReadBenchJson(const std::string& filename, std::vector<BENCH_RESULT>& results, std::string& error);
+
+// Reports every result slower than its baseline by more than threshold, a
+// fraction of the baseline time. Returns the number of regressions.
+uint32_t CompareToBaseline(const std::vector<BENCH_RESULT>& results,
+	const std::vector<BENCH_RESULT>& baseline, double threshold, std::ostream& report);
+
+// Keeps the compiler from removing work whose result is unused
+void DoNotOptimize(const void* p);
+
+// Writes deterministic noise as a .bmp, 1 or 3 bytes per pixel.
+// Returns the error code of image_base::write_bmp.
+int WriteNoiseBmp(const std::string& filename, uint32_t width, uint32_t height, uint32_t bytesPerPixel);
+
+// What the suites run over
+struct BENCH_CONFIG
+{
+	std::vector<uint32_t> ThreadCounts;		// Job system sizes for parallel code
+	bool Quick = false;						// Smallest sizes only
+	std::string TempDirectory = ".";		// For files read and written
+};
+
+// Suites, one per source file
+void RunImageBenchmarks(BenchRunner& runner, const BENCH_CONFIG& config);
+void RunUploadBenchmarks(BenchRunner& runner, const BENCH_CONFIG& config);
+void RunJobBenchmarks(BenchRunner& runner, const BENCH_CONFIG& config);
+void RunMeshBenchmarks(BenchRunner& runner, const BENCH_CONFIG& config);
+void RunRenderBenchmarks(BenchRunner& runner, const BENCH_CONFIG& config);
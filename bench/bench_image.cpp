@@ -0,0 +1,83 @@
+/*****************************************************************//**
+ * \file   bench_image.cpp
+ * \brief  Benchmarks of BMP reading, writing and color conversion
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include <cstdio>
+#include <memory>
+
+#include "bench.h"
+#include "image_helper.h"
+#include "job_system.h"
+
+// Opens the protected interface of image_base
+class BenchImage : public image_base
+{
+public:
+    // Noise, deterministic so that every run converts the same data
+    void Fill(uint32_t width, uint32_t height, IMAGE_COLOR_MODE mode)
+    {
+        uint32_t rowBytes = (width * mode + 7) & ~7u;
+        std::vector<uint8_t> pixels(static_cast<size_t>(rowBytes) * height);
+        uint32_t state = 12345;
+        for (uint8_t& value : pixels)
+        {
+            state = state * 1103515245u + 12345u;
+            value = static_cast<uint8_t>(state >> 24);
+        }
+        read_raw_memory(pixels.data(), width, height, mode);
+    }
+
+    int ReadBmp(const std::string& filename) { return read_bmp(filename.c_str()); }
+    int WriteBmp(const std::string& filename) const { return write_bmp(filename.c_str()); }
+    void SetColorMode(IMAGE_COLOR_MODE mode, JobSystem* pJobs) { set_color_mode(mode, pJobs); }
+};
+
+int WriteNoiseBmp(const std::string& filename, uint32_t width, uint32_t height, uint32_t bytesPerPixel)
+{
+    BenchImage image;
+    image.Fill(width, height, bytesPerPixel == 1 ? IMAGE_COLOR_MODE_GRAYSCALE : IMAGE_COLOR_MODE_RGB);
+    return image.WriteBmp(filename);
+}
+
+void RunImageBenchmarks(BenchRunner& runner, const BENCH_CONFIG& config)
+{
+    std::vector<uint32_t> sizes = { 256, 1024, 2048 };
+    if (config.Quick) sizes.resize(1);
+
+    for (uint32_t size : sizes)
+    {
+        const uint64_t pixels = static_cast<uint64_t>(size) * size;
+        const std::string filename = config.TempDirectory + "/bench_" + std::to_string(size) + ".bmp";
+
+        BenchImage image;
+        image.Fill(size, size, IMAGE_COLOR_MODE_RGB);
+
+        runner.Run("image/write_bmp", size, 1, pixels, [&]()
+            {
+                image.WriteBmp(filename);
+            });
+
+        runner.Run("image/read_bmp", size, 1, pixels, [&]()
+            {
+                BenchImage read;
+                read.ReadBmp(filename);
+                DoNotOptimize(&read);
+            });
+
+        // To grayscale and back, so every operation starts from RGB
+        for (uint32_t threads : config.ThreadCounts)
+        {
+            std::unique_ptr<JobSystem> jobs(threads > 1 ? new JobSystem(threads) : nullptr);
+            runner.Run("image/set_color_mode", size, threads, pixels, [&]()
+                {
+                    image.SetColorMode(IMAGE_COLOR_MODE_GRAYSCALE, jobs.get());
+                    image.SetColorMode(IMAGE_COLOR_MODE_RGB, jobs.get());
+                });
+        }
+
+        std::remove(filename.c_str());
+    }
+}
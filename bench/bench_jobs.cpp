@@ -0,0 +1,78 @@
+/*****************************************************************//**
+ * \file   bench_jobs.cpp
+ * \brief  Benchmarks of JobSystem scaling with the thread count, against
+ *         a serial loop and threads spawned per loop
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "bench.h"
+#include "job_system.h"
+
+// Enough arithmetic per item that scaling is not bound by memory
+static void scale_values(float* values, uint32_t begin, uint32_t end)
+{
+    for (uint32_t i = begin; i < end; i++)
+    {
+        values[i] = std::sqrt(values[i] * 1.0001f + 1.0f);
+    }
+}
+
+void RunJobBenchmarks(BenchRunner& runner, const BENCH_CONFIG& config)
+{
+    std::vector<uint32_t> sizes = { 1u << 16, 1u << 20 };
+    if (config.Quick) sizes.resize(1);
+
+    for (uint32_t size : sizes)
+    {
+        std::vector<float> values(size);
+        for (uint32_t i = 0; i < size; i++) values[i] = static_cast<float>(i);
+
+        // Baselines the job system is measured against: the loop alone, and
+        // spawning threads for every loop as a plain std::thread version would
+        runner.Run("jobs/serial_for", size, 1, size, [&]()
+            {
+                scale_values(values.data(), 0, size);
+                DoNotOptimize(values.data());
+            });
+
+        for (uint32_t threads : config.ThreadCounts)
+        {
+            runner.Run("jobs/thread_per_call", size, threads, size, [&]()
+                {
+                    std::vector<std::thread> workers;
+                    for (uint32_t t = 1; t < threads; t++)
+                    {
+                        workers.emplace_back(scale_values, values.data(),
+                            static_cast<uint32_t>(uint64_t(size) * t / threads),
+                            static_cast<uint32_t>(uint64_t(size) * (t + 1) / threads));
+                    }
+                    scale_values(values.data(), 0, size / threads);
+                    for (std::thread& worker : workers) worker.join();
+                    DoNotOptimize(values.data());
+                });
+
+            JobSystem jobs(threads);
+
+            runner.Run("jobs/parallel_for", size, threads, size, [&]()
+                {
+                    jobs.ParallelFor(0, size, 4096, [&](uint32_t begin, uint32_t end)
+                        {
+                            scale_values(values.data(), begin, end);
+                        });
+                    DoNotOptimize(values.data());
+                });
+
+            // Cost of forking and joining with no work to hide it
+            runner.Run("jobs/empty_parallel_for", size, threads, 0, [&]()
+                {
+                    jobs.ParallelFor(0, size, 4096, [](uint32_t, uint32_t) { });
+                });
+        }
+    }
+}
@@ -0,0 +1,145 @@
+/*****************************************************************//**
+ * \file   bench_main.cpp
+ * \brief  Entry point of the benchmark executable
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "bench.h"
+#include "clock.h"
+#include "perf_counters.h"
+
+static void print_usage()
+{
+    std::cout <<
+        "Usage: phys-sim-bench [options]\n"
+        "  --filter <text>      run benchmarks whose name contains text\n"
+        "  --threads <list>     job system sizes, default 1,2,4,8,16,32,64\n"
+        "  --min-time <s>       time per benchmark, default 0.25\n"
+        "  --repetitions <n>    timed batches per benchmark, default 5\n"
+        "  --quick              smallest sizes only\n"
+        "  --json <file>        write results as JSON\n"
+        "  --baseline <file>    compare with results of an earlier --json\n"
+        "  --threshold <f>      slowdown counted as a regression, default 0.1\n"
+        "  --temp <dir>         directory for image files, default .\n"
+        "  --perf               report hardware counters of the instrumented zones\n";
+}
+
+// "1,2,4" into thread counts; false on anything else
+static bool parse_thread_counts(const char* text, std::vector<uint32_t>& counts)
+{
+    counts.clear();
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ','))
+    {
+        char* end = nullptr;
+        unsigned long count = std::strtoul(item.c_str(), &end, 10);
+        if (item.empty() || *end != '\0' || count == 0 || count > 1024) return false;
+        counts.push_back(static_cast<uint32_t>(count));
+    }
+    return !counts.empty();
+}
+
+int main(int argc, char* argv[])
+{
+    BENCH_PARAMS params;
+    BENCH_CONFIG config;
+    config.ThreadCounts = { 1, 2, 4, 8, 16, 32, 64 };
+    std::string jsonFilename;
+    std::string baselineFilename;
+    double threshold = 0.1;
+    bool perf = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        bool takesValue = true;
+
+        if (strcmp(arg, "--quick") == 0) { config.Quick = true; takesValue = false; }
+        else if (strcmp(arg, "--perf") == 0) { perf = true; takesValue = false; }
+        else if (strcmp(arg, "--help") == 0) { print_usage(); return 0; }
+        else if (value == nullptr) { print_usage(); return 2; }
+        else if (strcmp(arg, "--filter") == 0) params.Filter = value;
+        else if (strcmp(arg, "--json") == 0) jsonFilename = value;
+        else if (strcmp(arg, "--baseline") == 0) baselineFilename = value;
+        else if (strcmp(arg, "--temp") == 0) config.TempDirectory = value;
+        else if (strcmp(arg, "--min-time") == 0) params.MinSeconds = std::atof(value);
+        else if (strcmp(arg, "--repetitions") == 0) params.Repetitions = static_cast<uint32_t>(std::atoi(value));
+        else if (strcmp(arg, "--threshold") == 0) threshold = std::atof(value);
+        else if (strcmp(arg, "--threads") == 0)
+        {
+            if (!parse_thread_counts(value, config.ThreadCounts))
+            {
+                std::cerr << "Invalid thread counts: " << value << '\n';
+                return 2;
+            }
+        }
+        else { print_usage(); return 2; }
+
+        if (takesValue) i++;
+    }
+
+    // Read the baseline first, so a bad file fails before minutes of timing
+    std::vector<BENCH_RESULT> baseline;
+    if (!baselineFilename.empty())
+    {
+        std::string error;
+        if (!ReadBenchJson(baselineFilename, baseline, error))
+        {
+            std::cerr << "Baseline: " << error << '\n';
+            return 2;
+        }
+    }
+
+    Clock::EnableTsc();
+    PerfProfiler::Instance().SetEnabled(perf);
+
+    BenchRunner runner(params);
+    RunImageBenchmarks(runner, config);
+    RunUploadBenchmarks(runner, config);
+    RunJobBenchmarks(runner, config);
+    RunMeshBenchmarks(runner, config);
+    RunRenderBenchmarks(runner, config);
+
+    const std::vector<BENCH_RESULT>& results = runner.Results();
+    for (const BENCH_RESULT& result : results)
+    {
+        std::cout << result.Key() << ": " << result.NsPerOp << " ns/op (min " << result.MinNsPerOp << ")";
+        if (result.ItemsPerSecond > 0.0) std::cout << ", " << result.ItemsPerSecond * 1e-6 << " M items/s";
+        std::cout << '\n';
+    }
+
+    if (perf)
+    {
+        std::cout << '\n';
+        PerfProfiler::Instance().WriteReport(std::cout);
+    }
+
+    if (!jsonFilename.empty())
+    {
+        std::ofstream file(jsonFilename, std::ios::out | std::ios::trunc);
+        BenchRunner::WriteJson(file, results);
+        if (!file)
+        {
+            std::cerr << "Failed to write " << jsonFilename << '\n';
+            return 2;
+        }
+    }
+
+    if (!baseline.empty())
+    {
+        std::cout << '\n';
+        uint32_t regressions = CompareToBaseline(results, baseline, threshold, std::cout);
+        std::cout << regressions << " regression(s) over " << threshold * 100.0 << "%\n";
+        if (regressions > 0) return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,107 @@
+/*****************************************************************//**
+ * \file   bench_mesh.cpp
+ * \brief  Benchmarks of mesh generation and camera matrices
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include "bench.h"
+
+// DirectXMath ships with the Windows SDK; on other systems these
+// benchmarks are built only if its headers are on the include path
+#if defined(_WIN32)
+#define BENCH_HAS_DIRECTXMATH 1
+#elif defined(__has_include)
+#if __has_include(<DirectXMath.h>)
+#define BENCH_HAS_DIRECTXMATH 1
+#endif
+#endif
+
+#if defined(BENCH_HAS_DIRECTXMATH)
+
+#include <cstdio>
+#include <memory>
+
+#include "mesh_gen.h"
+#include "pass_matrices.h"
+
+#if defined(_WIN32)
+#include "d3dcamera.h"
+#endif
+
+using namespace DirectX;
+
+void RunMeshBenchmarks(BenchRunner& runner, const BENCH_CONFIG& config)
+{
+    // 16-bit indices limit the terrain to 256 by 256 pixels
+    std::vector<uint32_t> sizes = { 128, 256 };
+    if (config.Quick) sizes.resize(1);
+
+    for (uint32_t size : sizes)
+    {
+        const std::string filename = config.TempDirectory + "/bench_heightmap_" + std::to_string(size) + ".bmp";
+        if (WriteNoiseBmp(filename, size, size, 1) < 0) continue;
+
+        HeightmapImage heightmap(filename);
+        const uint64_t vertices = static_cast<uint64_t>(size - 2) * (size - 2);
+
+        for (uint32_t threads : config.ThreadCounts)
+        {
+            std::unique_ptr<JobSystem> jobs(threads > 1 ? new JobSystem(threads) : nullptr);
+            runner.Run("mesh/terrain", size, threads, vertices, [&]()
+                {
+                    MESH_DATA mesh;
+                    GenerateTerrainMesh(heightmap, jobs.get(), mesh);
+                    DoNotOptimize(mesh.Vertices.data());
+                });
+        }
+
+        runner.Run("mesh/plane", size, 1, static_cast<uint64_t>(size) * size, [&]()
+            {
+                MESH_DATA mesh;
+                GeneratePlaneMesh(size, size, 100.0f, 100.0f, mesh);
+                DoNotOptimize(mesh.Vertices.data());
+            });
+
+        std::remove(filename.c_str());
+    }
+
+    // Once per frame in UpdatePassCB
+    XMFLOAT4X4 view;
+    XMFLOAT4X4 proj;
+    XMStoreFloat4x4(&view, XMMatrixLookToLH(XMVectorSet(0.0f, 10.0f, -20.0f, 1.0f),
+        XMVectorSet(0.0f, -0.3f, 1.0f, 0.0f), XMVectorSet(0.0f, 1.0f, 0.3f, 0.0f)));
+    XMStoreFloat4x4(&proj, XMMatrixPerspectiveFovLH(0.25f * XM_PI, 16.0f / 9.0f, 1.0f, 1000.0f));
+
+    runner.Run("camera/pass_matrices", 1, 1, 1, [&]()
+        {
+            PASS_MATRICES matrices;
+            XMFLOAT4X4 viewProj;
+            ComputePassMatrices(view, proj, matrices, viewProj);
+            DoNotOptimize(&matrices);
+        });
+
+#if defined(_WIN32)
+    // Reads the keyboard, so it needs Windows
+    Camera camera(XMVectorSet(0.0f, 10.0f, -20.0f, 1.0f), 0.0f, 0.0f);
+    runner.Run("camera/update", 1, 1, 1, [&]()
+        {
+            camera.Update(1.0f / 60.0f);
+            DoNotOptimize(&camera.mView);
+        });
+#endif
+}
+
+#else
+
+#include <iostream>
+
+void RunMeshBenchmarks(BenchRunner& runner, const BENCH_CONFIG&)
+{
+    if (runner.Selected("mesh/") || runner.Selected("camera/"))
+    {
+        std::cerr << "Mesh and camera benchmarks skipped: DirectXMath.h not found\n";
+    }
+}
+
+#endif
@@ -0,0 +1,287 @@
+/*****************************************************************//**
+ * \file   bench_render.cpp
+ * \brief  Benchmarks of the CPU side of rendering: culling, light
+ *         clustering and the render queue
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+#include "bench.h"
+#include "clustered_lights.h"
+#include "frustum_cull.h"
+#include "job_system.h"
+#include "occlusion.h"
+#include "render_queue.h"
+
+// Same scene setup as the application: 45 degree field of view, planes at 1 and 1000
+static const float NearZ = 1.0f;
+static const float FarZ = 1000.0f;
+static const float AspectRatio = 16.0f / 9.0f;
+
+// Deterministic uniform numbers in [lo, hi), so every run sees the same scene
+class SceneRandom
+{
+public:
+    float Uniform(float lo, float hi)
+    {
+        m_state = m_state * 1103515245u + 12345u;
+        return lo + (hi - lo) * static_cast<float>(m_state >> 8) / 16777216.0f;
+    }
+
+    uint32_t Below(uint32_t count)
+    {
+        m_state = m_state * 1103515245u + 12345u;
+        return (m_state >> 8) % count;
+    }
+
+private:
+    uint32_t m_state = 12345;
+};
+
+// Perspective projection as XMMatrixPerspectiveFovLH builds it. The camera sits
+// at the origin looking down +z, so this is the view-projection as well.
+static void perspective(float m[16])
+{
+    const float scaleY = 1.0f / std::tan(0.125f * 3.14159265f);
+    const float range = FarZ / (FarZ - NearZ);
+
+    std::fill(m, m + 16, 0.0f);
+    m[0] = scaleY / AspectRatio;
+    m[5] = scaleY;
+    m[10] = range;
+    m[11] = 1.0f;
+    m[14] = -range * NearZ;
+}
+
+static void identity(float m[16])
+{
+    std::fill(m, m + 16, 0.0f);
+    m[0] = m[5] = m[10] = m[15] = 1.0f;
+}
+
+// Objects scattered around the camera, about a quarter of them in view
+static void random_bounds(uint32_t count, CullingBounds& bounds)
+{
+    SceneRandom random;
+    bounds.Clear();
+    bounds.Reserve(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        MESH_BOUNDS b;
+        b.Center[0] = random.Uniform(-500.0f, 500.0f);
+        b.Center[1] = random.Uniform(-20.0f, 40.0f);
+        b.Center[2] = random.Uniform(-500.0f, 500.0f);
+        for (int axis = 0; axis < 3; axis++) b.Extents[axis] = random.Uniform(0.5f, 4.0f);
+        b.Radius = std::sqrt(b.Extents[0] * b.Extents[0] + b.Extents[1] * b.Extents[1] +
+            b.Extents[2] * b.Extents[2]);
+        bounds.Add(b);
+    }
+}
+
+static void run_frustum(BenchRunner& runner, const BENCH_CONFIG& config)
+{
+    if (!runner.Selected("render/frustum_cull")) return;
+
+    uint32_t count = config.Quick ? 100000 : 1000000;
+    CullingBounds bounds;
+    random_bounds(count, bounds);
+
+    float viewProj[16];
+    perspective(viewProj);
+    FRUSTUM_PLANES frustum = ExtractFrustumPlanes(viewProj);
+
+    std::vector<uint32_t> visible;
+    for (uint32_t threads : config.ThreadCounts)
+    {
+        JobSystem jobs(threads);
+        FrustumCuller culler(&jobs);
+        runner.Run("render/frustum_cull", count, threads, count, [&]()
+            {
+                culler.Cull(frustum, bounds, visible);
+                DoNotOptimize(visible.data());
+            });
+    }
+}
+
+static void run_occlusion(BenchRunner& runner, const BENCH_CONFIG& config)
+{
+    if (!runner.Selected("render/occlusion")) return;
+
+    // Rolling terrain in front of the camera, 512x512 on purpose: four times
+    // the side of the shipped 128x128 heightmap, so the occluder build and
+    // rasterization are measured at a size larger scenes will reach
+    const uint32_t size = 512;
+    std::vector<uint8_t> heights(size * size);
+    for (uint32_t row = 0; row < size; row++)
+    {
+        for (uint32_t col = 0; col < size; col++)
+        {
+            float wave = std::sin(col * 0.05f) * std::cos(row * 0.03f);
+            heights[row * size + col] = static_cast<uint8_t>(128.0f + 120.0f * wave);
+        }
+    }
+
+    // The application's 8-sample occluder grid and depth buffer size
+    OCCLUDER_MESH occluder = BuildHeightfieldOccluder(heights.data(), size, size, size, 8,
+        -256.0f, 512.0f, 1.0f, 1.0f, 1.0f / 8.0f, -20.0f);
+
+    uint32_t count = config.Quick ? 10000 : 100000;
+    CullingBounds bounds;
+    random_bounds(count, bounds);
+
+    float viewProj[16];
+    perspective(viewProj);
+
+    std::vector<uint32_t> all(count);
+    for (uint32_t i = 0; i < count; i++) all[i] = i;
+    std::vector<uint32_t> visible;
+
+    for (uint32_t threads : config.ThreadCounts)
+    {
+        JobSystem jobs(threads);
+        OcclusionCuller culler(256, 128, &jobs);
+        culler.SetOccluder(occluder);
+
+        runner.Run("render/occlusion_render", occluder.Indices.size() / 3, threads,
+            occluder.Indices.size() / 3, [&]()
+            {
+                culler.Render(viewProj);
+                DoNotOptimize(culler.LevelDepth(0));
+            });
+
+        // Testing does not depend on the thread count
+        if (threads != config.ThreadCounts.front()) continue;
+        runner.Run("render/occlusion_cull", count, 1, count, [&]()
+            {
+                visible = all;
+                culler.Cull(bounds, visible);
+                DoNotOptimize(visible.data());
+            });
+    }
+}
+
+static void run_clustering(BenchRunner& runner, const BENCH_CONFIG& config)
+{
+    if (!runner.Selected("render/cluster_lights")) return;
+
+    std::vector<uint32_t> counts = { 1000, 10000 };
+    if (config.Quick) counts.resize(1);
+
+    float proj[16];
+    perspective(proj);
+    float view[16];
+    identity(view);
+
+    for (uint32_t count : counts)
+    {
+        // Lights spread through the view volume, one in four a spot light
+        SceneRandom random;
+        std::vector<CLUSTER_LIGHT> lights(count);
+        for (CLUSTER_LIGHT& light : lights)
+        {
+            light.Position[2] = random.Uniform(NearZ, 300.0f);
+            light.Position[0] = random.Uniform(-0.8f, 0.8f) * light.Position[2];
+            light.Position[1] = random.Uniform(-0.5f, 0.5f) * light.Position[2];
+            light.Range = random.Uniform(2.0f, 20.0f);
+            light.Direction[0] = 0.0f;
+            light.Direction[1] = -1.0f;
+            light.Direction[2] = 0.0f;
+            light.SpotAngle = random.Below(4) == 0 ? 0.5f : 0.0f;
+        }
+
+        for (uint32_t threads : config.ThreadCounts)
+        {
+            JobSystem jobs(threads);
+            LightClusterer clusterer(&jobs);
+            clusterer.SetGrid(16, 8, 24, proj[0], proj[5], NearZ, FarZ);
+
+            runner.Run("render/cluster_lights", count, threads, count, [&]()
+                {
+                    clusterer.Build(view, lights.data(), count);
+                    DoNotOptimize(clusterer.LightIndices().data());
+                });
+        }
+    }
+}
+
+// Opaque packets of objects spread over drawableCount drawables
+static std::vector<RENDER_PACKET> random_packets(uint32_t count, uint32_t drawableCount)
+{
+    SceneRandom random;
+    std::vector<RENDER_PACKET> packets(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t drawable = random.Below(drawableCount);
+        packets[i].Key = RenderQueue::OpaqueKey(0, drawable % 4, drawable % 16, drawable,
+            random.Uniform(0.0f, 1.0f), random.Below(64));
+        packets[i].DrawableIndex = drawable;
+        packets[i].ObjectIndex = i;
+        packets[i].LightMask = 1;
+    }
+    return packets;
+}
+
+static void run_queue(BenchRunner& runner, const BENCH_CONFIG& config)
+{
+    // Every packet a different state, so sorting does all the work
+    const uint32_t sortCount = config.Quick ? 10000 : 100000;
+    if (runner.Selected("render/queue_sort"))
+    {
+        std::vector<RENDER_PACKET> packets = random_packets(sortCount, 1u << 16);
+        std::vector<RENDER_PACKET> sorted;
+        std::vector<RENDER_PACKET> scratch;
+
+        runner.Run("render/queue_sort", sortCount, 1, sortCount, [&]()
+            {
+                sorted = packets;
+                RadixSortPackets(sorted, scratch);
+                DoNotOptimize(sorted.data());
+            });
+
+        // What the radix sort replaces
+        runner.Run("render/queue_sort_std", sortCount, 1, sortCount, [&]()
+            {
+                sorted = packets;
+                std::stable_sort(sorted.begin(), sorted.end(),
+                    [](const RENDER_PACKET& a, const RENDER_PACKET& b) { return a.Key < b.Key; });
+                DoNotOptimize(sorted.data());
+            });
+    }
+
+    // A frame's worth of objects drawn with few meshes: submission, sorting
+    // and merging into instanced batches, as BuildRenderQueue does
+    if (runner.Selected("render/instancing"))
+    {
+        std::vector<uint32_t> counts = { 10000, 100000, 1000000 };
+        if (config.Quick) counts.resize(1);
+
+        for (uint32_t count : counts)
+        {
+            std::vector<RENDER_PACKET> packets = random_packets(count, 64);
+            RenderQueue queue;
+
+            runner.Run("render/instancing", count, 1, count, [&]()
+                {
+                    queue.Begin();
+                    for (const RENDER_PACKET& packet : packets)
+                    {
+                        queue.Submit(packet.Key, packet.DrawableIndex, packet.ObjectIndex, packet.LightMask);
+                    }
+                    queue.Sort();
+                    DoNotOptimize(queue.Batches().data());
+                });
+        }
+    }
+}
+
+void RunRenderBenchmarks(BenchRunner& runner, const BENCH_CONFIG& config)
+{
+    run_frustum(runner, config);
+    run_occlusion(runner, config);
+    run_clustering(runner, config);
+    run_queue(runner, config);
+}
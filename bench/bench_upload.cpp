@@ -0,0 +1,116 @@
+/*****************************************************************//**
+ * \file   bench_upload.cpp
+ * \brief  Benchmarks of packing per-object constants for upload
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include <cstring>
+
+#include "bench.h"
+#include "stream_copy.h"
+
+// sizeof(ObjectConstants), and the slot each takes in a constant buffer
+static const size_t ObjectConstantsSize = 80;
+static const size_t ConstantBufferSlot = 256;
+
+// Upload heaps are never in the CPU caches. Host memory comes closest to
+// that when every operation writes a region the last ones did not touch.
+static const size_t ColdPoolBytes = size_t(512) << 20;
+
+// Aligned regions of host memory written in turn, allocated on first use
+// so that filtered out benchmarks cost nothing
+class DestinationPool
+{
+public:
+    DestinationPool(size_t regionBytes, size_t poolBytes)
+        : m_regionBytes((regionBytes + 255) & ~static_cast<size_t>(255))
+    {
+        m_regionCount = poolBytes / m_regionBytes > 0 ? poolBytes / m_regionBytes : 1;
+    }
+
+    uint8_t* Next()
+    {
+        if (m_base == nullptr)
+        {
+            m_memory.assign(m_regionCount * m_regionBytes + 255, 0);
+            m_base = reinterpret_cast<uint8_t*>(
+                (reinterpret_cast<size_t>(m_memory.data()) + 255) & ~static_cast<size_t>(255));
+        }
+
+        uint8_t* region = m_base + m_next * m_regionBytes;
+        m_next = (m_next + 1) % m_regionCount;
+        return region;
+    }
+
+private:
+    std::vector<uint8_t> m_memory;
+    uint8_t* m_base = nullptr;
+    size_t m_regionBytes = 0;
+    size_t m_regionCount = 0;
+    size_t m_next = 0;
+};
+
+static void run_upload(BenchRunner& runner, const char* suffix, uint32_t count, size_t poolBytes,
+    const std::vector<uint8_t>& source)
+{
+    const std::string prefix = "upload/";
+
+    // Constant buffer slots, as UploadBuffer and LinearAllocator::PushArray write them
+    DestinationPool slots(count * ConstantBufferSlot, poolBytes);
+    runner.Run(prefix + "copy_data" + suffix, count, 1, count, [&]()
+        {
+            uint8_t* pDst = slots.Next();
+            for (uint32_t i = 0; i < count; i++)
+            {
+                memcpy(pDst + i * ConstantBufferSlot, source.data() + i * ObjectConstantsSize,
+                    ObjectConstantsSize);
+            }
+            DoNotOptimize(pDst);
+        });
+
+    runner.Run(prefix + "stream_scatter" + suffix, count, 1, count, [&]()
+        {
+            uint8_t* pDst = slots.Next();
+            StreamScatter(pDst, ConstantBufferSlot, source.data(), ObjectConstantsSize,
+                ObjectConstantsSize, count);
+            StreamFence();
+            DoNotOptimize(pDst);
+        });
+
+    // Tightly packed structured buffer, copied in one go as by
+    // LinearAllocator::PushStructured
+    DestinationPool packed(count * ObjectConstantsSize, poolBytes);
+    runner.Run(prefix + "structured_memcpy" + suffix, count, 1, count, [&]()
+        {
+            uint8_t* pDst = packed.Next();
+            memcpy(pDst, source.data(), count * ObjectConstantsSize);
+            DoNotOptimize(pDst);
+        });
+
+    runner.Run(prefix + "structured_stream" + suffix, count, 1, count, [&]()
+        {
+            uint8_t* pDst = packed.Next();
+            StreamCopy(pDst, source.data(), count * ObjectConstantsSize);
+            StreamFence();
+            DoNotOptimize(pDst);
+        });
+}
+
+void RunUploadBenchmarks(BenchRunner& runner, const BENCH_CONFIG& config)
+{
+    std::vector<uint32_t> counts = { 1024, 16384, 65536 };
+    if (config.Quick) counts.resize(1);
+
+    for (uint32_t count : counts)
+    {
+        std::vector<uint8_t> source(count * ObjectConstantsSize);
+        for (size_t i = 0; i < source.size(); i++) source[i] = static_cast<uint8_t>(i);
+
+        run_upload(runner, "", count, ColdPoolBytes, source);
+
+        // The same destination every time, so it stays in cache. Streaming
+        // stores lose here, since they evict lines memcpy would hit.
+        run_upload(runner, "_cached", count, 0, source);
+    }
+}
@@ -10,25 +10,57 @@
 #define NUM_SPOT_LIGHTS 0
 #endif
 
+cbuffer cbInstance : register(b1)
+{
+    uint gInstanceBase;     // First instance of the current draw
+    uint2 gLightIndices;    // Slots in gLights of the lights of the draw, 4 bits each
+};
+
+// Lights of a draw are a compact list of slots, so that variants only
+// loop over the lights that reach the draw.
+#define LIGHT_INDEX(i) ((gLightIndices[(i) / 8] >> (((i) % 8) * 4)) & 0xF)
+
 // Include structures and functions for lighting.
 #include "util.hlsl"
 
-// Constant data that varies per frame.
+// Data of all objects and materials of the frame.
+
+struct ObjectData
+{
+    float4x4 World;
+    uint MaterialIndex;
+    uint3 _pad;
+};
 
-cbuffer cbPerObject : register(b1)
+struct MaterialData
 {
-    float4x4 gWorld;
+    float4 DiffuseAlbedo;
+    float3 FresnelR0;
+    float Roughness;
+    float4x4 MatTransform;
 };
 
-cbuffer cbMaterial : register(b2)
+StructuredBuffer<ObjectData> gObjects : register(t0, space1);
+StructuredBuffer<MaterialData> gMaterials : register(t1, space1);
+
+// Object indices of instanced draws, see RenderQueue::InstanceObjects.
+StructuredBuffer<uint> gInstanceObjects : register(t2, space1);
+
+#ifdef CLUSTERED_LIGHTS
+// Point and spot lights that do not fit in gLights, binned on the CPU into
+// view-space clusters, see LightClusterer. Each cluster is a range of indices.
+struct ClusterRange
 {
-    float4 gDiffuseAlbedo;
-    float3 gFresnelR0;
-    float gRoughness;
-    float4x4 gMatTransform;
+    uint Offset;
+    uint Count;
 };
 
-// Constant data that varies per material.
+StructuredBuffer<Light> gClusterLights : register(t3, space1);
+StructuredBuffer<ClusterRange> gClusterRanges : register(t4, space1);
+StructuredBuffer<uint> gClusterLightIndices : register(t5, space1);
+#endif
+
+// Camera and timing, updated every frame.
 cbuffer cbPass : register(b0)
 {
     float4x4 gView;
@@ -45,19 +77,54 @@ cbuffer cbPass : register(b0)
     float gFarZ;
     float gTotalTime;
     float gDeltaTime;
+};
+
+// Lighting and fog, updated only when they change.
+cbuffer cbEnvironment : register(b2)
+{
     float4 gAmbientLight;
 
 	float4 gFogColor;
 	float gFogStart;
 	float gFogRange;
 
-    // Indices [0, NUM_DIR_LIGHTS) are directional lights;
-    // indices [NUM_DIR_LIGHTS, NUM_DIR_LIGHTS+NUM_POINT_LIGHTS) are point lights;
-    // indices [NUM_DIR_LIGHTS+NUM_POINT_LIGHTS, NUM_DIR_LIGHTS+NUM_POINT_LIGHT+NUM_SPOT_LIGHTS)
-    // are spot lights for a maximum of MaxLights per object.
+    // Directional lights come first, then point lights, then spot lights,
+    // for a maximum of MaxLights. Draws pick theirs through gLightIndices.
     Light gLights[MaxLights];
+
+    // Cluster grid: tiles of the screen by exponential depth slices
+    float2 gClusterTileScale;
+    float gClusterSliceScale;
+    float gClusterSliceBias;
+    uint gClusterTilesX;
+    uint gClusterTilesY;
+    uint gClusterSlices;
 };
 
+#ifdef CLUSTERED_LIGHTS
+float3 ComputeClusteredLights(float4 posH, Material mat, float3 pos, float3 normal, float3 toEye)
+{
+    // SV_Position holds the pixel in xy and the view depth in w
+    uint2 tile = min(uint2(posH.xy * gClusterTileScale), uint2(gClusterTilesX, gClusterTilesY) - 1);
+    uint slice = (uint) clamp(log2(posH.w) * gClusterSliceScale + gClusterSliceBias,
+        0.0f, gClusterSlices - 1.0f);
+    ClusterRange range = gClusterRanges[tile.x + gClusterTilesX * (tile.y + gClusterTilesY * slice)];
+
+    float3 result = 0.0f;
+    for (uint i = 0; i < range.Count; ++i)
+    {
+        Light L = gClusterLights[gClusterLightIndices[range.Offset + i]];
+
+        // Point lights have no spot power
+        if (L.SpotPower > 0.0f)
+            result += ComputeSpotLight(L, mat, pos, normal, toEye);
+        else
+            result += ComputePointLight(L, mat, pos, normal, toEye);
+    }
+    return result;
+}
+#endif
+
 SamplerState gSamLinearWrap : register(s0);
 
 Texture2D gDiffuseMap : register(t0);
@@ -75,18 +142,22 @@ struct VertexOut
     float3 PosW : POSITION;
     float3 NormalW : NORMAL;
 	float2 TexC : TEXCOORD;
+    nointerpolation uint MatIndex : MATINDEX;
 };
 
-VertexOut VS(VertexIn vin)
+VertexOut VS(VertexIn vin, uint instanceID : SV_InstanceID)
 {
     VertexOut vout = (VertexOut) 0.0f;
+
+    ObjectData object = gObjects[gInstanceObjects[gInstanceBase + instanceID]];
+    vout.MatIndex = object.MaterialIndex;
 	
     // Transform to world space.
-    float4 posW = mul(float4(vin.PosL, 1.0f), gWorld);
+    float4 posW = mul(float4(vin.PosL, 1.0f), object.World);
     vout.PosW = posW.xyz;
 
     // Assumes nonuniform scaling; otherwise, need to use inverse-transpose of world matrix.
-    vout.NormalW = mul(vin.NormalL, (float3x3) gWorld);
+    vout.NormalW = mul(vin.NormalL, (float3x3) object.World);
 
     // Transform to homogeneous clip space.
     vout.PosH = mul(posW, gViewProj);
@@ -98,6 +169,8 @@ VertexOut VS(VertexIn vin)
 
 float4 PS(VertexOut pin) : SV_Target
 {
+    MaterialData material = gMaterials[pin.MatIndex];
+
     // Interpolating normal can unnormalize it, so renormalize it.
     pin.NormalW = normalize(pin.NormalW);
 
@@ -105,7 +178,7 @@ float4 PS(VertexOut pin) : SV_Target
 	float distToEye = length(gEyePosW - pin.PosW);
     float3 toEyeW = (gEyePosW - pin.PosW) / distToEye;
 
-	float4 diffuseAlbedo = gDiffuseMap.Sample(gSamLinearWrap, pin.TexC) * gDiffuseAlbedo;
+	float4 diffuseAlbedo = gDiffuseMap.Sample(gSamLinearWrap, pin.TexC) * material.DiffuseAlbedo;
 
 #ifdef ALPHA_TEST
 	clip(diffuseAlbedo.a - 0.1f);
@@ -114,12 +187,16 @@ float4 PS(VertexOut pin) : SV_Target
 	// Indirect lighting.
     float4 ambient = gAmbientLight * diffuseAlbedo;
 
-    const float shininess = 1.0f - gRoughness;
-    Material mat = { diffuseAlbedo, gFresnelR0, shininess };
+    const float shininess = 1.0f - material.Roughness;
+    Material mat = { diffuseAlbedo, material.FresnelR0, shininess };
     float3 shadowFactor = 1.0f;
     float4 directLight = ComputeLighting(gLights, mat, pin.PosW,
         pin.NormalW, toEyeW, shadowFactor);
 
+#ifdef CLUSTERED_LIGHTS
+    directLight.rgb += ComputeClusteredLights(pin.PosH, mat, pin.PosW, pin.NormalW, toEyeW);
+#endif
+
     float4 litColor = ambient + directLight;
 
 #ifdef FOG
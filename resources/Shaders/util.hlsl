@@ -9,6 +9,11 @@
 
 #define MaxLights 16
 
+// Maps the i-th light of a draw to its slot in the light array
+#ifndef LIGHT_INDEX
+#define LIGHT_INDEX(i) (i)
+#endif
+
 struct Material
 {
     float4 DiffuseAlbedo;
@@ -174,21 +179,21 @@ float4 ComputeLighting(Light gLights[MaxLights], Material mat,
 #if (NUM_DIR_LIGHTS > 0)
     for(i = 0; i < NUM_DIR_LIGHTS; ++i)
     {
-        result += shadowFactor[i] * ComputeDirectionalLight(gLights[i], mat, normal, toEye);
+        result += shadowFactor[i] * ComputeDirectionalLight(gLights[LIGHT_INDEX(i)], mat, normal, toEye);
     }
 #endif
 
 #if (NUM_POINT_LIGHTS > 0)
     for(i = NUM_DIR_LIGHTS; i < NUM_DIR_LIGHTS+NUM_POINT_LIGHTS; ++i)
     {
-        result += ComputePointLight(gLights[i], mat, pos, normal, toEye);
+        result += ComputePointLight(gLights[LIGHT_INDEX(i)], mat, pos, normal, toEye);
     }
 #endif
 
 #if (NUM_SPOT_LIGHTS > 0)
     for(i = NUM_DIR_LIGHTS + NUM_POINT_LIGHTS; i < NUM_DIR_LIGHTS + NUM_POINT_LIGHTS + NUM_SPOT_LIGHTS; ++i)
     {
-        result += ComputeSpotLight(gLights[i], mat, pos, normal, toEye);
+        result += ComputeSpotLight(gLights[LIGHT_INDEX(i)], mat, pos, normal, toEye);
     }
 #endif 
 
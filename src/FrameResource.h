@@ -11,25 +11,33 @@
 #include <DirectXMath.h>
 #include <wrl.h>
 #include <memory>
+#include <vector>
 
-#include "UploadBuffer.h"
-#include "RingBuffer.h"
+#include "linearallocator.h"
 #include "d3dUtil.h"
 #include "structures.h"
 
 struct FrameResource
 {
 public:
-	// Constructor to create command allocator and initialize memory
-	// for frame constant buffers
-	FrameResource(ID3D12Device* pDevice, UINT passCount, UINT materialCount, std::vector<ObjectConstants>& objCPU)
+	// Constructor to create command allocators and lists of the recording
+	// threads and initialize memory for frame constant buffers
+	FrameResource(ID3D12Device* pDevice, UINT64 constantBufferByteSize, UINT workerCount)
 	{
-		pDevice->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT,
-			IID_PPV_ARGS(CommandListAllocator.GetAddressOf()));
+		CommandAllocators.resize(workerCount);
+		CommandLists.resize(workerCount);
+		for (UINT i = 0; i < workerCount; i++)
+		{
+			ThrowIfFailed(pDevice->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT,
+				IID_PPV_ARGS(CommandAllocators[i].GetAddressOf())));
+			ThrowIfFailed(pDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT,
+				CommandAllocators[i].Get(), nullptr, IID_PPV_ARGS(CommandLists[i].GetAddressOf())));
 
-		PassCB = std::make_unique<UploadBuffer<PassConstants>>(pDevice, passCount, true);
-		ObjectCB = std::make_unique<RingBuffer<ObjectConstants, 16>>(pDevice, true, objCPU);
-		MaterialCB = std::make_unique<UploadBuffer<MaterialConstants>>(pDevice, materialCount, true);
+			// Lists are reset by the thread that records them
+			ThrowIfFailed(CommandLists[i]->Close());
+		}
+
+		ConstantAllocator = std::make_unique<LinearAllocator>(pDevice, constantBufferByteSize);
 	}
 
 	~FrameResource() { }
@@ -37,14 +45,29 @@ public:
 	FrameResource& operator=(const FrameResource& rhs) = delete;
 
 	// We cannot reset command allocator until the GPU is done
-	// processing the commands it stores, so each frame gets its own allocator.
-	Microsoft::WRL::ComPtr<ID3D12CommandAllocator>		CommandListAllocator = nullptr;
-
-	// Each frame has its own associated constant buffer resources, used
-	// to render the scene.
-	std::unique_ptr<UploadBuffer<PassConstants>>		PassCB = nullptr;
-	std::unique_ptr<RingBuffer<ObjectConstants, 16>>	ObjectCB = nullptr;
-	std::unique_ptr<UploadBuffer<MaterialConstants>>	MaterialCB = nullptr;
+	// processing the commands it stores, so each frame gets its own allocators.
+	// There is one per recording thread, as allocators are not thread safe.
+	std::vector<Microsoft::WRL::ComPtr<ID3D12CommandAllocator>>		CommandAllocators;
+	std::vector<Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList>>	CommandLists;
+
+	// Each frame has its own constant buffer memory, used to render the scene.
+	// All constants of the frame are packed into it by DynamicResources.
+	std::unique_ptr<LinearAllocator>					ConstantAllocator = nullptr;
+
+	// GPU addresses of the data packed for this frame
+	D3D12_GPU_VIRTUAL_ADDRESS PassCBAddress = 0;
+	D3D12_GPU_VIRTUAL_ADDRESS EnvironmentCBAddress = 0;
+	D3D12_GPU_VIRTUAL_ADDRESS MaterialBufferAddress = 0;	// StructuredBuffer<MaterialConstants>
+	D3D12_GPU_VIRTUAL_ADDRESS ObjectBufferAddress = 0;		// StructuredBuffer<ObjectConstants>
+	D3D12_GPU_VIRTUAL_ADDRESS InstanceBufferAddress = 0;	// StructuredBuffer<uint> of object indices
+	D3D12_GPU_VIRTUAL_ADDRESS ClusterLightsAddress = 0;		// StructuredBuffer<Light>
+	D3D12_GPU_VIRTUAL_ADDRESS ClusterRangesAddress = 0;		// StructuredBuffer<CLUSTER_RANGE>
+	D3D12_GPU_VIRTUAL_ADDRESS ClusterIndicesAddress = 0;	// StructuredBuffer<uint> of light indices
+
+	// Generation of CPU constant data this frame resource last received.
+	// Zero means the contents of the allocator are not valid.
+	UINT64 ConstantsGeneration = 0;
+	UINT ObjectCount = 0;		// Scene size the constant layout was built for
 
 	// Fence value to mark commands up to this fence point. This lets us
 	// check if the resource is still in use by the GPU.
@@ -10,6 +10,8 @@
 //	CopyData(int elementIndex, const T& data) - copies contents of T		*
 //	to the [elementIndex] entry to the buffer, using CB padding if necessary*
 //	Is used to copy only one element, for an array an overload can be used.	*
+//	Writes are streamed: call StreamFence() once after the last CopyData	*
+//	of an upload pass, before the GPU may read the buffer.					*
 //																			*
 // **************************************************************************
 
@@ -18,6 +20,7 @@
 #include <wrl.h>
 
 #include "d3dUtil.h"
+#include "stream_copy.h"
 
 /**
  * Class-wrapper for GPU upload buffer.
@@ -85,20 +88,24 @@ public:
 	// Getter for ID3D12Resource interface
 	ID3D12Resource* Resource() const { return mUploadBuffer.Get(); }
 
-	// Copy given element to the buffer at [elementIndex] slot
+	// Copy given element to the buffer at [elementIndex] slot.
+	// Does not fence, so that updating many elements one by one costs a
+	// single StreamFence() at the end of the pass.
 	void CopyData(int elementIndex, const T& data)
 	{
-		memcpy(&mMappedData[elementIndex * mElementByteSize],
-			&data, sizeof(T));
+		CopyData(elementIndex, 1, &data);
 	}
 
-	// Convenience method to copy an array of data, including CB padding
+	// Convenience method to copy an array of data, including CB padding.
+	// Mapped memory is write-combined, so whole aligned blocks are streamed
+	// when the element layout allows it. Prefer it to a loop of single
+	// copies; the caller fences as above.
 	void CopyData(int firstElementIndex, int numElements, const T* dataArray)
 	{
-		for (int i = 0; i < numElements; i++)
-		{
-			CopyData(firstElementIndex + i, dataArray[i]);
-		}
+		BYTE* pDst = &mMappedData[firstElementIndex * mElementByteSize];
+
+		StreamScatter(pDst, mElementByteSize, dataArray, sizeof(T),
+			sizeof(T), numElements);
 	}
 
 	D3D12_GPU_VIRTUAL_ADDRESS GetGPUHandle(int index)
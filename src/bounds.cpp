@@ -0,0 +1,97 @@
+/*****************************************************************//**
+ * \file   bounds.cpp
+ * \brief  Definition of bounding volume helpers
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include <cmath>
+#include <cfloat>
+
+#include "bounds.h"
+
+static inline const float* position_at(const float* pPositions, size_t strideBytes, size_t index)
+{
+    return reinterpret_cast<const float*>(
+        reinterpret_cast<const unsigned char*>(pPositions) + strideBytes * index);
+}
+
+// Builds bounds from a box given by its corners, then fits the sphere
+// around the points so that it is not larger than needed
+template<typename PositionAt>
+static MESH_BOUNDS compute_bounds(size_t count, PositionAt positionAt)
+{
+    MESH_BOUNDS bounds;
+    if (count == 0) return bounds;
+
+    float lo[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+    float hi[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const float* p = positionAt(i);
+        for (int axis = 0; axis < 3; axis++)
+        {
+            if (p[axis] < lo[axis]) lo[axis] = p[axis];
+            if (p[axis] > hi[axis]) hi[axis] = p[axis];
+        }
+    }
+
+    for (int axis = 0; axis < 3; axis++)
+    {
+        bounds.Center[axis] = 0.5f * (lo[axis] + hi[axis]);
+        bounds.Extents[axis] = 0.5f * (hi[axis] - lo[axis]);
+    }
+
+    float radiusSq = 0.0f;
+    for (size_t i = 0; i < count; i++)
+    {
+        const float* p = positionAt(i);
+        float dx = p[0] - bounds.Center[0];
+        float dy = p[1] - bounds.Center[1];
+        float dz = p[2] - bounds.Center[2];
+        float distSq = dx * dx + dy * dy + dz * dz;
+        if (distSq > radiusSq) radiusSq = distSq;
+    }
+    bounds.Radius = std::sqrt(radiusSq);
+
+    return bounds;
+}
+
+MESH_BOUNDS ComputeBounds(const float* pPositions, size_t count, size_t strideBytes)
+{
+    return compute_bounds(count, [=](size_t i)
+        { return position_at(pPositions, strideBytes, i); });
+}
+
+MESH_BOUNDS ComputeBounds(const float* pPositions, size_t strideBytes,
+    const unsigned short* pIndices, size_t indexCount)
+{
+    return compute_bounds(indexCount, [=](size_t i)
+        { return position_at(pPositions, strideBytes, pIndices[i]); });
+}
+
+MESH_BOUNDS TransformBounds(const MESH_BOUNDS& bounds, const float m[16])
+{
+    MESH_BOUNDS result;
+
+    // Row i of the matrix is the image of axis i
+    float maxScaleSq = 0.0f;
+    for (int col = 0; col < 3; col++)
+    {
+        result.Center[col] = m[12 + col];
+        result.Extents[col] = 0.0f;
+        for (int row = 0; row < 3; row++)
+        {
+            result.Center[col] += bounds.Center[row] * m[row * 4 + col];
+            result.Extents[col] += bounds.Extents[row] * std::fabs(m[row * 4 + col]);
+        }
+
+        const float* axis = m + col * 4;
+        float scaleSq = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+        if (scaleSq > maxScaleSq) maxScaleSq = scaleSq;
+    }
+    result.Radius = bounds.Radius * std::sqrt(maxScaleSq);
+
+    return result;
+}
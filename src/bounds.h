@@ -0,0 +1,41 @@
+/*****************************************************************//**
+ * \file   bounds.h
+ * \brief  Bounding volumes of meshes and mesh chunks
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+
+#include <cstddef>
+
+// Axis-aligned box and bounding sphere sharing one center.
+// The sphere gives a cheap first test, the box a tight second one.
+struct MESH_BOUNDS
+{
+	float Center[3] = { 0.0f, 0.0f, 0.0f };
+	float Extents[3] = { 0.0f, 0.0f, 0.0f };	// Half sizes of the box
+	float Radius = 0.0f;
+};
+
+/**
+ * Computes bounds of a set of points.
+ *
+ * \param pPositions first position, three floats
+ * \param count number of points
+ * \param strideBytes distance between positions, e.g. sizeof(Vertex)
+ */
+MESH_BOUNDS ComputeBounds(const float* pPositions, size_t count, size_t strideBytes);
+
+// Same, for the points addressed by an index list
+MESH_BOUNDS ComputeBounds(const float* pPositions, size_t strideBytes,
+	const unsigned short* pIndices, size_t indexCount);
+
+/**
+ * Transforms bounds by an affine matrix in row-vector convention (p' = p * M),
+ * as stored by DirectXMath. The box stays axis-aligned and grows to contain
+ * the rotated one.
+ *
+ * \param m 4x4 row-major matrix
+ */
+MESH_BOUNDS TransformBounds(const MESH_BOUNDS& bounds, const float m[16]);
@@ -0,0 +1,71 @@
+/*****************************************************************//**
+ * \file   clock.cpp
+ * \brief  Calibration of the time stamp counter for Clock
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include "clock.h"
+
+#if CLOCK_HAS_TSC && !defined(_MSC_VER)
+#include <cpuid.h>
+#endif
+
+std::atomic<CLOCK_SOURCE> Clock::s_source{ CLOCK_SOURCE_STEADY };
+uint64_t Clock::s_ticksPerSecond = 1000000000ull;
+uint64_t Clock::s_nsPerTick = 0;
+
+#if CLOCK_HAS_TSC
+// Invariant TSC runs at a constant rate in all power states, CPUID 0x80000007 EDX bit 8
+static bool has_invariant_tsc()
+{
+    unsigned int regs[4] = { };
+#if defined(_MSC_VER)
+    __cpuid(reinterpret_cast<int*>(regs), 0x80000000);
+    if (regs[0] < 0x80000007) return false;
+    __cpuid(reinterpret_cast<int*>(regs), 0x80000007);
+#else
+    if (!__get_cpuid(0x80000007, &regs[0], &regs[1], &regs[2], &regs[3])) return false;
+#endif
+    return (regs[3] & (1u << 8)) != 0;
+}
+#endif
+
+bool Clock::EnableTsc(uint32_t calibrationMs)
+{
+#if CLOCK_HAS_TSC
+    if (!has_invariant_tsc()) return false;
+
+    typedef std::chrono::steady_clock Steady;
+    Steady::time_point start = Steady::now();
+    uint64_t startTicks = __rdtsc();
+
+    // Spin rather than sleep, the thread may be descheduled for longer
+    // but both clocks keep running meanwhile
+    Steady::time_point end = start + std::chrono::milliseconds(calibrationMs > 0 ? calibrationMs : 1);
+    Steady::time_point now;
+    do
+    {
+        now = Steady::now();
+    } while (now < end);
+    uint64_t endTicks = __rdtsc();
+
+    double seconds = std::chrono::duration<double>(now - start).count();
+    double ticksPerSecond = (endTicks - startTicks) / seconds;
+    if (ticksPerSecond < 1e9) return false;
+
+    s_ticksPerSecond = static_cast<uint64_t>(ticksPerSecond + 0.5);
+    s_nsPerTick = static_cast<uint64_t>(1e9 * 4294967296.0 / ticksPerSecond + 0.5);
+    s_source.store(CLOCK_SOURCE_TSC, std::memory_order_relaxed);
+    return true;
+#else
+    (void)calibrationMs;
+    return false;
+#endif
+}
+
+uint64_t Clock::FromNanoseconds(uint64_t nanoseconds)
+{
+    if (s_nsPerTick == 0) return nanoseconds;
+    return static_cast<uint64_t>(nanoseconds * 1e-9 * s_ticksPerSecond + 0.5);
+}
@@ -0,0 +1,110 @@
+/*****************************************************************//**
+ * \file   clock.h
+ * \brief  Portable monotonic clock with integer ticks
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define CLOCK_HAS_TSC 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#else
+#define CLOCK_HAS_TSC 0
+#endif
+
+enum CLOCK_SOURCE
+{
+	CLOCK_SOURCE_STEADY = 0,		// std::chrono::steady_clock, ticks are nanoseconds
+	CLOCK_SOURCE_TSC,				// Invariant time stamp counter, ticks are CPU reference cycles
+};
+
+/**
+ * Monotonic clock for measuring intervals, shared by the whole program.
+ *
+ * Now() returns integer ticks and does no arithmetic, so hot paths take two
+ * readings and subtract. Ticks are converted to time only when reported.
+ *
+ * By default ticks come from std::chrono::steady_clock and are nanoseconds.
+ * On x86 with an invariant time stamp counter, EnableTsc switches to reading
+ * it directly, which takes a few nanoseconds instead of a call into the
+ * system. Its frequency is calibrated against steady_clock. Ticks of the two
+ * sources do not mix, so the source is chosen once at startup, before any
+ * ticks are taken.
+ */
+class Clock
+{
+public:
+	static uint64_t Now()
+	{
+#if CLOCK_HAS_TSC
+		if (s_source.load(std::memory_order_relaxed) == CLOCK_SOURCE_TSC) return __rdtsc();
+#endif
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count());
+	}
+
+	// Calibrates the time stamp counter over the given time and reads it
+	// from now on. Returns false and keeps steady_clock if there is no
+	// invariant counter, or if it runs slower than 1 GHz.
+	static bool EnableTsc(uint32_t calibrationMs = 20);
+
+	static CLOCK_SOURCE Source() { return s_source.load(std::memory_order_relaxed); }
+	static uint64_t TicksPerSecond() { return s_ticksPerSecond; }
+
+	static uint64_t ToNanoseconds(uint64_t ticks)
+	{
+		if (s_nsPerTick == 0) return ticks;
+
+		// 32.32 fixed point, in halves so no product exceeds 64 bits
+		return (ticks >> 32) * s_nsPerTick + (((ticks & 0xffffffffull) * s_nsPerTick) >> 32);
+	}
+	static uint64_t FromNanoseconds(uint64_t nanoseconds);
+	static double ToSeconds(uint64_t ticks) { return ToNanoseconds(ticks) * 1e-9; }
+
+private:
+	static std::atomic<CLOCK_SOURCE> s_source;
+	static uint64_t s_ticksPerSecond;
+	static uint64_t s_nsPerTick;			// 32.32 fixed point, 0 if ticks are nanoseconds
+};
+
+// Adds the ticks of its lifetime to a counter
+class ScopedTicks
+{
+public:
+	explicit ScopedTicks(uint64_t& total)
+		: m_total(total), m_start(Clock::Now()) { }
+	~ScopedTicks() { m_total += Clock::Now() - m_start; }
+
+	ScopedTicks(const ScopedTicks&) = delete;
+	ScopedTicks& operator=(const ScopedTicks&) = delete;
+
+private:
+	uint64_t& m_total;
+	uint64_t m_start;
+};
+
+// Adds the nanoseconds of its lifetime to a counter
+class ScopedNanoseconds
+{
+public:
+	explicit ScopedNanoseconds(uint64_t& total)
+		: m_total(total), m_start(Clock::Now()) { }
+	~ScopedNanoseconds() { m_total += Clock::ToNanoseconds(Clock::Now() - m_start); }
+
+	ScopedNanoseconds(const ScopedNanoseconds&) = delete;
+	ScopedNanoseconds& operator=(const ScopedNanoseconds&) = delete;
+
+private:
+	uint64_t& m_total;
+	uint64_t m_start;
+};
@@ -0,0 +1,376 @@
+/*****************************************************************//**
+ * \file   clustered_lights.cpp
+ * \brief  Definition of LightClusterer
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include <cmath>
+
+#include "clustered_lights.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define CLUSTERED_LIGHTS_SSE
+#include <immintrin.h>
+#endif
+
+// Padding clusters are this far away, so no light reaches them
+static const float Unreachable = 1e30f;
+
+static const float HalfPi = 1.57079632679f;
+
+LightClusterer::LightClusterer(JobSystem* pJobs)
+    : m_pJobs(pJobs)
+{
+}
+
+void LightClusterer::SetUseSSE(bool useSSE)
+{
+#ifdef CLUSTERED_LIGHTS_SSE
+    m_useSSE = useSSE;
+#else
+    (void)useSSE;
+#endif
+}
+
+bool LightClusterer::UsesSSE() const
+{
+#ifdef CLUSTERED_LIGHTS_SSE
+    return m_useSSE;
+#else
+    return false;
+#endif
+}
+
+void LightClusterer::SetGrid(uint32_t tilesX, uint32_t tilesY, uint32_t slices,
+    float scaleX, float scaleY, float nearZ, float farZ)
+{
+    m_tilesX = tilesX;
+    m_tilesY = tilesY;
+    m_slices = slices;
+    m_rowStride = (tilesX + 3) & ~3u;
+    m_scaleX = scaleX;
+    m_scaleY = scaleY;
+    m_nearZ = nearZ;
+    m_farZ = farZ;
+
+    // slice = log2(z / near) / log2(far / near) * slices
+    float logRange = std::log2(farZ / nearZ);
+    m_sliceScale = slices / logRange;
+    m_sliceBias = -static_cast<float>(slices) * std::log2(nearZ) / logRange;
+
+    const size_t padded = static_cast<size_t>(m_rowStride) * tilesY * slices;
+    for (std::vector<float>* pArray : { &m_minX, &m_minY, &m_minZ })
+    {
+        pArray->assign(padded, Unreachable);
+    }
+    for (std::vector<float>* pArray : { &m_maxX, &m_maxY, &m_maxZ })
+    {
+        pArray->assign(padded, -Unreachable);
+    }
+    for (std::vector<float>* pArray : { &m_sphereX, &m_sphereY, &m_sphereZ, &m_sphereRadius })
+    {
+        pArray->assign(padded, 0.0f);
+    }
+
+    for (uint32_t z = 0; z < slices; z++)
+    {
+        float zNear = nearZ * std::pow(farZ / nearZ, static_cast<float>(z) / slices);
+        float zFar = nearZ * std::pow(farZ / nearZ, static_cast<float>(z + 1) / slices);
+
+        for (uint32_t y = 0; y < tilesY; y++)
+        {
+            // NDC y grows upwards, tiles go down the screen
+            float ndcTop = 1.0f - 2.0f * y / tilesY;
+            float ndcBottom = 1.0f - 2.0f * (y + 1) / tilesY;
+
+            for (uint32_t x = 0; x < tilesX; x++)
+            {
+                float ndcLeft = -1.0f + 2.0f * x / tilesX;
+                float ndcRight = -1.0f + 2.0f * (x + 1) / tilesX;
+
+                // Box around the 8 corners of the cluster frustum
+                float xs[4] = { ndcLeft * zNear, ndcLeft * zFar, ndcRight * zNear, ndcRight * zFar };
+                float ys[4] = { ndcBottom * zNear, ndcBottom * zFar, ndcTop * zNear, ndcTop * zFar };
+                float minX = xs[0], maxX = xs[0], minY = ys[0], maxY = ys[0];
+                for (int i = 1; i < 4; i++)
+                {
+                    if (xs[i] < minX) minX = xs[i];
+                    if (xs[i] > maxX) maxX = xs[i];
+                    if (ys[i] < minY) minY = ys[i];
+                    if (ys[i] > maxY) maxY = ys[i];
+                }
+                minX /= scaleX; maxX /= scaleX;
+                minY /= scaleY; maxY /= scaleY;
+
+                size_t i = (static_cast<size_t>(z) * tilesY + y) * m_rowStride + x;
+                m_minX[i] = minX; m_maxX[i] = maxX;
+                m_minY[i] = minY; m_maxY[i] = maxY;
+                m_minZ[i] = zNear; m_maxZ[i] = zFar;
+
+                float hx = (maxX - minX) * 0.5f, hy = (maxY - minY) * 0.5f, hz = (zFar - zNear) * 0.5f;
+                m_sphereX[i] = minX + hx;
+                m_sphereY[i] = minY + hy;
+                m_sphereZ[i] = zNear + hz;
+                m_sphereRadius[i] = std::sqrt(hx * hx + hy * hy + hz * hz);
+            }
+        }
+    }
+
+    m_sliceHits.resize(slices);
+    m_sliceCounts.resize(slices);
+}
+
+uint32_t LightClusterer::slice_of(float z) const
+{
+    if (z <= m_nearZ) return 0;
+    float slice = std::log2(z) * m_sliceScale + m_sliceBias;
+    return slice >= m_slices ? m_slices - 1 : static_cast<uint32_t>(slice);
+}
+
+// Tile of an NDC coordinate, clamped to the grid
+static inline uint16_t tile_of(float t, uint32_t tiles)
+{
+    float tile = t * tiles;
+    if (!(tile > 0.0f)) return 0;
+    return tile >= tiles ? static_cast<uint16_t>(tiles - 1) : static_cast<uint16_t>(tile);
+}
+
+void LightClusterer::Build(const float view[16], const CLUSTER_LIGHT* pLights, uint32_t lightCount)
+{
+    for (std::vector<float>* pArray : { &m_lightX, &m_lightY, &m_lightZ, &m_lightRange,
+        &m_dirX, &m_dirY, &m_dirZ, &m_cosAngle, &m_sinAngle })
+    {
+        pArray->resize(lightCount);
+    }
+    for (std::vector<uint16_t>* pArray : { &m_tileMinX, &m_tileMaxX, &m_tileMinY, &m_tileMaxY,
+        &m_sliceMin, &m_sliceMax })
+    {
+        pArray->resize(lightCount);
+    }
+
+    // To view space, and the tiles and slices each light may reach
+    for (uint32_t i = 0; i < lightCount; i++)
+    {
+        const CLUSTER_LIGHT& light = pLights[i];
+        const float* p = light.Position;
+        const float* d = light.Direction;
+
+        float x = p[0] * view[0] + p[1] * view[4] + p[2] * view[8] + view[12];
+        float y = p[0] * view[1] + p[1] * view[5] + p[2] * view[9] + view[13];
+        float z = p[0] * view[2] + p[1] * view[6] + p[2] * view[10] + view[14];
+        float r = light.Range;
+
+        m_lightX[i] = x; m_lightY[i] = y; m_lightZ[i] = z; m_lightRange[i] = r;
+        m_dirX[i] = d[0] * view[0] + d[1] * view[4] + d[2] * view[8];
+        m_dirY[i] = d[0] * view[1] + d[1] * view[5] + d[2] * view[9];
+        m_dirZ[i] = d[0] * view[2] + d[1] * view[6] + d[2] * view[10];
+
+        // Point lights get no cone; wider cones than a half-space are not tested
+        float angle = light.SpotAngle > HalfPi ? HalfPi : light.SpotAngle;
+        m_cosAngle[i] = light.SpotAngle > 0.0f ? std::cos(angle) : 2.0f;
+        m_sinAngle[i] = std::sin(angle);
+
+        float zMin = z - r, zMax = z + r;
+        if (zMax < m_nearZ || zMin > m_farZ)
+        {
+            m_sliceMin[i] = 1;
+            m_sliceMax[i] = 0;
+            continue;
+        }
+        float zNear = zMin > m_nearZ ? zMin : m_nearZ;
+        float zFar = zMax < m_farZ ? zMax : m_farZ;
+
+        // Extremes of the projected sphere box: the nearest depth for
+        // coordinates away from the center of the screen, the farthest otherwise
+        float right = x + r, left = x - r, top = y + r, bottom = y - r;
+        float ndcRight = right * m_scaleX / (right >= 0.0f ? zNear : zFar);
+        float ndcLeft = left * m_scaleX / (left <= 0.0f ? zNear : zFar);
+        float ndcTop = top * m_scaleY / (top >= 0.0f ? zNear : zFar);
+        float ndcBottom = bottom * m_scaleY / (bottom <= 0.0f ? zNear : zFar);
+
+        if (ndcRight < -1.0f || ndcLeft > 1.0f || ndcTop < -1.0f || ndcBottom > 1.0f)
+        {
+            m_sliceMin[i] = 1;
+            m_sliceMax[i] = 0;
+            continue;
+        }
+
+        m_tileMinX[i] = tile_of((ndcLeft + 1.0f) * 0.5f, m_tilesX);
+        m_tileMaxX[i] = tile_of((ndcRight + 1.0f) * 0.5f, m_tilesX);
+        m_tileMinY[i] = tile_of((1.0f - ndcTop) * 0.5f, m_tilesY);
+        m_tileMaxY[i] = tile_of((1.0f - ndcBottom) * 0.5f, m_tilesY);
+        m_sliceMin[i] = static_cast<uint16_t>(slice_of(zNear));
+        m_sliceMax[i] = static_cast<uint16_t>(slice_of(zFar));
+    }
+
+    // Bin each slice on its own, then compact. Both passes keep light order.
+    auto runSlices = [this](void (LightClusterer::*pass)(uint32_t))
+    {
+        auto slices = [this, pass](uint32_t first, uint32_t last)
+        {
+            for (uint32_t slice = first; slice < last; slice++) (this->*pass)(slice);
+        };
+
+        if (m_pJobs != nullptr) m_pJobs->ParallelFor(0, m_slices, 1, slices);
+        else slices(0, m_slices);
+    };
+
+    runSlices(&LightClusterer::bin_slice);
+
+    const uint32_t clustersPerSlice = m_tilesX * m_tilesY;
+    m_ranges.resize(ClusterCount());
+    uint32_t offset = 0;
+    for (uint32_t slice = 0; slice < m_slices; slice++)
+    {
+        for (uint32_t c = 0; c < clustersPerSlice; c++)
+        {
+            uint32_t count = m_sliceCounts[slice][c];
+            m_ranges[slice * clustersPerSlice + c] = { offset, count };
+            offset += count;
+        }
+    }
+    m_lightIndices.resize(offset);
+
+    runSlices(&LightClusterer::compact_slice);
+}
+
+// Bits of the 4 clusters starting at column `base` that lie in [first, last]
+static inline int column_mask(uint32_t base, uint32_t first, uint32_t last)
+{
+    int mask = 0;
+    for (uint32_t k = 0; k < 4; k++)
+    {
+        if (base + k >= first && base + k <= last) mask |= 1 << k;
+    }
+    return mask;
+}
+
+void LightClusterer::bin_slice(uint32_t slice)
+{
+    std::vector<Hit>& hits = m_sliceHits[slice];
+    std::vector<uint32_t>& counts = m_sliceCounts[slice];
+    hits.clear();
+    counts.assign(static_cast<size_t>(m_tilesX) * m_tilesY, 0);
+
+    const uint32_t lightCount = static_cast<uint32_t>(m_lightX.size());
+    for (uint32_t light = 0; light < lightCount; light++)
+    {
+        if (slice < m_sliceMin[light] || slice > m_sliceMax[light]) continue;
+
+        const float lx = m_lightX[light], ly = m_lightY[light], lz = m_lightZ[light];
+        const float range = m_lightRange[light];
+        const bool spot = m_cosAngle[light] <= 1.0f;
+        const float dx = m_dirX[light], dy = m_dirY[light], dz = m_dirZ[light];
+        const float cosAngle = m_cosAngle[light], sinAngle = m_sinAngle[light];
+
+        const uint32_t firstX = m_tileMinX[light], lastX = m_tileMaxX[light];
+
+#ifdef CLUSTERED_LIGHTS_SSE
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 cx = _mm_set1_ps(lx), cy = _mm_set1_ps(ly), cz = _mm_set1_ps(lz);
+        const __m128 rangeSq = _mm_set1_ps(range * range);
+        const __m128 vRange = _mm_set1_ps(range);
+        const __m128 vdx = _mm_set1_ps(dx), vdy = _mm_set1_ps(dy), vdz = _mm_set1_ps(dz);
+        const __m128 vCos = _mm_set1_ps(cosAngle), vSin = _mm_set1_ps(sinAngle);
+#endif
+
+        for (uint32_t y = m_tileMinY[light]; y <= m_tileMaxY[light]; y++)
+        {
+            const size_t row = (static_cast<size_t>(slice) * m_tilesY + y) * m_rowStride;
+
+            for (uint32_t base = firstX & ~3u; base <= lastX; base += 4)
+            {
+                const size_t i = row + base;
+                int mask = column_mask(base, firstX, lastX);
+
+#ifdef CLUSTERED_LIGHTS_SSE
+                if (m_useSSE)
+                {
+                    // Sphere against box: squared distance from the center to the box
+                    __m128 ex = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&m_minX[i]), cx),
+                        _mm_sub_ps(cx, _mm_loadu_ps(&m_maxX[i]))), zero);
+                    __m128 ey = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&m_minY[i]), cy),
+                        _mm_sub_ps(cy, _mm_loadu_ps(&m_maxY[i]))), zero);
+                    __m128 ez = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&m_minZ[i]), cz),
+                        _mm_sub_ps(cz, _mm_loadu_ps(&m_maxZ[i]))), zero);
+                    __m128 distSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ex, ex), _mm_mul_ps(ey, ey)), _mm_mul_ps(ez, ez));
+                    mask &= _mm_movemask_ps(_mm_cmple_ps(distSq, rangeSq));
+
+                    if (spot && mask)
+                    {
+                        // Cone against the cluster sphere: reject spheres entirely
+                        // outside the cone's side, or behind its apex or beyond its range
+                        __m128 radius = _mm_loadu_ps(&m_sphereRadius[i]);
+                        __m128 vx = _mm_sub_ps(_mm_loadu_ps(&m_sphereX[i]), cx);
+                        __m128 vy = _mm_sub_ps(_mm_loadu_ps(&m_sphereY[i]), cy);
+                        __m128 vz = _mm_sub_ps(_mm_loadu_ps(&m_sphereZ[i]), cz);
+                        __m128 lenSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz));
+                        __m128 along = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vdx), _mm_mul_ps(vy, vdy)), _mm_mul_ps(vz, vdz));
+                        __m128 across = _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(lenSq, _mm_mul_ps(along, along)), zero));
+                        __m128 side = _mm_sub_ps(_mm_mul_ps(vCos, across), _mm_mul_ps(along, vSin));
+
+                        __m128 outside = _mm_or_ps(_mm_cmpgt_ps(side, radius),
+                            _mm_or_ps(_mm_cmpgt_ps(along, _mm_add_ps(radius, vRange)),
+                                _mm_cmplt_ps(along, _mm_sub_ps(zero, radius))));
+                        mask &= ~_mm_movemask_ps(outside);
+                    }
+                }
+                else
+#endif
+                {
+                    for (uint32_t k = 0; k < 4; k++)
+                    {
+                        if (!(mask & (1 << k))) continue;
+                        const size_t j = i + k;
+
+                        float ex = m_minX[j] - lx > lx - m_maxX[j] ? m_minX[j] - lx : lx - m_maxX[j];
+                        float ey = m_minY[j] - ly > ly - m_maxY[j] ? m_minY[j] - ly : ly - m_maxY[j];
+                        float ez = m_minZ[j] - lz > lz - m_maxZ[j] ? m_minZ[j] - lz : lz - m_maxZ[j];
+                        if (ex < 0.0f) ex = 0.0f;
+                        if (ey < 0.0f) ey = 0.0f;
+                        if (ez < 0.0f) ez = 0.0f;
+                        bool touches = ex * ex + ey * ey + ez * ez <= range * range;
+
+                        if (touches && spot)
+                        {
+                            float radius = m_sphereRadius[j];
+                            float vx = m_sphereX[j] - lx, vy = m_sphereY[j] - ly, vz = m_sphereZ[j] - lz;
+                            float along = vx * dx + vy * dy + vz * dz;
+                            float acrossSq = vx * vx + vy * vy + vz * vz - along * along;
+                            float across = std::sqrt(acrossSq > 0.0f ? acrossSq : 0.0f);
+                            float side = cosAngle * across - along * sinAngle;
+                            touches = !(side > radius || along > radius + range || along < -radius);
+                        }
+
+                        if (!touches) mask &= ~(1 << k);
+                    }
+                }
+
+                for (uint32_t k = 0; k < 4; k++)
+                {
+                    if (!(mask & (1 << k))) continue;
+
+                    uint32_t cluster = y * m_tilesX + base + k;
+                    hits.push_back({ cluster, light });
+                    counts[cluster]++;
+                }
+            }
+        }
+    }
+}
+
+void LightClusterer::compact_slice(uint32_t slice)
+{
+    // Hits are in light order, so a stable scatter keeps each cluster sorted
+    const uint32_t clustersPerSlice = m_tilesX * m_tilesY;
+    const CLUSTER_RANGE* pRanges = &m_ranges[static_cast<size_t>(slice) * clustersPerSlice];
+
+    std::vector<uint32_t>& cursors = m_sliceCounts[slice];
+    for (uint32_t c = 0; c < clustersPerSlice; c++) cursors[c] = pRanges[c].Offset;
+
+    for (const Hit& hit : m_sliceHits[slice])
+    {
+        m_lightIndices[cursors[hit.Cluster]++] = hit.Light;
+    }
+}
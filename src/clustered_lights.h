@@ -0,0 +1,124 @@
+/*****************************************************************//**
+ * \file   clustered_lights.h
+ * \brief  CPU assignment of point and spot lights to view-space clusters
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "job_system.h"
+
+// Point or spot light in world space
+struct CLUSTER_LIGHT
+{
+	float Position[3];
+	float Range;			// Distance at which the light no longer contributes
+	float Direction[3];		// Spot lights only, normalized
+	float SpotAngle;		// Half-angle of the cone in radians, 0 for point lights
+};
+
+// Lights of one cluster are LightIndices()[Offset, Offset + Count)
+struct CLUSTER_RANGE
+{
+	uint32_t Offset;
+	uint32_t Count;
+};
+
+/**
+ * Splits the view frustum into a grid of clusters, TilesX x TilesY screen tiles
+ * by Slices depth slices spaced exponentially between the near and far planes,
+ * and lists the lights reaching each cluster.
+ *
+ * Lights are first bounded to a range of tiles and slices, then tested against
+ * the view-space boxes of the clusters in that range, 4 at a time with SSE:
+ * point lights as spheres, spot lights also by their cone against the bounding
+ * sphere of the cluster. Each slice is binned as a job.
+ *
+ * Each cluster lists its lights in ascending index order, and the output does
+ * not depend on the number of threads. Cluster (x, y, z) has index
+ * x + TilesX * (y + TilesY * z), with tile (0, 0) at the top left of the screen.
+ */
+class LightClusterer
+{
+public:
+	// Without a job system, bins on the calling thread alone
+	explicit LightClusterer(JobSystem* pJobs = nullptr);
+
+	/**
+	 * Sets up the grid for a perspective projection.
+	 *
+	 * \param scaleX, scaleY proj[0][0] and proj[1][1] of the projection
+	 */
+	void SetGrid(uint32_t tilesX, uint32_t tilesY, uint32_t slices,
+		float scaleX, float scaleY, float nearZ, float farZ);
+
+	/**
+	 * Bins lights into clusters.
+	 *
+	 * \param view 4x4 row-major view matrix, row-vector convention
+	 */
+	void Build(const float view[16], const CLUSTER_LIGHT* pLights, uint32_t lightCount);
+
+	const std::vector<CLUSTER_RANGE>& Ranges() const { return m_ranges; }
+	const std::vector<uint32_t>& LightIndices() const { return m_lightIndices; }
+
+	uint32_t TilesX() const { return m_tilesX; }
+	uint32_t TilesY() const { return m_tilesY; }
+	uint32_t Slices() const { return m_slices; }
+	uint32_t ClusterCount() const { return m_tilesX * m_tilesY * m_slices; }
+
+	// Slice of a view depth is log2(z) * SliceScale() + SliceBias(), as in the shader
+	float SliceScale() const { return m_sliceScale; }
+	float SliceBias() const { return m_sliceBias; }
+
+	// Clusters are tested 4 at a time with SSE where the CPU has it. The scalar
+	// path gives the same lists; turning SSE off is meant for comparing the two.
+	void SetUseSSE(bool useSSE);
+	bool UsesSSE() const;
+
+private:
+	// A light that passed to a cluster of a slice, before compaction
+	struct Hit
+	{
+		uint32_t Cluster;		// Within the slice
+		uint32_t Light;
+	};
+
+	void bin_slice(uint32_t slice);
+	void compact_slice(uint32_t slice);
+	uint32_t slice_of(float z) const;
+
+	JobSystem* m_pJobs = nullptr;
+	bool m_useSSE = true;
+
+	uint32_t m_tilesX = 0;
+	uint32_t m_tilesY = 0;
+	uint32_t m_slices = 0;
+	uint32_t m_rowStride = 0;		// TilesX rounded up to 4
+	float m_scaleX = 1.0f;
+	float m_scaleY = 1.0f;
+	float m_nearZ = 1.0f;
+	float m_farZ = 1000.0f;
+	float m_sliceScale = 0.0f;
+	float m_sliceBias = 0.0f;
+
+	// View-space cluster boxes and bounding spheres, rows padded to m_rowStride
+	// with boxes that nothing touches
+	std::vector<float> m_minX, m_minY, m_minZ, m_maxX, m_maxY, m_maxZ;
+	std::vector<float> m_sphereX, m_sphereY, m_sphereZ, m_sphereRadius;
+
+	// View-space lights and the clusters they may reach
+	std::vector<float> m_lightX, m_lightY, m_lightZ, m_lightRange;
+	std::vector<float> m_dirX, m_dirY, m_dirZ, m_cosAngle, m_sinAngle;
+	std::vector<uint16_t> m_tileMinX, m_tileMaxX, m_tileMinY, m_tileMaxY, m_sliceMin, m_sliceMax;
+
+	std::vector<std::vector<Hit>> m_sliceHits;			// [slice]
+	std::vector<std::vector<uint32_t>> m_sliceCounts;	// [slice][cluster in slice]
+
+	std::vector<CLUSTER_RANGE> m_ranges;
+	std::vector<uint32_t> m_lightIndices;
+};
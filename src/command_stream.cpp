@@ -0,0 +1,181 @@
+/*****************************************************************//**
+ * \file   command_stream.cpp
+ * \brief  Definition of CommandStream
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include "command_stream.h"
+
+void* CommandStream::allocate(COMMAND_TYPE type, size_t byteSize)
+{
+    size_t words = (byteSize + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    size_t offset = m_data.size();
+    m_data.resize(offset + words, 0);
+
+    COMMAND_HEADER* pHeader = reinterpret_cast<COMMAND_HEADER*>(&m_data[offset]);
+    pHeader->Type = type;
+    pHeader->Size = static_cast<uint16_t>(words * sizeof(uint64_t));
+
+    m_commandCount++;
+    return pHeader;
+}
+
+const COMMAND_HEADER* CommandStream::First() const
+{
+    return m_data.empty() ? nullptr : reinterpret_cast<const COMMAND_HEADER*>(m_data.data());
+}
+
+const COMMAND_HEADER* CommandStream::Next(const COMMAND_HEADER* pCommand) const
+{
+    const uint8_t* pNext = reinterpret_cast<const uint8_t*>(pCommand) + pCommand->Size;
+    const uint8_t* pEnd = reinterpret_cast<const uint8_t*>(m_data.data() + m_data.size());
+    return pNext < pEnd ? reinterpret_cast<const COMMAND_HEADER*>(pNext) : nullptr;
+}
+
+void CommandStream::SetPipeline(GPU_HANDLE pipeline)
+{
+    push<CMD_SET_HANDLE>(COMMAND_SET_PIPELINE)->Handle = pipeline;
+}
+
+void CommandStream::SetRootSignature(GPU_HANDLE rootSignature)
+{
+    push<CMD_SET_HANDLE>(COMMAND_SET_ROOT_SIGNATURE)->Handle = rootSignature;
+}
+
+void CommandStream::SetDescriptorHeap(GPU_HANDLE heap)
+{
+    push<CMD_SET_HANDLE>(COMMAND_SET_DESCRIPTOR_HEAP)->Handle = heap;
+}
+
+void CommandStream::SetRootCBV(uint32_t slot, GPU_HANDLE address)
+{
+    CMD_SET_ROOT_HANDLE* pCommand = push<CMD_SET_ROOT_HANDLE>(COMMAND_SET_ROOT_CBV);
+    pCommand->Slot = slot;
+    pCommand->Handle = address;
+}
+
+void CommandStream::SetRootSRV(uint32_t slot, GPU_HANDLE address)
+{
+    CMD_SET_ROOT_HANDLE* pCommand = push<CMD_SET_ROOT_HANDLE>(COMMAND_SET_ROOT_SRV);
+    pCommand->Slot = slot;
+    pCommand->Handle = address;
+}
+
+void CommandStream::SetRootTable(uint32_t slot, GPU_HANDLE descriptor)
+{
+    CMD_SET_ROOT_HANDLE* pCommand = push<CMD_SET_ROOT_HANDLE>(COMMAND_SET_ROOT_TABLE);
+    pCommand->Slot = slot;
+    pCommand->Handle = descriptor;
+}
+
+void CommandStream::SetRootConstants(uint32_t slot, uint32_t count, const uint32_t* pValues, uint32_t offset)
+{
+    CMD_SET_ROOT_CONSTANTS* pCommand = static_cast<CMD_SET_ROOT_CONSTANTS*>(
+        allocate(COMMAND_SET_ROOT_CONSTANTS, sizeof(CMD_SET_ROOT_CONSTANTS) + sizeof(uint32_t) * count));
+    pCommand->Slot = slot;
+    pCommand->Count = count;
+    pCommand->Offset = offset;
+    std::memcpy(pCommand + 1, pValues, sizeof(uint32_t) * count);
+}
+
+void CommandStream::SetVertexBuffer(GPU_HANDLE address, uint32_t size, uint32_t stride)
+{
+    CMD_SET_VERTEX_BUFFER* pCommand = push<CMD_SET_VERTEX_BUFFER>(COMMAND_SET_VERTEX_BUFFER);
+    pCommand->Stride = stride;
+    pCommand->Address = address;
+    pCommand->Size = size;
+}
+
+void CommandStream::SetIndexBuffer(GPU_HANDLE address, uint32_t size, uint32_t indexSize)
+{
+    CMD_SET_INDEX_BUFFER* pCommand = push<CMD_SET_INDEX_BUFFER>(COMMAND_SET_INDEX_BUFFER);
+    pCommand->IndexSize = indexSize;
+    pCommand->Address = address;
+    pCommand->Size = size;
+}
+
+void CommandStream::SetTopology(uint32_t topology)
+{
+    push<CMD_SET_TOPOLOGY>(COMMAND_SET_TOPOLOGY)->Topology = topology;
+}
+
+void CommandStream::SetViewport(float x, float y, float width, float height, float minDepth, float maxDepth)
+{
+    CMD_SET_VIEWPORT* pCommand = push<CMD_SET_VIEWPORT>(COMMAND_SET_VIEWPORT);
+    pCommand->X = x;
+    pCommand->Y = y;
+    pCommand->Width = width;
+    pCommand->Height = height;
+    pCommand->MinDepth = minDepth;
+    pCommand->MaxDepth = maxDepth;
+}
+
+void CommandStream::SetScissor(int32_t left, int32_t top, int32_t right, int32_t bottom)
+{
+    CMD_SET_SCISSOR* pCommand = push<CMD_SET_SCISSOR>(COMMAND_SET_SCISSOR);
+    pCommand->Left = left;
+    pCommand->Top = top;
+    pCommand->Right = right;
+    pCommand->Bottom = bottom;
+}
+
+void CommandStream::SetRenderTarget(GPU_HANDLE renderTarget, GPU_HANDLE depthStencil)
+{
+    CMD_SET_RENDER_TARGET* pCommand = push<CMD_SET_RENDER_TARGET>(COMMAND_SET_RENDER_TARGET);
+    pCommand->RenderTarget = renderTarget;
+    pCommand->DepthStencil = depthStencil;
+}
+
+void CommandStream::ClearRenderTarget(GPU_HANDLE renderTarget, const float color[4])
+{
+    CMD_CLEAR_RENDER_TARGET* pCommand = push<CMD_CLEAR_RENDER_TARGET>(COMMAND_CLEAR_RENDER_TARGET);
+    pCommand->RenderTarget = renderTarget;
+    std::memcpy(pCommand->Color, color, sizeof(pCommand->Color));
+}
+
+void CommandStream::ClearDepthStencil(GPU_HANDLE depthStencil, uint32_t flags, float depth, uint32_t stencil)
+{
+    CMD_CLEAR_DEPTH_STENCIL* pCommand = push<CMD_CLEAR_DEPTH_STENCIL>(COMMAND_CLEAR_DEPTH_STENCIL);
+    pCommand->Flags = flags;
+    pCommand->DepthStencil = depthStencil;
+    pCommand->Depth = depth;
+    pCommand->Stencil = stencil;
+}
+
+void CommandStream::DrawIndexed(uint32_t indexCount, uint32_t instanceCount,
+    uint32_t startIndex, int32_t baseVertex, uint32_t startInstance)
+{
+    CMD_DRAW_INDEXED* pCommand = push<CMD_DRAW_INDEXED>(COMMAND_DRAW_INDEXED);
+    pCommand->IndexCount = indexCount;
+    pCommand->InstanceCount = instanceCount;
+    pCommand->StartIndex = startIndex;
+    pCommand->BaseVertex = baseVertex;
+    pCommand->StartInstance = startInstance;
+}
+
+void CommandStream::DrawInstances(uint32_t slot, uint32_t indexCount, uint32_t startIndex,
+    int32_t baseVertex, uint32_t firstInstance, uint32_t instanceCount)
+{
+    SetRootConstants(slot, 1, &firstInstance, 0);
+    DrawIndexed(indexCount, instanceCount, startIndex, baseVertex, firstInstance);
+}
+
+void CommandStream::Barrier(GPU_HANDLE resource, uint32_t before, uint32_t after)
+{
+    CMD_BARRIER* pCommand = push<CMD_BARRIER>(COMMAND_BARRIER);
+    pCommand->Resource = resource;
+    pCommand->Before = before;
+    pCommand->After = after;
+}
+
+void CommandStream::CopyBuffer(GPU_HANDLE destination, uint64_t destinationOffset,
+    GPU_HANDLE source, uint64_t sourceOffset, uint64_t byteSize)
+{
+    CMD_COPY_BUFFER* pCommand = push<CMD_COPY_BUFFER>(COMMAND_COPY_BUFFER);
+    pCommand->Destination = destination;
+    pCommand->DestinationOffset = destinationOffset;
+    pCommand->Source = source;
+    pCommand->SourceOffset = sourceOffset;
+    pCommand->ByteSize = byteSize;
+}
@@ -0,0 +1,228 @@
+/*****************************************************************//**
+ * \file   command_stream.h
+ * \brief  Backend-agnostic stream of recorded rendering commands
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Backend object the stream refers to: a pipeline, resource, descriptor
+// handle or GPU address. The stream never looks inside.
+typedef uint64_t GPU_HANDLE;
+
+enum COMMAND_TYPE : uint16_t
+{
+	COMMAND_SET_PIPELINE,
+	COMMAND_SET_ROOT_SIGNATURE,
+	COMMAND_SET_DESCRIPTOR_HEAP,
+	COMMAND_SET_ROOT_CBV,
+	COMMAND_SET_ROOT_SRV,
+	COMMAND_SET_ROOT_TABLE,
+	COMMAND_SET_ROOT_CONSTANTS,
+	COMMAND_SET_VERTEX_BUFFER,
+	COMMAND_SET_INDEX_BUFFER,
+	COMMAND_SET_TOPOLOGY,
+	COMMAND_SET_VIEWPORT,
+	COMMAND_SET_SCISSOR,
+	COMMAND_SET_RENDER_TARGET,
+	COMMAND_CLEAR_RENDER_TARGET,
+	COMMAND_CLEAR_DEPTH_STENCIL,
+	COMMAND_DRAW_INDEXED,
+	COMMAND_BARRIER,
+	COMMAND_COPY_BUFFER,
+	COMMAND_TYPE_COUNT
+};
+
+// Starts every command. Commands are 8-byte aligned, Size includes padding.
+struct COMMAND_HEADER
+{
+	uint16_t Type;
+	uint16_t Size;
+};
+
+struct CMD_SET_HANDLE			// Pipeline, root signature or descriptor heap
+{
+	COMMAND_HEADER Header;
+	uint32_t _pad;
+	GPU_HANDLE Handle;
+};
+
+struct CMD_SET_ROOT_HANDLE		// Root CBV, SRV or descriptor table
+{
+	COMMAND_HEADER Header;
+	uint32_t Slot;
+	GPU_HANDLE Handle;			// GPU address, or GPU descriptor for tables
+};
+
+struct CMD_SET_ROOT_CONSTANTS	// Followed by Count values
+{
+	COMMAND_HEADER Header;
+	uint32_t Slot;
+	uint32_t Count;
+	uint32_t Offset;			// First 32-bit value in the slot
+};
+
+struct CMD_SET_VERTEX_BUFFER
+{
+	COMMAND_HEADER Header;
+	uint32_t Stride;
+	GPU_HANDLE Address;
+	uint32_t Size;
+	uint32_t _pad;
+};
+
+struct CMD_SET_INDEX_BUFFER
+{
+	COMMAND_HEADER Header;
+	uint32_t IndexSize;			// 2 or 4 bytes
+	GPU_HANDLE Address;
+	uint32_t Size;
+	uint32_t _pad;
+};
+
+struct CMD_SET_TOPOLOGY
+{
+	COMMAND_HEADER Header;
+	uint32_t Topology;			// Backend value
+};
+
+struct CMD_SET_VIEWPORT
+{
+	COMMAND_HEADER Header;
+	float X, Y, Width, Height, MinDepth, MaxDepth;
+	uint32_t _pad;
+};
+
+struct CMD_SET_SCISSOR
+{
+	COMMAND_HEADER Header;
+	int32_t Left, Top, Right, Bottom;
+	uint32_t _pad;
+};
+
+struct CMD_SET_RENDER_TARGET
+{
+	COMMAND_HEADER Header;
+	uint32_t _pad;
+	GPU_HANDLE RenderTarget;	// CPU descriptors
+	GPU_HANDLE DepthStencil;	// 0 for none
+};
+
+struct CMD_CLEAR_RENDER_TARGET
+{
+	COMMAND_HEADER Header;
+	uint32_t _pad;
+	GPU_HANDLE RenderTarget;
+	float Color[4];
+};
+
+struct CMD_CLEAR_DEPTH_STENCIL
+{
+	COMMAND_HEADER Header;
+	uint32_t Flags;				// Backend value
+	GPU_HANDLE DepthStencil;
+	float Depth;
+	uint32_t Stencil;
+};
+
+struct CMD_DRAW_INDEXED
+{
+	COMMAND_HEADER Header;
+	uint32_t IndexCount;
+	uint32_t InstanceCount;
+	uint32_t StartIndex;
+	int32_t BaseVertex;
+	uint32_t StartInstance;
+};
+
+struct CMD_BARRIER				// Transition of a whole resource
+{
+	COMMAND_HEADER Header;
+	uint32_t _pad;
+	GPU_HANDLE Resource;
+	uint32_t Before;			// Backend states
+	uint32_t After;
+};
+
+struct CMD_COPY_BUFFER
+{
+	COMMAND_HEADER Header;
+	uint32_t _pad;
+	GPU_HANDLE Destination;
+	uint64_t DestinationOffset;
+	GPU_HANDLE Source;
+	uint64_t SourceOffset;
+	uint64_t ByteSize;
+};
+
+/**
+ * Records draws, binds, barriers and copies into one packed buffer, to be
+ * replayed by a backend: D3D12CommandBackend onto a command list, or
+ * NullCommandBackend, which only validates and counts.
+ *
+ * Recording does not depend on D3D, so the CPU side of a frame can be run and
+ * measured headless. Backend values such as topologies, resource states and
+ * clear flags are stored as they are given.
+ */
+class CommandStream
+{
+public:
+	// Drops recorded commands, keeps the memory
+	void Reset() { m_data.clear(); m_commandCount = 0; }
+
+	void SetPipeline(GPU_HANDLE pipeline);
+	void SetRootSignature(GPU_HANDLE rootSignature);
+	void SetDescriptorHeap(GPU_HANDLE heap);
+	void SetRootCBV(uint32_t slot, GPU_HANDLE address);
+	void SetRootSRV(uint32_t slot, GPU_HANDLE address);
+	void SetRootTable(uint32_t slot, GPU_HANDLE descriptor);
+	void SetRootConstants(uint32_t slot, uint32_t count, const uint32_t* pValues, uint32_t offset = 0);
+	void SetVertexBuffer(GPU_HANDLE address, uint32_t size, uint32_t stride);
+	void SetIndexBuffer(GPU_HANDLE address, uint32_t size, uint32_t indexSize);
+	void SetTopology(uint32_t topology);
+	void SetViewport(float x, float y, float width, float height, float minDepth, float maxDepth);
+	void SetScissor(int32_t left, int32_t top, int32_t right, int32_t bottom);
+	void SetRenderTarget(GPU_HANDLE renderTarget, GPU_HANDLE depthStencil);
+	void ClearRenderTarget(GPU_HANDLE renderTarget, const float color[4]);
+	void ClearDepthStencil(GPU_HANDLE depthStencil, uint32_t flags, float depth, uint32_t stencil);
+	void DrawIndexed(uint32_t indexCount, uint32_t instanceCount,
+		uint32_t startIndex, int32_t baseVertex, uint32_t startInstance);
+
+	// Draws instances [firstInstance, firstInstance + instanceCount) of the
+	// frame's instance list. SV_InstanceID starts from zero regardless of
+	// StartInstance, so the base also goes to the first root constant of slot.
+	void DrawInstances(uint32_t slot, uint32_t indexCount, uint32_t startIndex, int32_t baseVertex,
+		uint32_t firstInstance, uint32_t instanceCount);
+	void Barrier(GPU_HANDLE resource, uint32_t before, uint32_t after);
+	void CopyBuffer(GPU_HANDLE destination, uint64_t destinationOffset,
+		GPU_HANDLE source, uint64_t sourceOffset, uint64_t byteSize);
+
+	// Walks the commands: for (p = First(); p; p = Next(p)). Casting a header
+	// to the struct of its Type is valid.
+	const COMMAND_HEADER* First() const;
+	const COMMAND_HEADER* Next(const COMMAND_HEADER* pCommand) const;
+
+	uint32_t CommandCount() const { return m_commandCount; }
+	size_t ByteSize() const { return m_data.size() * sizeof(uint64_t); }
+
+	static const uint32_t* RootConstantValues(const CMD_SET_ROOT_CONSTANTS* pCommand)
+	{
+		return reinterpret_cast<const uint32_t*>(pCommand + 1);
+	}
+
+private:
+	// Reserves an 8-byte aligned command of byteSize bytes and fills its header
+	void* allocate(COMMAND_TYPE type, size_t byteSize);
+
+	template<typename T>
+	T* push(COMMAND_TYPE type) { return static_cast<T*>(allocate(type, sizeof(T))); }
+
+	// Stored as 64-bit words so that every command is aligned
+	std::vector<uint64_t> m_data;
+	uint32_t m_commandCount = 0;
+};
@@ -0,0 +1,188 @@
+/*****************************************************************//**
+ * \file   d3d12_backend.cpp
+ * \brief  Definition of D3D12CommandBackend
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include "d3d12_backend.h"
+
+template<typename T>
+static T* object(GPU_HANDLE handle)
+{
+	return reinterpret_cast<T*>(static_cast<uintptr_t>(handle));
+}
+
+static D3D12_CPU_DESCRIPTOR_HANDLE cpu_descriptor(GPU_HANDLE handle)
+{
+	D3D12_CPU_DESCRIPTOR_HANDLE descriptor = { };
+	descriptor.ptr = static_cast<SIZE_T>(handle);
+	return descriptor;
+}
+
+void D3D12CommandBackend::FlushBarriers(ID3D12GraphicsCommandList* pCommandList)
+{
+	if (mBarriers.empty()) return;
+
+	pCommandList->ResourceBarrier(static_cast<UINT>(mBarriers.size()), mBarriers.data());
+	mBarriers.clear();
+}
+
+void D3D12CommandBackend::Execute(const CommandStream& stream, ID3D12GraphicsCommandList* pCommandList)
+{
+	for (const COMMAND_HEADER* p = stream.First(); p != nullptr; p = stream.Next(p))
+	{
+		if (p->Type != COMMAND_BARRIER) FlushBarriers(pCommandList);
+
+		switch (p->Type)
+		{
+		case COMMAND_SET_PIPELINE:
+			pCommandList->SetPipelineState(
+				object<ID3D12PipelineState>(reinterpret_cast<const CMD_SET_HANDLE*>(p)->Handle));
+			break;
+
+		case COMMAND_SET_ROOT_SIGNATURE:
+			pCommandList->SetGraphicsRootSignature(
+				object<ID3D12RootSignature>(reinterpret_cast<const CMD_SET_HANDLE*>(p)->Handle));
+			break;
+
+		case COMMAND_SET_DESCRIPTOR_HEAP:
+		{
+			ID3D12DescriptorHeap* heaps[] = {
+				object<ID3D12DescriptorHeap>(reinterpret_cast<const CMD_SET_HANDLE*>(p)->Handle) };
+			pCommandList->SetDescriptorHeaps(_countof(heaps), heaps);
+			break;
+		}
+
+		case COMMAND_SET_ROOT_CBV:
+		{
+			const CMD_SET_ROOT_HANDLE* pCommand = reinterpret_cast<const CMD_SET_ROOT_HANDLE*>(p);
+			pCommandList->SetGraphicsRootConstantBufferView(pCommand->Slot, pCommand->Handle);
+			break;
+		}
+
+		case COMMAND_SET_ROOT_SRV:
+		{
+			const CMD_SET_ROOT_HANDLE* pCommand = reinterpret_cast<const CMD_SET_ROOT_HANDLE*>(p);
+			pCommandList->SetGraphicsRootShaderResourceView(pCommand->Slot, pCommand->Handle);
+			break;
+		}
+
+		case COMMAND_SET_ROOT_TABLE:
+		{
+			const CMD_SET_ROOT_HANDLE* pCommand = reinterpret_cast<const CMD_SET_ROOT_HANDLE*>(p);
+			D3D12_GPU_DESCRIPTOR_HANDLE descriptor = { };
+			descriptor.ptr = pCommand->Handle;
+			pCommandList->SetGraphicsRootDescriptorTable(pCommand->Slot, descriptor);
+			break;
+		}
+
+		case COMMAND_SET_ROOT_CONSTANTS:
+		{
+			const CMD_SET_ROOT_CONSTANTS* pCommand = reinterpret_cast<const CMD_SET_ROOT_CONSTANTS*>(p);
+			pCommandList->SetGraphicsRoot32BitConstants(pCommand->Slot, pCommand->Count,
+				CommandStream::RootConstantValues(pCommand), pCommand->Offset);
+			break;
+		}
+
+		case COMMAND_SET_VERTEX_BUFFER:
+		{
+			const CMD_SET_VERTEX_BUFFER* pCommand = reinterpret_cast<const CMD_SET_VERTEX_BUFFER*>(p);
+			D3D12_VERTEX_BUFFER_VIEW view = { pCommand->Address, pCommand->Size, pCommand->Stride };
+			pCommandList->IASetVertexBuffers(0, 1, &view);
+			break;
+		}
+
+		case COMMAND_SET_INDEX_BUFFER:
+		{
+			const CMD_SET_INDEX_BUFFER* pCommand = reinterpret_cast<const CMD_SET_INDEX_BUFFER*>(p);
+			D3D12_INDEX_BUFFER_VIEW view = { pCommand->Address, pCommand->Size,
+				pCommand->IndexSize == 2 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT };
+			pCommandList->IASetIndexBuffer(&view);
+			break;
+		}
+
+		case COMMAND_SET_TOPOLOGY:
+			pCommandList->IASetPrimitiveTopology(static_cast<D3D12_PRIMITIVE_TOPOLOGY>(
+				reinterpret_cast<const CMD_SET_TOPOLOGY*>(p)->Topology));
+			break;
+
+		case COMMAND_SET_VIEWPORT:
+		{
+			const CMD_SET_VIEWPORT* pCommand = reinterpret_cast<const CMD_SET_VIEWPORT*>(p);
+			D3D12_VIEWPORT viewport = { pCommand->X, pCommand->Y, pCommand->Width, pCommand->Height,
+				pCommand->MinDepth, pCommand->MaxDepth };
+			pCommandList->RSSetViewports(1, &viewport);
+			break;
+		}
+
+		case COMMAND_SET_SCISSOR:
+		{
+			const CMD_SET_SCISSOR* pCommand = reinterpret_cast<const CMD_SET_SCISSOR*>(p);
+			D3D12_RECT rect = { pCommand->Left, pCommand->Top, pCommand->Right, pCommand->Bottom };
+			pCommandList->RSSetScissorRects(1, &rect);
+			break;
+		}
+
+		case COMMAND_SET_RENDER_TARGET:
+		{
+			const CMD_SET_RENDER_TARGET* pCommand = reinterpret_cast<const CMD_SET_RENDER_TARGET*>(p);
+			D3D12_CPU_DESCRIPTOR_HANDLE renderTarget = cpu_descriptor(pCommand->RenderTarget);
+			D3D12_CPU_DESCRIPTOR_HANDLE depthStencil = cpu_descriptor(pCommand->DepthStencil);
+			pCommandList->OMSetRenderTargets(1, &renderTarget, true,
+				pCommand->DepthStencil != 0 ? &depthStencil : nullptr);
+			break;
+		}
+
+		case COMMAND_CLEAR_RENDER_TARGET:
+		{
+			const CMD_CLEAR_RENDER_TARGET* pCommand = reinterpret_cast<const CMD_CLEAR_RENDER_TARGET*>(p);
+			pCommandList->ClearRenderTargetView(cpu_descriptor(pCommand->RenderTarget),
+				pCommand->Color, 0, nullptr);
+			break;
+		}
+
+		case COMMAND_CLEAR_DEPTH_STENCIL:
+		{
+			const CMD_CLEAR_DEPTH_STENCIL* pCommand = reinterpret_cast<const CMD_CLEAR_DEPTH_STENCIL*>(p);
+			pCommandList->ClearDepthStencilView(cpu_descriptor(pCommand->DepthStencil),
+				static_cast<D3D12_CLEAR_FLAGS>(pCommand->Flags), pCommand->Depth,
+				static_cast<UINT8>(pCommand->Stencil), 0, nullptr);
+			break;
+		}
+
+		case COMMAND_DRAW_INDEXED:
+		{
+			const CMD_DRAW_INDEXED* pCommand = reinterpret_cast<const CMD_DRAW_INDEXED*>(p);
+			pCommandList->DrawIndexedInstanced(pCommand->IndexCount, pCommand->InstanceCount,
+				pCommand->StartIndex, pCommand->BaseVertex, pCommand->StartInstance);
+			break;
+		}
+
+		case COMMAND_BARRIER:
+		{
+			const CMD_BARRIER* pCommand = reinterpret_cast<const CMD_BARRIER*>(p);
+			D3D12_RESOURCE_BARRIER barrier = { };
+			barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+			barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+			barrier.Transition.pResource = object<ID3D12Resource>(pCommand->Resource);
+			barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+			barrier.Transition.StateBefore = static_cast<D3D12_RESOURCE_STATES>(pCommand->Before);
+			barrier.Transition.StateAfter = static_cast<D3D12_RESOURCE_STATES>(pCommand->After);
+			mBarriers.push_back(barrier);
+			break;
+		}
+
+		case COMMAND_COPY_BUFFER:
+		{
+			const CMD_COPY_BUFFER* pCommand = reinterpret_cast<const CMD_COPY_BUFFER*>(p);
+			pCommandList->CopyBufferRegion(object<ID3D12Resource>(pCommand->Destination),
+				pCommand->DestinationOffset, object<ID3D12Resource>(pCommand->Source),
+				pCommand->SourceOffset, pCommand->ByteSize);
+			break;
+		}
+		}
+	}
+
+	FlushBarriers(pCommandList);
+}
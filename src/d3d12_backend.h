@@ -0,0 +1,36 @@
+/*****************************************************************//**
+ * \file   d3d12_backend.h
+ * \brief  Replays command streams onto D3D12 command lists
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+
+#include <d3d12.h>
+#include <vector>
+
+#include "command_stream.h"
+
+/**
+ * Translates a CommandStream into calls on a graphics command list.
+ *
+ * Handles in the stream are the D3D objects themselves: pointers to pipeline
+ * states, root signatures, heaps and resources, the ptr of descriptor
+ * handles, and GPU virtual addresses. Consecutive barriers are submitted
+ * with one ResourceBarrier call.
+ */
+class D3D12CommandBackend
+{
+public:
+	void Execute(const CommandStream& stream, ID3D12GraphicsCommandList* pCommandList);
+
+	static GPU_HANDLE Handle(const void* pObject) { return reinterpret_cast<uintptr_t>(pObject); }
+	static GPU_HANDLE Handle(D3D12_CPU_DESCRIPTOR_HANDLE descriptor) { return descriptor.ptr; }
+	static GPU_HANDLE Handle(D3D12_GPU_DESCRIPTOR_HANDLE descriptor) { return descriptor.ptr; }
+
+private:
+	void FlushBarriers(ID3D12GraphicsCommandList* pCommandList);
+
+	std::vector<D3D12_RESOURCE_BARRIER> mBarriers;
+};
@@ -1,6 +1,8 @@
 #include "d3dUtil.h"
+#include "shader_cache.h"
 
 #include <comdef.h>
+#include <cstring>
 #include <fstream>
 #include <wrl.h>
 #include <d3dcompiler.h>
@@ -78,7 +80,8 @@ Microsoft::WRL::ComPtr<ID3DBlob> CompileShader(
     const std::wstring& filename,
     const D3D_SHADER_MACRO* defines,
     const std::string& entrypoint,
-    const std::string& target)
+    const std::string& target,
+    std::string* pMessages)
 {
     UINT compileFlags = 0;
 #if defined(DEBUG) || defined(_DEBUG)
@@ -104,11 +107,55 @@ Microsoft::WRL::ComPtr<ID3DBlob> CompileShader(
     if (errors != nullptr)
     {
         OutputDebugStringA((char*)errors->GetBufferPointer());
+        if (pMessages != nullptr)
+        {
+            const char* pText = reinterpret_cast<const char*>(errors->GetBufferPointer());
+            pMessages->assign(pText, strnlen(pText, errors->GetBufferSize()));
+        }
     }
     ThrowIfFailed(hr);
     return byteCode;
 }
 
+std::string ShaderCompilerTag()
+{
+    std::string tag = "D3DCompile " + std::to_string(D3D_COMPILER_VERSION);
+#if defined(DEBUG) || defined(_DEBUG)
+    tag += " debug";
+#endif
+    return tag;
+}
+
+Microsoft::WRL::ComPtr<ID3DBlob> CompileShaderCached(
+    ShaderCache& cache,
+    const std::string& filename,
+    const D3D_SHADER_MACRO* defines,
+    const std::string& entrypoint,
+    const std::string& target,
+    uint64_t* key)
+{
+    SHADER_DESC desc;
+    desc.Filename = filename;
+    for (const D3D_SHADER_MACRO* pDefine = defines; pDefine && pDefine->Name; pDefine++)
+    {
+        desc.Defines.push_back({ pDefine->Name, pDefine->Definition ? pDefine->Definition : "" });
+    }
+    desc.EntryPoint = entrypoint;
+    desc.Target = target;
+
+    std::vector<uint8_t> bytecode;
+    if (!cache.Get(desc, bytecode, key))
+    {
+        OutputDebugStringA(cache.Errors().c_str());
+        ThrowIfFailed(E_FAIL);
+    }
+
+    ComPtr<ID3DBlob> blob = nullptr;
+    ThrowIfFailed(D3DCreateBlob(bytecode.size(), blob.GetAddressOf()));
+    memcpy(blob->GetBufferPointer(), bytecode.data(), bytecode.size());
+    return blob;
+}
+
 // Utility function to that creates default buffer and uploads
 // the data specified through the upload buffer.
 //
@@ -8,6 +8,7 @@
 #pragma once
 
 #include <d3d12.h>
+#include <cstdint>
 #include <cstdlib>
 #include <string>
 #include <unordered_map>
@@ -62,11 +63,28 @@ inline UINT CalcConstantBufferByteSize(UINT byteSize)
 
 // Function wrapper for D3DCompileFromFile that handles errors.
 // Also enables debug flags if running a debug build.
+// Compiler messages also go to pMessages, if not null, before a failure throws.
 Microsoft::WRL::ComPtr<ID3DBlob> CompileShader(
     const std::wstring& filename,
     const D3D_SHADER_MACRO* defines,
     const std::string& entrypoint,
-    const std::string& target);
+    const std::string& target,
+    std::string* pMessages = nullptr);
+
+class ShaderCache;
+
+// Gets a shader through the disk cache, compiling it with CompileShader on a miss.
+// key receives the cache key of the shader, if not null.
+Microsoft::WRL::ComPtr<ID3DBlob> CompileShaderCached(
+    ShaderCache& cache,
+    const std::string& filename,
+    const D3D_SHADER_MACRO* defines,
+    const std::string& entrypoint,
+    const std::string& target,
+    uint64_t* key = nullptr);
+
+// Compiler version and flags used by CompileShader, part of every cache key
+std::string ShaderCompilerTag();
 
 // Utility function to create a default buffer and fill it with initData
 // by creating an intermediate upload buffer.
@@ -1,6 +1,30 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
 #include "d3dinit.h"
+#include "latency_controller.h"
+#include "render_queue.h"
+#include "frustum_cull.h"
+#include "occlusion.h"
+#include "horizon.h"
+#include "shader_cache.h"
+#include "pipeline_library.h"
+#include "shader_permutations.h"
+#include "clustered_lights.h"
+#include "command_stream.h"
+#include "d3d12_backend.h"
+#include "parallel_record.h"
+#include "task_graph.h"
+#include "triple_buffer.h"
+#include "fixed_step.h"
+#include "profiler.h"
+#include "perf_counters.h"
+#include "pass_matrices.h"
 
 /**
  * Class that defines runtime behavior of the program.
@@ -12,44 +36,234 @@ class D3DApplication : public D3DBase
 	std::unique_ptr<StaticResources>					pStaticResources = nullptr;
 	std::unique_ptr<DynamicResources>					pDynamicResources = nullptr;
 
+	// Root signature and input layout shared by all variants of main.hlsl
 	Shader												mDefaultShader;
 
-	// An array of pipeline states
-	static const int									gNumRenderModes = 3;
+	// Compiled shaders and PSOs are kept on disk between runs
+	std::unique_ptr<ShaderCache>						mShaderCache = nullptr;
+	std::unique_ptr<PipelineLibrary>					mPipelineLibrary = nullptr;
+
+	// main.hlsl is specialized on light counts, clustered lights, fog and alpha test
+	struct ShaderAxes
+	{
+		uint32_t DirectionalLights = 0;
+		uint32_t PointLights = 0;
+		uint32_t SpotLights = 0;
+		uint32_t ClusteredLights = 0;
+		uint32_t Fog = 0;
+		uint32_t AlphaTest = 0;
+	};
+
+	// Compiled variant and its PSOs, created on first use
+	struct ShaderVariant
+	{
+		Microsoft::WRL::ComPtr<ID3DBlob> VS = nullptr;
+		Microsoft::WRL::ComPtr<ID3DBlob> PS = nullptr;
+		uint64_t CacheKey = 0;			// Hash of the shader cache keys, names the PSOs
+		Microsoft::WRL::ComPtr<ID3D12PipelineState> PSOs[PIPELINE_STATE_COUNT];
+	};
+
+	ShaderPermutations									mPermutations;
+	ShaderAxes											mShaderAxes;
+	uint32_t											mBaseVariant = 0;		// All scene lights, with fog
+	std::unordered_map<uint32_t, ShaderVariant>			mShaderVariants;
+
+	// PSO descriptions without shaders, one per PIPELINE_STATE
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC					mPipelineDescs[PIPELINE_STATE_COUNT];
+
+	// Lights of the scene, stored by type in the environment constants
+	std::vector<Light>									mDirectionalLights;
+	std::vector<Light>									mPointLights;
+	std::vector<Light>									mSpotLights;
+
+	// When point and spot lights do not fit in the MAX_LIGHTS slots, they are
+	// binned into view-space clusters every frame instead of assigned per draw
+	static const UINT									ClusterTilesX = 16;
+	static const UINT									ClusterTilesY = 8;
+	static const UINT									ClusterSlices = 24;
+	bool												mClusteredLighting = false;
+	LightClusterer										mLightClusterer = LightClusterer(&mJobSystem);
+	std::vector<CLUSTER_LIGHT>							mClusterLights;		// Point, then spot lights
+	std::vector<Light>									mClusterLightData;	// Same order, read by shaders
+
+	// The simulation runs on a thread of its own in fixed steps of
+	// 1 / SimulationHz seconds and hands what a frame needs to the render
+	// thread as immutable snapshots. Frames draw the latest complete snapshot,
+	// so neither thread waits for the other. Transforms and lights do not
+	// change after loading, so they stay with the renderer.
+	//
+	// Frames rarely fall on a step, so a snapshot holds the camera at the
+	// previous publish and now, and the frame blends the two over all the
+	// steps between them by how far real time has moved past the previous
+	// state. The simulation thread wakes for several steps at a time when
+	// the sleep is coarse, and motion is still smooth at any frame rate, one
+	// publish behind the simulation.
+	struct CameraState
+	{
+		DirectX::XMFLOAT4 Position;
+		DirectX::XMFLOAT4 Direction;
+		DirectX::XMFLOAT4 Up;
+	};
+
+	struct Snapshot
+	{
+		CameraState Previous;			// At the previous publish
+		CameraState Current;
+		uint32_t Steps;					// Between Previous and Current, at least 1
+		float TotalTime;				// Simulation time of Current
+		float Alpha;					// Time accumulated past Current at publishing, in steps
+		std::chrono::steady_clock::time_point PublishedAt;
+		uint64_t Step;
+	};
+
+	// Interpolated for the current frame
+	struct FrameView
+	{
+		DirectX::XMFLOAT4X4 View;
+		DirectX::XMFLOAT4 EyePosition;
+		float TotalTime;
+	};
+
+	static const UINT									SimulationHz = 240;
+	std::unique_ptr<Camera>								mCamera = nullptr;			// Simulation thread only
+	FixedStepClock										mFixedStep;					// Simulation thread only
+	CameraState											mPreviousCamera = { };		// Simulation thread only, at the last publish
+	uint64_t											mPublishedStep = 0;			// Simulation thread only
+	TripleBuffer<Snapshot>								mSnapshots;
+	FrameView											mFrameView = { };
+	std::thread											mSimulationThread;
+	std::atomic<bool>									mSimulationQuit{ false };
+
+	// Mouse drag not yet applied to the camera, from the window thread
+	std::mutex											mMouseMutex;
+	POINT												mLastMousePos = { };
+	POINT												mMouseDelta = { };
 
-	Microsoft::WRL::ComPtr<ID3D12PipelineState>			mDefaultPSO = nullptr;
-	Microsoft::WRL::ComPtr<ID3D12PipelineState>			mLinePSO = nullptr;
-	Microsoft::WRL::ComPtr<ID3D12PipelineState>			mBlendPSO = nullptr;
+	// Render item is a scene object drawn with one of the drawables
+	struct RenderItem
+	{
+		UINT DrawableIndex = 0;
+		UINT ObjectIndex = 0;			// Index in the frame's object buffer
+	};
+
+	std::vector<std::unique_ptr<IDrawable>>			mDrawables;
+	std::vector<RenderItem>								mRenderItems;
+	RenderQueue											mRenderQueue;
+
+	// Draws are recorded by up to NUM_RECORD_WORKERS jobs into command
+	// streams, each replayed onto the worker's command list of the frame
+	ParallelRecorder									mRecorder = ParallelRecorder(NUM_RECORD_WORKERS, &mJobSystem);
+	D3D12CommandBackend									mCommandBackends[NUM_RECORD_WORKERS];
+
+	UINT												mCommandListCount = 0;	// Recorded for the current frame
+
+	// PSO and light slots of each batch, resolved before recording starts
+	std::vector<ID3D12PipelineState*>					mBatchPSOs;
+	std::vector<DRAW_LIGHTS>							mBatchLights;
 
-	std::unique_ptr<Camera>								mCamera = nullptr;
+	// World-space bounds per render item, and items that passed the frustum test
+	CullingBounds										mItemBounds;
+	FrustumCuller										mFrustumCuller = FrustumCuller(&mJobSystem);
+	std::vector<uint32_t>								mVisibleItems;
 
-	std::unique_ptr<DefaultDrawable>					mTerrain = nullptr;
-	std::unique_ptr<DefaultDrawable>					mWater = nullptr;
+	// Terrain hides whatever is behind hills. The horizon test is cheap and goes
+	// first, the rasterized occluder catches what it leaves.
+	std::unique_ptr<HeightPyramid>						mHeightPyramid = nullptr;
+	std::unique_ptr<HorizonCuller>						mHorizonCuller = nullptr;
+	std::unique_ptr<OcclusionCuller>					mOcclusionCuller = nullptr;
 
 	DirectX::XMFLOAT4X4 mProj = MathHelper::Identity4x4();
+	DirectX::XMFLOAT4X4 mViewProj = MathHelper::Identity4x4();	// Not transposed, for culling
+
+	// Set to rebuild lighting and fog constants on the next update
+	bool												mEnvironmentDirty = true;
+
+	// Frames in flight are adjusted at runtime from CPU stall and GPU idle time
+	std::unique_ptr<FrameLatencyController>				mLatencyController = nullptr;
+	std::chrono::steady_clock::time_point				mFrameStartTime;
+	bool												mGpuDrainedAtFrameStart = false;
+	double												mGpuIdleSeconds = 0.0;
+	uint64_t											mFrameStallNs = 0;
+
+	// Update runs the frame as a graph of tasks on the job system
+	TaskGraph											mFrameGraph;
 
 private:
 	void D3DBase::InitializeComponents() override
 	{
 		LoadResources();
+		FIXED_STEP_PARAMS stepParams;
+		stepParams.StepSeconds = 1.0 / SimulationHz;
+		mFixedStep = FixedStepClock(stepParams);
 		mCamera = std::make_unique<Camera>(DirectX::XMVectorSet(5.0f, 2.0f, 5.0f, 1.0f),
-			DirectX::XM_PI * 7 / 4, -0.2f, mTimer.get());
+			DirectX::XM_PI * 7 / 4, -0.2f);
 
 		// temp
 		D3DHelper::CreateDefaultRootSignature(md3dDevice.Get(), mDefaultShader.mRootSignature.GetAddressOf());
 
 		BuildShadersAndInputLayout();
 		BuildPSO();
+
+		FRAME_LATENCY_PARAMS latencyParams;
+		latencyParams.MinFrames = MIN_FRAME_RESOURCES;
+		latencyParams.MaxFrames = MAX_FRAME_RESOURCES;
+		mLatencyController = std::make_unique<FrameLatencyController>(
+			pDynamicResources->FrameResourceCount(), latencyParams);
+
+		BuildFrameGraph();
+
+		// The first frame has a snapshot to draw
+		mPreviousCamera = CaptureCamera();
+		PublishSnapshot(0.0);
+		mSimulationThread = std::thread(&D3DApplication::RunSimulation, this);
+	}
+
+public:
+	~D3DApplication()
+	{
+		mSimulationQuit.store(true);
+		if (mSimulationThread.joinable()) mSimulationThread.join();
+
+		// Frame resources may still be in use by the GPU. Nothing is left to
+		// do about a failure here, so it does not escape the destructor.
+		if (pDynamicResources)
+		{
+			try
+			{
+				pDynamicResources->WaitForAllFrameResources(mFenceWaiter.get(), mFence.Get());
+			}
+			catch (...)
+			{
+			}
+		}
 	}
 
 private:
 	void LoadResources();
-	void BuildShadersAndInputLayout();			// Compiles shaders and defines input layout
+	void BuildTerrainOcclusion(const char* heightmapFilename);
+	void BuildLights();
+	void BuildShadersAndInputLayout();			// Defines shader variants and input layout
 	void BuildPSO();							// Configures rendering pipeline
+	void BuildFrameGraph();						// Declares the tasks of a frame and what they share
 
-	void DrawRenderItems();						// Draw every render item
+	void PrepareRenderItems();					// Upload draw data and resolve state of the batches
+	void DrawRenderItems(const RECORD_RANGE& range, CommandStream& stream);	// Record a range of batches
+	void RecordCommandLists();					// Record all batches into the frame's command lists
+	uint32_t ShaderVariantKey(const DRAW_LIGHTS& lights, bool alphaTest) const;
+	ID3D12PipelineState* GetPipelineState(PIPELINE_STATE pipeline, uint32_t variantKey);
 
 	void UpdatePassCB();						// Update and store in CB pass constants
+	void UpdateEnvironmentCB();					// Store lighting and fog if they were changed
+	void CullRenderItems();						// Collect render items inside the view frustum and not occluded
+	uint32_t ItemLightMask(uint32_t itemIndex) const;
+	void BuildLightClusters();					// Bin point and spot lights into clusters of the view
+	void BuildRenderQueue();					// Sort visible render items into instanced batches
+	void UpdateFrameLatency();					// Feed last frame timing to latency controller
+
+	void RunSimulation();						// Simulation thread: step and publish until quit
+	CameraState CaptureCamera() const;
+	void PublishSnapshot(double alpha);			// Hand the simulation state to the render thread
+	void InterpolateSnapshot();					// Blend the latest snapshot into the frame's view
 
 	void Update() override;
 	void Draw() override;
@@ -60,6 +274,11 @@ private:
 		DirectX::XMMATRIX P = DirectX::XMMatrixPerspectiveFovLH(0.25f * MathHelper::Pi,
 			AspectRatio(), 1.0f, 1000.0f);
 		XMStoreFloat4x4(&mProj, P);
+
+		// So does the cluster grid, and its constants with it
+		mLightClusterer.SetGrid(ClusterTilesX, ClusterTilesY, ClusterSlices,
+			mProj._11, mProj._22, 1.0f, 1000.0f);
+		mEnvironmentDirty = true;
 	}
 
 	void OnMouseDown(WPARAM btnState, int x, int y) override;
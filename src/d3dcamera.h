@@ -12,15 +12,12 @@
 #include <Windows.h>
 
 #include "MathHelper.h"
-#include "timer.h"
 
 class Camera
 {
 public:
-	Camera(DirectX::FXMVECTOR pos, float phi, float theta, Timer* timer)
+	Camera(DirectX::FXMVECTOR pos, float phi, float theta)
 	{
-		mTimer = timer;
-
 		mDirection = {
 			cosf(mTheta) * sinf(mPhi),
 			sinf(mTheta),
@@ -63,16 +60,24 @@ private:
 
 	float mSpeedZ = 0.0f;
 	float mSpeedX = 0.0f;
-
-	Timer* mTimer = nullptr;
 public:
+	const DirectX::XMFLOAT4& Direction() const { return mDirection; }
+	const DirectX::XMFLOAT4& Up() const { return mUp; }
+
 	void OnMouseMove(int mouseX, int mouseY)
+	{
+		Rotate(mouseX - mLastMousePos.x, mouseY - mLastMousePos.y);
+		mLastMousePos = { mouseX, mouseY };
+	}
+
+	// Turns by a mouse movement in pixels
+	void Rotate(int deltaX, int deltaY)
 	{
 		float dPhi = DirectX::XMConvertToRadians(
-			0.25f * static_cast<float>(mouseX - mLastMousePos.x));
+			0.25f * static_cast<float>(deltaX));
 		
 		float dTheta = DirectX::XMConvertToRadians(
-			0.25f * static_cast<float>(mouseY - mLastMousePos.y));
+			0.25f * static_cast<float>(deltaY));
 
 		mPhi += dPhi;
 		mTheta -= dTheta;
@@ -91,9 +96,10 @@ public:
 			cosf(mTheta),
 			- cosf(mTheta) * cosf(mPhi),
 			0.0f };
-		mLastMousePos = { mouseX, mouseY };
 	}
-	void Update()
+	// Moves by one simulation step. Speeds decay by a fixed factor per
+	// call, so steps should be of a fixed length.
+	void Update(float deltaTime)
 	{
 		OnKeyDown();
 
@@ -112,8 +118,8 @@ public:
 		// Forward/Backward
 		position = DirectX::XMVectorAdd(position,
 			DirectX::XMVectorAdd(
-				DirectX::XMVectorScale(direction, mSpeedZ * mTimer->DeltaTime()),
-				DirectX::XMVectorScale(left, -mSpeedX * mTimer->DeltaTime())));
+				DirectX::XMVectorScale(direction, mSpeedZ * deltaTime),
+				DirectX::XMVectorScale(left, -mSpeedX * deltaTime)));
 
 		// Return speed to equilibrium
 		mSpeedX *= 0.95f;
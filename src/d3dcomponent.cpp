@@ -217,20 +217,48 @@ namespace D3DHelper
 	void CreateDefaultRootSignature(ID3D12Device* pDevice, ID3D12RootSignature** ppRootSignature)
 	{
 		// Root parameter can be a table, root descriptor or root constants.
-		D3D12_ROOT_PARAMETER slotRootParameters[4] = { };
+		D3D12_ROOT_PARAMETER slotRootParameters[10] = { };
 
 		// Pass CBV will be bound to b0
 		D3D12_ROOT_DESCRIPTOR perPassCBV = { };
 		perPassCBV.RegisterSpace = 0;
 		perPassCBV.ShaderRegister = 0;
 
-		D3D12_ROOT_DESCRIPTOR perObjectCBV = { };
-		perObjectCBV.RegisterSpace = 0;
-		perObjectCBV.ShaderRegister = 1;
+		// Lighting and fog, bound to b2
+		D3D12_ROOT_DESCRIPTOR environmentCBV = { };
+		environmentCBV.RegisterSpace = 0;
+		environmentCBV.ShaderRegister = 2;
+
+		// Per-frame structured buffers live in space1, so they do
+		// not collide with the texture table
+		D3D12_ROOT_DESCRIPTOR objectSRV = { };
+		objectSRV.RegisterSpace = 1;
+		objectSRV.ShaderRegister = 0;
+
+		D3D12_ROOT_DESCRIPTOR materialSRV = { };
+		materialSRV.RegisterSpace = 1;
+		materialSRV.ShaderRegister = 1;
+
+		D3D12_ROOT_DESCRIPTOR instanceSRV = { };
+		instanceSRV.RegisterSpace = 1;
+		instanceSRV.ShaderRegister = 2;
+
+		// Light clusters: punctual lights, light range per cluster and
+		// the light index lists the ranges point into
+		D3D12_ROOT_DESCRIPTOR clusterSRVs[3] = { };
+		for (UINT i = 0; i < _countof(clusterSRVs); i++)
+		{
+			clusterSRVs[i].RegisterSpace = 1;
+			clusterSRVs[i].ShaderRegister = 3 + i;
+		}
 
-		D3D12_ROOT_DESCRIPTOR materialCBV = { };
-		materialCBV.RegisterSpace = 0;
-		materialCBV.ShaderRegister = 2;
+		// Offset of the draw into the instance list at b1. SV_InstanceID
+		// does not include StartInstanceLocation, so it is passed explicitly.
+		// Two more values hold the light slots of the draw.
+		D3D12_ROOT_CONSTANTS instanceBase = { };
+		instanceBase.RegisterSpace = 0;
+		instanceBase.ShaderRegister = 1;
+		instanceBase.Num32BitValues = 3;
 
 		D3D12_ROOT_DESCRIPTOR_TABLE srvTable = { };
 
@@ -248,18 +276,38 @@ namespace D3DHelper
 		slotRootParameters[0].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
 		slotRootParameters[0].Descriptor = perPassCBV;
 
-		slotRootParameters[1].ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;
+		slotRootParameters[1].ParameterType = D3D12_ROOT_PARAMETER_TYPE_SRV;
 		slotRootParameters[1].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
-		slotRootParameters[1].Descriptor = perObjectCBV;
+		slotRootParameters[1].Descriptor = objectSRV;
 
-		slotRootParameters[2].ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;
+		slotRootParameters[2].ParameterType = D3D12_ROOT_PARAMETER_TYPE_SRV;
 		slotRootParameters[2].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
-		slotRootParameters[2].Descriptor = materialCBV;
+		slotRootParameters[2].Descriptor = materialSRV;
 
 		slotRootParameters[3].ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
 		slotRootParameters[3].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
 		slotRootParameters[3].DescriptorTable = srvTable;
 
+		slotRootParameters[4].ParameterType = D3D12_ROOT_PARAMETER_TYPE_SRV;
+		slotRootParameters[4].ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;
+		slotRootParameters[4].Descriptor = instanceSRV;
+
+		// The vertex shader reads the instance base, the pixel shader the light slots
+		slotRootParameters[5].ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+		slotRootParameters[5].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+		slotRootParameters[5].Constants = instanceBase;
+
+		slotRootParameters[6].ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;
+		slotRootParameters[6].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+		slotRootParameters[6].Descriptor = environmentCBV;
+
+		for (UINT i = 0; i < _countof(clusterSRVs); i++)
+		{
+			slotRootParameters[7 + i].ParameterType = D3D12_ROOT_PARAMETER_TYPE_SRV;
+			slotRootParameters[7 + i].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+			slotRootParameters[7 + i].Descriptor = clusterSRVs[i];
+		}
+
 		// Create static samplers
 
 		D3D12_STATIC_SAMPLER_DESC samplerDesc = { };
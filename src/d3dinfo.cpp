@@ -45,6 +45,8 @@ void D3DBase::CalculateFrameStats()
 	// between function calls
 	static int frameCnt = 0;
 	static float timeElapsed = 0.0f;
+	static uint64_t stallNsElapsed = 0;
+	static double criticalPathElapsed = 0.0;
 
 	frameCnt++;
 
@@ -54,12 +56,34 @@ void D3DBase::CalculateFrameStats()
 		float fps = (float)frameCnt;
 		float mspf = 1000.0f / fps;
 
+		// Time per frame the CPU spent waiting for a free frame resource
+		uint64_t stallNs = mFenceWaiter->Stats().Get(STALL_SITE_FRAME_RESOURCE).TotalNanoseconds();
+		float stallms = (float)(stallNs - stallNsElapsed) / 1e6f / fps;
+		stallNsElapsed = stallNs;
+
+		// CPU time per frame if every independent task had a thread of its own
+		float criticalms = (float)((mCriticalPathSeconds - criticalPathElapsed) * 1e3) / fps;
+		criticalPathElapsed = mCriticalPathSeconds;
+
+		// Tail of the last frames, the average hides spikes
+		FRAME_STATS_SUMMARY summary = mFrameStats.Summary();
+		mFrameStatsLog.Write(summary, mTimer->TotalTime());
+
 		std::wstring fpsStr = AnsiToWString(std::to_string(fps));
 		std::wstring mspfStr = AnsiToWString(std::to_string(mspf));
+		std::wstring stallStr = AnsiToWString(std::to_string(stallms));
+		std::wstring criticalStr = AnsiToWString(std::to_string(criticalms));
+		std::wstring p99Str = AnsiToWString(std::to_string(
+			summary.Metrics[FRAME_METRIC_PRESENT_INTERVAL].P99Ms));
+		std::wstring stutterStr = AnsiToWString(std::to_string(summary.Stutters));
 
 		std::wstring windowText = mMainWindowCaption +
 			L"		fps: " + fpsStr +
-			L"		mspf: " + mspfStr;
+			L"		mspf: " + mspfStr +
+			L"		p99 ms: " + p99Str +
+			L"		stutters: " + stutterStr +
+			L"		stall ms: " + stallStr +
+			L"		critical path ms: " + criticalStr;
 
 		SetWindowText(mhWnd, windowText.c_str());
 
@@ -68,6 +92,31 @@ void D3DBase::CalculateFrameStats()
 	}
 }
 
+void D3DBase::RecordFrameStats(uint64_t frameStartTicks)
+{
+	uint64_t now = Clock::Now();
+
+	// Fence waits of every site, since the previous frame
+	uint64_t stallNs = 0;
+	for (int site = 0; site < STALL_SITE_COUNT; site++)
+	{
+		stallNs += mFenceWaiter->Stats().Get(static_cast<STALL_SITE>(site)).TotalNanoseconds();
+	}
+
+	// The first frame has no interval to the previous one
+	if (mLastPresentTicks != 0)
+	{
+		FRAME_SAMPLE sample;
+		sample.Nanoseconds[FRAME_METRIC_CPU] = Clock::ToNanoseconds(now - frameStartTicks);
+		sample.Nanoseconds[FRAME_METRIC_FENCE_STALL] = stallNs - mFrameStallTotalNs;
+		sample.Nanoseconds[FRAME_METRIC_PRESENT_INTERVAL] = Clock::ToNanoseconds(now - mLastPresentTicks);
+		mFrameStats.AddFrame(sample);
+	}
+
+	mLastPresentTicks = now;
+	mFrameStallTotalNs = stallNs;
+}
+
 // Print debug string containing the list of adapters
 void D3DBase::LogAdapters()
 {
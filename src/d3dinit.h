@@ -7,6 +7,7 @@
  *********************************************************************/
 
 #pragma once
+#include <atomic>
 #include <d3d12.h>
 #include <dxgi1_4.h>
 #include <wrl.h>
@@ -16,6 +17,9 @@
 #include <memory>
 
 #include "timer.h"
+#include "frame_stats.h"
+#include "fencewait.h"
+#include "job_system.h"
 #include "d3dUtil.h"
 #include "UploadBuffer.h"
 #include "FrameResource.h"
@@ -47,6 +51,13 @@ public:
 		mTimer->Reset();
 		mTimer->Start();
 
+		mFenceWaiter = std::make_unique<FenceWaiter>();
+
+		if (!mFrameStatsLog.Open("frame_stats.csv", FRAME_STATS_FORMAT_CSV))
+		{
+			OutputDebugStringA("Failed to open the frame statistics log\n");
+		}
+
 #if defined(DEBUG) || defined(_DEBUG)
 		D3DHelper::EnableDebugInterface(mDebugController.GetAddressOf());
 #endif
@@ -103,6 +114,23 @@ protected:
 	Microsoft::WRL::ComPtr<ID3D12Device>				md3dDevice = nullptr;
 
 	Microsoft::WRL::ComPtr<ID3D12Fence>					mFence = nullptr;
+	std::unique_ptr<FenceWaiter>						mFenceWaiter = nullptr;
+
+	// Threads for all CPU work that runs in parallel. Started with the object
+	// rather than in Initialize, so that members of the application can be
+	// constructed with it.
+	JobSystem											mJobSystem;
+
+	// Sum over frames of the longest chain of dependent CPU work in a frame,
+	// shown per frame next to the frame time
+	double												mCriticalPathSeconds = 0.0;
+
+	// Timings of every frame, summarized in the window title and appended
+	// to the log every second
+	FrameStatsCollector									mFrameStats;
+	FrameStatsLog										mFrameStatsLog;
+	uint64_t											mLastPresentTicks = 0;
+	uint64_t											mFrameStallTotalNs = 0;
 
 	Microsoft::WRL::ComPtr<ID3D12CommandQueue>			mCommandQueue = nullptr;
 	Microsoft::WRL::ComPtr<ID3D12CommandAllocator>		mCommandAllocator = nullptr;
@@ -143,7 +171,7 @@ private:
 	std::wstring mMainWindowCaption = L"Window";
 
 	// Window management variables
-	bool mAppPaused = false;
+	std::atomic<bool> mAppPaused{ false };		// Also read by the simulation thread
 	bool mMaximized = false;
 	bool mMinimized = false;
 	bool mResizing = false;		// Used to terminate drawing while resizing
@@ -203,6 +231,7 @@ protected:
 	void FlushCommandQueue();					// Used to wait till GPU finishes execution
 	virtual void OnResize();							// Called when user finishes resizing
 	void CalculateFrameStats();					// Update window title with FPS
+	void RecordFrameStats(uint64_t frameStartTicks);	// Add the frame that just presented
 
 	// Mouse events
 	virtual void OnMouseDown(WPARAM btnState, int x, int y) = 0;
@@ -7,23 +7,39 @@
  *********************************************************************/
 
 #include <d3d12.h>
+#include <cmath>
+#include <cstdio>
+#include <random>
 #include <DDSTextureLoader.h>
 #include <ResourceUploadBatch.h>
 
 #include "d3dinit.h"
 #include "d3dUtil.h"
 #include "d3dapp.h"
+#include "image_helper.h"
 
 using Microsoft::WRL::ComPtr;
 
+// Compiled shaders and PSOs are kept here between runs
+static const char* ShaderCacheDirectory = "cache";
+static const char* PipelineLibraryFilename = "cache\\pipelines.bin";
+
+// Lamps scattered over the terrain, far more than fit in the light slots
+static const UINT LampCount = 1024;
+
 void D3DApplication::LoadResources()
 {
+	PROFILE_ZONE("LoadResources");
+
 	// LOAD RESOURCES
 	pStaticResources = std::make_unique<StaticResources>();
 	pStaticResources->LoadGeometry(md3dDevice.Get(), mCommandQueue.Get(),
-		mFence.Get(), mCurrentFence);
+		mFenceWaiter.get(), mFence.Get(), mCurrentFence, &mJobSystem);
 	pStaticResources->LoadTextures(md3dDevice.Get(), mCommandQueue.Get());
 
+	BuildTerrainOcclusion("resources\\Textures\\heightmap.bmp");
+	BuildLights();
+
 	// Set materials and transforms
 
 	MaterialConstants materials[NUM_MATERIALS];
@@ -38,7 +54,8 @@ void D3DApplication::LoadResources()
 	materials[1].Roughness = 0.0f;
 	materials[1].MatTransform = MathHelper::Identity4x4();
 
-	std::vector<ObjectConstants> objectTransforms(2, { MathHelper::Identity4x4() });
+	std::vector<ObjectConstants> objectTransforms(2);
+	objectTransforms[1].MaterialIndex = 1;
 
 	//XMMATRIX terrain = XMMatrixIdentity();
 	//terrain *= XMMatrixTranslation(0.0f, -4.0f, 0.0f);
@@ -46,29 +63,186 @@ void D3DApplication::LoadResources()
 
 	pDynamicResources = std::make_unique<DynamicResources>(md3dDevice.Get(), objectTransforms, materials);
 
-	mTerrain = std::make_unique<DefaultDrawable>(
-		pStaticResources->Geometries[0].Submeshes.at(0), 0, 0, pStaticResources->GetTextureSRV(0));
+	// Terrain, one drawable per chunk so that each is culled separately
+	for (const SubmeshGeometry& chunk : pStaticResources->Geometries[0].Chunks.at(0))
+	{
+		mRenderItems.push_back({ static_cast<UINT>(mDrawables.size()), 0 });
+		mDrawables.push_back(std::make_unique<DefaultDrawable>(
+			chunk, 0, pStaticResources->GetTextureSRV(0)));
+	}
 
-	mWater = std::make_unique<DefaultDrawable>(
-		pStaticResources->Geometries[0].Submeshes.at(1), 1, 1, pStaticResources->GetTextureSRV(1));
+	// Water
+	mRenderItems.push_back({ static_cast<UINT>(mDrawables.size()), 1 });
+	mDrawables.push_back(std::make_unique<DefaultDrawable>(
+		pStaticResources->Geometries[0].Submeshes.at(1), 1, pStaticResources->GetTextureSRV(1),
+		DRAW_LAYER_TRANSPARENT));
 
+	// Every item may be visible, each drawn as an instance of its own
+	pDynamicResources->ReserveInstances(static_cast<UINT>(mRenderItems.size()));
 }
 
-// Compile shaders and create input layout
-void D3DApplication::BuildShadersAndInputLayout()
+// Coarse copies of the terrain for CPU occlusion culling,
+// placed the same way as the mesh built by CreateTerrain
+void D3DApplication::BuildTerrainOcclusion(const char* heightmapFilename)
 {
-	HRESULT hr = S_OK;
+	HeightmapImage heightmap(heightmapFilename);
 
-	const D3D_SHADER_MACRO defines[] =
+	UINT width = heightmap.GetWidth();
+	UINT depth = heightmap.GetHeight();
+
+	std::vector<uint8_t> heights(width * depth);
+	for (UINT i = 0; i < width; i++)
 	{
-		"FOG", "1",
-		NULL, NULL
-	};
+		for (UINT j = 0; j < depth; j++)
+		{
+			heights[i * depth + j] = heightmap.GetPixel(j, i);
+		}
+	}
+
+	float dx = (float)width / static_cast<float>(width - 1);
+	float dz = (float)depth / static_cast<float>(depth - 1);
+
+	// The terrain mesh skips border samples, so do the occluders
+	OCCLUDER_MESH occluder = BuildHeightfieldOccluder(
+		heights.data() + depth + 1, width - 2, depth - 2, depth, 8,
+		-(float)width / 2 + dx, (float)depth / 2 - dz, dx, dz,
+		1.0f / 128.0f, -5.5f);
+
+	mOcclusionCuller = std::make_unique<OcclusionCuller>(256, 128, &mJobSystem);
+	mOcclusionCuller->SetOccluder(occluder);
+
+	mHeightPyramid = std::make_unique<HeightPyramid>(
+		heights.data() + depth + 1, width - 2, depth - 2, depth,
+		-(float)width / 2 + dx, (float)depth / 2 - dz, dx, dz,
+		1.0f / 128.0f, -5.5f);
+	mHorizonCuller = std::make_unique<HorizonCuller>(mHeightPyramid.get());
+}
+
+// Lights of the scene, by type. Variants are compiled for at most
+// 3 directional lights, and all types share MAX_LIGHTS slots. Point and
+// spot lights that do not fit are clustered instead.
+void D3DApplication::BuildLights()
+{
+	Light dir = { };
+	dir.Direction = { 0.0f, -0.6f, -0.8f };
+	dir.Strength = { 1.0f, 1.0f, 1.0f };
+	mDirectionalLights.push_back(dir);
+
+	Light point = { };
+	point.FalloffEnd = 100.0f;
+	point.FalloffStart = 0.1f;
+	point.Position = { 0.0f, 12.0f, 0.0f };
+	point.Strength = { 1.0f, 1.0f, 1.0f };
+	mPointLights.push_back(point);
+
+	// Lamps above the ground, every fourth a spot light aimed down.
+	// A fixed seed keeps the scene the same between runs.
+	std::mt19937 random(42);
+	std::uniform_real_distribution<float> xs(mHeightPyramid->OriginX(), -mHeightPyramid->OriginX());
+	std::uniform_real_distribution<float> zs(-mHeightPyramid->OriginZ(), mHeightPyramid->OriginZ());
+	for (UINT i = 0; i < LampCount; i++)
+	{
+		float x = xs(random), z = zs(random);
+		float low = 0.0f, high = 0.0f;
+		if (!mHeightPyramid->HeightRange(x, z, x, z, low, high)) continue;
+
+		Light lamp = { };
+		lamp.Position = { x, high + 3.0f, z };
+		lamp.Strength = { 0.6f, 0.5f, 0.3f };
+		lamp.FalloffStart = 1.0f;
+		lamp.FalloffEnd = 8.0f;
+		if (i % 4 == 3)
+		{
+			lamp.Direction = { 0.0f, -1.0f, 0.0f };
+			lamp.SpotPower = 8.0f;
+			lamp.FalloffEnd = 12.0f;
+			mSpotLights.push_back(lamp);
+		}
+		else
+		{
+			mPointLights.push_back(lamp);
+		}
+	}
+
+	// Directional lights always keep their slots
+	mClusteredLighting = mDirectionalLights.size() + mPointLights.size() + mSpotLights.size() > MAX_LIGHTS;
+	if (!mClusteredLighting) return;
+
+	for (const std::vector<Light>* pLights : { &mPointLights, &mSpotLights })
+	{
+		for (const Light& light : *pLights)
+		{
+			CLUSTER_LIGHT clusterLight = { };
+			clusterLight.Position[0] = light.Position.x;
+			clusterLight.Position[1] = light.Position.y;
+			clusterLight.Position[2] = light.Position.z;
+			clusterLight.Range = light.FalloffEnd;
+			clusterLight.Direction[0] = light.Direction.x;
+			clusterLight.Direction[1] = light.Direction.y;
+			clusterLight.Direction[2] = light.Direction.z;
+
+			// The cone ends where the spot factor max(cos, 0)^SpotPower drops below 1/256
+			clusterLight.SpotAngle = light.SpotPower > 0.0f
+				? std::acos(std::pow(1.0f / 256.0f, 1.0f / light.SpotPower)) : 0.0f;
+
+			mClusterLights.push_back(clusterLight);
+			mClusterLightData.push_back(light);
+		}
+	}
+}
+
+// Define shader variants and create input layout
+void D3DApplication::BuildShadersAndInputLayout()
+{
+	// Shaders are compiled only when their source, includes or defines change
+	mShaderCache = std::make_unique<ShaderCache>(ShaderCacheDirectory,
+		[](const SHADER_DESC& desc, std::vector<uint8_t>& bytecode, std::string& errors)
+		{
+			std::vector<D3D_SHADER_MACRO> macros;
+			for (const auto& define : desc.Defines)
+			{
+				macros.push_back({ define.first.c_str(), define.second.c_str() });
+			}
+			macros.push_back({ NULL, NULL });
+
+			// The cache takes failures as a false return with the compiler's
+			// messages, not as an exception. Warnings of a success are dropped.
+			ComPtr<ID3DBlob> blob;
+			std::string messages;
+			try
+			{
+				blob = CompileShader(AnsiToWString(desc.Filename),
+					macros.data(), desc.EntryPoint, desc.Target, &messages);
+			}
+			catch (const DxException& e)
+			{
+				char code[16];
+				snprintf(code, sizeof(code), "0x%08X", static_cast<unsigned>(e.ErrorCode));
+				errors = messages.empty()
+					? "Compiling " + desc.Filename + " failed with " + code
+					: messages;
+				return false;
+			}
 
-	mDefaultShader.mvsByteCode = CompileShader(L"resources\\Shaders\\main.hlsl",
-		defines, "VS", "vs_5_0");
-	mDefaultShader.mpsByteCode = CompileShader(L"resources\\Shaders\\main.hlsl",
-		defines, "PS", "ps_5_0");
+			const uint8_t* pData = reinterpret_cast<const uint8_t*>(blob->GetBufferPointer());
+			bytecode.assign(pData, pData + blob->GetBufferSize());
+			return true;
+		},
+		ShaderCompilerTag());
+
+	// Variants are compiled on first use, see GetPipelineState
+	mShaderAxes.DirectionalLights = mPermutations.AddCount("NUM_DIR_LIGHTS", 3);
+	mShaderAxes.PointLights = mPermutations.AddCount("NUM_POINT_LIGHTS", MAX_LIGHTS);
+	mShaderAxes.SpotLights = mPermutations.AddCount("NUM_SPOT_LIGHTS", MAX_LIGHTS);
+	mShaderAxes.ClusteredLights = mPermutations.AddFlag("CLUSTERED_LIGHTS");
+	mShaderAxes.Fog = mPermutations.AddFlag("FOG");
+	mShaderAxes.AlphaTest = mPermutations.AddFlag("ALPHA_TEST");
+
+	// Clustered point and spot lights are not in the slots
+	uint32_t slotMask = mClusteredLighting ? (1u << mDirectionalLights.size()) - 1 : UINT32_MAX;
+	DRAW_LIGHTS allLights = PackDrawLights(slotMask, (UINT)mDirectionalLights.size(),
+		(UINT)mPointLights.size(), (UINT)mSpotLights.size());
+	mBaseVariant = ShaderVariantKey(allLights, false);
 
 	mDefaultShader.mInputLayout =
 	{
@@ -81,6 +255,17 @@ void D3DApplication::BuildShadersAndInputLayout()
 	};
 }
 
+uint32_t D3DApplication::ShaderVariantKey(const DRAW_LIGHTS& lights, bool alphaTest) const
+{
+	uint32_t key = mPermutations.Set(0, mShaderAxes.DirectionalLights, lights.Directional);
+	key = mPermutations.Set(key, mShaderAxes.PointLights, lights.Point);
+	key = mPermutations.Set(key, mShaderAxes.SpotLights, lights.Spot);
+	key = mPermutations.Set(key, mShaderAxes.ClusteredLights, mClusteredLighting ? 1 : 0);
+	key = mPermutations.Set(key, mShaderAxes.Fog, 1);
+	key = mPermutations.Set(key, mShaderAxes.AlphaTest, alphaTest ? 1 : 0);
+	return key;
+}
+
 void D3DApplication::BuildPSO()
 {
 	// Rasterizer desc
@@ -92,8 +277,9 @@ void D3DApplication::BuildPSO()
 	D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = { };
 	ZeroMemory(&psoDesc, sizeof(D3D12_GRAPHICS_PIPELINE_STATE_DESC));
 
-	// Set shaders
-	mDefaultShader.Set(psoDesc);
+	// Shaders are set per variant
+	psoDesc.InputLayout = mDefaultShader.GetInputLayoutDesc();
+	psoDesc.pRootSignature = mDefaultShader.mRootSignature.Get();
 	
 	psoDesc.RasterizerState = rd;
 	psoDesc.BlendState = bd;
@@ -106,15 +292,13 @@ void D3DApplication::BuildPSO()
 	psoDesc.SampleDesc.Quality = msaaEnabled ? (msaaQualityLevels - 1) : 0;
 	psoDesc.DSVFormat = mDepthStencilFormat;
 
-	ThrowIfFailed(md3dDevice->CreateGraphicsPipelineState(
-		&psoDesc, IID_PPV_ARGS(mDefaultPSO.GetAddressOf())));
+	mPipelineDescs[PIPELINE_STATE_DEFAULT] = psoDesc;
 
-	// Create another PSO for line list drawing
+	// Another PSO for line list drawing
 	D3D12_GRAPHICS_PIPELINE_STATE_DESC linePSODesc = psoDesc;
 	linePSODesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_LINE;
 
-	ThrowIfFailed(md3dDevice->CreateGraphicsPipelineState(
-		&linePSODesc, IID_PPV_ARGS(mLinePSO.GetAddressOf())));
+	mPipelineDescs[PIPELINE_STATE_LINE] = linePSODesc;
 
 	D3D12_GRAPHICS_PIPELINE_STATE_DESC blendingPSO = psoDesc;
 
@@ -133,6 +317,107 @@ void D3DApplication::BuildPSO()
 
 	blendingPSO.BlendState.RenderTarget[0] = blendDesc;
 
-	ThrowIfFailed(md3dDevice->CreateGraphicsPipelineState(
-		&blendingPSO, IID_PPV_ARGS(mBlendPSO.GetAddressOf())));
-}
\ No newline at end of file
+	mPipelineDescs[PIPELINE_STATE_BLEND] = blendingPSO;
+
+	mPipelineLibrary = std::make_unique<PipelineLibrary>(md3dDevice.Get(), PipelineLibraryFilename);
+
+	// The base variant is needed on the first frame, others follow the lights
+	GetPipelineState(PIPELINE_STATE_DEFAULT, mBaseVariant);
+	GetPipelineState(PIPELINE_STATE_BLEND, mBaseVariant);
+}
+
+ID3D12PipelineState* D3DApplication::GetPipelineState(PIPELINE_STATE pipeline, uint32_t variantKey)
+{
+	auto it = mShaderVariants.find(variantKey);
+	if (it == mShaderVariants.end())
+	{
+		std::vector<std::pair<std::string, std::string>> defines = mPermutations.Defines(variantKey);
+		std::vector<D3D_SHADER_MACRO> macros;
+		for (const auto& define : defines)
+		{
+			macros.push_back({ define.first.c_str(), define.second.c_str() });
+		}
+		macros.push_back({ NULL, NULL });
+
+		ShaderVariant variant;
+		uint64_t vsKey = 0, psKey = 0;
+		variant.VS = CompileShaderCached(*mShaderCache, "resources\\Shaders\\main.hlsl",
+			macros.data(), "VS", "vs_5_0", &vsKey);
+		variant.PS = CompileShaderCached(*mShaderCache, "resources\\Shaders\\main.hlsl",
+			macros.data(), "PS", "ps_5_0", &psKey);
+
+		// PSOs are stored under names that change with the shaders
+		variant.CacheKey = HashBytes(&psKey, sizeof(psKey), HashBytes(&vsKey, sizeof(vsKey)));
+
+		it = mShaderVariants.emplace(variantKey, variant).first;
+	}
+
+	ShaderVariant& variant = it->second;
+	if (variant.PSOs[pipeline] == nullptr)
+	{
+		static const wchar_t* pipelineNames[PIPELINE_STATE_COUNT] = { L"default", L"blend", L"line" };
+
+		D3D12_GRAPHICS_PIPELINE_STATE_DESC desc = mPipelineDescs[pipeline];
+		desc.VS = { variant.VS->GetBufferPointer(), variant.VS->GetBufferSize() };
+		desc.PS = { variant.PS->GetBufferPointer(), variant.PS->GetBufferSize() };
+
+		variant.PSOs[pipeline] = mPipelineLibrary->CreateGraphicsPipeline(
+			std::wstring(pipelineNames[pipeline]) + L"-" + std::to_wstring(variant.CacheKey), desc);
+		mPipelineLibrary->Save();
+	}
+
+	return variant.PSOs[pipeline].Get();
+}
+
+// Stages of a frame up to recording, ordered by what they read and write.
+// Waiting for a free frame resource overlaps with culling and clustering,
+// which do not touch it.
+void D3DApplication::BuildFrameGraph()
+{
+	const uint32_t frameTiming = mFrameGraph.AddResource("frame timing");
+	const uint32_t frameResource = mFrameGraph.AddResource("frame resource");
+	const uint32_t snapshot = mFrameGraph.AddResource("snapshot");
+	const uint32_t passConstants = mFrameGraph.AddResource("pass constants");
+	const uint32_t environment = mFrameGraph.AddResource("environment constants");
+	const uint32_t visibleItems = mFrameGraph.AddResource("visible items");
+	const uint32_t renderQueue = mFrameGraph.AddResource("render queue");
+	const uint32_t lightClusters = mFrameGraph.AddResource("light clusters");
+	const uint32_t frameConstants = mFrameGraph.AddResource("frame constants");
+	const uint32_t commandLists = mFrameGraph.AddResource("command lists");
+
+	mFrameGraph.AddTask("latency", [this]() { UpdateFrameLatency(); },
+		{ }, { frameTiming });
+	mFrameGraph.AddTask("next frame resource",
+		[this]() { pDynamicResources->NextFrameResource(mFenceWaiter.get(), mFence.Get()); },
+		{ frameTiming }, { frameResource });
+
+	// Camera and time come from the simulation thread
+	mFrameGraph.AddTask("snapshot", [this]() { InterpolateSnapshot(); },
+		{ }, { snapshot });
+	mFrameGraph.AddTask("pass constants", [this]() { UpdatePassCB(); },
+		{ snapshot }, { passConstants });
+	mFrameGraph.AddTask("environment constants", [this]() { UpdateEnvironmentCB(); },
+		{ }, { environment });
+
+	mFrameGraph.AddTask("culling", [this]() { CullRenderItems(); },
+		{ snapshot, passConstants }, { visibleItems });
+	mFrameGraph.AddTask("render queue", [this]() { BuildRenderQueue(); },
+		{ snapshot, visibleItems }, { renderQueue });
+	mFrameGraph.AddTask("light clusters", [this]() { BuildLightClusters(); },
+		{ snapshot }, { lightClusters });
+
+	// Pack all constants of the frame once they are final
+	mFrameGraph.AddTask("constant upload", [this]() { pDynamicResources->UpdateConstantBuffers(); },
+		{ frameResource, passConstants, environment, lightClusters }, { frameConstants });
+	mFrameGraph.AddTask("recording", [this]() { RecordCommandLists(); },
+		{ frameConstants, renderQueue, lightClusters }, { commandLists });
+
+	if (!mFrameGraph.Build())
+	{
+		for (const std::string& error : mFrameGraph.Errors())
+		{
+			OutputDebugStringA(("Frame graph: " + error + "\n").c_str());
+		}
+		ThrowIfFailed(E_FAIL);
+	}
+}
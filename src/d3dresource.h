@@ -11,12 +11,17 @@
 #include <d3d12.h>
 #include <wrl.h>
 #include <vector>
+#include <deque>
+#include <algorithm>
+#include <cstring>
 #include <ResourceUploadBatch.h>
 #include <DDSTextureLoader.h>
 
 #include "structures.h"
 #include "geometry.h"
 #include "FrameResource.h"
+#include "fencewait.h"
+#include "clustered_lights.h"
 
 #define NUM_OBJECTS 2
 #define NUM_MATERIALS 2
@@ -24,7 +29,13 @@
 #define NUM_TEXTURES 2
 #define NUM_GEOMETRIES 1
 
+// Frames in flight at startup and the range the count may be changed to at runtime
 #define NUM_FRAME_RESOURCES 3
+#define MIN_FRAME_RESOURCES 2
+#define MAX_FRAME_RESOURCES 4
+
+// Threads recording a frame's draws, each with a command list per frame resource
+#define NUM_RECORD_WORKERS 4
 
 struct GEOMETRY_DESCRIPTOR
 {
@@ -32,6 +43,7 @@ struct GEOMETRY_DESCRIPTOR
 	D3D12_INDEX_BUFFER_VIEW IndexBufferView;
 
 	std::vector<SubmeshGeometry> Submeshes;
+	std::vector<std::vector<SubmeshGeometry>> Chunks;	// Per submesh, empty if not split
 };
 
 class StaticResources
@@ -49,17 +61,21 @@ public:
 
 	void LoadGeometry(ID3D12Device* pDevice,
 		ID3D12CommandQueue* pQueue,
+		FenceWaiter* pFenceWaiter,
 		ID3D12Fence* pFence,
-		UINT64& currentValue)
+		UINT64& currentValue,
+		JobSystem* pJobs)
 	{
 		StaticGeometryUploader<Vertex> uploader(pDevice);
 
-		CreateTerrain(&uploader, "resources\\Textures\\heightmap.bmp");
+		CreateTerrain(&uploader, "resources\\Textures\\heightmap.bmp", pJobs);
 		CreatePlane(&uploader, 100, 100, 128.0f, 128.0f);
 
-		uploader.ConstructGeometry(VertexBuffers[0], IndexBuffers[0], pQueue, pFence, currentValue);
+		uploader.ConstructGeometry(VertexBuffers[0], IndexBuffers[0], pQueue,
+			pFenceWaiter, pFence, currentValue);
 
 		Geometries[0].Submeshes = uploader.GetSubmeshes();
+		Geometries[0].Chunks = uploader.GetChunks();
 		Geometries[0].VertexBufferView = uploader.VertexBufferView();
 		Geometries[0].IndexBufferView = uploader.IndexBufferView();
 	}
@@ -121,12 +137,31 @@ public:
 
 struct ConstantBufferDataCPU
 {
+	// Every change of constant data is stamped with the current generation.
+	// A frame resource last synchronized at generation g needs exactly the
+	// entries whose version is greater than g.
+	UINT64 Generation = 1;
+
 	std::vector<ObjectConstants> ObjectTransforms;
+	std::vector<UINT64> ObjectVersions;
 
 	PassConstants PassBuffer = { };
+	UINT64 PassVersion = 1;
+
+	EnvironmentConstants EnvironmentBuffer = { };
+	UINT64 EnvironmentVersion = 1;
 
 	MaterialConstants Materials[NUM_MATERIALS];
-	int MaterialModified[NUM_MATERIALS];			// Number dirty frames
+	UINT64 MaterialVersions[NUM_MATERIALS];
+
+	// Objects changed in recent generations, ordered by generation. Lets frame
+	// resources copy only what changed instead of scanning the whole scene.
+	struct ObjectChange
+	{
+		UINT64 Generation;
+		UINT Index;
+	};
+	std::deque<ObjectChange> ObjectChangeLog;
 
 	// Delete default and copy constuctors
 	ConstantBufferDataCPU() = delete;
@@ -138,78 +173,191 @@ struct ConstantBufferDataCPU
 	{
 		// Copy the object transform vector
 		ObjectTransforms = transformInitialData;
+		ObjectVersions.assign(ObjectTransforms.size(), Generation);
 		
 		for (int i = 0; i < NUM_MATERIALS; i++)
 		{
 			Materials[i] = pMaterialInitialData[i];
-			MaterialModified[i] = NUM_FRAME_RESOURCES;
+			MaterialVersions[i] = Generation;
+		}
+	}
+
+	void TouchObject(UINT index)
+	{
+		// Log each object at most once per generation
+		if (ObjectVersions[index] == Generation) return;
+
+		ObjectVersions[index] = Generation;
+		ObjectChangeLog.push_back({ Generation, index });
+	}
+
+	// Forget changes that every frame resource has already received
+	void TrimChangeLog(UINT64 oldestSyncedGeneration)
+	{
+		while (!ObjectChangeLog.empty()
+			&& ObjectChangeLog.front().Generation <= oldestSyncedGeneration)
+		{
+			ObjectChangeLog.pop_front();
 		}
 	}
 };
 
 class DynamicResources
 {
-	std::unique_ptr<FrameResource> pFrameResources[NUM_FRAME_RESOURCES];
+	// Ordered by age: the frame resource after the current one is the oldest
+	std::vector<std::unique_ptr<FrameResource>> pFrameResources;
 	UINT currFrameResourceIndex = 0;
 
 	ConstantBufferDataCPU CBDataCPU;
+
+	ID3D12Device* mpDevice = nullptr;
+
+	// Upload space for the instance list and light clusters, requested by
+	// ReserveInstances and ReserveClusters
+	UINT64 mInstanceBytes = 0;
+	UINT64 mClusterBytes = 0;
 public:
 	FrameResource* pCurrentFrameResource = nullptr;
 
 	DynamicResources(ID3D12Device* pDevice, 
 		std::vector<ObjectConstants> pTransformInitialData, MaterialConstants* pMaterialInitialData)
-		: CBDataCPU(pTransformInitialData, pMaterialInitialData)
+		: CBDataCPU(pTransformInitialData, pMaterialInitialData), mpDevice(pDevice)
 	{
 		for (int i = 0; i < NUM_FRAME_RESOURCES; i++)
 		{
-			pFrameResources[i] =
-				std::make_unique<FrameResource>(pDevice, 1, NUM_MATERIALS, CBDataCPU.ObjectTransforms);
+			pFrameResources.push_back(CreateFrameResource());
 		}
 		pCurrentFrameResource = pFrameResources[currFrameResourceIndex].get();
 	}
 
-	void NextFrameResource(ID3D12Fence* pFence)
+	UINT FrameResourceCount() const { return static_cast<UINT>(pFrameResources.size()); }
+
+	/**
+	 * Changes the number of frames the CPU may run ahead of the GPU.
+	 * Call between frames, i.e. before NextFrameResource. Growing never
+	 * blocks; shrinking waits only for the frame resources being released.
+	 */
+	void SetFrameResourceCount(FenceWaiter* pFenceWaiter, ID3D12Fence* pFence, UINT count)
+	{
+		if (count < 1 || count == FrameResourceCount()) return;
+
+		// Reorder oldest first, so that the current frame resource is the last one
+		std::vector<std::unique_ptr<FrameResource>> ordered;
+		for (UINT i = 1; i <= FrameResourceCount(); i++)
+		{
+			UINT index = (currFrameResourceIndex + i) % FrameResourceCount();
+			ordered.push_back(std::move(pFrameResources[index]));
+		}
+
+		// Release the oldest ones, they are the most likely to be finished already
+		if (count < ordered.size())
+		{
+			UINT released = static_cast<UINT>(ordered.size()) - count;
+			WaitForFrameResources(pFenceWaiter, pFence, ordered.data(), released,
+				STALL_SITE_FRAME_RESOURCE);
+			ordered.erase(ordered.begin(), ordered.begin() + released);
+		}
+
+		// New frame resources are free, so they go first in line
+		while (ordered.size() < count)
+		{
+			ordered.insert(ordered.begin(), CreateFrameResource());
+		}
+
+		pFrameResources = std::move(ordered);
+		currFrameResourceIndex = count - 1;
+		pCurrentFrameResource = pFrameResources[currFrameResourceIndex].get();
+	}
+
+	// Blocks until the GPU is done with every frame resource, e.g. before
+	// they are destroyed
+	void WaitForAllFrameResources(FenceWaiter* pFenceWaiter, ID3D12Fence* pFence)
+	{
+		WaitForFrameResources(pFenceWaiter, pFence, pFrameResources.data(), FrameResourceCount(),
+			STALL_SITE_FLUSH_COMMAND_QUEUE);
+	}
+
+	void NextFrameResource(FenceWaiter* pFenceWaiter, ID3D12Fence* pFence)
 	{
 		// Write to next frame resource
 		currFrameResourceIndex =
-			(currFrameResourceIndex + 1) % NUM_FRAME_RESOURCES;
+			(currFrameResourceIndex + 1) % FrameResourceCount();
 		pCurrentFrameResource = pFrameResources[currFrameResourceIndex].get();
 
-		// Check whether the GPU has finished processing current frame
-		if (pCurrentFrameResource->Fence != 0
-			&& pFence->GetCompletedValue() < pCurrentFrameResource->Fence)
-		{
-			HANDLE eventHandle = CreateEventEx(nullptr, nullptr, false, EVENT_ALL_ACCESS);
-			ThrowIfFailed(pFence->SetEventOnCompletion(pCurrentFrameResource->Fence, eventHandle));
-			if (eventHandle == nullptr) return;
-			WaitForSingleObject(eventHandle, INFINITE);
-			CloseHandle(eventHandle);
-		}
+		// Wait till the GPU has finished processing the frame that used it
+		pFenceWaiter->Wait(pFence, pCurrentFrameResource->Fence,
+			STALL_SITE_FRAME_RESOURCE);
 	}
 
+	// Brings constants in the linear allocator of current frame resource up
+	// to date. Call after all Set* calls of the frame and after NextFrameResource,
+	// as it relies on the fence wait. Only entries changed since this frame
+	// resource was last used are copied.
 	void UpdateConstantBuffers()
 	{
-		// Reset the object CB. Object transform data are uploaded dynamically
-		// through the usage of GetGPUHandle()
-		pCurrentFrameResource->ObjectCB->FrameReset();
+		FrameResource* pFrame = pCurrentFrameResource;
+		LinearAllocator* pAllocator = pFrame->ConstantAllocator.get();
 
-		// Update GPU buffer for pass constants
+		UINT objectCount = static_cast<UINT>(CBDataCPU.ObjectTransforms.size());
 
-		pCurrentFrameResource->PassCB->CopyData(0,
-			CBDataCPU.PassBuffer);
+		// The layout of frame constants only depends on the scene size, so unless
+		// the buffer was recreated or the scene resized, entries written the last
+		// time this frame resource was used are still in place.
+		bool recreated = pAllocator->Reset(mpDevice,
+			FrameConstantsByteSize(objectCount) + mInstanceBytes + mClusterBytes);
+		if (recreated || pFrame->ObjectCount != objectCount)
+		{
+			pFrame->ConstantsGeneration = 0;
+			pFrame->ObjectCount = objectCount;
+		}
+		const UINT64 synced = pFrame->ConstantsGeneration;
 
-		// Update GPU buffer for material constants
+		LinearAllocator::Allocation pass = pAllocator->Allocate(sizeof(PassConstants));
+		LinearAllocator::Allocation environment = pAllocator->Allocate(sizeof(EnvironmentConstants));
+		LinearAllocator::Allocation materials = pAllocator->AllocateStructured<MaterialConstants>(NUM_MATERIALS);
+		LinearAllocator::Allocation objects = pAllocator->AllocateStructured<ObjectConstants>(objectCount);
+
+		if (CBDataCPU.PassVersion > synced)
+		{
+			StreamCopyLines(pass.CPUAddress, &CBDataCPU.PassBuffer, sizeof(PassConstants));
+		}
+
+		if (CBDataCPU.EnvironmentVersion > synced)
+		{
+			StreamCopyLines(environment.CPUAddress, &CBDataCPU.EnvironmentBuffer, sizeof(EnvironmentConstants));
+		}
 
 		for (UINT i = 0; i < NUM_MATERIALS; i++)
 		{
-			if (CBDataCPU.MaterialModified[i] > 0)
-			{
-				pCurrentFrameResource->MaterialCB->CopyData(i,
-					CBDataCPU.Materials[i]);
+			if (CBDataCPU.MaterialVersions[i] > synced)
+				LinearAllocator::WriteStructured(materials, i, CBDataCPU.Materials[i]);
+		}
 
-				CBDataCPU.MaterialModified[i]--;
-			}
+		UploadObjects(objects, synced);
+
+		// Constants are written with streaming stores, make them visible
+		StreamFence();
+
+		pFrame->PassCBAddress = pass.GPUAddress;
+		pFrame->EnvironmentCBAddress = environment.GPUAddress;
+		pFrame->MaterialBufferAddress = materials.GPUAddress;
+		pFrame->ObjectBufferAddress = objects.GPUAddress;
+		pFrame->InstanceBufferAddress = 0;
+		pFrame->ClusterLightsAddress = 0;
+		pFrame->ClusterRangesAddress = 0;
+		pFrame->ClusterIndicesAddress = 0;
+
+		// Frame resource is now up to date, later changes go to the next generation
+		pFrame->ConstantsGeneration = CBDataCPU.Generation;
+		CBDataCPU.Generation++;
+
+		UINT64 oldestSynced = pFrame->ConstantsGeneration;
+		for (UINT i = 0; i < FrameResourceCount(); i++)
+		{
+			if (pFrameResources[i]->ConstantsGeneration < oldestSynced)
+				oldestSynced = pFrameResources[i]->ConstantsGeneration;
 		}
+		CBDataCPU.TrimChangeLog(oldestSynced);
 	}
 
 	// Handles to retrieve and change CB data
@@ -217,28 +365,180 @@ public:
 	void SetObjectTransform(UINT index, const ObjectConstants& transform)
 	{
 		CBDataCPU.ObjectTransforms[index] = transform;
+		CBDataCPU.TouchObject(index);
 	}
 
-	// We let application do pass constants assignment
+	// We let application do pass constants assignment.
+	// Values equal to the current ones are not uploaded again.
 	void SetPassConstants(const PassConstants& pass)
 	{
+		if (std::memcmp(&CBDataCPU.PassBuffer, &pass, sizeof(PassConstants)) == 0) return;
+
 		CBDataCPU.PassBuffer = pass;
+		CBDataCPU.PassVersion = CBDataCPU.Generation;
+	}
+
+	void SetEnvironmentConstants(const EnvironmentConstants& environment)
+	{
+		if (std::memcmp(&CBDataCPU.EnvironmentBuffer, &environment, sizeof(EnvironmentConstants)) == 0) return;
+
+		CBDataCPU.EnvironmentBuffer = environment;
+		CBDataCPU.EnvironmentVersion = CBDataCPU.Generation;
 	}
 
 	void SetMaterial(UINT index, const MaterialConstants& material)
 	{
 		CBDataCPU.Materials[index] = material;
-		CBDataCPU.MaterialModified[index] = NUM_FRAME_RESOURCES;
+		CBDataCPU.MaterialVersions[index] = CBDataCPU.Generation;
 	}
 
 	ObjectConstants GetTransform(UINT index) { return CBDataCPU.ObjectTransforms[index]; }
 	PassConstants GetPassConstants() { return CBDataCPU.PassBuffer; }
+	EnvironmentConstants GetEnvironmentConstants() { return CBDataCPU.EnvironmentBuffer; }
 	MaterialConstants GetMaterialConstants(UINT index) { return CBDataCPU.Materials[index]; }
 
-	D3D12_GPU_VIRTUAL_ADDRESS GetObjectCBDescriptor(UINT index) 
-	{ return pCurrentFrameResource->ObjectCB->GetGPUHandle(index); }
+	/**
+	 * Uploads object indices of the frame's instanced draws, laid out as built
+	 * by RenderQueue::Sort. Call after UpdateConstantBuffers. count must not
+	 * exceed the last ReserveInstances.
+	 */
+	void UploadInstances(const UINT* pObjectIndices, UINT count)
+	{
+		FrameResource* pFrame = pCurrentFrameResource;
+		if (count == 0)
+		{
+			pFrame->InstanceBufferAddress = 0;
+			return;
+		}
+
+		LinearAllocator::Allocation instances =
+			pFrame->ConstantAllocator->PushStructured(pObjectIndices, count);
+		StreamFence();
+
+		pFrame->InstanceBufferAddress = instances.GPUAddress;
+	}
+
+	/**
+	 * Makes room for the instance list in the constants of the next
+	 * UpdateConstantBuffers. There is one instance per drawn render item, and
+	 * items may share an object, so this is not bounded by the object count.
+	 */
+	void ReserveInstances(UINT instanceCount)
+	{
+		mInstanceBytes = LinearAllocator::AlignConstant(sizeof(UINT) * static_cast<UINT64>(instanceCount));
+	}
+
+	/**
+	 * Makes room for light clusters in the constants of the next
+	 * UpdateConstantBuffers. The sizes are upper bounds of the following
+	 * UploadClusters call.
+	 */
+	void ReserveClusters(UINT lightCount, UINT clusterCount, UINT indexCount)
+	{
+		mClusterBytes = ClusterByteSize(lightCount, clusterCount, indexCount);
+	}
+
+	// Uploads punctual lights and their clusters, see LightClusterer.
+	// Call after UpdateConstantBuffers.
+	void UploadClusters(const Light* pLights, UINT lightCount,
+		const CLUSTER_RANGE* pRanges, UINT clusterCount, const UINT* pIndices, UINT indexCount)
+	{
+		FrameResource* pFrame = pCurrentFrameResource;
+		LinearAllocator* pAllocator = pFrame->ConstantAllocator.get();
+
+		// Empty buffers still get an element, so that every view is in bounds
+		const UINT zero = 0;
+		LinearAllocator::Allocation lights = pAllocator->PushStructured(pLights, lightCount);
+		LinearAllocator::Allocation ranges = pAllocator->PushStructured(pRanges, clusterCount);
+		LinearAllocator::Allocation indices = indexCount > 0
+			? pAllocator->PushStructured(pIndices, indexCount)
+			: pAllocator->PushStructured(&zero, 1);
+		StreamFence();
+
+		pFrame->ClusterLightsAddress = lights.GPUAddress;
+		pFrame->ClusterRangesAddress = ranges.GPUAddress;
+		pFrame->ClusterIndicesAddress = indices.GPUAddress;
+	}
+
 	D3D12_GPU_VIRTUAL_ADDRESS GetPassCBDescriptor() 
-	{ return pCurrentFrameResource->PassCB->GetGPUHandle(0); }
-	D3D12_GPU_VIRTUAL_ADDRESS GetMaterialCBDescriptor(UINT index) 
-	{ return pCurrentFrameResource->MaterialCB->GetGPUHandle(index); }
-};
+	{ return pCurrentFrameResource->PassCBAddress; }
+	D3D12_GPU_VIRTUAL_ADDRESS GetEnvironmentCBDescriptor() 
+	{ return pCurrentFrameResource->EnvironmentCBAddress; }
+	D3D12_GPU_VIRTUAL_ADDRESS GetObjectBufferDescriptor() 
+	{ return pCurrentFrameResource->ObjectBufferAddress; }
+	D3D12_GPU_VIRTUAL_ADDRESS GetMaterialBufferDescriptor() 
+	{ return pCurrentFrameResource->MaterialBufferAddress; }
+	D3D12_GPU_VIRTUAL_ADDRESS GetInstanceBufferDescriptor() 
+	{ return pCurrentFrameResource->InstanceBufferAddress; }
+	D3D12_GPU_VIRTUAL_ADDRESS GetClusterLightsDescriptor()
+	{ return pCurrentFrameResource->ClusterLightsAddress; }
+	D3D12_GPU_VIRTUAL_ADDRESS GetClusterRangesDescriptor()
+	{ return pCurrentFrameResource->ClusterRangesAddress; }
+	D3D12_GPU_VIRTUAL_ADDRESS GetClusterIndicesDescriptor()
+	{ return pCurrentFrameResource->ClusterIndicesAddress; }
+
+private:
+	std::unique_ptr<FrameResource> CreateFrameResource()
+	{
+		UINT64 constantsByteSize = FrameConstantsByteSize(
+			static_cast<UINT>(CBDataCPU.ObjectTransforms.size()));
+		return std::make_unique<FrameResource>(mpDevice, constantsByteSize, NUM_RECORD_WORKERS);
+	}
+
+	static void WaitForFrameResources(FenceWaiter* pFenceWaiter, ID3D12Fence* pFence,
+		const std::unique_ptr<FrameResource>* ppFrames, UINT count, STALL_SITE site)
+	{
+		std::vector<ID3D12Fence*> fences(count, pFence);
+		std::vector<UINT64> values(count);
+		for (UINT i = 0; i < count; i++) values[i] = ppFrames[i]->Fence;
+
+		pFenceWaiter->WaitAll(fences.data(), values.data(), count, site);
+	}
+
+	// Copies objects changed after generation synced into the object array
+	void UploadObjects(const LinearAllocator::Allocation& objects, UINT64 synced)
+	{
+		const UINT objectCount = static_cast<UINT>(CBDataCPU.ObjectTransforms.size());
+		const std::deque<ConstantBufferDataCPU::ObjectChange>& log = CBDataCPU.ObjectChangeLog;
+
+		// First change this frame resource has not seen yet
+		auto first = std::upper_bound(log.begin(), log.end(), synced,
+			[](UINT64 generation, const ConstantBufferDataCPU::ObjectChange& change)
+			{ return generation < change.Generation; });
+
+		// Nothing valid in the buffer, or most of the scene changed: scan everything
+		if (synced == 0 || static_cast<size_t>(log.end() - first) >= objectCount)
+		{
+			for (UINT i = 0; i < objectCount; i++)
+			{
+				if (CBDataCPU.ObjectVersions[i] > synced)
+					LinearAllocator::WriteStructured(objects, i, CBDataCPU.ObjectTransforms[i]);
+			}
+			return;
+		}
+
+		for (auto it = first; it != log.end(); ++it)
+		{
+			LinearAllocator::WriteStructured(objects, it->Index, CBDataCPU.ObjectTransforms[it->Index]);
+		}
+	}
+
+	// Bytes of upload memory one frame needs for given scene size,
+	// not counting the instance list and clusters
+	static UINT64 FrameConstantsByteSize(UINT objectCount)
+	{
+		return LinearAllocator::ConstantStride<PassConstants>()
+			+ LinearAllocator::ConstantStride<EnvironmentConstants>()
+			+ LinearAllocator::AlignConstant(sizeof(MaterialConstants) * NUM_MATERIALS)
+			+ LinearAllocator::AlignConstant(sizeof(ObjectConstants) * static_cast<UINT64>(objectCount));
+	}
+
+	static UINT64 ClusterByteSize(UINT lightCount, UINT clusterCount, UINT indexCount)
+	{
+		if (lightCount == 0) return 0;
+
+		return LinearAllocator::AlignConstant(sizeof(Light) * static_cast<UINT64>(lightCount))
+			+ LinearAllocator::AlignConstant(sizeof(CLUSTER_RANGE) * static_cast<UINT64>(clusterCount))
+			+ LinearAllocator::AlignConstant(sizeof(UINT) * static_cast<UINT64>(indexCount > 0 ? indexCount : 1));
+	}
+};
\ No newline at end of file
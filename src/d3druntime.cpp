@@ -9,6 +9,7 @@
 #include "d3dUtil.h"
 #include "window.h"
 #include "timer.h"
+#include "clock.h"
 #include "UploadBuffer.h"
 #include "d3dinit.h"
 #include "drawable.h"
@@ -17,77 +18,169 @@
 using namespace DirectX;
 using namespace DirectX::PackedVector;
 
-void D3DApplication::DrawRenderItems()
+// Fewest batches worth a command list of their own
+static const uint32_t MinBatchesPerWorker = 64;
+
+// Written by F9, the zones recorded so far on all threads
+static const char* ProfileFilename = "profile.json";
+
+void D3DApplication::PrepareRenderItems()
 {
-	mCommandList->SetGraphicsRootSignature(mDefaultShader.mRootSignature.Get());
+	const std::vector<uint32_t>& instanceObjects = mRenderQueue.InstanceObjects();
+	pDynamicResources->UploadInstances(instanceObjects.data(),
+		static_cast<UINT>(instanceObjects.size()));
+
+	if (mClusteredLighting)
+	{
+		const std::vector<CLUSTER_RANGE>& ranges = mLightClusterer.Ranges();
+		const std::vector<uint32_t>& indices = mLightClusterer.LightIndices();
+		pDynamicResources->UploadClusters(mClusterLightData.data(), (UINT)mClusterLightData.size(),
+			ranges.data(), (UINT)ranges.size(), indices.data(), (UINT)indices.size());
+	}
 
-	// Set pass constants
-	mCommandList->SetGraphicsRootConstantBufferView(0,
-		pDynamicResources->pCurrentFrameResource->PassCB->Resource()->GetGPUVirtualAddress());
+	// Variants are created on first use, which recording threads must not do
+	const std::vector<INSTANCE_BATCH>& batches = mRenderQueue.Batches();
+	const std::vector<uint32_t>& lightMasks = mRenderQueue.BatchLightMasks();
 
-	mCommandList->SetDescriptorHeaps(1, pStaticResources->mSRVHeap.GetAddressOf());
+	mBatchPSOs.resize(batches.size());
+	mBatchLights.resize(batches.size());
+	for (size_t i = 0; i < batches.size(); i++)
+	{
+		const IDrawable* pDrawable = mDrawables[batches[i].DrawableIndex].get();
+
+		// Tightest variant for the lights reaching the batch
+		mBatchLights[i] = PackDrawLights(lightMasks[i], (UINT)mDirectionalLights.size(),
+			(UINT)mPointLights.size(), (UINT)mSpotLights.size());
+		mBatchPSOs[i] = GetPipelineState(pDrawable->Pipeline(),
+			ShaderVariantKey(mBatchLights[i], pDrawable->AlphaTest()));
+	}
+}
+
+void D3DApplication::DrawRenderItems(const RECORD_RANGE& range, CommandStream& stream)
+{
+	PROFILE_ZONE("DrawRenderItems");
+
+	// Every stream starts on a fresh command list, so all state is set again
+	stream.SetViewport(mViewport.TopLeftX, mViewport.TopLeftY, mViewport.Width, mViewport.Height,
+		mViewport.MinDepth, mViewport.MaxDepth);
+	stream.SetScissor(mScissorRect.left, mScissorRect.top, mScissorRect.right, mScissorRect.bottom);
+	stream.SetRenderTarget(D3D12CommandBackend::Handle(CurrentBackBufferView()),
+		D3D12CommandBackend::Handle(DepthStencilView()));
+
+	stream.SetRootSignature(D3D12CommandBackend::Handle(mDefaultShader.mRootSignature.Get()));
+
+	// Set pass constants and per-frame structured buffers
+	stream.SetRootCBV(0, pDynamicResources->GetPassCBDescriptor());
+	stream.SetRootCBV(6, pDynamicResources->GetEnvironmentCBDescriptor());
+	stream.SetRootSRV(1, pDynamicResources->GetObjectBufferDescriptor());
+	stream.SetRootSRV(2, pDynamicResources->GetMaterialBufferDescriptor());
+	stream.SetRootSRV(4, pDynamicResources->GetInstanceBufferDescriptor());
+	if (mClusteredLighting)
+	{
+		stream.SetRootSRV(7, pDynamicResources->GetClusterLightsDescriptor());
+		stream.SetRootSRV(8, pDynamicResources->GetClusterRangesDescriptor());
+		stream.SetRootSRV(9, pDynamicResources->GetClusterIndicesDescriptor());
+	}
+
+	stream.SetDescriptorHeap(D3D12CommandBackend::Handle(pStaticResources->mSRVHeap.Get()));
 
 	GEOMETRY_DESCRIPTOR& defaultGeometry = pStaticResources->Geometries[0];
-	DefaultDrawable::SetVBAndIB(mCommandList.Get(), defaultGeometry.VertexBufferView, defaultGeometry.IndexBufferView);
+	DefaultDrawable::SetVBAndIB(stream, defaultGeometry.VertexBufferView, defaultGeometry.IndexBufferView);
 
-	mTerrain->Draw(mCommandList.Get(), pDynamicResources->pCurrentFrameResource);
+	// Batches come sorted by state, so only changes are set
+	ID3D12PipelineState* pCurrentPSO = nullptr;
+	UINT currentLights[2] = { UINT_MAX, UINT_MAX };
+	const IDrawable* pPrevious = nullptr;
 
-	mCommandList->SetPipelineState(mBlendPSO.Get());
+	const std::vector<INSTANCE_BATCH>& batches = mRenderQueue.Batches();
 
-	mWater->Draw(mCommandList.Get(), pDynamicResources->pCurrentFrameResource);
+	for (uint32_t i = range.First; i < range.First + range.Count; i++)
+	{
+		const INSTANCE_BATCH& batch = batches[i];
+		IDrawable* pDrawable = mDrawables[batch.DrawableIndex].get();
 
-}
+		if (mBatchPSOs[i] != pCurrentPSO)
+		{
+			pCurrentPSO = mBatchPSOs[i];
+			stream.SetPipeline(D3D12CommandBackend::Handle(pCurrentPSO));
+		}
 
-void D3DApplication::Draw()
-{
-	ID3D12CommandAllocator* currCmdAlloc =
-		pDynamicResources->pCurrentFrameResource->CommandListAllocator.Get();
+		// Light slots follow the instance base in the root constants
+		const DRAW_LIGHTS& lights = mBatchLights[i];
+		if (lights.Indices[0] != currentLights[0] || lights.Indices[1] != currentLights[1])
+		{
+			currentLights[0] = lights.Indices[0];
+			currentLights[1] = lights.Indices[1];
+			stream.SetRootConstants(5, 2, lights.Indices, 1);
+		}
 
-	// Reuse the memory since the frame is processed
-	ThrowIfFailed(currCmdAlloc->Reset());
+		pDrawable->Draw(stream, batch.FirstInstance, batch.InstanceCount, pPrevious);
+		pPrevious = pDrawable;
+	}
+}
 
-	// Use the default PSO
-	ThrowIfFailed(mCommandList->Reset(currCmdAlloc, mDefaultPSO.Get()));
+void D3DApplication::RecordCommandLists()
+{
+	FrameResource* pFrame = pDynamicResources->pCurrentFrameResource;
 
+	PrepareRenderItems();
 
-	// To know what to render
-	mCommandList->RSSetViewports(1, &mViewport);
-	mCommandList->RSSetScissorRects(1, &mScissorRect);
+	const GPU_HANDLE backBuffer = D3D12CommandBackend::Handle(GetCurrentBackBuffer());
+	const uint32_t batchCount = static_cast<uint32_t>(mRenderQueue.Batches().size());
 
-	Transition(GetCurrentBackBuffer(),
-		mCommandList.Get(),
-		D3D12_RESOURCE_STATE_PRESENT,
-		D3D12_RESOURCE_STATE_RENDER_TARGET);
+	// Each worker records a range of batches into its stream and replays it
+	// onto its own command list. Lists are submitted in range order.
+	mCommandListCount = mRecorder.Record(batchCount, MinBatchesPerWorker,
+		[this, pFrame, backBuffer, batchCount](uint32_t worker, const RECORD_RANGE& range, CommandStream& stream)
+		{
+			// The first list prepares and clears the back buffer
+			if (range.First == 0)
+			{
+				stream.Barrier(backBuffer, D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET);
+				stream.ClearRenderTarget(D3D12CommandBackend::Handle(CurrentBackBufferView()),
+					DirectX::Colors::LightSteelBlue);
+				stream.ClearDepthStencil(D3D12CommandBackend::Handle(DepthStencilView()),
+					D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0);
+			}
 
-	// Clear the back and depth buffer
-	mCommandList->ClearRenderTargetView(CurrentBackBufferView(),
-		DirectX::Colors::LightSteelBlue, 0, nullptr);
-	
-	mCommandList->ClearDepthStencilView(DepthStencilView(),
-		D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL,
-		1.0f, 0, 0, nullptr);
+			DrawRenderItems(range, stream);
 
-	const D3D12_CPU_DESCRIPTOR_HANDLE currBackBufferHandle = CurrentBackBufferView();
-	const D3D12_CPU_DESCRIPTOR_HANDLE currDepthBufferHandle = DepthStencilView();
+			// The last one hands it over to present
+			if (range.First + range.Count == batchCount)
+			{
+				stream.Barrier(backBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT);
+			}
 
-	// Set render target
-	mCommandList->OMSetRenderTargets(1, &currBackBufferHandle,
-		true, &currDepthBufferHandle);
+			// Reuse the memory since the frame is processed
+			ID3D12CommandAllocator* pAllocator = pFrame->CommandAllocators[worker].Get();
+			ID3D12GraphicsCommandList* pCommandList = pFrame->CommandLists[worker].Get();
+			ThrowIfFailed(pAllocator->Reset());
+			ThrowIfFailed(pCommandList->Reset(pAllocator, nullptr));
 
-	// Draw objects
-	DrawRenderItems();
+			mCommandBackends[worker].Execute(stream, pCommandList);
+			ThrowIfFailed(pCommandList->Close());
+		});
+}
 
-	// When rendered, change state to present
-	Transition(GetCurrentBackBuffer(),
-		mCommandList.Get(),
-		D3D12_RESOURCE_STATE_RENDER_TARGET,
-		D3D12_RESOURCE_STATE_PRESENT);
+void D3DApplication::Draw()
+{
+	FrameResource* pFrame = pDynamicResources->pCurrentFrameResource;
 
-	// Done recording commands
-	ThrowIfFailed(mCommandList->Close());
+	// If the queue was empty when the frame started, the GPU has been
+	// idle at least since then
+	mGpuIdleSeconds = 0.0;
+	if (mGpuDrainedAtFrameStart)
+	{
+		mGpuIdleSeconds = std::chrono::duration<double>(
+			std::chrono::steady_clock::now() - mFrameStartTime).count();
+	}
 
-	ID3D12CommandList* cmdLists[] = { mCommandList.Get() };
-	mCommandQueue->ExecuteCommandLists(_countof(cmdLists), cmdLists);
+	ID3D12CommandList* cmdLists[NUM_RECORD_WORKERS];
+	for (UINT i = 0; i < mCommandListCount; i++)
+	{
+		cmdLists[i] = pFrame->CommandLists[i].Get();
+	}
+	mCommandQueue->ExecuteCommandLists(mCommandListCount, cmdLists);
 
 	ThrowIfFailed(mSwapChain->Present(0, 0));
 
@@ -95,80 +188,299 @@ void D3DApplication::Draw()
 	mCurrBackBuffer = (mCurrBackBuffer + 1) % swapChainBufferCount;
 
 	// Set fence point for current frame resource
-	pDynamicResources->pCurrentFrameResource->Fence = ++mCurrentFence;
+	pFrame->Fence = ++mCurrentFence;
 	mCommandQueue->Signal(mFence.Get(), mCurrentFence);
 }
 
 void D3DApplication::UpdatePassCB()
 {
+	PROFILE_ZONE("UpdatePassCB");
 	PassConstants mPassCB;
 
-	XMMATRIX view = XMLoadFloat4x4(&mCamera->mView);
-	XMMATRIX proj = XMLoadFloat4x4(&mProj);
+	PASS_MATRICES matrices;
+	ComputePassMatrices(mFrameView.View, mProj, matrices, mViewProj);
 
-	XMMATRIX viewProj = XMMatrixMultiply(view, proj);
+	mPassCB.View = matrices.View;
+	mPassCB.Proj = matrices.Proj;
+	mPassCB.ViewProj = matrices.ViewProj;
+	mPassCB.InvView = matrices.InvView;
+	mPassCB.InvProj = matrices.InvProj;
+	mPassCB.InvViewProj = matrices.InvViewProj;
 
-	XMVECTOR viewDet = XMMatrixDeterminant(view);
-	XMMATRIX invView = XMMatrixInverse(&viewDet, view);
+	XMStoreFloat3(&mPassCB.EyePosW, XMLoadFloat4(&mFrameView.EyePosition));
 
-	XMVECTOR projDet = XMMatrixDeterminant(proj);
-	XMMATRIX invProj = XMMatrixInverse(&projDet, proj);
+	mPassCB.NearZ = 1.0f;
+	mPassCB.FarZ = 1000.0f;
+	mPassCB.TotalTime = mFrameView.TotalTime;
+	mPassCB.DeltaTime = mTimer->DeltaTime();
 
-	XMVECTOR viewProjDet = XMMatrixDeterminant(viewProj);
-	XMMATRIX invViewProj = XMMatrixInverse(&viewProjDet, viewProj);
+	pDynamicResources->SetPassConstants(mPassCB);
+}
 
+void D3DApplication::CullRenderItems()
+{
+	PerfZone perfZone("culling", mRenderItems.size());
 
-	XMStoreFloat4x4(&mPassCB.View, XMMatrixTranspose(view));
-	XMStoreFloat4x4(&mPassCB.Proj, XMMatrixTranspose(proj));
-	XMStoreFloat4x4(&mPassCB.ViewProj, XMMatrixTranspose(viewProj));
-	XMStoreFloat4x4(&mPassCB.InvView, XMMatrixTranspose(invView));
-	XMStoreFloat4x4(&mPassCB.InvProj, XMMatrixTranspose(invProj));
-	XMStoreFloat4x4(&mPassCB.InvViewProj, XMMatrixTranspose(invViewProj));
+	// Bounds follow the objects, world matrices are stored transposed for HLSL
+	mItemBounds.Clear();
+	mItemBounds.Reserve(mRenderItems.size());
+	for (const RenderItem& item : mRenderItems)
+	{
+		ObjectConstants object = pDynamicResources->GetTransform(item.ObjectIndex);
 
-	XMStoreFloat3(&mPassCB.EyePosW, XMLoadFloat4(&mCamera->mPosition));
+		XMFLOAT4X4 world;
+		XMStoreFloat4x4(&world, XMMatrixTranspose(XMLoadFloat4x4(&object.World)));
 
-	mPassCB.NearZ = 1.0f;
-	mPassCB.FarZ = 1000.0f;
-	mPassCB.TotalTime = mTimer->TotalTime();
-	mPassCB.DeltaTime = mTimer->DeltaTime();
+		mItemBounds.Add(TransformBounds(mDrawables[item.DrawableIndex]->Bounds(), &world.m[0][0]));
+	}
+
+	FRUSTUM_PLANES frustum = ExtractFrustumPlanes(&mViewProj.m[0][0]);
+	mFrustumCuller.Cull(frustum, mItemBounds, mVisibleItems);
 
-	mPassCB.AmbientLight = { 0.25f, 0.25f, 0.25f, 1.0f };
+	const XMFLOAT4& eye = mFrameView.EyePosition;
+	mHorizonCuller->Update(eye.x, eye.y, eye.z);
+	mHorizonCuller->Cull(mItemBounds, mVisibleItems);
 
-	XMStoreFloat4(&mPassCB.FogColor, DirectX::Colors::Gray.v);
-	mPassCB.FogStart = 100.0f;
-	mPassCB.FogRange = 200.0f;
+	mOcclusionCuller->Render(&mViewProj.m[0][0]);
+	mOcclusionCuller->Cull(mItemBounds, mVisibleItems);
+}
 
-	Light point = { };
-	point.FalloffEnd = 100.0f;
-	point.FalloffStart = 0.1f;
-	point.Position = { 0.0f, 12.0f, 0.0f };
-	point.Strength = { 1.0f, 1.0f, 1.0f };
+// Slots of the lights reaching an item: all directional lights, and point
+// and spot lights whose range touches the item's bounding sphere
+uint32_t D3DApplication::ItemLightMask(uint32_t itemIndex) const
+{
+	UINT slot = (UINT)mDirectionalLights.size();
+	uint32_t mask = (1u << slot) - 1;
 
-	Light dir = { };
-	dir.Direction = { 0.0f, -0.6f, -0.8f };
-	dir.Strength = { 1.0f, 1.0f, 1.0f };
+	// Otherwise the pixel shader finds them in the clusters
+	if (mClusteredLighting) return mask;
 
-	//mPassCB.Lights[1] = point;
-	//mPassCB.Lights[0] = dir;
-	mPassCB.Lights[0] = dir;
+	XMVECTOR center = XMVectorSet(mItemBounds.CenterX()[itemIndex],
+		mItemBounds.CenterY()[itemIndex], mItemBounds.CenterZ()[itemIndex], 1.0f);
+	float radius = mItemBounds.Radius()[itemIndex];
 
-	UploadBuffer<PassConstants>* currPassCB = pDynamicResources->pCurrentFrameResource->PassCB.get();
-	currPassCB->CopyData(0, mPassCB);
+	for (const std::vector<Light>* pLights : { &mPointLights, &mSpotLights })
+	{
+		for (const Light& light : *pLights)
+		{
+			float distance = XMVectorGetX(XMVector3Length(XMLoadFloat3(&light.Position) - center));
+			if (slot < MAX_LIGHTS && distance < light.FalloffEnd + radius) mask |= 1u << slot;
+			slot++;
+		}
+	}
+	return mask;
+}
+
+void D3DApplication::BuildRenderQueue()
+{
+	XMMATRIX view = XMLoadFloat4x4(&mFrameView.View);
+	const float farZ = 1000.0f;
+
+	mRenderQueue.Begin();
+	for (uint32_t itemIndex : mVisibleItems)
+	{
+		const RenderItem& item = mRenderItems[itemIndex];
+		const IDrawable* pDrawable = mDrawables[item.DrawableIndex].get();
+
+		// View depth of the bounds center, normalized by the far plane
+		XMVECTOR center = XMVectorSet(mItemBounds.CenterX()[itemIndex],
+			mItemBounds.CenterY()[itemIndex], mItemBounds.CenterZ()[itemIndex], 1.0f);
+		float depth = XMVectorGetZ(XMVector3TransformCoord(center, view)) / farZ;
+
+		UINT material = pDynamicResources->GetTransform(item.ObjectIndex).MaterialIndex;
+
+		uint64_t key = pDrawable->Layer() == DRAW_LAYER_TRANSPARENT
+			? RenderQueue::TransparentKey(pDrawable->Layer(), pDrawable->Pipeline(),
+				pDrawable->BindingKey(), item.DrawableIndex, depth, material)
+			: RenderQueue::OpaqueKey(pDrawable->Layer(), pDrawable->Pipeline(),
+				pDrawable->BindingKey(), item.DrawableIndex, depth, material);
+
+		mRenderQueue.Submit(key, item.DrawableIndex, item.ObjectIndex, ItemLightMask(itemIndex));
+	}
+	mRenderQueue.Sort();
+}
+
+void D3DApplication::BuildLightClusters()
+{
+	if (!mClusteredLighting) return;
+
+	mLightClusterer.Build(&mFrameView.View.m[0][0], mClusterLights.data(),
+		static_cast<uint32_t>(mClusterLights.size()));
+
+	// Upload space is reserved before the frame's constants are packed
+	pDynamicResources->ReserveClusters((UINT)mClusterLightData.size(),
+		mLightClusterer.ClusterCount(), (UINT)mLightClusterer.LightIndices().size());
+}
+
+void D3DApplication::UpdateEnvironmentCB()
+{
+	// Lighting and fog only change on request
+	if (!mEnvironmentDirty) return;
+	mEnvironmentDirty = false;
+
+	EnvironmentConstants environment;
+
+	environment.AmbientLight = { 0.25f, 0.25f, 0.25f, 1.0f };
+
+	XMStoreFloat4(&environment.FogColor, DirectX::Colors::Gray.v);
+	environment.FogStart = 100.0f;
+	environment.FogRange = 200.0f;
+
+	// Stored by type, the order shaders and PackDrawLights expect.
+	// Clustered point and spot lights are uploaded with the clusters.
+	UINT slot = 0;
+	for (const std::vector<Light>* pLights : { &mDirectionalLights, &mPointLights, &mSpotLights })
+	{
+		if (mClusteredLighting && pLights != &mDirectionalLights) continue;
+
+		for (const Light& light : *pLights)
+		{
+			if (slot < MAX_LIGHTS) environment.Lights[slot++] = light;
+		}
+	}
+
+	if (mClusteredLighting)
+	{
+		environment.ClusterTileScale = { ClusterTilesX / mViewport.Width, ClusterTilesY / mViewport.Height };
+		environment.ClusterSliceScale = mLightClusterer.SliceScale();
+		environment.ClusterSliceBias = mLightClusterer.SliceBias();
+		environment.ClusterTilesX = mLightClusterer.TilesX();
+		environment.ClusterTilesY = mLightClusterer.TilesY();
+		environment.ClusterSlices = mLightClusterer.Slices();
+	}
+
+	pDynamicResources->SetEnvironmentConstants(environment);
+}
+
+void D3DApplication::UpdateFrameLatency()
+{
+	// CPU stall of the previous frame
+	uint64_t stallNs = mFenceWaiter->Stats().Get(STALL_SITE_FRAME_RESOURCE).TotalNanoseconds();
+	double stallSeconds = (double)(stallNs - mFrameStallNs) * 1e-9;
+	mFrameStallNs = stallNs;
+
+	UINT frames = mLatencyController->AddFrame(mTimer->DeltaTime(), stallSeconds, mGpuIdleSeconds);
+	pDynamicResources->SetFrameResourceCount(mFenceWaiter.get(), mFence.Get(), frames);
+
+	mFrameStartTime = std::chrono::steady_clock::now();
+	mGpuDrainedAtFrameStart = mFence->GetCompletedValue() >= mCurrentFence;
 }
 
 void D3DApplication::Update()
 {
-	pDynamicResources->NextFrameResource(mFence.Get());
-	pDynamicResources->UpdateConstantBuffers();
-	mCamera->Update();
-	UpdatePassCB();
+	PROFILE_ZONE("Update");
+
+	// Everything up to recorded command lists, see BuildFrameGraph
+	mFrameGraph.Execute(&mJobSystem);
+	mCriticalPathSeconds += mFrameGraph.CriticalPathSeconds();
+}
+
+void D3DApplication::RunSimulation()
+{
+	const float step = static_cast<float>(mFixedStep.StepSeconds());
+	uint64_t last = Clock::Now();
+
+	Profiler::Instance().SetThreadName("simulation");
+	while (!mSimulationQuit.load())
+	{
+		// Hold still while the window is inactive or resizing
+		if (IsPaused())
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			last = Clock::Now();
+			continue;
+		}
+
+		uint64_t now = Clock::Now();
+		uint32_t steps = mFixedStep.Advance(Clock::ToSeconds(now - last));
+		last = now;
+
+		if (steps > 0)
+		{
+			POINT mouse;
+			{
+				std::lock_guard<std::mutex> lock(mMouseMutex);
+				mouse = mMouseDelta;
+				mMouseDelta = { 0, 0 };
+			}
+
+			for (uint32_t i = 0; i < steps; i++)
+			{
+				PROFILE_ZONE("simulation step");
+				PerfZone perfZone("simulation step", 1);
+
+				// Turning belongs to the first step, so frames blend it in too
+				if (i == 0 && (mouse.x != 0 || mouse.y != 0)) mCamera->Rotate(mouse.x, mouse.y);
+
+				// Keyboard input is polled by the camera
+				mCamera->Update(step);
+			}
+			PublishSnapshot(mFixedStep.Alpha());
+		}
+
+		// Wake up when the next step is due
+		std::this_thread::sleep_for(std::chrono::duration<double>(
+			(1.0 - mFixedStep.Alpha()) * mFixedStep.StepSeconds()));
+	}
+}
+
+D3DApplication::CameraState D3DApplication::CaptureCamera() const
+{
+	CameraState state;
+	state.Position = mCamera->mPosition;
+	state.Direction = mCamera->Direction();
+	state.Up = mCamera->Up();
+	return state;
+}
+
+void D3DApplication::PublishSnapshot(double alpha)
+{
+	// Frames blend from the state of the last publish, however many steps ago
+	Snapshot& snapshot = mSnapshots.Write();
+	snapshot.Previous = mPreviousCamera;
+	snapshot.Current = CaptureCamera();
+	snapshot.Steps = mFixedStep.StepCount() > mPublishedStep ?
+		static_cast<uint32_t>(mFixedStep.StepCount() - mPublishedStep) : 1;
+	snapshot.TotalTime = static_cast<float>(mFixedStep.SimulatedSeconds());
+	snapshot.Alpha = static_cast<float>(alpha);
+	snapshot.PublishedAt = std::chrono::steady_clock::now();
+	snapshot.Step = mFixedStep.StepCount();
+	mPreviousCamera = snapshot.Current;
+	mPublishedStep = snapshot.Step;
+	mSnapshots.Publish();
+}
+
+void D3DApplication::InterpolateSnapshot()
+{
+	// Without a new snapshot the last one is blended further along
+	mSnapshots.Acquire();
+	const Snapshot& snapshot = mSnapshots.Read();
+
+	// Time past the previous state, as a fraction of the steps up to Current:
+	// the remainder at publishing plus the time since. If the next publish
+	// comes as late as this one did, the blend reaches Current just then.
+	// Later than that the simulation is late, hold Current.
+	float sincePublished = std::chrono::duration<float>(
+		std::chrono::steady_clock::now() - snapshot.PublishedAt).count();
+	float alpha = (snapshot.Alpha + sincePublished * SimulationHz) / snapshot.Steps;
+	alpha = MathHelper::Clamp(alpha, 0.0f, 1.0f);
+
+	XMVECTOR position = XMVectorLerp(XMLoadFloat4(&snapshot.Previous.Position),
+		XMLoadFloat4(&snapshot.Current.Position), alpha);
+	XMVECTOR direction = XMVector3Normalize(XMVectorLerp(XMLoadFloat4(&snapshot.Previous.Direction),
+		XMLoadFloat4(&snapshot.Current.Direction), alpha));
+	XMVECTOR up = XMVector3Normalize(XMVectorLerp(XMLoadFloat4(&snapshot.Previous.Up),
+		XMLoadFloat4(&snapshot.Current.Up), alpha));
+
+	XMStoreFloat4x4(&mFrameView.View, XMMatrixLookToLH(position, direction, up));
+	XMStoreFloat4(&mFrameView.EyePosition, position);
+	mFrameView.TotalTime = snapshot.TotalTime + (alpha - 1.0f) * snapshot.Steps / SimulationHz;
 }
 
 void D3DApplication::OnMouseDown(WPARAM btnState, int x, int y)
 {
 	// Prepare to move
-	mCamera->mLastMousePos.x = x;
-	mCamera->mLastMousePos.y = y;
+	mLastMousePos = { x, y };
 
 	// Set mouse capture on current window
 	SetCapture(mhWnd);
@@ -183,7 +495,11 @@ void D3DApplication::OnMouseMove(WPARAM btnState, int x, int y)
 {
 	if ((btnState & MK_LBUTTON) != 0)
 	{
-		mCamera->OnMouseMove(x, y);
+		// Applied by the next simulation step
+		std::lock_guard<std::mutex> lock(mMouseMutex);
+		mMouseDelta.x += x - mLastMousePos.x;
+		mMouseDelta.y += y - mLastMousePos.y;
+		mLastMousePos = { x, y };
 	}
 }
 
@@ -196,19 +512,7 @@ void D3DBase::FlushCommandQueue()
 	// Set a new fence point
 	ThrowIfFailed(mCommandQueue->Signal(mFence.Get(), mCurrentFence));
 
-	if (mFence->GetCompletedValue() < mCurrentFence)
-	{
-		HANDLE eventHandle = CreateEventEx(nullptr, nullptr, false,
-			EVENT_ALL_ACCESS);
-
-		// Fire event when GPU hits current fence
-		ThrowIfFailed(mFence->SetEventOnCompletion(mCurrentFence, eventHandle));
-
-		if (eventHandle == nullptr) return;
-
-		WaitForSingleObject(eventHandle, INFINITE);
-		CloseHandle(eventHandle);
-	}
+	mFenceWaiter->Wait(mFence.Get(), mCurrentFence, STALL_SITE_FLUSH_COMMAND_QUEUE);
 }
 
 // Called to change back and DS buffer sizes.
@@ -397,6 +701,19 @@ LRESULT D3DBase::MsgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 			PostQuitMessage(0);
 			return 0;
 		}
+		if (wParam == VK_F9)
+		{
+			// Open in chrome://tracing or ui.perfetto.dev
+			if (Profiler::Instance().WriteChromeTrace(std::string(ProfileFilename)))
+			{
+				OutputDebugStringA("Profile written to profile.json\n");
+			}
+			else
+			{
+				OutputDebugStringA("Failed to write profile.json\n");
+			}
+			return 0;
+		}
 	}
 	return DefWindowProc(hwnd, msg, wParam, lParam);
 }
\ No newline at end of file
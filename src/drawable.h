@@ -20,11 +20,34 @@
 #include "UploadBuffer.h"
 
 #include "d3dresource.h"
+#include "command_stream.h"
+
+// Pipeline state a drawable is rendered with
+enum DRAW_LAYER
+{
+	DRAW_LAYER_OPAQUE,
+	DRAW_LAYER_TRANSPARENT,
+	DRAW_LAYER_COUNT
+};
+
+// Pipeline state objects created by the application
+enum PIPELINE_STATE
+{
+	PIPELINE_STATE_DEFAULT,
+	PIPELINE_STATE_BLEND,
+	PIPELINE_STATE_LINE,
+	PIPELINE_STATE_COUNT
+};
 
 /**
  * Interface that defines any object that can be drawn.
  * 
- * VB and IB are set by static function of the children.
+ * A drawable is geometry plus draw state, not a scene object. Objects using
+ * the same drawable are drawn with one instanced call, their per-object
+ * data is read by the shader from the frame's structured buffers.
+ * 
+ * VB and IB are set by static function of the children. Commands are
+ * recorded into a CommandStream, which a backend replays later.
  */
 class IDrawable
 {
@@ -36,35 +59,54 @@ protected:
 		PrimitiveTopology(topology), Submesh(submesh) { }
 
 public:
-	
-	static void SetVBAndIB(ID3D12GraphicsCommandList* pCommandList,
+	virtual ~IDrawable() { }
+
+	static void SetVBAndIB(CommandStream& stream,
 		const D3D12_VERTEX_BUFFER_VIEW &vbv,
 		const D3D12_INDEX_BUFFER_VIEW &ibv)
 	{
-		pCommandList->IASetVertexBuffers(0, 1, &vbv);
-		pCommandList->IASetIndexBuffer(&ibv);
+		stream.SetVertexBuffer(vbv.BufferLocation, vbv.SizeInBytes, vbv.StrideInBytes);
+		stream.SetIndexBuffer(ibv.BufferLocation, ibv.SizeInBytes,
+			ibv.Format == DXGI_FORMAT_R16_UINT ? 2 : 4);
 	}
 
 	/**
-	 * Call only after SetVBAndIB.
+	 * Call only after SetVBAndIB and after the frame's structured
+	 * buffers are bound. State already set by the previous drawable
+	 * is not set again.
 	 * 
-	 * \param pCmdList Command List
-	 * \param pCurrentFrameResource Current FrameResource
+	 * \param stream stream the frame is recorded into
+	 * \param firstInstance position of the first object in the instance list
+	 * \param instanceCount number of objects to draw
+	 * \param pPrevious drawable drawn last into this stream, or nullptr
 	 */
-	void Draw(ID3D12GraphicsCommandList* pCmdList,
-		FrameResource* pCurrentFrameResource)
+	void Draw(CommandStream& stream,
+		UINT firstInstance, UINT instanceCount, const IDrawable* pPrevious = nullptr)
 	{
-		pCmdList->IASetPrimitiveTopology(PrimitiveTopology);
+		if (pPrevious == nullptr || pPrevious->PrimitiveTopology != PrimitiveTopology)
+			stream.SetTopology(PrimitiveTopology);
 
-		SetRootParameters(pCmdList, pCurrentFrameResource);
+		if (pPrevious == nullptr || pPrevious->BindingKey() != BindingKey())
+			SetRootParameters(stream);
 
-		pCmdList->DrawIndexedInstanced(Submesh.IndexCount, 1,
-			Submesh.StartIndexLocation, Submesh.BaseVertexLocation, 0);
+		stream.DrawInstances(5, Submesh.IndexCount, Submesh.StartIndexLocation,
+			Submesh.BaseVertexLocation, firstInstance, instanceCount);
 	}
 
+	virtual DRAW_LAYER Layer() const = 0;
+	virtual PIPELINE_STATE Pipeline() const = 0;
+
+	// Selects the ALPHA_TEST shader variant, which discards texels with low alpha
+	virtual bool AlphaTest() const { return false; }
+
+	// Identifies what SetRootParameters binds. Drawables with equal
+	// keys bind the same resources, e.g. the index of their texture.
+	virtual UINT BindingKey() const = 0;
+
+	const MESH_BOUNDS& Bounds() const { return Submesh.Bounds; }
+
 protected:
-	virtual void SetRootParameters(ID3D12GraphicsCommandList* pCmdList,
-		FrameResource* pCurrentFrameResource) = 0;
+	virtual void SetRootParameters(CommandStream& stream) = 0;
 };
 
 /**
@@ -75,32 +117,34 @@ class DefaultDrawable : public IDrawable
 {
 public:
 	DefaultDrawable(const SubmeshGeometry& submesh,
-		UINT objectCBIndex, UINT materialCBIndex,
-		D3D12_GPU_DESCRIPTOR_HANDLE textureDescriptorHandle,
+		UINT textureIndex, D3D12_GPU_DESCRIPTOR_HANDLE textureDescriptorHandle,
+		DRAW_LAYER layer = DRAW_LAYER_OPAQUE,
 		D3D12_PRIMITIVE_TOPOLOGY primitiveTypology = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST) : 
 
 		IDrawable(primitiveTypology, submesh),
-		ObjectCBIndex(objectCBIndex),
-		MaterialCBIndex(materialCBIndex),
-		TextureHandle(textureDescriptorHandle)
+		TextureIndex(textureIndex),
+		TextureHandle(textureDescriptorHandle),
+		DrawLayer(layer)
 	{	
 	}
 
 	DefaultDrawable& operator=(DefaultDrawable& rhs) = delete;
 
-	void SetRootParameters(ID3D12GraphicsCommandList* pCmdList,
-		FrameResource* pCurrentFrameResource) override
+	DRAW_LAYER Layer() const override { return DrawLayer; }
+
+	PIPELINE_STATE Pipeline() const override
 	{
-		// Set the CB descriptor to the 1 slot of descriptor table
-		pCmdList->SetGraphicsRootConstantBufferView(1, 
-			pCurrentFrameResource->ObjectCB->GetGPUHandle(ObjectCBIndex));
-		pCmdList->SetGraphicsRootConstantBufferView(2, 
-			pCurrentFrameResource->MaterialCB->GetGPUHandle(MaterialCBIndex));
-		pCmdList->SetGraphicsRootDescriptorTable(3, TextureHandle);
+		return DrawLayer == DRAW_LAYER_TRANSPARENT ? PIPELINE_STATE_BLEND : PIPELINE_STATE_DEFAULT;
+	}
+
+	UINT BindingKey() const override { return TextureIndex; }
+
+	void SetRootParameters(CommandStream& stream) override
+	{
+		stream.SetRootTable(3, TextureHandle.ptr);
 	}
 private:
-	UINT ObjectCBIndex = 0;
-	UINT MaterialCBIndex = 0;
+	UINT TextureIndex = 0;
 	D3D12_GPU_DESCRIPTOR_HANDLE TextureHandle;
+	DRAW_LAYER DrawLayer = DRAW_LAYER_OPAQUE;
 };
-
@@ -0,0 +1,137 @@
+/*****************************************************************//**
+ * \file   fencewait.cpp
+ * \brief  Definition of FenceWaiter
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include "fencewait.h"
+#include "d3dUtil.h"
+#include "clock.h"
+#include "profiler.h"
+
+static uint64_t elapsed_ns(uint64_t startTicks)
+{
+	return Clock::ToNanoseconds(Clock::Now() - startTicks);
+}
+
+FenceWaiter::~FenceWaiter()
+{
+	for (HANDLE eventHandle : mFreeEvents)
+	{
+		CloseHandle(eventHandle);
+	}
+}
+
+HANDLE FenceWaiter::AcquireEvent()
+{
+	{
+		std::lock_guard<std::mutex> lock(mEventMutex);
+		if (!mFreeEvents.empty())
+		{
+			HANDLE eventHandle = mFreeEvents.back();
+			mFreeEvents.pop_back();
+			return eventHandle;
+		}
+	}
+
+	// Auto-reset event, so it is unsignaled again after a successful wait
+	HANDLE eventHandle = CreateEventEx(nullptr, nullptr, 0, EVENT_ALL_ACCESS);
+	if (eventHandle == nullptr)
+	{
+		ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
+	}
+	return eventHandle;
+}
+
+void FenceWaiter::ReleaseEvent(HANDLE eventHandle)
+{
+	std::lock_guard<std::mutex> lock(mEventMutex);
+	mFreeEvents.push_back(eventHandle);
+}
+
+void FenceWaiter::Wait(ID3D12Fence* pFence, UINT64 value, STALL_SITE site)
+{
+	// Fast path: GPU is already there, nothing to record
+	if (pFence->GetCompletedValue() >= value) return;
+
+	PROFILE_ZONE("fence wait");
+	uint64_t start = Clock::Now();
+
+	HANDLE eventHandle = AcquireEvent();
+
+	// Fire event when GPU hits the fence value. The event goes back to
+	// the pool if that fails, it was never handed to the fence.
+	try
+	{
+		ThrowIfFailed(pFence->SetEventOnCompletion(value, eventHandle));
+	}
+	catch (...)
+	{
+		ReleaseEvent(eventHandle);
+		throw;
+	}
+	WaitForSingleObject(eventHandle, INFINITE);
+
+	ReleaseEvent(eventHandle);
+
+	mStats.Record(site, elapsed_ns(start));
+}
+
+void FenceWaiter::WaitAndRelease(HANDLE* pEvents, UINT& count)
+{
+	if (count == 0) return;
+
+	WaitForMultipleObjects(count, pEvents, TRUE, INFINITE);
+	for (UINT i = 0; i < count; i++) ReleaseEvent(pEvents[i]);
+	count = 0;
+}
+
+void FenceWaiter::WaitAll(ID3D12Fence* const* ppFences, const UINT64* pValues,
+	UINT count, STALL_SITE site)
+{
+	// Fast path as in Wait: skip fences that are already there
+	UINT first = 0;
+	while (first < count && ppFences[first]->GetCompletedValue() >= pValues[first]) first++;
+	if (first == count) return;
+
+	PROFILE_ZONE("fence wait all");
+	uint64_t start = Clock::Now();
+
+	// WaitForMultipleObjects takes a limited number of handles, so more
+	// fences than that are waited for in groups
+	HANDLE events[MAXIMUM_WAIT_OBJECTS];
+	UINT pending = 0;
+
+	try
+	{
+		for (UINT i = first; i < count; i++)
+		{
+			if (ppFences[i]->GetCompletedValue() >= pValues[i]) continue;
+
+			HANDLE eventHandle = AcquireEvent();
+			try
+			{
+				ThrowIfFailed(ppFences[i]->SetEventOnCompletion(pValues[i], eventHandle));
+			}
+			catch (...)
+			{
+				ReleaseEvent(eventHandle);
+				throw;
+			}
+			events[pending++] = eventHandle;
+
+			if (pending == MAXIMUM_WAIT_OBJECTS) WaitAndRelease(events, pending);
+		}
+	}
+	catch (...)
+	{
+		// Events already handed to fences are signaled later, so they
+		// only go back to the pool once that has happened
+		WaitAndRelease(events, pending);
+		throw;
+	}
+	WaitAndRelease(events, pending);
+
+	mStats.Record(site, elapsed_ns(start));
+}
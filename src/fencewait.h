@@ -0,0 +1,59 @@
+/*****************************************************************//**
+ * \file   fencewait.h
+ * \brief  Waiting on GPU fences with cached events and stall statistics
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+
+#include <Windows.h>
+#include <d3d12.h>
+#include <mutex>
+#include <vector>
+
+#include "stall_stats.h"
+
+/**
+ * Single place where the CPU blocks on the GPU.
+ *
+ * Win32 events are created once and reused between waits instead of
+ * creating a kernel object per wait. Time spent blocked is recorded per
+ * call site, see Stats().
+ */
+class FenceWaiter
+{
+public:
+	FenceWaiter() = default;
+	~FenceWaiter();
+
+	// Forbid copying
+	FenceWaiter(FenceWaiter& rhs) = delete;
+	FenceWaiter& operator=(FenceWaiter& rhs) = delete;
+
+	// Blocks until pFence reaches value. Returns without any
+	// kernel calls if the value is already reached.
+	void Wait(ID3D12Fence* pFence, UINT64 value, STALL_SITE site);
+
+	// Blocks until every fence reaches its value, waiting on all of them at
+	// once. Records a single stall for the call, none if nothing was pending.
+	void WaitAll(ID3D12Fence* const* ppFences, const UINT64* pValues,
+		UINT count, STALL_SITE site);
+
+	const StallRecorder& Stats() const { return mStats; }
+	StallRecorder& Stats() { return mStats; }
+
+private:
+	HANDLE AcquireEvent();
+	void ReleaseEvent(HANDLE eventHandle);
+
+	// Waits for count events handed to fences, returns them to the pool
+	// and sets count to zero
+	void WaitAndRelease(HANDLE* pEvents, UINT& count);
+
+	// Auto-reset events that are not in use by any wait
+	std::vector<HANDLE> mFreeEvents;
+	std::mutex mEventMutex;
+
+	StallRecorder mStats;
+};
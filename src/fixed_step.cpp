@@ -0,0 +1,42 @@
+/*****************************************************************//**
+ * \file   fixed_step.cpp
+ * \brief  Definition of FixedStepClock
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include "fixed_step.h"
+
+FixedStepClock::FixedStepClock(const FIXED_STEP_PARAMS& params)
+    : m_params(params)
+{
+    if (!(m_params.StepSeconds > 0.0)) m_params.StepSeconds = 1.0 / 240.0;
+    if (m_params.MaxSubsteps == 0) m_params.MaxSubsteps = 1;
+}
+
+uint32_t FixedStepClock::Advance(double elapsedSeconds)
+{
+    if (!(elapsedSeconds > 0.0)) return 0;
+
+    if (elapsedSeconds > m_params.MaxElapsedSeconds)
+    {
+        m_dropped += elapsedSeconds - m_params.MaxElapsedSeconds;
+        elapsedSeconds = m_params.MaxElapsedSeconds;
+    }
+    m_accumulator += elapsedSeconds;
+
+    uint64_t steps = static_cast<uint64_t>(m_accumulator / m_params.StepSeconds);
+    if (steps > m_params.MaxSubsteps)
+    {
+        // Keep the fraction of a step, drop whole steps beyond the cap
+        m_dropped += (steps - m_params.MaxSubsteps) * m_params.StepSeconds;
+        m_accumulator -= (steps - m_params.MaxSubsteps) * m_params.StepSeconds;
+        steps = m_params.MaxSubsteps;
+    }
+
+    m_accumulator -= steps * m_params.StepSeconds;
+    if (m_accumulator < 0.0) m_accumulator = 0.0;
+
+    m_steps += steps;
+    return static_cast<uint32_t>(steps);
+}
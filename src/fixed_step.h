@@ -0,0 +1,57 @@
+/*****************************************************************//**
+ * \file   fixed_step.h
+ * \brief  Turns real time into a whole number of fixed simulation steps
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+
+#include <cstdint>
+
+// Tuning of FixedStepClock
+struct FIXED_STEP_PARAMS
+{
+	double StepSeconds = 1.0 / 240.0;	// Simulated time per step
+	uint32_t MaxSubsteps = 8;			// Steps run at most per Advance
+	double MaxElapsedSeconds = 0.25;	// Longer gaps, such as a debugger break, count as this
+};
+
+/**
+ * Accumulates elapsed real time and pays it out in steps of a fixed length,
+ * so the simulation behaves the same at any frame rate.
+ *
+ * If steps take longer to run than they simulate, the debt grows with every
+ * call: the "spiral of death". Each call therefore runs at most MaxSubsteps
+ * steps and drops the time beyond them, and gaps longer than
+ * MaxElapsedSeconds are cut short before they are added, so the simulation
+ * slows down instead of falling further behind.
+ *
+ * Time left over is less than a step. Alpha() is that fraction of a step,
+ * to blend the last two simulated states when presenting.
+ */
+class FixedStepClock
+{
+public:
+	explicit FixedStepClock(const FIXED_STEP_PARAMS& params = FIXED_STEP_PARAMS());
+
+	// Adds elapsed time, returns the number of steps to run now
+	uint32_t Advance(double elapsedSeconds);
+
+	// Time accumulated since the last step, in steps, in [0, 1)
+	double Alpha() const { return m_accumulator / m_params.StepSeconds; }
+
+	double StepSeconds() const { return m_params.StepSeconds; }
+	uint64_t StepCount() const { return m_steps; }
+	double SimulatedSeconds() const { return m_steps * m_params.StepSeconds; }
+
+	// Time thrown away to keep up, in total
+	double DroppedSeconds() const { return m_dropped; }
+
+private:
+	FIXED_STEP_PARAMS m_params;
+
+	double m_accumulator = 0.0;
+	uint64_t m_steps = 0;
+	double m_dropped = 0.0;
+};
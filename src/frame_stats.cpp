@@ -0,0 +1,219 @@
+/*****************************************************************//**
+ * \file   frame_stats.cpp
+ * \brief  Definition of QuantileSketch, FrameStatsCollector and FrameStatsLog
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include <cmath>
+
+#include "frame_stats.h"
+
+static const char* const frame_metric_names[FRAME_METRIC_COUNT] =
+{
+    "cpu",
+    "fence_stall",
+    "present_interval",
+};
+
+const char* FrameMetricName(FRAME_METRIC metric)
+{
+    if (metric < 0 || metric >= FRAME_METRIC_COUNT) return "unknown";
+    return frame_metric_names[metric];
+}
+
+QuantileSketch::QuantileSketch(double relativeAccuracy)
+{
+    if (!(relativeAccuracy > 0.0 && relativeAccuracy < 1.0)) relativeAccuracy = 0.01;
+
+    // Every value in (min * gamma^(i-1), min * gamma^i] is within the
+    // accuracy of the bucket's middle
+    m_gamma = (1.0 + relativeAccuracy) / (1.0 - relativeAccuracy);
+    m_inverseLogGamma = 1.0 / std::log(m_gamma);
+
+    double range = static_cast<double>(MaxNanoseconds) / MinNanoseconds;
+    m_counts.assign(static_cast<size_t>(std::ceil(std::log(range) * m_inverseLogGamma)) + 2, 0);
+}
+
+uint32_t QuantileSketch::bucket_index(uint64_t nanoseconds) const
+{
+    if (nanoseconds <= MinNanoseconds) return 0;
+
+    double index = std::ceil(std::log(static_cast<double>(nanoseconds) / MinNanoseconds) * m_inverseLogGamma);
+    uint32_t last = static_cast<uint32_t>(m_counts.size() - 1);
+    return index < last ? static_cast<uint32_t>(index) : last;
+}
+
+void QuantileSketch::Clear()
+{
+    m_counts.assign(m_counts.size(), 0);
+    m_count = 0;
+}
+
+uint64_t QuantileSketch::Quantile(double p) const
+{
+    if (m_count == 0) return 0;
+    if (p < 0.0) p = 0.0;
+    if (p > 1.0) p = 1.0;
+
+    uint64_t rank = static_cast<uint64_t>(p * (m_count - 1));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < m_counts.size(); i++)
+    {
+        seen += m_counts[i];
+        if (seen > rank)
+        {
+            if (i == 0) return 0;
+            return static_cast<uint64_t>(MinNanoseconds * 2.0 * std::pow(m_gamma, static_cast<double>(i)) / (m_gamma + 1.0));
+        }
+    }
+    return MaxNanoseconds;
+}
+
+FrameStatsCollector::FrameStatsCollector(const FRAME_STATS_PARAMS& params)
+    : m_params(params)
+{
+    if (m_params.WindowFrames == 0) m_params.WindowFrames = 1;
+    m_samples.reserve(m_params.WindowFrames);
+    m_stutters.reserve(m_params.WindowFrames);
+    m_sketches.assign(FRAME_METRIC_COUNT, QuantileSketch(m_params.RelativeAccuracy));
+}
+
+void FrameStatsCollector::AddFrame(const FRAME_SAMPLE& sample)
+{
+    // Judged against the frames before it, so a run of slow frames counts
+    // until it becomes the median
+    const QuantileSketch& intervals = m_sketches[FRAME_METRIC_PRESENT_INTERVAL];
+    bool stutter = intervals.Count() >= m_params.MinStutterFrames &&
+        sample.Nanoseconds[FRAME_METRIC_PRESENT_INTERVAL] >
+        m_params.StutterFactor * intervals.Quantile(0.5);
+
+    if (m_samples.size() == m_params.WindowFrames)
+    {
+        const FRAME_SAMPLE& oldest = m_samples[m_next];
+        for (int metric = 0; metric < FRAME_METRIC_COUNT; metric++)
+        {
+            m_sketches[metric].Remove(oldest.Nanoseconds[metric]);
+            m_totals[metric] -= oldest.Nanoseconds[metric];
+        }
+        m_stutterCount -= m_stutters[m_next];
+
+        m_samples[m_next] = sample;
+        m_stutters[m_next] = stutter ? 1 : 0;
+    }
+    else
+    {
+        m_samples.push_back(sample);
+        m_stutters.push_back(stutter ? 1 : 0);
+    }
+    m_next = (m_next + 1) % m_params.WindowFrames;
+
+    for (int metric = 0; metric < FRAME_METRIC_COUNT; metric++)
+    {
+        m_sketches[metric].Add(sample.Nanoseconds[metric]);
+        m_totals[metric] += sample.Nanoseconds[metric];
+    }
+    m_stutterCount += stutter ? 1 : 0;
+    m_frames++;
+}
+
+void FrameStatsCollector::Clear()
+{
+    m_samples.clear();
+    m_stutters.clear();
+    m_next = 0;
+    for (QuantileSketch& sketch : m_sketches) sketch.Clear();
+    for (uint64_t& total : m_totals) total = 0;
+    m_stutterCount = 0;
+}
+
+FRAME_STATS_SUMMARY FrameStatsCollector::Summary() const
+{
+    FRAME_STATS_SUMMARY summary = { };
+    summary.Frame = m_frames;
+    summary.WindowFrames = static_cast<uint32_t>(m_samples.size());
+    summary.Stutters = m_stutterCount;
+    if (m_samples.empty()) return summary;
+
+    for (int metric = 0; metric < FRAME_METRIC_COUNT; metric++)
+    {
+        uint64_t maxNs = 0;
+        for (const FRAME_SAMPLE& sample : m_samples)
+        {
+            if (sample.Nanoseconds[metric] > maxNs) maxNs = sample.Nanoseconds[metric];
+        }
+
+        const QuantileSketch& sketch = m_sketches[metric];
+        FRAME_METRIC_SUMMARY& result = summary.Metrics[metric];
+        result.MeanMs = m_totals[metric] * 1e-6 / m_samples.size();
+        result.P50Ms = sketch.Quantile(0.50) * 1e-6;
+        result.P95Ms = sketch.Quantile(0.95) * 1e-6;
+        result.P99Ms = sketch.Quantile(0.99) * 1e-6;
+        result.MaxMs = maxNs * 1e-6;
+
+        // Buckets of the sketch may round past the largest value
+        if (result.P50Ms > result.MaxMs) result.P50Ms = result.MaxMs;
+        if (result.P95Ms > result.MaxMs) result.P95Ms = result.MaxMs;
+        if (result.P99Ms > result.MaxMs) result.P99Ms = result.MaxMs;
+    }
+    return summary;
+}
+
+bool FrameStatsLog::Open(const std::string& filename, FRAME_STATS_FORMAT format)
+{
+    m_file.open(filename, std::ios::out | std::ios::trunc);
+    if (!m_file) return false;
+
+    m_format = format;
+    if (m_format == FRAME_STATS_FORMAT_CSV) WriteCsvHeader(m_file);
+    return static_cast<bool>(m_file);
+}
+
+bool FrameStatsLog::Write(const FRAME_STATS_SUMMARY& summary, double seconds)
+{
+    if (!m_file.is_open()) return false;
+
+    if (m_format == FRAME_STATS_FORMAT_CSV) WriteCsvRow(m_file, summary, seconds);
+    else WriteJson(m_file, summary, seconds);
+
+    // Logs are read while the program runs
+    m_file.flush();
+    return static_cast<bool>(m_file);
+}
+
+void FrameStatsLog::WriteCsvHeader(std::ostream& stream)
+{
+    stream << "seconds,frame,window_frames,stutters";
+    for (int metric = 0; metric < FRAME_METRIC_COUNT; metric++)
+    {
+        const char* name = FrameMetricName(static_cast<FRAME_METRIC>(metric));
+        stream << ',' << name << "_mean_ms," << name << "_p50_ms," << name << "_p95_ms," <<
+            name << "_p99_ms," << name << "_max_ms";
+    }
+    stream << '\n';
+}
+
+void FrameStatsLog::WriteCsvRow(std::ostream& stream, const FRAME_STATS_SUMMARY& summary, double seconds)
+{
+    stream << seconds << ',' << summary.Frame << ',' << summary.WindowFrames << ',' << summary.Stutters;
+    for (int metric = 0; metric < FRAME_METRIC_COUNT; metric++)
+    {
+        const FRAME_METRIC_SUMMARY& m = summary.Metrics[metric];
+        stream << ',' << m.MeanMs << ',' << m.P50Ms << ',' << m.P95Ms << ',' << m.P99Ms << ',' << m.MaxMs;
+    }
+    stream << '\n';
+}
+
+void FrameStatsLog::WriteJson(std::ostream& stream, const FRAME_STATS_SUMMARY& summary, double seconds)
+{
+    stream << "{\"seconds\":" << seconds << ",\"frame\":" << summary.Frame <<
+        ",\"window_frames\":" << summary.WindowFrames << ",\"stutters\":" << summary.Stutters;
+    for (int metric = 0; metric < FRAME_METRIC_COUNT; metric++)
+    {
+        const FRAME_METRIC_SUMMARY& m = summary.Metrics[metric];
+        stream << ",\"" << FrameMetricName(static_cast<FRAME_METRIC>(metric)) << "\":{" <<
+            "\"mean_ms\":" << m.MeanMs << ",\"p50_ms\":" << m.P50Ms << ",\"p95_ms\":" << m.P95Ms <<
+            ",\"p99_ms\":" << m.P99Ms << ",\"max_ms\":" << m.MaxMs << "}";
+    }
+    stream << "}\n";
+}
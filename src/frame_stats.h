@@ -0,0 +1,152 @@
+/*****************************************************************//**
+ * \file   frame_stats.h
+ * \brief  Percentiles of frame times over a rolling window
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Quantities measured for every frame
+enum FRAME_METRIC
+{
+	FRAME_METRIC_CPU = 0,					// Update and Draw on the render thread
+	FRAME_METRIC_FENCE_STALL,				// CPU blocked on fences within the frame
+	FRAME_METRIC_PRESENT_INTERVAL,			// Time since the previous Present
+	FRAME_METRIC_COUNT
+};
+
+const char* FrameMetricName(FRAME_METRIC metric);
+
+// One frame, in nanoseconds
+struct FRAME_SAMPLE
+{
+	uint64_t Nanoseconds[FRAME_METRIC_COUNT];
+};
+
+/**
+ * Approximate quantiles of a stream of durations in constant memory.
+ *
+ * Durations are counted in buckets whose bounds grow geometrically, so any
+ * quantile is reported within the relative accuracy of its true value.
+ * Counts can be removed as well as added, which keeps a sketch over a
+ * sliding window cheap. Durations below MinNanoseconds share the first
+ * bucket, those above MaxNanoseconds the last.
+ */
+class QuantileSketch
+{
+public:
+	static const uint64_t MinNanoseconds = 1000;
+	static const uint64_t MaxNanoseconds = 100000000000ull;
+
+	explicit QuantileSketch(double relativeAccuracy = 0.01);
+
+	void Add(uint64_t nanoseconds) { m_counts[bucket_index(nanoseconds)]++; m_count++; }
+	void Remove(uint64_t nanoseconds) { m_counts[bucket_index(nanoseconds)]--; m_count--; }
+	void Clear();
+
+	uint64_t Count() const { return m_count; }
+
+	// Value at fraction p of the sorted durations, p in [0, 1]. Durations in
+	// the first bucket are reported as 0.
+	uint64_t Quantile(double p) const;
+
+private:
+	uint32_t bucket_index(uint64_t nanoseconds) const;
+
+	double m_gamma;
+	double m_inverseLogGamma;
+	std::vector<uint32_t> m_counts;
+	uint64_t m_count = 0;
+};
+
+// Tuning of FrameStatsCollector
+struct FRAME_STATS_PARAMS
+{
+	uint32_t WindowFrames = 1000;			// Frames the statistics cover
+	double RelativeAccuracy = 0.01;			// Of the percentiles
+	double StutterFactor = 2.0;				// Present interval this many times the median is a stutter
+	uint32_t MinStutterFrames = 30;			// Frames needed before stutters are counted
+};
+
+struct FRAME_METRIC_SUMMARY
+{
+	double MeanMs;
+	double P50Ms;
+	double P95Ms;
+	double P99Ms;
+	double MaxMs;
+};
+
+struct FRAME_STATS_SUMMARY
+{
+	uint64_t Frame;							// Frames added in total
+	uint32_t WindowFrames;					// Frames the summary covers
+	uint32_t Stutters;						// In the window
+	FRAME_METRIC_SUMMARY Metrics[FRAME_METRIC_COUNT];
+};
+
+/**
+ * Statistics over the last frames: mean, median, tail percentiles and maximum
+ * of every metric, and the number of stutters.
+ *
+ * Averages hide the frames users notice, so the tail is reported too. A
+ * stutter is a frame presented more than StutterFactor times the median
+ * interval after the previous one. Percentiles come from sketches, the mean
+ * and maximum are exact.
+ */
+class FrameStatsCollector
+{
+public:
+	explicit FrameStatsCollector(const FRAME_STATS_PARAMS& params = FRAME_STATS_PARAMS());
+
+	void AddFrame(const FRAME_SAMPLE& sample);
+	void Clear();
+
+	FRAME_STATS_SUMMARY Summary() const;
+
+	uint64_t FrameCount() const { return m_frames; }
+
+private:
+	FRAME_STATS_PARAMS m_params;
+
+	// Window of the latest frames, oldest at m_next once full
+	std::vector<FRAME_SAMPLE> m_samples;
+	std::vector<uint8_t> m_stutters;
+	uint32_t m_next = 0;
+
+	std::vector<QuantileSketch> m_sketches;
+	uint64_t m_totals[FRAME_METRIC_COUNT] = { };
+	uint32_t m_stutterCount = 0;
+	uint64_t m_frames = 0;
+};
+
+enum FRAME_STATS_FORMAT
+{
+	FRAME_STATS_FORMAT_CSV = 0,				// Header, then a row per summary
+	FRAME_STATS_FORMAT_JSON_LINES,			// An object per summary and line
+};
+
+// Appends summaries to a file, one per Write
+class FrameStatsLog
+{
+public:
+	bool Open(const std::string& filename, FRAME_STATS_FORMAT format);
+	bool IsOpen() const { return m_file.is_open(); }
+
+	bool Write(const FRAME_STATS_SUMMARY& summary, double seconds);
+
+	static void WriteCsvHeader(std::ostream& stream);
+	static void WriteCsvRow(std::ostream& stream, const FRAME_STATS_SUMMARY& summary, double seconds);
+	static void WriteJson(std::ostream& stream, const FRAME_STATS_SUMMARY& summary, double seconds);
+
+private:
+	std::ofstream m_file;
+	FRAME_STATS_FORMAT m_format = FRAME_STATS_FORMAT_CSV;
+};
@@ -0,0 +1,353 @@
+/*****************************************************************//**
+ * \file   frustum_cull.cpp
+ * \brief  Definition of FrustumCuller and its SIMD kernels
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include <cmath>
+
+#include "frustum_cull.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define FRUSTUM_CULL_SIMD
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// The application is not built with /arch:AVX, so the 8-wide kernel is
+// compiled for AVX on its own and picked at runtime
+#if defined(FRUSTUM_CULL_SIMD) && (defined(_MSC_VER) || defined(__GNUC__))
+#define FRUSTUM_CULL_AVX
+#ifdef _MSC_VER
+#define AVX_TARGET
+#else
+#define AVX_TARGET __attribute__((target("avx")))
+#endif
+#endif
+
+// Splitting is only worth it for large sets
+static const size_t MinBoundsPerThread = 16 * 1024;
+
+FRUSTUM_PLANES ExtractFrustumPlanes(const float viewProj[16])
+{
+    // Column j of the matrix gives clip coordinate j
+    float col[4][4];
+    for (int j = 0; j < 4; j++)
+    {
+        for (int i = 0; i < 4; i++) col[j][i] = viewProj[i * 4 + j];
+    }
+
+    FRUSTUM_PLANES frustum;
+    for (int i = 0; i < 4; i++)
+    {
+        frustum.Planes[0][i] = col[3][i] + col[0][i];   // Left
+        frustum.Planes[1][i] = col[3][i] - col[0][i];   // Right
+        frustum.Planes[2][i] = col[3][i] + col[1][i];   // Bottom
+        frustum.Planes[3][i] = col[3][i] - col[1][i];   // Top
+        frustum.Planes[4][i] = col[2][i];               // Near, z >= 0
+        frustum.Planes[5][i] = col[3][i] - col[2][i];   // Far
+    }
+
+    // Normalize, so that plane distances are in world units
+    for (int p = 0; p < 6; p++)
+    {
+        float* plane = frustum.Planes[p];
+        float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        if (length > 0.0f)
+        {
+            for (int i = 0; i < 4; i++) plane[i] /= length;
+        }
+    }
+    return frustum;
+}
+
+void CullingBounds::Clear()
+{
+    m_centerX.clear(); m_centerY.clear(); m_centerZ.clear();
+    m_extentX.clear(); m_extentY.clear(); m_extentZ.clear();
+    m_radius.clear();
+}
+
+void CullingBounds::Reserve(size_t count)
+{
+    m_centerX.reserve(count); m_centerY.reserve(count); m_centerZ.reserve(count);
+    m_extentX.reserve(count); m_extentY.reserve(count); m_extentZ.reserve(count);
+    m_radius.reserve(count);
+}
+
+uint32_t CullingBounds::Add(const MESH_BOUNDS& bounds)
+{
+    uint32_t index = static_cast<uint32_t>(m_radius.size());
+
+    m_centerX.push_back(bounds.Center[0]);
+    m_centerY.push_back(bounds.Center[1]);
+    m_centerZ.push_back(bounds.Center[2]);
+    m_extentX.push_back(bounds.Extents[0]);
+    m_extentY.push_back(bounds.Extents[1]);
+    m_extentZ.push_back(bounds.Extents[2]);
+    m_radius.push_back(bounds.Radius);
+
+    return index;
+}
+
+void CullingBounds::Set(uint32_t index, const MESH_BOUNDS& bounds)
+{
+    m_centerX[index] = bounds.Center[0];
+    m_centerY[index] = bounds.Center[1];
+    m_centerZ[index] = bounds.Center[2];
+    m_extentX[index] = bounds.Extents[0];
+    m_extentY[index] = bounds.Extents[1];
+    m_extentZ[index] = bounds.Extents[2];
+    m_radius[index] = bounds.Radius;
+}
+
+// Culls bounds [begin, end) and writes visible indices to pOut,
+// which has room for end - begin entries. Returns the number written.
+typedef size_t (*CullKernel)(const FRUSTUM_PLANES& frustum, const CullingBounds& bounds,
+    size_t begin, size_t end, uint32_t* pOut);
+
+static inline bool cull_one(const FRUSTUM_PLANES& frustum, const CullingBounds& bounds, size_t i)
+{
+    for (int p = 0; p < 6; p++)
+    {
+        const float* plane = frustum.Planes[p];
+        float dist = plane[0] * bounds.CenterX()[i] + plane[1] * bounds.CenterY()[i]
+            + plane[2] * bounds.CenterZ()[i] + plane[3];
+
+        // How far the volume reaches towards the plane: the tighter of box and sphere
+        float boxReach = bounds.ExtentX()[i] * std::fabs(plane[0])
+            + bounds.ExtentY()[i] * std::fabs(plane[1])
+            + bounds.ExtentZ()[i] * std::fabs(plane[2]);
+        float reach = boxReach < bounds.Radius()[i] ? boxReach : bounds.Radius()[i];
+
+        if (dist + reach < 0.0f) return false;
+    }
+    return true;
+}
+
+static size_t cull_scalar(const FRUSTUM_PLANES& frustum, const CullingBounds& bounds,
+    size_t begin, size_t end, uint32_t* pOut)
+{
+    size_t written = 0;
+    for (size_t i = begin; i < end; i++)
+    {
+        pOut[written] = static_cast<uint32_t>(i);
+        written += cull_one(frustum, bounds, i) ? 1 : 0;
+    }
+    return written;
+}
+
+#ifdef FRUSTUM_CULL_SIMD
+
+static size_t cull_sse(const FRUSTUM_PLANES& frustum, const CullingBounds& bounds,
+    size_t begin, size_t end, uint32_t* pOut)
+{
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 zero = _mm_setzero_ps();
+
+    size_t written = 0;
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4)
+    {
+        __m128 cx = _mm_loadu_ps(bounds.CenterX() + i);
+        __m128 cy = _mm_loadu_ps(bounds.CenterY() + i);
+        __m128 cz = _mm_loadu_ps(bounds.CenterZ() + i);
+        __m128 ex = _mm_loadu_ps(bounds.ExtentX() + i);
+        __m128 ey = _mm_loadu_ps(bounds.ExtentY() + i);
+        __m128 ez = _mm_loadu_ps(bounds.ExtentZ() + i);
+        __m128 r = _mm_loadu_ps(bounds.Radius() + i);
+
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < 6; p++)
+        {
+            const float* plane = frustum.Planes[p];
+            __m128 nx = _mm_set1_ps(plane[0]);
+            __m128 ny = _mm_set1_ps(plane[1]);
+            __m128 nz = _mm_set1_ps(plane[2]);
+
+            __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, nx), _mm_mul_ps(cy, ny)),
+                _mm_add_ps(_mm_mul_ps(cz, nz), _mm_set1_ps(plane[3])));
+
+            __m128 boxReach = _mm_add_ps(_mm_add_ps(
+                _mm_mul_ps(ex, _mm_andnot_ps(signMask, nx)),
+                _mm_mul_ps(ey, _mm_andnot_ps(signMask, ny))),
+                _mm_mul_ps(ez, _mm_andnot_ps(signMask, nz)));
+
+            __m128 reach = _mm_min_ps(boxReach, r);
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(dist, reach), zero));
+        }
+
+        // Branchless compaction
+        int mask = _mm_movemask_ps(inside);
+        for (int lane = 0; lane < 4; lane++)
+        {
+            pOut[written] = static_cast<uint32_t>(i + lane);
+            written += (mask >> lane) & 1;
+        }
+    }
+
+    return written + cull_scalar(frustum, bounds, i, end, pOut + written);
+}
+
+#endif
+
+#ifdef FRUSTUM_CULL_AVX
+
+AVX_TARGET
+static size_t cull_avx(const FRUSTUM_PLANES& frustum, const CullingBounds& bounds,
+    size_t begin, size_t end, uint32_t* pOut)
+{
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+
+    // Plane components broadcast once for the whole range
+    __m256 nx[6], ny[6], nz[6], nd[6], ax[6], ay[6], az[6];
+    for (int p = 0; p < 6; p++)
+    {
+        const float* plane = frustum.Planes[p];
+        nx[p] = _mm256_set1_ps(plane[0]);
+        ny[p] = _mm256_set1_ps(plane[1]);
+        nz[p] = _mm256_set1_ps(plane[2]);
+        nd[p] = _mm256_set1_ps(plane[3]);
+        ax[p] = _mm256_andnot_ps(signMask, nx[p]);
+        ay[p] = _mm256_andnot_ps(signMask, ny[p]);
+        az[p] = _mm256_andnot_ps(signMask, nz[p]);
+    }
+
+    size_t written = 0;
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8)
+    {
+        __m256 cx = _mm256_loadu_ps(bounds.CenterX() + i);
+        __m256 cy = _mm256_loadu_ps(bounds.CenterY() + i);
+        __m256 cz = _mm256_loadu_ps(bounds.CenterZ() + i);
+        __m256 ex = _mm256_loadu_ps(bounds.ExtentX() + i);
+        __m256 ey = _mm256_loadu_ps(bounds.ExtentY() + i);
+        __m256 ez = _mm256_loadu_ps(bounds.ExtentZ() + i);
+        __m256 r = _mm256_loadu_ps(bounds.Radius() + i);
+
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p = 0; p < 6; p++)
+        {
+            __m256 dist = _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(cx, nx[p]), _mm256_mul_ps(cy, ny[p])),
+                _mm256_add_ps(_mm256_mul_ps(cz, nz[p]), nd[p]));
+
+            __m256 boxReach = _mm256_add_ps(_mm256_add_ps(
+                _mm256_mul_ps(ex, ax[p]), _mm256_mul_ps(ey, ay[p])),
+                _mm256_mul_ps(ez, az[p]));
+
+            __m256 reach = _mm256_min_ps(boxReach, r);
+            inside = _mm256_and_ps(inside,
+                _mm256_cmp_ps(_mm256_add_ps(dist, reach), _mm256_setzero_ps(), _CMP_GE_OQ));
+        }
+
+        // Branchless compaction
+        int mask = _mm256_movemask_ps(inside);
+        for (int lane = 0; lane < 8; lane++)
+        {
+            pOut[written] = static_cast<uint32_t>(i + lane);
+            written += (mask >> lane) & 1;
+        }
+    }
+
+    return written + cull_scalar(frustum, bounds, i, end, pOut + written);
+}
+
+static bool cpu_has_avx()
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    // The OS has to save YMM registers on context switches
+    return osxsave && avx && (_xgetbv(0) & 6) == 6;
+#else
+    return __builtin_cpu_supports("avx") != 0;
+#endif
+}
+
+#endif
+
+static CullKernel select_kernel()
+{
+#if defined(FRUSTUM_CULL_AVX)
+    if (cpu_has_avx()) return cull_avx;
+    return cull_sse;
+#elif defined(FRUSTUM_CULL_SIMD)
+    return cull_sse;
+#else
+    return cull_scalar;
+#endif
+}
+
+static const CullKernel gCullKernel = select_kernel();
+
+bool FrustumCuller::UsesAVX()
+{
+#ifdef FRUSTUM_CULL_AVX
+    return gCullKernel == cull_avx;
+#else
+    return false;
+#endif
+}
+
+FrustumCuller::FrustumCuller(JobSystem* pJobs)
+    : m_pJobs(pJobs)
+{
+}
+
+void FrustumCuller::Cull(const FRUSTUM_PLANES& frustum, const CullingBounds& bounds,
+    std::vector<uint32_t>& visible)
+{
+    const size_t count = bounds.Size();
+    visible.resize(count);
+
+    size_t ranges = count / MinBoundsPerThread;
+    if (m_pJobs == nullptr) ranges = 1;
+    else if (ranges > m_pJobs->ThreadCount()) ranges = m_pJobs->ThreadCount();
+    if (ranges <= 1)
+    {
+        visible.resize(gCullKernel(frustum, bounds, 0, count, visible.data()));
+        return;
+    }
+
+    // Ranges are multiples of 8 so that only the last one has a scalar tail
+    size_t rangeSize = ((count + ranges - 1) / ranges + 7) & ~static_cast<size_t>(7);
+    ranges = (count + rangeSize - 1) / rangeSize;
+
+    m_rangeVisible.resize(ranges - 1);
+    std::vector<size_t> written(ranges, 0);
+
+    // One job per range, the first range goes straight into the output
+    m_pJobs->ParallelFor(0, static_cast<uint32_t>(ranges), 1,
+        [this, &frustum, &bounds, &written, &visible, rangeSize, count](uint32_t first, uint32_t last)
+        {
+            for (uint32_t r = first; r < last; r++)
+            {
+                size_t begin = r * rangeSize;
+                size_t end = begin + rangeSize < count ? begin + rangeSize : count;
+
+                uint32_t* pOut = visible.data();
+                if (r > 0)
+                {
+                    m_rangeVisible[r - 1].resize(end - begin);
+                    pOut = m_rangeVisible[r - 1].data();
+                }
+                written[r] = gCullKernel(frustum, bounds, begin, end, pOut);
+            }
+        });
+
+    // Append the other ranges in order
+    size_t total = written[0];
+    for (size_t t = 1; t < ranges; t++)
+    {
+        const std::vector<uint32_t>& out = m_rangeVisible[t - 1];
+        for (size_t k = 0; k < written[t]; k++) visible[total + k] = out[k];
+        total += written[t];
+    }
+    visible.resize(total);
+}
@@ -0,0 +1,85 @@
+/*****************************************************************//**
+ * \file   frustum_cull.h
+ * \brief  Frustum culling of bounding volumes in SoA layout
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "bounds.h"
+#include "job_system.h"
+
+// Six normalized planes (a, b, c, d). A point p is inside when
+// a*p.x + b*p.y + c*p.z + d >= 0 for every plane.
+struct FRUSTUM_PLANES
+{
+	float Planes[6][4];
+};
+
+/**
+ * Extracts frustum planes from a view-projection matrix in row-vector
+ * convention (DirectXMath, not transposed), D3D depth range [0, 1].
+ *
+ * \param viewProj 4x4 row-major matrix
+ */
+FRUSTUM_PLANES ExtractFrustumPlanes(const float viewProj[16]);
+
+/**
+ * Bounding volumes stored as separate arrays per component, so that a group
+ * of 8 bounds loads into SIMD registers without shuffles.
+ */
+class CullingBounds
+{
+public:
+	void Clear();
+	void Reserve(size_t count);
+
+	// Appends bounds, returns their index
+	uint32_t Add(const MESH_BOUNDS& bounds);
+	void Set(uint32_t index, const MESH_BOUNDS& bounds);
+
+	size_t Size() const { return m_radius.size(); }
+
+	const float* CenterX() const { return m_centerX.data(); }
+	const float* CenterY() const { return m_centerY.data(); }
+	const float* CenterZ() const { return m_centerZ.data(); }
+	const float* ExtentX() const { return m_extentX.data(); }
+	const float* ExtentY() const { return m_extentY.data(); }
+	const float* ExtentZ() const { return m_extentZ.data(); }
+	const float* Radius() const { return m_radius.data(); }
+
+private:
+	std::vector<float> m_centerX, m_centerY, m_centerZ;
+	std::vector<float> m_extentX, m_extentY, m_extentZ;
+	std::vector<float> m_radius;
+};
+
+/**
+ * Tests bounds against a frustum and produces a compact list of visible indices.
+ *
+ * Each bound is rejected if it is outside of any plane by either its sphere or
+ * its box, whichever is tighter. Bounds are tested 8 at a time with AVX when the
+ * CPU supports it (4 at a time with SSE otherwise), and large sets are split
+ * into ranges run as jobs. The output is in ascending index order regardless of the
+ * number of threads.
+ */
+class FrustumCuller
+{
+public:
+	// Without a job system, culls on the calling thread alone
+	explicit FrustumCuller(JobSystem* pJobs = nullptr);
+
+	void Cull(const FRUSTUM_PLANES& frustum, const CullingBounds& bounds,
+		std::vector<uint32_t>& visible);
+
+	// Whether the 8-wide kernel is used on this CPU
+	static bool UsesAVX();
+
+private:
+	JobSystem* m_pJobs = nullptr;
+	std::vector<std::vector<uint32_t>> m_rangeVisible;	// Per range after the first
+};
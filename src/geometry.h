@@ -10,6 +10,8 @@
 #include <vector>
 
 #include "d3dUtil.h"
+#include "fencewait.h"
+#include "job_system.h"
 #include "structures.h"
 
 // Class defining a mesh which could consist of multiple
@@ -34,6 +36,7 @@ private:
     std::vector<uint16_t> mRawIndexData;
 
     std::vector<SubmeshGeometry> mSubmeshes;
+    std::vector<std::vector<SubmeshGeometry>> mChunks;     // Per submesh, empty if not split
 
     // Pointers to D3D interfaces
     ID3D12Device* mpd3dDevice = nullptr;
@@ -57,6 +60,7 @@ public:
     void ConstructGeometry(Microsoft::WRL::ComPtr<ID3D12Resource>& pVertexBufferResource,
         Microsoft::WRL::ComPtr<ID3D12Resource>& pIndexBufferResource,
         ID3D12CommandQueue* pQueue,
+        FenceWaiter* pFenceWaiter,
         ID3D12Fence* pFence,
         UINT64& currentFence)
     {
@@ -82,19 +86,7 @@ public:
         currentFence++;
         pQueue->Signal(pFence, currentFence);
 
-        if (pFence->GetCompletedValue() < currentFence)
-        {
-            HANDLE eventHandle = CreateEventEx(nullptr, nullptr, false,
-                EVENT_ALL_ACCESS);
-
-            // Fire event when GPU hits current fence
-            ThrowIfFailed(pFence->SetEventOnCompletion(currentFence, eventHandle));
-
-            if (eventHandle == nullptr) return;
-
-            WaitForSingleObject(eventHandle, INFINITE);
-            CloseHandle(eventHandle);
-        }
+        pFenceWaiter->Wait(pFence, currentFence, STALL_SITE_GEOMETRY_UPLOAD);
 
         VBBufferAddress = pVertexBufferResource->GetGPUVirtualAddress();
         IBBufferAddress = pIndexBufferResource->GetGPUVirtualAddress();
@@ -108,6 +100,11 @@ public:
         return mSubmeshes;
     }
 
+    const std::vector<std::vector<SubmeshGeometry>> GetChunks()const
+    {
+        return mChunks;
+    }
+
 private:
     // Takes raw vertex and index data and returns associated submesh in common buffer
     void AddVertexData(std::vector<T> vertices, std::vector<uint16_t> indices)
@@ -116,8 +113,10 @@ private:
         submesh.BaseVertexLocation = static_cast<INT>(mRawVertexData.size());
         submesh.StartIndexLocation = static_cast<UINT>(mRawIndexData.size());
         submesh.IndexCount = static_cast<UINT>(indices.size());
+        submesh.Bounds = ComputeBounds(PositionData(vertices), vertices.size(), sizeof(T));
 
         mSubmeshes.push_back(submesh);
+        mChunks.emplace_back();
 
         // Merge the vectors
         mRawVertexData.insert(std::end(mRawVertexData),
@@ -127,6 +126,39 @@ private:
             std::begin(indices), std::end(indices));
     }
 
+    // Same as AddVertexData, but also splits the submesh into chunks that can be
+    // culled separately. Chunk i uses the next chunkIndexCounts[i] indices.
+    void AddChunkedVertexData(std::vector<T> vertices, std::vector<uint16_t> indices,
+        const std::vector<UINT>& chunkIndexCounts)
+    {
+        UINT startIndex = static_cast<UINT>(mRawIndexData.size());
+        INT baseVertex = static_cast<INT>(mRawVertexData.size());
+
+        std::vector<SubmeshGeometry> chunks;
+        UINT offset = 0;
+        for (UINT indexCount : chunkIndexCounts)
+        {
+            SubmeshGeometry chunk = { };
+            chunk.BaseVertexLocation = baseVertex;
+            chunk.StartIndexLocation = startIndex + offset;
+            chunk.IndexCount = indexCount;
+            chunk.Bounds = ComputeBounds(PositionData(vertices), sizeof(T),
+                indices.data() + offset, indexCount);
+
+            chunks.push_back(chunk);
+            offset += indexCount;
+        }
+
+        AddVertexData(std::move(vertices), std::move(indices));
+        mChunks.back() = std::move(chunks);
+    }
+
+    // Vertex types used with the uploader start with float3 position
+    static const float* PositionData(const std::vector<T>& vertices)
+    {
+        return reinterpret_cast<const float*>(vertices.data());
+    }
+
 public:
     // Get binding of the vertex buffer to the pipeline
     D3D12_VERTEX_BUFFER_VIEW VertexBufferView()const
@@ -162,13 +194,14 @@ private:
     }
 
     friend void CreateGrid(StaticGeometryUploader<Vertex>* meshGeometry, UINT numRows, float cellLength);
-    friend void CreateTerrain(StaticGeometryUploader<Vertex>* meshGeometry, std::string filename);
+    friend void CreateTerrain(StaticGeometryUploader<Vertex>* meshGeometry, std::string filename, JobSystem* pJobs);
     friend void CreatePlane(StaticGeometryUploader<Vertex>* meshGeometry, UINT n, UINT m, float width, float depth);
 
 };
 
 void CreateGrid(StaticGeometryUploader<Vertex>* meshGeometry, UINT numRows, float cellLength);
-void CreateTerrain(StaticGeometryUploader<Vertex>* meshGeometry, std::string filename);
+// Rows of vertices are generated as jobs
+void CreateTerrain(StaticGeometryUploader<Vertex>* meshGeometry, std::string filename, JobSystem* pJobs);
 void CreatePlane(StaticGeometryUploader<Vertex>* meshGeometry, UINT n, UINT m, float width, float depth);
 
 
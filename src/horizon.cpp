@@ -0,0 +1,284 @@
+/*****************************************************************//**
+ * \file   horizon.cpp
+ * \brief  Definition of HeightPyramid and HorizonCuller
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include <cmath>
+#include <limits>
+
+#include "horizon.h"
+
+static const float Pi = 3.14159265358979f;
+static const float NoHorizon = -std::numeric_limits<float>::infinity();
+
+// Sweep step along a sector, in arc widths and at least in heightfield samples
+static const float StepArcs = 2.0f;
+static const float MinStepSamples = 4.0f;
+
+HeightPyramid::HeightPyramid(const uint8_t* heights, uint32_t rows, uint32_t cols, uint32_t rowPitch,
+    float originX, float originZ, float dx, float dz,
+    float heightScale, float heightOffset)
+    : m_originX(originX), m_originZ(originZ), m_dx(dx), m_dz(dz),
+    m_invDx(1.0f / dx), m_invDz(1.0f / dz),
+    m_heightScale(heightScale), m_heightOffset(heightOffset)
+{
+    if (rows == 0 || cols == 0) return;
+
+    Level base;
+    base.Rows = rows;
+    base.Cols = cols;
+    base.Min.resize(static_cast<size_t>(rows) * cols);
+    for (uint32_t r = 0; r < rows; r++)
+    {
+        for (uint32_t c = 0; c < cols; c++)
+        {
+            base.Min[r * cols + c] = heights[r * rowPitch + c];
+        }
+    }
+    base.Max = base.Min;
+    m_levels.push_back(std::move(base));
+
+    // Each level keeps the extremes of the 2x2 texels below it, odd edges fold in
+    while (m_levels.back().Rows > 1 || m_levels.back().Cols > 1)
+    {
+        const Level& fine = m_levels.back();
+
+        Level coarse;
+        coarse.Rows = (fine.Rows + 1) / 2;
+        coarse.Cols = (fine.Cols + 1) / 2;
+        coarse.Min.resize(static_cast<size_t>(coarse.Rows) * coarse.Cols);
+        coarse.Max.resize(coarse.Min.size());
+
+        for (uint32_t r = 0; r < coarse.Rows; r++)
+        {
+            uint32_t r0 = r * 2;
+            uint32_t r1 = r0 + 1 < fine.Rows ? r0 + 1 : r0;
+
+            for (uint32_t c = 0; c < coarse.Cols; c++)
+            {
+                uint32_t c0 = c * 2;
+                uint32_t c1 = c0 + 1 < fine.Cols ? c0 + 1 : c0;
+
+                uint8_t lo = fine.Min[r0 * fine.Cols + c0];
+                uint8_t hi = fine.Max[r0 * fine.Cols + c0];
+                const uint32_t corners[3] = { r0 * fine.Cols + c1, r1 * fine.Cols + c0, r1 * fine.Cols + c1 };
+                for (uint32_t i : corners)
+                {
+                    if (fine.Min[i] < lo) lo = fine.Min[i];
+                    if (fine.Max[i] > hi) hi = fine.Max[i];
+                }
+
+                coarse.Min[r * coarse.Cols + c] = lo;
+                coarse.Max[r * coarse.Cols + c] = hi;
+            }
+        }
+
+        m_levels.push_back(std::move(coarse));
+    }
+}
+
+bool HeightPyramid::HeightRange(float minX, float minZ, float maxX, float maxZ, float& low, float& high) const
+{
+    if (m_levels.empty()) return false;
+
+    const Level& base = m_levels[0];
+
+    // Samples around the rectangle; the surface inside it is interpolated from them
+    float fc0 = (minX - m_originX) * m_invDx;
+    float fc1 = (maxX - m_originX) * m_invDx;
+    float fr0 = (m_originZ - maxZ) * m_invDz;
+    float fr1 = (m_originZ - minZ) * m_invDz;
+    if (!(fc0 >= 0.0f && fr0 >= 0.0f) || fc1 > base.Cols - 1 || fr1 > base.Rows - 1) return false;
+
+    // Non-negative here, so truncation is floor
+    uint32_t c0 = static_cast<uint32_t>(fc0), c1 = static_cast<uint32_t>(std::ceil(fc1));
+    uint32_t r0 = static_cast<uint32_t>(fr0), r1 = static_cast<uint32_t>(std::ceil(fr1));
+
+    // Coarsest level where the samples span at most 2x2 texels
+    uint32_t span = c1 - c0 > r1 - r0 ? c1 - c0 : r1 - r0;
+    uint32_t level = 0;
+    while ((span >> level) != 0 && level + 1 < m_levels.size()) level++;
+
+    c0 >>= level; c1 >>= level;
+    r0 >>= level; r1 >>= level;
+
+    const Level& texels = m_levels[level];
+    uint8_t lo = 255, hi = 0;
+    for (uint32_t r = r0; r <= r1; r++)
+    {
+        for (uint32_t c = c0; c <= c1; c++)
+        {
+            if (texels.Min[r * texels.Cols + c] < lo) lo = texels.Min[r * texels.Cols + c];
+            if (texels.Max[r * texels.Cols + c] > hi) hi = texels.Max[r * texels.Cols + c];
+        }
+    }
+
+    low = lo * m_heightScale + m_heightOffset;
+    high = hi * m_heightScale + m_heightOffset;
+    return true;
+}
+
+HorizonCuller::HorizonCuller(const HeightPyramid* pPyramid, uint32_t sectorCount, uint32_t ringCount)
+    : m_pPyramid(pPyramid),
+    m_sectorCount(sectorCount > 4 ? sectorCount : 4),
+    m_ringCount(ringCount > 1 ? ringCount : 1)
+{
+    m_horizon.assign(static_cast<size_t>(m_sectorCount) * m_ringCount, NoHorizon);
+}
+
+void HorizonCuller::Update(float eyeX, float eyeY, float eyeZ)
+{
+    m_eye[0] = eyeX;
+    m_eye[1] = eyeY;
+    m_eye[2] = eyeZ;
+
+    // Rings reach the farthest corner of the terrain
+    const HeightPyramid& pyramid = *m_pPyramid;
+    float x0 = pyramid.OriginX() - eyeX;
+    float x1 = pyramid.OriginX() + (pyramid.LevelCols(0) - 1) * pyramid.Dx() - eyeX;
+    float z0 = pyramid.OriginZ() - eyeZ;
+    float z1 = pyramid.OriginZ() - (pyramid.LevelRows(0) - 1) * pyramid.Dz() - eyeZ;
+    float farX = std::fabs(x0) > std::fabs(x1) ? std::fabs(x0) : std::fabs(x1);
+    float farZ = std::fabs(z0) > std::fabs(z1) ? std::fabs(z0) : std::fabs(z1);
+
+    m_maxDistance = std::sqrt(farX * farX + farZ * farZ);
+    m_ringWidth = m_maxDistance / m_ringCount;
+
+    for (uint32_t sector = 0; sector < m_sectorCount; sector++)
+    {
+        sweep_sector(sector);
+    }
+}
+
+void HorizonCuller::sweep_sector(uint32_t sector)
+{
+    const float sectorAngle = 2.0f * Pi / m_sectorCount;
+    const float angle0 = sector * sectorAngle - Pi;
+    const float angle1 = angle0 + sectorAngle;
+    const float cos0 = std::cos(angle0), sin0 = std::sin(angle0);
+    const float cos1 = std::cos(angle1), sin1 = std::sin(angle1);
+    const float cosMid = std::cos(angle0 + sectorAngle * 0.5f), sinMid = std::sin(angle0 + sectorAngle * 0.5f);
+
+    // How far the arc bulges past the chord, per unit of distance
+    const float sagitta = 1.0f - std::cos(sectorAngle * 0.5f);
+
+    float* horizon = &m_horizon[static_cast<size_t>(sector) * m_ringCount];
+    for (uint32_t ring = 0; ring < m_ringCount; ring++) horizon[ring] = NoHorizon;
+
+    const float sampleSpacing = m_pPyramid->Dx() > m_pPyramid->Dz() ? m_pPyramid->Dx() : m_pPyramid->Dz();
+    const float minStep = sampleSpacing * MinStepSamples;
+
+    for (float d = sampleSpacing; d < m_maxDistance; )
+    {
+        // Every ray of the sector crosses the arc at distance d, so the lowest
+        // terrain around the whole arc lower-bounds what each ray meets there
+        float ax[3] = { cos0 * d, cos1 * d, cosMid * d };
+        float az[3] = { sin0 * d, sin1 * d, sinMid * d };
+        float minX = ax[0], maxX = ax[0], minZ = az[0], maxZ = az[0];
+        for (int i = 1; i < 3; i++)
+        {
+            if (ax[i] < minX) minX = ax[i];
+            if (ax[i] > maxX) maxX = ax[i];
+            if (az[i] < minZ) minZ = az[i];
+            if (az[i] > maxZ) maxZ = az[i];
+        }
+        float pad = d * sagitta;
+
+        float low, high;
+        if (m_pPyramid->HeightRange(m_eye[0] + minX - pad, m_eye[2] + minZ - pad,
+            m_eye[0] + maxX + pad, m_eye[2] + maxZ + pad, low, high))
+        {
+            // Counts for everything at least this far away
+            uint32_t ring = static_cast<uint32_t>(std::ceil(d / m_ringWidth));
+            if (ring < m_ringCount)
+            {
+                float slope = (low - m_eye[1]) / d;
+                if (slope > horizon[ring]) horizon[ring] = slope;
+            }
+        }
+
+        // Steps grow with the arc, so the far terrain is read from coarse levels.
+        // Terrain skipped between steps only makes the horizon lower.
+        float step = d * sectorAngle * StepArcs;
+        d += step > minStep ? step : minStep;
+    }
+
+    for (uint32_t ring = 1; ring < m_ringCount; ring++)
+    {
+        if (horizon[ring - 1] > horizon[ring]) horizon[ring] = horizon[ring - 1];
+    }
+}
+
+bool HorizonCuller::test_box(float minX, float minZ, float maxX, float maxZ, float topY) const
+{
+    const float ex = m_eye[0], ez = m_eye[2];
+
+    // The eye above the box sees it from every direction
+    if (ex >= minX && ex <= maxX && ez >= minZ && ez <= maxZ) return true;
+
+    float nearX = ex < minX ? minX - ex : (ex > maxX ? ex - maxX : 0.0f);
+    float nearZ = ez < minZ ? minZ - ez : (ez > maxZ ? ez - maxZ : 0.0f);
+    float farX = std::fabs(minX - ex) > std::fabs(maxX - ex) ? std::fabs(minX - ex) : std::fabs(maxX - ex);
+    float farZ = std::fabs(minZ - ez) > std::fabs(maxZ - ez) ? std::fabs(minZ - ez) : std::fabs(maxZ - ez);
+    float nearDistance = std::sqrt(nearX * nearX + nearZ * nearZ);
+    float farDistance = std::sqrt(farX * farX + farZ * farZ);
+
+    // Steepest line from the eye to any point of the box top
+    float rise = topY - m_eye[1];
+    float slope = rise / (rise >= 0.0f ? nearDistance : farDistance);
+
+    uint32_t ring = static_cast<uint32_t>(nearDistance / m_ringWidth);
+    if (ring >= m_ringCount) ring = m_ringCount - 1;
+
+    // Angular span of the corners around the direction of the center
+    float centerAngle = std::atan2((minZ + maxZ) * 0.5f - ez, (minX + maxX) * 0.5f - ex);
+    const float cornersX[4] = { minX, maxX, minX, maxX };
+    const float cornersZ[4] = { minZ, minZ, maxZ, maxZ };
+    float lo = 0.0f, hi = 0.0f;
+    for (int i = 0; i < 4; i++)
+    {
+        float delta = std::atan2(cornersZ[i] - ez, cornersX[i] - ex) - centerAngle;
+        if (delta > Pi) delta -= 2.0f * Pi;
+        if (delta < -Pi) delta += 2.0f * Pi;
+        if (delta < lo) lo = delta;
+        if (delta > hi) hi = delta;
+    }
+
+    const float sectorsPerRadian = m_sectorCount / (2.0f * Pi);
+    int first = static_cast<int>(std::floor((centerAngle + lo + Pi) * sectorsPerRadian));
+    int last = static_cast<int>(std::floor((centerAngle + hi + Pi) * sectorsPerRadian));
+
+    // Hidden only if every covered sector has higher terrain in front
+    const int sectorCount = static_cast<int>(m_sectorCount);
+    for (int s = first; s <= last; s++)
+    {
+        int sector = ((s % sectorCount) + sectorCount) % sectorCount;
+        if (!(slope < m_horizon[static_cast<size_t>(sector) * m_ringCount + ring])) return true;
+    }
+    return false;
+}
+
+bool HorizonCuller::IsVisible(const MESH_BOUNDS& bounds) const
+{
+    return test_box(bounds.Center[0] - bounds.Extents[0], bounds.Center[2] - bounds.Extents[2],
+        bounds.Center[0] + bounds.Extents[0], bounds.Center[2] + bounds.Extents[2],
+        bounds.Center[1] + bounds.Extents[1]);
+}
+
+void HorizonCuller::Cull(const CullingBounds& bounds, std::vector<uint32_t>& visible) const
+{
+    size_t kept = 0;
+    for (uint32_t index : visible)
+    {
+        float cx = bounds.CenterX()[index], cz = bounds.CenterZ()[index];
+        float ex = bounds.ExtentX()[index], ez = bounds.ExtentZ()[index];
+
+        if (test_box(cx - ex, cz - ez, cx + ex, cz + ez, bounds.CenterY()[index] + bounds.ExtentY()[index]))
+        {
+            visible[kept++] = index;
+        }
+    }
+    visible.resize(kept);
+}
@@ -0,0 +1,113 @@
+/*****************************************************************//**
+ * \file   horizon.h
+ * \brief  Horizon-based occlusion for heightfield terrain
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "bounds.h"
+#include "frustum_cull.h"
+
+/**
+ * Mip chain of a heightfield keeping both the lowest and the highest height
+ * under every texel. Sample (row, col) of level 0 is at
+ * x = originX + col * dx, z = originZ - row * dz, the same layout as
+ * BuildHeightfieldOccluder.
+ */
+class HeightPyramid
+{
+public:
+	HeightPyramid(const uint8_t* heights, uint32_t rows, uint32_t cols, uint32_t rowPitch,
+		float originX, float originZ, float dx, float dz,
+		float heightScale, float heightOffset);
+
+	uint32_t LevelCount() const { return static_cast<uint32_t>(m_levels.size()); }
+	uint32_t LevelRows(uint32_t level) const { return m_levels[level].Rows; }
+	uint32_t LevelCols(uint32_t level) const { return m_levels[level].Cols; }
+
+	float MinHeight(uint32_t level, uint32_t row, uint32_t col) const
+	{ return m_levels[level].Min[row * m_levels[level].Cols + col] * m_heightScale + m_heightOffset; }
+	float MaxHeight(uint32_t level, uint32_t row, uint32_t col) const
+	{ return m_levels[level].Max[row * m_levels[level].Cols + col] * m_heightScale + m_heightOffset; }
+
+	/**
+	 * Bounds the terrain over a world-space rectangle from at most 2x2 texels of
+	 * one level, so low may be lower and high higher than the exact values.
+	 *
+	 * \return false if the rectangle is not entirely over the heightfield
+	 */
+	bool HeightRange(float minX, float minZ, float maxX, float maxZ, float& low, float& high) const;
+
+	float OriginX() const { return m_originX; }
+	float OriginZ() const { return m_originZ; }
+	float Dx() const { return m_dx; }
+	float Dz() const { return m_dz; }
+
+private:
+	struct Level
+	{
+		uint32_t Rows = 0;
+		uint32_t Cols = 0;
+		std::vector<uint8_t> Min;		// Raw heights, scaled on read
+		std::vector<uint8_t> Max;
+	};
+
+	std::vector<Level> m_levels;
+
+	float m_originX = 0.0f;
+	float m_originZ = 0.0f;
+	float m_dx = 1.0f;
+	float m_dz = 1.0f;
+	float m_invDx = 1.0f;
+	float m_invDz = 1.0f;
+	float m_heightScale = 1.0f;
+	float m_heightOffset = 0.0f;
+};
+
+/**
+ * Occlusion test against the terrain horizon seen from the camera.
+ *
+ * Space around the camera is divided into angular sectors. For each sector the
+ * terrain is swept outward, taking coarser pyramid levels as the sector widens,
+ * and the steepest elevation slope seen so far is stored per distance ring.
+ * Bounds are hidden if, in every sector they cover, their top is below the
+ * horizon formed by terrain nearer than they are.
+ *
+ * Occluding terrain is taken from the min-height mips over the whole width of
+ * the sector, so the horizon is never higher than the real one and the test
+ * only ever errs towards visible.
+ */
+class HorizonCuller
+{
+public:
+	HorizonCuller(const HeightPyramid* pPyramid, uint32_t sectorCount = 128, uint32_t ringCount = 128);
+
+	// Sweeps the horizon for a new eye position
+	void Update(float eyeX, float eyeY, float eyeZ);
+
+	bool IsVisible(const MESH_BOUNDS& bounds) const;
+
+	// Removes hidden entries from a list of indices into bounds
+	void Cull(const CullingBounds& bounds, std::vector<uint32_t>& visible) const;
+
+private:
+	bool test_box(float minX, float minZ, float maxX, float maxZ, float topY) const;
+	void sweep_sector(uint32_t sector);
+
+	const HeightPyramid* m_pPyramid = nullptr;
+	uint32_t m_sectorCount = 0;
+	uint32_t m_ringCount = 0;
+	float m_ringWidth = 1.0f;
+	float m_maxDistance = 0.0f;
+
+	float m_eye[3] = { };
+
+	// Horizon slope per [sector][ring]: terrain closer than the ring's inner
+	// radius rises at least this steeply above the eye
+	std::vector<float> m_horizon;
+};
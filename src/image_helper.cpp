@@ -10,9 +10,14 @@
 #include <fstream>
 #include <iostream>
 #include <cstring>
+#include <vector>
 
 #include "image_helper.h"
 #include "memory_util.h"
+#include "perf_counters.h"
+
+// Rows converted by one job
+static const uint32_t RowsPerJob = 64;
 
 static int padded_row_size_bits(uint32_t row_size_bits)
 {
@@ -163,8 +168,9 @@ int image_base::read_bmp(const char* src)
     in.read((char*)ptr, 2);
     m_colorMode = (IMAGE_COLOR_MODE)(*ptr / 8);
 
-    // Get row size
+    // Get row and image size
     m_rowByteSize = padded_row_size_bytes(m_width * m_colorMode);
+    m_rawByteSize = m_rowByteSize * m_height;
 
     delete ptr;
 
@@ -264,7 +270,7 @@ int image_base::write_bmp(const char* dst) const
  * 
  * \param mode image color mode to change
  */
-void image_base::set_color_mode(IMAGE_COLOR_MODE mode)
+void image_base::set_color_mode(IMAGE_COLOR_MODE mode, JobSystem* pJobs)
 {
     // If the mode is not changed, return
     if (mode == m_colorMode) return;
@@ -278,33 +284,39 @@ void image_base::set_color_mode(IMAGE_COLOR_MODE mode)
     // Allocate memory for new raw color data
     void* pNewRaw = malloc(newRawByteSize);
 
-    for (uint32_t row = 0; row < m_height; row++)
+    // Rows are independent, each writes its own row of the new memory
+    auto convertRows = [this, mode, pNewRaw, newRowByteSize](uint32_t first, uint32_t last)
     {
-        static void* currentRow = pNewRaw;
-        for (uint32_t col = 0; col < m_width; col++)
-        {
-            // Static variable declarations
-            static Color3 clr24;
-            static uint8_t clr8;
+        PerfZone perfZone("set_color_mode", static_cast<uint64_t>(last - first) * m_width);
 
-            switch (mode)
+        for (uint32_t row = first; row < last; row++)
+        {
+            void* currentRow = (void*)((uint64_t)pNewRaw + (uint64_t)row * newRowByteSize);
+            for (uint32_t col = 0; col < m_width; col++)
             {
-            case IMAGE_COLOR_MODE_GRAYSCALE:
-                // Calculate grayscale color as mean of other colors
-                clr24 = get_color24(row, col);
-                clr8 = (clr24.r + clr24.g + clr24.b) / 3;
-                *(uint8_t*)((uint64_t)currentRow + col) = clr8;
-                break;
-            case IMAGE_COLOR_MODE_RGB:
-                clr8 = get_color8(row, col);
-                clr24 = { clr8, clr8, clr8 };
-                *(Color3*)((uint64_t)currentRow + (uint64_t)col * 3ull) = clr24;
-                break;
+                Color3 clr24;
+                uint8_t clr8;
+
+                switch (mode)
+                {
+                case IMAGE_COLOR_MODE_GRAYSCALE:
+                    // Calculate grayscale color as mean of other colors
+                    clr24 = get_color24(row, col);
+                    clr8 = (clr24.r + clr24.g + clr24.b) / 3;
+                    *(uint8_t*)((uint64_t)currentRow + col) = clr8;
+                    break;
+                case IMAGE_COLOR_MODE_RGB:
+                    clr8 = get_color8(row, col);
+                    clr24 = { clr8, clr8, clr8 };
+                    *(Color3*)((uint64_t)currentRow + (uint64_t)col * 3ull) = clr24;
+                    break;
+                }
             }
-
         }
-        currentRow = (void*)((uint64_t)currentRow + newRowByteSize);
-    }
+    };
+
+    if (pJobs != nullptr) pJobs->ParallelFor(0, m_height, RowsPerJob, convertRows);
+    else convertRows(0, m_height);
 
     // Release current raw memory
     free(m_pRaw);
@@ -378,3 +390,33 @@ image_base::image_base(image_base& other)
         memcpy(other.m_pRaw, m_pRaw, m_rawByteSize);
     }
 }
+
+/**
+ * Converts a depth buffer to grayscale.
+ * 
+ * \param depth depth values in [0, 1], rows top to bottom
+ * \param width width of the buffer
+ * \param height height of the buffer
+ */
+DepthImage::DepthImage(const float* depth, uint32_t width, uint32_t height)
+{
+    uint32_t rowByteSize = padded_row_size_bytes(width);
+    std::vector<uint8_t> pixels(static_cast<size_t>(rowByteSize) * height, 0);
+
+    for (uint32_t row = 0; row < height; row++)
+    {
+        // BMP stores rows bottom to top
+        uint8_t* dst = pixels.data() + static_cast<size_t>(height - 1 - row) * rowByteSize;
+        const float* src = depth + static_cast<size_t>(row) * width;
+
+        for (uint32_t col = 0; col < width; col++)
+        {
+            float d = src[col];
+            if (d < 0.0f) d = 0.0f;
+            if (d > 1.0f) d = 1.0f;
+            dst[col] = static_cast<uint8_t>((1.0f - d) * 255.0f);
+        }
+    }
+
+    read_raw_memory(pixels.data(), width, height, IMAGE_COLOR_MODE_GRAYSCALE);
+}
@@ -8,6 +8,9 @@
 #pragma once
 
 #include <cstdint>
+#include <string>
+
+#include "job_system.h"
 
 enum IMAGE_COLOR_MODE
 {
@@ -38,7 +41,8 @@ protected:
 	int read_bmp(const char* src);
 	int write_bmp(const char* dst) const;
 
-	void set_color_mode(IMAGE_COLOR_MODE mode);
+	// Rows are converted as jobs when a job system is given
+	void set_color_mode(IMAGE_COLOR_MODE mode, JobSystem* pJobs = nullptr);
 
 protected:
 	// Raw image_base memory
@@ -87,4 +91,18 @@ public:
 	{
 		write_bmp("test.bmp");
 	}
+};
+
+// 8-bit .bmp view of a depth buffer, near is white and far is black
+class DepthImage : public image_base
+{
+public:
+	// depth is in [0, 1], rows top to bottom. Width should be a multiple
+	// of 8, as image_base pads rows to 8 bytes.
+	DepthImage(const float* depth, uint32_t width, uint32_t height);
+
+	int Write(const char* filename) const
+	{
+		return write_bmp(filename);
+	}
 };
\ No newline at end of file
@@ -0,0 +1,243 @@
+/*****************************************************************//**
+ * \file   job_system.cpp
+ * \brief  Definition of JobSystem
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include "job_system.h"
+#include "profiler.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Attempts to find a job before a worker goes to sleep
+static const int SpinsBeforeSleep = 64;
+
+// System and index of the calling thread, if it is a worker
+static thread_local const JobSystem* t_pSystem = nullptr;
+static thread_local unsigned t_index = 0;
+
+static bool pin_thread(std::thread& thread, unsigned processor)
+{
+#if defined(_WIN32)
+    if (processor >= sizeof(DWORD_PTR) * 8) return false;
+    DWORD_PTR mask = static_cast<DWORD_PTR>(1) << processor;
+    return SetThreadAffinityMask(thread.native_handle(), mask) != 0;
+#elif defined(__linux__)
+    if (processor >= CPU_SETSIZE) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(processor, &set);
+    return pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0;
+#else
+    (void)thread;
+    (void)processor;
+    return false;
+#endif
+}
+
+JobSystem::JobSystem(unsigned threadCount, bool pinThreads)
+{
+    if (threadCount == 0) threadCount = std::thread::hardware_concurrency();
+    m_threadCount = threadCount > 0 ? threadCount : 1;
+
+    m_workers.reset(new Worker[m_threadCount]);
+
+    m_pinned = pinThreads && m_threadCount > 1;
+    for (unsigned i = 1; i < m_threadCount; i++)
+    {
+        m_threads.emplace_back(&JobSystem::worker_main, this, i);
+        if (pinThreads && !pin_thread(m_threads.back(), i)) m_pinned = false;
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_quit.store(true);
+    }
+    m_wake.notify_all();
+    for (std::thread& thread : m_threads) thread.join();
+}
+
+unsigned JobSystem::ThreadIndex() const
+{
+    return t_pSystem == this ? t_index : 0;
+}
+
+void JobSystem::Run(JobGroup& group, JobFn job)
+{
+    group.m_pending.fetch_add(1);
+
+    Worker& worker = m_workers[ThreadIndex()];
+    {
+        std::lock_guard<std::mutex> lock(worker.Mutex);
+        worker.Jobs.push_back({ std::move(job), &group });
+    }
+
+    // Both counters are sequentially consistent, so either a worker about to
+    // sleep sees the job or this sees the worker and wakes it
+    m_queued.fetch_add(1);
+    if (m_sleeping.load() > 0)
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_wake.notify_one();
+    }
+}
+
+void JobSystem::Wait(JobGroup& group)
+{
+    const unsigned index = ThreadIndex();
+    while (!group.Done())
+    {
+        if (!try_run(index)) std::this_thread::yield();
+    }
+
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(group.m_errorMutex);
+        std::swap(error, group.m_error);
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+void JobSystem::ParallelFor(uint32_t begin, uint32_t end, uint32_t grain, const RangeFn& body)
+{
+    if (begin >= end) return;
+    if (grain == 0) grain = 1;
+
+    // The calling thread takes the first range, so a loop of a single range
+    // never leaves it. Its exceptions wait for the forked halves like any other.
+    JobGroup group;
+    try
+    {
+        split_range(group, begin, end, grain, body);
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(group.m_errorMutex);
+        if (!group.m_error) group.m_error = std::current_exception();
+    }
+    Wait(group);
+}
+
+void JobSystem::split_range(JobGroup& group, uint32_t begin, uint32_t end, uint32_t grain, const RangeFn& body)
+{
+    // Fork the upper half until the rest fits in a range. Halves at the front
+    // of the deque are the largest, and those are what thieves take.
+    while (end - begin > grain)
+    {
+        uint32_t middle = begin + (end - begin) / 2;
+        Run(group, [this, &group, middle, end, grain, &body]()
+            { split_range(group, middle, end, grain, body); });
+        end = middle;
+    }
+    body(begin, end);
+}
+
+JOB_SYSTEM_STATS JobSystem::Stats() const
+{
+    JOB_SYSTEM_STATS stats;
+    for (unsigned i = 0; i < m_threadCount; i++)
+    {
+        stats.Jobs += m_workers[i].Executed.load(std::memory_order_relaxed);
+        stats.Steals += m_workers[i].Stolen.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+void JobSystem::ResetStats()
+{
+    for (unsigned i = 0; i < m_threadCount; i++)
+    {
+        m_workers[i].Executed.store(0, std::memory_order_relaxed);
+        m_workers[i].Stolen.store(0, std::memory_order_relaxed);
+    }
+}
+
+void JobSystem::worker_main(unsigned index)
+{
+    t_pSystem = this;
+    t_index = index;
+    Profiler::Instance().SetThreadName("worker " + std::to_string(index));
+
+    while (true)
+    {
+        bool found = false;
+        for (int spin = 0; spin < SpinsBeforeSleep && !found; spin++)
+        {
+            found = try_run(index);
+            if (!found) std::this_thread::yield();
+        }
+        if (found) continue;
+
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_sleeping.fetch_add(1);
+        m_wake.wait(lock, [this]() { return m_quit.load() || m_queued.load() > 0; });
+        m_sleeping.fetch_sub(1);
+        if (m_quit.load()) return;
+    }
+}
+
+bool JobSystem::try_run(unsigned index)
+{
+    Job job;
+    bool found = false;
+
+    // Own deque, newest first
+    {
+        Worker& own = m_workers[index];
+        std::lock_guard<std::mutex> lock(own.Mutex);
+        if (!own.Jobs.empty())
+        {
+            job = std::move(own.Jobs.back());
+            own.Jobs.pop_back();
+            found = true;
+        }
+    }
+
+    // Other deques, oldest first
+    for (unsigned k = 1; k < m_threadCount && !found; k++)
+    {
+        Worker& victim = m_workers[(index + k) % m_threadCount];
+        std::lock_guard<std::mutex> lock(victim.Mutex);
+        if (!victim.Jobs.empty())
+        {
+            job = std::move(victim.Jobs.front());
+            victim.Jobs.pop_front();
+            found = true;
+            m_workers[index].Stolen.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    if (!found) return false;
+
+    m_queued.fetch_sub(1);
+    execute(index, job);
+    return true;
+}
+
+void JobSystem::execute(unsigned index, Job& job)
+{
+    JobGroup& group = *job.pGroup;
+    try
+    {
+        job.Fn();
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(group.m_errorMutex);
+        if (!group.m_error) group.m_error = std::current_exception();
+    }
+    m_workers[index].Executed.fetch_add(1, std::memory_order_relaxed);
+    job.Fn = nullptr;
+
+    // The waiting thread may destroy the group as soon as this reaches zero
+    group.m_pending.fetch_sub(1, std::memory_order_release);
+}
@@ -0,0 +1,143 @@
+/*****************************************************************//**
+ * \file   job_system.h
+ * \brief  Work-stealing job scheduler shared by the whole application
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+typedef std::function<void()> JobFn;
+
+// Processes [begin, end) of a ParallelFor
+typedef std::function<void(uint32_t begin, uint32_t end)> RangeFn;
+
+struct JOB_SYSTEM_STATS
+{
+	uint64_t Jobs = 0;			// Jobs run, on any thread
+	uint64_t Steals = 0;		// Jobs taken from another thread's deque
+};
+
+/**
+ * Jobs forked together and joined with JobSystem::Wait. The first exception
+ * thrown by one of its jobs is rethrown by Wait once all of them are done.
+ * A group must outlive its jobs, so it is always waited on before it goes
+ * out of scope.
+ */
+class JobGroup
+{
+public:
+	JobGroup() = default;
+
+	bool Done() const { return m_pending.load(std::memory_order_acquire) == 0; }
+
+private:
+	friend class JobSystem;
+
+	JobGroup(const JobGroup&) = delete;
+	JobGroup& operator=(const JobGroup&) = delete;
+
+	std::atomic<uint32_t> m_pending{ 0 };
+	std::mutex m_errorMutex;
+	std::exception_ptr m_error;
+};
+
+/**
+ * Runs jobs on a fixed set of threads, one per hardware thread by default.
+ *
+ * Every thread owns a deque: jobs it forks are pushed to the back and it
+ * pops them from the back, so a thread keeps working on the data it has just
+ * touched. A thread with an empty deque steals from the front of the others,
+ * taking the oldest and usually largest pieces of work. Idle workers sleep
+ * until a job is pushed.
+ *
+ * The thread that creates the system is thread 0: it has no thread of its
+ * own but runs jobs while it waits, so ThreadCount() threads are busy during
+ * a ParallelFor. Other threads may fork and wait too, sharing deque 0.
+ *
+ * With pinning, worker i stays on logical processor i; the creating thread
+ * is left where the OS puts it.
+ */
+class JobSystem
+{
+public:
+	// threadCount 0 uses every hardware thread, 1 runs every job on the
+	// waiting thread
+	explicit JobSystem(unsigned threadCount = 0, bool pinThreads = false);
+	~JobSystem();
+
+	// Fork: queues job as part of group
+	void Run(JobGroup& group, JobFn job);
+
+	// Join: runs queued jobs until those of group are done
+	void Wait(JobGroup& group);
+
+	/**
+	 * Calls body over [begin, end) in ranges of at most grain items and
+	 * returns when all of them are done.
+	 *
+	 * The loop is forked in halves, the largest first, so a thread that steals
+	 * takes a large share of the work in one job. Range boundaries depend only
+	 * on begin, end and grain.
+	 */
+	void ParallelFor(uint32_t begin, uint32_t end, uint32_t grain, const RangeFn& body);
+
+	unsigned ThreadCount() const { return m_threadCount; }
+
+	// Index of the calling thread in [0, ThreadCount()), 0 for threads
+	// outside of the system
+	unsigned ThreadIndex() const;
+
+	// Whether every worker was pinned
+	bool Pinned() const { return m_pinned; }
+
+	JOB_SYSTEM_STATS Stats() const;
+	void ResetStats();
+
+private:
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	struct Job
+	{
+		JobFn Fn;
+		JobGroup* pGroup;
+	};
+
+	// Deques are locked, but each lock is held for a push or pop only
+	struct Worker
+	{
+		std::mutex Mutex;
+		std::deque<Job> Jobs;
+		std::atomic<uint64_t> Executed{ 0 };
+		std::atomic<uint64_t> Stolen{ 0 };
+	};
+
+	void worker_main(unsigned index);
+	bool try_run(unsigned index);
+	void execute(unsigned index, Job& job);
+	void split_range(JobGroup& group, uint32_t begin, uint32_t end, uint32_t grain, const RangeFn& body);
+
+	unsigned m_threadCount = 1;
+	bool m_pinned = false;
+
+	std::unique_ptr<Worker[]> m_workers;
+	std::vector<std::thread> m_threads;			// Workers 1 to ThreadCount() - 1
+
+	std::atomic<uint32_t> m_queued{ 0 };		// Jobs in all deques
+	std::atomic<uint32_t> m_sleeping{ 0 };
+	std::atomic<bool> m_quit{ false };
+	std::mutex m_sleepMutex;
+	std::condition_variable m_wake;
+};
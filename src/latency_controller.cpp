@@ -0,0 +1,80 @@
+/*****************************************************************//**
+ * \file   latency_controller.cpp
+ * \brief  Definition of FrameLatencyController
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include "latency_controller.h"
+
+FrameLatencyController::FrameLatencyController(uint32_t initialFrames, const FRAME_LATENCY_PARAMS& params)
+    : m_params(params)
+{
+    if (m_params.MinFrames < 1) m_params.MinFrames = 1;
+    if (m_params.MaxFrames < m_params.MinFrames) m_params.MaxFrames = m_params.MinFrames;
+    if (m_params.WindowFrames < 1) m_params.WindowFrames = 1;
+
+    m_frames = initialFrames;
+    if (m_frames < m_params.MinFrames) m_frames = m_params.MinFrames;
+    if (m_frames > m_params.MaxFrames) m_frames = m_params.MaxFrames;
+
+    reset_window();
+}
+
+void FrameLatencyController::reset_window()
+{
+    m_windowCount = 0;
+    m_frameSum = 0.0;
+    m_stallSum = 0.0;
+    m_idleSum = 0.0;
+}
+
+uint32_t FrameLatencyController::AddFrame(double frameSeconds, double cpuStallSeconds, double gpuIdleSeconds)
+{
+    if (m_hold > 0) m_hold--;
+
+    // Frames right after a change still reflect the old setting
+    if (m_cooldown > 0)
+    {
+        m_cooldown--;
+        return m_frames;
+    }
+
+    m_frameSum += frameSeconds;
+    m_stallSum += cpuStallSeconds;
+    m_idleSum += gpuIdleSeconds;
+    m_windowCount++;
+
+    if (m_windowCount < m_params.WindowFrames) return m_frames;
+
+    // Window is full, make a decision
+    double stallFraction = 0.0;
+    double idleFraction = 0.0;
+    if (m_frameSum > 0.0)
+    {
+        stallFraction = m_stallSum / m_frameSum;
+        idleFraction = m_idleSum / m_frameSum;
+    }
+    reset_window();
+
+    uint32_t frames = m_frames;
+    if (idleFraction > m_params.RaiseGpuIdleFraction
+        && stallFraction > m_params.RaiseCpuStallFraction)
+    {
+        if (frames < m_params.MaxFrames) frames++;
+        m_hold = m_params.HoldFrames;
+    }
+    else if ((stallFraction < m_params.IdleCpuStallFraction && m_hold == 0)
+        || (stallFraction > m_params.LowerCpuStallFraction
+            && idleFraction < m_params.LowerMaxGpuIdleFraction))
+    {
+        if (frames > m_params.MinFrames) frames--;
+    }
+
+    if (frames != m_frames)
+    {
+        m_frames = frames;
+        m_cooldown = m_params.CooldownFrames;
+    }
+    return m_frames;
+}
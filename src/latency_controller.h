@@ -0,0 +1,78 @@
+/*****************************************************************//**
+ * \file   latency_controller.h
+ * \brief  Chooses the number of frames in flight at runtime
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+
+#include <cstdint>
+
+// Tuning of FrameLatencyController. Fractions are relative to frame time.
+struct FRAME_LATENCY_PARAMS
+{
+	uint32_t MinFrames = 2;					// Bounds for frames in flight
+	uint32_t MaxFrames = 4;
+
+	uint32_t WindowFrames = 60;				// Frames averaged for one decision
+	uint32_t CooldownFrames = 180;			// Frames ignored after every change
+	uint32_t HoldFrames = 3600;				// After a raise, frames in which missing stalls do not undo it
+
+	double RaiseGpuIdleFraction = 0.10;		// GPU starves...
+	double RaiseCpuStallFraction = 0.01;	// ...while the CPU waited for a frame: buffer one more
+	double IdleCpuStallFraction = 0.005;	// CPU never waits: frames are spare, drop one
+	double LowerCpuStallFraction = 0.15;	// CPU mostly waits for the GPU...
+	double LowerMaxGpuIdleFraction = 0.005;	// ...and the GPU is kept busy: drop a frame
+};
+
+/**
+ * Policy deciding how many frames the CPU may run ahead of the GPU.
+ *
+ * More frames in flight keep the GPU fed when CPU frame times vary, but add
+ * latency. An extra frame only helps if the CPU was held back by the limit,
+ * so the count is raised when, within one window, the CPU blocked on a frame
+ * resource and the GPU also ran dry. A GPU that idles while the CPU never
+ * blocks is waiting for a slow CPU, and more frames would not feed it.
+ *
+ * The count is lowered when the CPU never blocks, since the frames are not
+ * used, and when the CPU spends a large part of the frame blocked while the
+ * GPU never idles: the GPU is the bottleneck and queued frames only add
+ * latency. A raise is what stops the stalls, so for HoldFrames after one
+ * the absence of stalls does not lower the count; the controller then
+ * tries one frame less and raises again if the stalls come back.
+ *
+ * The class has no dependency on D3D and is driven purely by timing samples.
+ */
+class FrameLatencyController
+{
+public:
+	FrameLatencyController(uint32_t initialFrames, const FRAME_LATENCY_PARAMS& params = FRAME_LATENCY_PARAMS());
+
+	/**
+	 * Feeds timing of one finished frame.
+	 *
+	 * \param frameSeconds total CPU frame time
+	 * \param cpuStallSeconds time the CPU was blocked waiting for the GPU
+	 * \param gpuIdleSeconds time the GPU had no work queued
+	 * \return number of frames in flight to use from now on
+	 */
+	uint32_t AddFrame(double frameSeconds, double cpuStallSeconds, double gpuIdleSeconds);
+
+	uint32_t FramesInFlight() const { return m_frames; }
+
+private:
+	void reset_window();
+
+	FRAME_LATENCY_PARAMS m_params;
+	uint32_t m_frames = 0;
+
+	// Accumulated samples of the current window
+	uint32_t m_windowCount = 0;
+	double m_frameSum = 0.0;
+	double m_stallSum = 0.0;
+	double m_idleSum = 0.0;
+
+	uint32_t m_cooldown = 0;
+	uint32_t m_hold = 0;
+};
@@ -0,0 +1,215 @@
+/*****************************************************************//**
+ * \file   linearallocator.h
+ * \brief  Per-frame linear allocator for constant and structured buffer data
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+
+#include <cstring>
+#include <d3d12.h>
+#include <wrl.h>
+
+#include "d3dUtil.h"
+#include "stream_copy.h"
+
+// Linear (bump) allocator over a single persistently mapped upload buffer.
+//
+// Every frame resource owns one allocator. At the beginning of the frame it is
+// reset and all constant data of that frame (pass, materials, objects) is packed
+// into it back to back, every allocation aligned to 256 bytes as required for CBVs.
+// The memory is reused only after the GPU has passed the fence of the frame resource,
+// so the allocations themselves never have to wait.
+//
+// Upload memory is write-combined, so data is written with streaming stores
+// (see stream_copy.h). Call StreamFence() after the last write of the frame.
+class LinearAllocator
+{
+public:
+	struct Allocation
+	{
+		BYTE* CPUAddress = nullptr;
+		D3D12_GPU_VIRTUAL_ADDRESS GPUAddress = 0;
+	};
+
+	LinearAllocator(ID3D12Device* pDevice, UINT64 capacity)
+	{
+		CreateBuffer(pDevice, capacity);
+	}
+
+	~LinearAllocator()
+	{
+		ReleaseBuffer();
+	}
+
+	// Forbid copying
+	LinearAllocator(LinearAllocator& rhs) = delete;
+	LinearAllocator& operator=(const LinearAllocator& rhs) = delete;
+
+	// Byte size of one constant buffer element of type T
+	template<typename T>
+	static UINT64 ConstantStride() { return AlignConstant(sizeof(T)); }
+
+	// Pads byte size to the multiple of 256
+	static UINT64 AlignConstant(UINT64 byteSize)
+	{
+		return (byteSize + 255) & ~static_cast<UINT64>(255);
+	}
+
+	/**
+	 * Rewinds the allocator. Must only be called when the GPU is done
+	 * with the previous contents of the buffer.
+	 *
+	 * \param pDevice device used if the buffer has to grow
+	 * \param requiredBytes number of bytes the frame is going to allocate
+	 * \return true if the buffer was recreated and previous contents are lost
+	 */
+	bool Reset(ID3D12Device* pDevice, UINT64 requiredBytes)
+	{
+		mOffset = 0;
+
+		if (requiredBytes <= mCapacity) return false;
+
+		// Grow geometrically so that slowly growing scenes do not
+		// recreate the resource every frame
+		UINT64 newCapacity = mCapacity > 0 ? mCapacity : 256;
+		while (newCapacity < requiredBytes) newCapacity *= 2;
+
+		ReleaseBuffer();
+		CreateBuffer(pDevice, newCapacity);
+		return true;
+	}
+
+	// Reserves byteSize bytes, aligned to 256
+	Allocation Allocate(UINT64 byteSize)
+	{
+		UINT64 alignedSize = AlignConstant(byteSize);
+
+		if (mOffset + alignedSize > mCapacity)
+		{
+			throw DxException(E_OUTOFMEMORY, L"LinearAllocator::Allocate",
+				AnsiToWString(__FILE__), __LINE__);
+		}
+
+		Allocation allocation = { };
+		allocation.CPUAddress = mMappedData + mOffset;
+		allocation.GPUAddress = mBaseGPUAddress + mOffset;
+
+		mOffset += alignedSize;
+		return allocation;
+	}
+
+	// Allocates one constant buffer element and copies data into it
+	template<typename T>
+	Allocation Push(const T& data)
+	{
+		Allocation allocation = Allocate(sizeof(T));
+		StreamCopyLines(allocation.CPUAddress, &data, sizeof(T));
+		return allocation;
+	}
+
+	// Reserves a contiguous array of count constant buffer elements,
+	// each padded to 256 bytes. Element i is at ConstantStride<T>() * i.
+	template<typename T>
+	Allocation AllocateArray(UINT count)
+	{
+		return Allocate(ConstantStride<T>() * count);
+	}
+
+	// Copies data into [index] element of an array made by AllocateArray
+	template<typename T>
+	static void WriteElement(const Allocation& array, UINT index, const T& data)
+	{
+		StreamCopyLines(array.CPUAddress + ConstantStride<T>() * index, &data, sizeof(T));
+	}
+
+	// Allocates an array of constant buffer elements and copies the data
+	template<typename T>
+	Allocation PushArray(const T* pData, UINT count)
+	{
+		Allocation allocation = AllocateArray<T>(count);
+
+		StreamScatter(allocation.CPUAddress, ConstantStride<T>(),
+			pData, sizeof(T), sizeof(T), count);
+		return allocation;
+	}
+
+	// Reserves a tightly packed array of count elements, read by
+	// shaders as StructuredBuffer<T>. Only the base is 256-byte aligned.
+	template<typename T>
+	Allocation AllocateStructured(UINT count)
+	{
+		return Allocate(sizeof(T) * static_cast<UINT64>(count));
+	}
+
+	// Copies data into [index] element of an array made by AllocateStructured.
+	// Elements that do not fill whole lines share them with their neighbours,
+	// and streaming part of a line costs more than plain stores.
+	template<typename T>
+	static void WriteStructured(const Allocation& array, UINT index, const T& data)
+	{
+		if (sizeof(T) % StreamLineSize == 0)
+			StreamCopy(array.CPUAddress + sizeof(T) * index, &data, sizeof(T));
+		else
+			memcpy(array.CPUAddress + sizeof(T) * index, &data, sizeof(T));
+	}
+
+	// Allocates a structured array and copies the data in one go
+	template<typename T>
+	Allocation PushStructured(const T* pData, UINT count)
+	{
+		Allocation allocation = Allocate(sizeof(T) * static_cast<UINT64>(count));
+		StreamCopy(allocation.CPUAddress, pData, sizeof(T) * static_cast<size_t>(count));
+		return allocation;
+	}
+
+	UINT64 Capacity() const { return mCapacity; }
+	UINT64 UsedBytes() const { return mOffset; }
+
+private:
+	void CreateBuffer(ID3D12Device* pDevice, UINT64 capacity)
+	{
+		capacity = AlignConstant(capacity);
+
+		D3D12_HEAP_PROPERTIES hp = HeapProperties(D3D12_HEAP_TYPE_UPLOAD);
+		D3D12_RESOURCE_DESC bufferDesc = BufferDesc(capacity);
+
+		ThrowIfFailed(pDevice->CreateCommittedResource(
+			&hp,
+			D3D12_HEAP_FLAG_NONE,
+			&bufferDesc,
+			D3D12_RESOURCE_STATE_GENERIC_READ,
+			nullptr,
+			IID_PPV_ARGS(mBuffer.GetAddressOf())));
+
+		// The buffer stays mapped for its whole lifetime
+		ThrowIfFailed(mBuffer->Map(0, nullptr,
+			reinterpret_cast<void**>(&mMappedData)));
+
+		mBaseGPUAddress = mBuffer->GetGPUVirtualAddress();
+		mCapacity = capacity;
+		mOffset = 0;
+	}
+
+	void ReleaseBuffer()
+	{
+		if (mBuffer != nullptr)
+		{
+			mBuffer->Unmap(0, nullptr);
+		}
+		mBuffer = nullptr;
+		mMappedData = nullptr;
+		mBaseGPUAddress = 0;
+		mCapacity = 0;
+	}
+
+private:
+	Microsoft::WRL::ComPtr<ID3D12Resource> mBuffer = nullptr;
+
+	BYTE* mMappedData = nullptr;
+	D3D12_GPU_VIRTUAL_ADDRESS mBaseGPUAddress = 0;
+
+	UINT64 mCapacity = 0;
+	UINT64 mOffset = 0;		// Next free byte
+};
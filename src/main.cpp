@@ -10,6 +10,8 @@
 
 #include "window.h"
 #include "timer.h"
+#include "clock.h"
+#include "profiler.h"
 #include "d3dinit.h"
 #include "d3dUtil.h"
 #include "d3dapp.h"
@@ -28,6 +30,10 @@ int WINAPI WinMain(_In_ HINSTANCE hInstance,// Handle to app in Windows
 	wndparams.width = 800;
 	wndparams.height = 600;
 
+	// Cheaper clock readings for timing, before anything takes ticks
+	Clock::EnableTsc();
+	Profiler::Instance().SetThreadName("render");
+
 	D3DWindow window(wndparams);
 
 	D3DApplication app;
@@ -61,12 +67,16 @@ int D3DBase::Run()
 			// TODO: display FPS at title
 			if (!mAppPaused)
 			{
+				uint64_t frameStart = Clock::Now();
 				CalculateFrameStats();
 				Update();
 				Draw();
+				RecordFrameStats(frameStart);
 			}
 			else
 			{
+				// Time paused is not a frame interval
+				mLastPresentTicks = 0;
 				Sleep(100);
 			}
 
@@ -0,0 +1,150 @@
+/*****************************************************************//**
+ * \file   mesh_gen.cpp
+ * \brief  Generation of terrain and plane meshes on the CPU
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include "mesh_gen.h"
+#include "perf_counters.h"
+
+using namespace DirectX;
+
+void GenerateTerrainMesh(HeightmapImage& heightmap, JobSystem* pJobs, MESH_DATA& mesh)
+{
+	mesh.Vertices.clear();
+	mesh.Indices.clear();
+	mesh.ChunkIndexCounts.clear();
+
+	uint32_t width = heightmap.GetWidth();
+	uint32_t depth = heightmap.GetHeight();
+
+	float dx = (float)width / static_cast<float>(width - 1);
+	float dz = (float)depth / static_cast<float>(depth - 1);
+
+	float zeroX = -(float)width / 2;
+	float zeroZ = (float)depth / 2;
+
+	// Generate vertices, rows are independent
+	mesh.Vertices.resize(static_cast<size_t>(width - 2) * (depth - 2));
+	auto generateRows = [&](uint32_t firstRow, uint32_t lastRow)
+	{
+		// Counted on the thread running the rows
+		PerfZone perfZone("CreateTerrain", static_cast<uint64_t>(lastRow - firstRow) * (depth - 2));
+
+		for (uint32_t i = firstRow; i < lastRow; i++)
+		{
+			for (uint32_t j = 1; j < depth - 1; j++)
+			{
+				float x = zeroX + j * dx;
+				float z = zeroZ - i * dz;
+
+				float height = (float)heightmap.GetPixel(j, i) / 128.0f - 5.5f;
+
+				float dhj = ((float)heightmap.GetPixel(j + 1, i) - (float)heightmap.GetPixel(j - 1, i)) / 128.0f;
+				float dhi = ((float)heightmap.GetPixel(j, i + 1) - (float)heightmap.GetPixel(j, i - 1)) / 128.0f;
+
+				XMFLOAT3 n(
+					- 2 * dz * dhj,
+					4 * dx * dz,
+					- 2 * dx * dhi);
+
+				// Normalize
+				XMVECTOR v = XMLoadFloat3(&n);
+				v = XMVector3Normalize(v);
+				XMStoreFloat3(&n, v);
+
+				//XMFLOAT3 n(0.0f, 1.0f, 0.0f);
+
+				//XMVECTOR posJ = XMVectorSet((float)heightmap.GetPixel(j + 1, i) - (float)heightmap.GetPixel(j - 1, i))
+
+				XMFLOAT2 uv(0.05 * x, 0.05 * z);
+
+				mesh.Vertices[(i - 1) * (depth - 2) + (j - 1)] = Vertex{
+					{ x, height, z }, n , uv };
+			}
+		}
+	};
+
+	if (pJobs != nullptr) pJobs->ParallelFor(1, width - 1, 16, generateRows);
+	else generateRows(1, width - 1);
+
+	// Generate indices tile by tile, so that every chunk
+	// is a contiguous range of the index buffer
+	const uint32_t rows = width - 2;	// Vertex grid size
+	const uint32_t cols = depth - 2;
+
+	for (uint32_t tileI = 0; tileI < rows - 1; tileI += TerrainChunkQuads)
+	{
+		for (uint32_t tileJ = 0; tileJ < cols - 1; tileJ += TerrainChunkQuads)
+		{
+			size_t chunkStart = mesh.Indices.size();
+
+			uint32_t endI = tileI + TerrainChunkQuads < rows - 1 ? tileI + TerrainChunkQuads : rows - 1;
+			uint32_t endJ = tileJ + TerrainChunkQuads < cols - 1 ? tileJ + TerrainChunkQuads : cols - 1;
+
+			for (uint32_t i = tileI; i < endI; i++)
+			{
+				for (uint32_t j = tileJ; j < endJ; j++)
+				{
+					// Generate indices for quad down and to the right
+					uint32_t n = cols;
+					mesh.Indices.push_back(j + i * n);
+					mesh.Indices.push_back((j + 1) + i * n);
+					mesh.Indices.push_back(j + (i + 1) * n);
+
+					mesh.Indices.push_back((j + 1) + i * n);
+					mesh.Indices.push_back((j + 1) + (i + 1) * n);
+					mesh.Indices.push_back(j + (i + 1) * n);
+				}
+			}
+
+			mesh.ChunkIndexCounts.push_back(static_cast<uint32_t>(mesh.Indices.size() - chunkStart));
+		}
+	}
+}
+
+void GeneratePlaneMesh(uint32_t n, uint32_t m, float width, float depth, MESH_DATA& mesh)
+{
+	mesh.Vertices.clear();
+	mesh.Indices.clear();
+	mesh.ChunkIndexCounts.clear();
+
+	float dx = width / static_cast<float>(n - 1);
+	float dz = depth / static_cast<float>(m - 1);
+
+	float zeroX = -width / 2;
+	float zeroZ = depth / 2;
+
+	// Generate vertices
+	for (uint32_t i = 0; i < m; i++)
+	{
+		for (uint32_t j = 0; j < n; j++)
+		{
+			float x = zeroX + j * dx;
+			float z = zeroZ - i * dz;
+			float height = -5.0f;
+
+			XMFLOAT3 n(0.0f, 1.0f, 0.0f);
+			XMFLOAT2 uv(0.01 * x, 0.01 * z);
+			mesh.Vertices.push_back(Vertex{
+				{ x, height, z }, n , uv });
+		}
+	}
+
+	// Generate indices
+	for (uint32_t i = 0; i < m - 1; i++)
+	{
+		for (uint32_t j = 0; j < n - 1; j++)
+		{
+			// Generate indices for quad down and to the right
+			mesh.Indices.push_back(j + i * n);
+			mesh.Indices.push_back((j + 1) + i * n);
+			mesh.Indices.push_back(j + (i + 1) * n);
+
+			mesh.Indices.push_back((j + 1) + i * n);
+			mesh.Indices.push_back((j + 1) + (i + 1) * n);
+			mesh.Indices.push_back(j + (i + 1) * n);
+		}
+	}
+}
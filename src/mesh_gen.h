@@ -0,0 +1,42 @@
+/*****************************************************************//**
+ * \file   mesh_gen.h
+ * \brief  Generation of terrain and plane meshes on the CPU
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+
+#include "image_helper.h"
+#include "job_system.h"
+
+// Structure describing vertex buffer element format
+struct Vertex
+{
+	DirectX::XMFLOAT3 Pos;		// Position in non-homogeneous coordinates
+	DirectX::XMFLOAT3 Normal;	// Vertex normal
+	DirectX::XMFLOAT2 TexC;		// Texture coordinates
+};
+
+// Terrain is split into square chunks of this many quads per side for culling
+const uint32_t TerrainChunkQuads = 32;
+
+// Mesh in host memory, before it is uploaded
+struct MESH_DATA
+{
+	std::vector<Vertex> Vertices;
+	std::vector<uint16_t> Indices;
+	std::vector<uint32_t> ChunkIndexCounts;		// Indices per chunk, empty if not split
+};
+
+// Grid of vertices over the heightmap without its border pixels, in chunks
+// of TerrainChunkQuads. Rows of vertices are generated as jobs when a job
+// system is given.
+void GenerateTerrainMesh(HeightmapImage& heightmap, JobSystem* pJobs, MESH_DATA& mesh);
+
+// Flat grid of n by m vertices
+void GeneratePlaneMesh(uint32_t n, uint32_t m, float width, float depth, MESH_DATA& mesh);
@@ -0,0 +1,246 @@
+/*****************************************************************//**
+ * \file   null_backend.cpp
+ * \brief  Definition of NullCommandBackend
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include "null_backend.h"
+
+// Smallest valid size of each command
+static const size_t CommandSizes[COMMAND_TYPE_COUNT] =
+{
+    sizeof(CMD_SET_HANDLE),
+    sizeof(CMD_SET_HANDLE),
+    sizeof(CMD_SET_HANDLE),
+    sizeof(CMD_SET_ROOT_HANDLE),
+    sizeof(CMD_SET_ROOT_HANDLE),
+    sizeof(CMD_SET_ROOT_HANDLE),
+    sizeof(CMD_SET_ROOT_CONSTANTS),
+    sizeof(CMD_SET_VERTEX_BUFFER),
+    sizeof(CMD_SET_INDEX_BUFFER),
+    sizeof(CMD_SET_TOPOLOGY),
+    sizeof(CMD_SET_VIEWPORT),
+    sizeof(CMD_SET_SCISSOR),
+    sizeof(CMD_SET_RENDER_TARGET),
+    sizeof(CMD_CLEAR_RENDER_TARGET),
+    sizeof(CMD_CLEAR_DEPTH_STENCIL),
+    sizeof(CMD_DRAW_INDEXED),
+    sizeof(CMD_BARRIER),
+    sizeof(CMD_COPY_BUFFER),
+};
+
+static const uint32_t MaxRootSlots = 64;
+
+const char* NullCommandBackend::CommandName(uint16_t type)
+{
+    static const char* names[COMMAND_TYPE_COUNT] =
+    {
+        "SetPipeline", "SetRootSignature", "SetDescriptorHeap",
+        "SetRootCBV", "SetRootSRV", "SetRootTable", "SetRootConstants",
+        "SetVertexBuffer", "SetIndexBuffer", "SetTopology",
+        "SetViewport", "SetScissor", "SetRenderTarget",
+        "ClearRenderTarget", "ClearDepthStencil",
+        "DrawIndexed", "Barrier", "CopyBuffer",
+    };
+    return type < COMMAND_TYPE_COUNT ? names[type] : "Unknown";
+}
+
+void NullCommandBackend::error(uint32_t index, uint16_t type, const char* message)
+{
+    m_errors.push_back("command " + std::to_string(index) + " (" + CommandName(type) + "): " + message);
+}
+
+bool NullCommandBackend::Execute(const CommandStream& stream)
+{
+    const size_t errorCount = m_errors.size();
+
+    // State of a fresh command list
+    GPU_HANDLE pipeline = 0, rootSignature = 0, heap = 0;
+    const CMD_SET_VERTEX_BUFFER* pVertexBuffer = nullptr;
+    const CMD_SET_INDEX_BUFFER* pIndexBuffer = nullptr;
+    bool topologySet = false, viewportSet = false, scissorSet = false, renderTargetSet = false;
+    uint32_t topology = 0;
+    GPU_HANDLE rootHandles[MaxRootSlots] = { };
+
+    uint32_t index = 0;
+    for (const COMMAND_HEADER* p = stream.First(); p != nullptr; p = stream.Next(p), index++)
+    {
+        if (p->Type >= COMMAND_TYPE_COUNT || p->Size < CommandSizes[p->Type] || p->Size % 8 != 0)
+        {
+            error(index, p->Type, "malformed command, stopping");
+            break;
+        }
+        m_stats.Commands[p->Type]++;
+
+        switch (p->Type)
+        {
+        case COMMAND_SET_PIPELINE:
+        case COMMAND_SET_ROOT_SIGNATURE:
+        case COMMAND_SET_DESCRIPTOR_HEAP:
+        {
+            GPU_HANDLE handle = reinterpret_cast<const CMD_SET_HANDLE*>(p)->Handle;
+            GPU_HANDLE& bound = p->Type == COMMAND_SET_PIPELINE ? pipeline
+                : p->Type == COMMAND_SET_ROOT_SIGNATURE ? rootSignature : heap;
+
+            if (handle == 0) error(index, p->Type, "null handle");
+            if (handle == bound) m_stats.RedundantBinds++;
+
+            // Root arguments do not survive a root signature change
+            if (p->Type == COMMAND_SET_ROOT_SIGNATURE && handle != bound)
+            {
+                for (GPU_HANDLE& argument : rootHandles) argument = 0;
+            }
+            bound = handle;
+            break;
+        }
+        case COMMAND_SET_ROOT_CBV:
+        case COMMAND_SET_ROOT_SRV:
+        case COMMAND_SET_ROOT_TABLE:
+        {
+            const CMD_SET_ROOT_HANDLE* pCommand = reinterpret_cast<const CMD_SET_ROOT_HANDLE*>(p);
+            if (rootSignature == 0) error(index, p->Type, "no root signature");
+            if (pCommand->Handle == 0) error(index, p->Type, "null address");
+            if (p->Type == COMMAND_SET_ROOT_TABLE && heap == 0) error(index, p->Type, "no descriptor heap");
+
+            if (pCommand->Slot >= MaxRootSlots)
+            {
+                error(index, p->Type, "slot out of range");
+                break;
+            }
+            if (rootHandles[pCommand->Slot] == pCommand->Handle) m_stats.RedundantBinds++;
+            rootHandles[pCommand->Slot] = pCommand->Handle;
+            break;
+        }
+        case COMMAND_SET_ROOT_CONSTANTS:
+        {
+            const CMD_SET_ROOT_CONSTANTS* pCommand = reinterpret_cast<const CMD_SET_ROOT_CONSTANTS*>(p);
+            if (rootSignature == 0) error(index, p->Type, "no root signature");
+            if (pCommand->Count == 0) error(index, p->Type, "no values");
+            if (pCommand->Slot >= MaxRootSlots) error(index, p->Type, "slot out of range");
+            if (sizeof(CMD_SET_ROOT_CONSTANTS) + sizeof(uint32_t) * pCommand->Count > p->Size)
+            {
+                error(index, p->Type, "values past the end of the command, stopping");
+                return false;
+            }
+            break;
+        }
+        case COMMAND_SET_VERTEX_BUFFER:
+        {
+            pVertexBuffer = reinterpret_cast<const CMD_SET_VERTEX_BUFFER*>(p);
+            if (pVertexBuffer->Address == 0 || pVertexBuffer->Size == 0) error(index, p->Type, "empty buffer");
+            if (pVertexBuffer->Stride == 0) error(index, p->Type, "zero stride");
+            break;
+        }
+        case COMMAND_SET_INDEX_BUFFER:
+        {
+            pIndexBuffer = reinterpret_cast<const CMD_SET_INDEX_BUFFER*>(p);
+            if (pIndexBuffer->Address == 0 || pIndexBuffer->Size == 0) error(index, p->Type, "empty buffer");
+            if (pIndexBuffer->IndexSize != 2 && pIndexBuffer->IndexSize != 4) error(index, p->Type, "index size is not 2 or 4");
+            break;
+        }
+        case COMMAND_SET_TOPOLOGY:
+        {
+            uint32_t value = reinterpret_cast<const CMD_SET_TOPOLOGY*>(p)->Topology;
+            if (topologySet && value == topology) m_stats.RedundantBinds++;
+            topology = value;
+            topologySet = true;
+            break;
+        }
+        case COMMAND_SET_VIEWPORT:
+        {
+            const CMD_SET_VIEWPORT* pCommand = reinterpret_cast<const CMD_SET_VIEWPORT*>(p);
+            if (!(pCommand->Width > 0.0f && pCommand->Height > 0.0f)) error(index, p->Type, "empty viewport");
+            if (!(pCommand->MinDepth >= 0.0f && pCommand->MinDepth <= pCommand->MaxDepth && pCommand->MaxDepth <= 1.0f))
+                error(index, p->Type, "depth range outside [0, 1]");
+            viewportSet = true;
+            break;
+        }
+        case COMMAND_SET_SCISSOR:
+        {
+            const CMD_SET_SCISSOR* pCommand = reinterpret_cast<const CMD_SET_SCISSOR*>(p);
+            if (pCommand->Right <= pCommand->Left || pCommand->Bottom <= pCommand->Top) error(index, p->Type, "empty rectangle");
+            scissorSet = true;
+            break;
+        }
+        case COMMAND_SET_RENDER_TARGET:
+        {
+            if (reinterpret_cast<const CMD_SET_RENDER_TARGET*>(p)->RenderTarget == 0) error(index, p->Type, "null render target");
+            renderTargetSet = true;
+            break;
+        }
+        case COMMAND_CLEAR_RENDER_TARGET:
+        {
+            if (reinterpret_cast<const CMD_CLEAR_RENDER_TARGET*>(p)->RenderTarget == 0) error(index, p->Type, "null render target");
+            break;
+        }
+        case COMMAND_CLEAR_DEPTH_STENCIL:
+        {
+            const CMD_CLEAR_DEPTH_STENCIL* pCommand = reinterpret_cast<const CMD_CLEAR_DEPTH_STENCIL*>(p);
+            if (pCommand->DepthStencil == 0) error(index, p->Type, "null depth stencil");
+            if (!(pCommand->Depth >= 0.0f && pCommand->Depth <= 1.0f)) error(index, p->Type, "depth outside [0, 1]");
+            break;
+        }
+        case COMMAND_DRAW_INDEXED:
+        {
+            const CMD_DRAW_INDEXED* pCommand = reinterpret_cast<const CMD_DRAW_INDEXED*>(p);
+            if (pipeline == 0) error(index, p->Type, "no pipeline");
+            if (rootSignature == 0) error(index, p->Type, "no root signature");
+            if (pVertexBuffer == nullptr) error(index, p->Type, "no vertex buffer");
+            if (pIndexBuffer == nullptr) error(index, p->Type, "no index buffer");
+            if (!topologySet) error(index, p->Type, "no topology");
+            if (!viewportSet || !scissorSet) error(index, p->Type, "no viewport or scissor");
+            if (!renderTargetSet) error(index, p->Type, "no render target");
+            if (pCommand->IndexCount == 0 || pCommand->InstanceCount == 0) error(index, p->Type, "empty draw");
+
+            if (pIndexBuffer != nullptr && pIndexBuffer->IndexSize != 0 &&
+                static_cast<uint64_t>(pCommand->StartIndex) + pCommand->IndexCount > pIndexBuffer->Size / pIndexBuffer->IndexSize)
+            {
+                error(index, p->Type, "indices past the end of the index buffer");
+            }
+
+            m_stats.Draws++;
+            m_stats.Instances += pCommand->InstanceCount;
+            m_stats.Indices += static_cast<uint64_t>(pCommand->IndexCount) * pCommand->InstanceCount;
+            break;
+        }
+        case COMMAND_BARRIER:
+        {
+            const CMD_BARRIER* pCommand = reinterpret_cast<const CMD_BARRIER*>(p);
+            if (pCommand->Resource == 0) error(index, p->Type, "null resource");
+            if (pCommand->Before == pCommand->After) error(index, p->Type, "transition to the same state");
+
+            auto it = m_states.find(pCommand->Resource);
+            if (it != m_states.end() && it->second != pCommand->Before)
+            {
+                error(index, p->Type, "resource is not in the before state");
+            }
+            m_states[pCommand->Resource] = pCommand->After;
+            break;
+        }
+        case COMMAND_COPY_BUFFER:
+        {
+            const CMD_COPY_BUFFER* pCommand = reinterpret_cast<const CMD_COPY_BUFFER*>(p);
+            if (pCommand->Destination == 0 || pCommand->Source == 0) error(index, p->Type, "null buffer");
+            if (pCommand->ByteSize == 0) error(index, p->Type, "empty copy");
+
+            auto dst = m_bufferSizes.find(pCommand->Destination);
+            if (dst != m_bufferSizes.end() && pCommand->DestinationOffset + pCommand->ByteSize > dst->second)
+                error(index, p->Type, "past the end of the destination");
+            auto src = m_bufferSizes.find(pCommand->Source);
+            if (src != m_bufferSizes.end() && pCommand->SourceOffset + pCommand->ByteSize > src->second)
+                error(index, p->Type, "past the end of the source");
+
+            if (pCommand->Destination == pCommand->Source &&
+                pCommand->DestinationOffset < pCommand->SourceOffset + pCommand->ByteSize &&
+                pCommand->SourceOffset < pCommand->DestinationOffset + pCommand->ByteSize)
+            {
+                error(index, p->Type, "source and destination overlap");
+            }
+            break;
+        }
+        }
+    }
+
+    return m_errors.size() == errorCount;
+}
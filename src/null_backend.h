@@ -0,0 +1,66 @@
+/*****************************************************************//**
+ * \file   null_backend.h
+ * \brief  Command stream backend that validates and counts without a GPU
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "command_stream.h"
+
+struct NULL_BACKEND_STATS
+{
+	uint32_t Commands[COMMAND_TYPE_COUNT] = { };
+	uint32_t Draws = 0;
+	uint64_t Instances = 0;
+	uint64_t Indices = 0;				// Indices drawn, over all instances
+	uint32_t RedundantBinds = 0;		// Binds of what was already bound
+};
+
+/**
+ * Consumes command streams the way a command list would, without drawing.
+ *
+ * Each stream starts with no state bound. Draws must have a pipeline, root
+ * signature, buffers, topology, viewport, scissor and render target, and
+ * stay within the index buffer. Root arguments need a root signature.
+ * Barriers must start from the state the resource is in, tracked across
+ * streams as on a queue; resources not registered with SetResourceState are
+ * trusted on their first barrier. Copies must stay within registered buffer
+ * sizes and not overlap themselves.
+ *
+ * Problems are collected as messages, and recording stops at a malformed
+ * command.
+ */
+class NullCommandBackend
+{
+public:
+	void SetResourceState(GPU_HANDLE resource, uint32_t state) { m_states[resource] = state; }
+	void SetBufferSize(GPU_HANDLE buffer, uint64_t byteSize) { m_bufferSizes[buffer] = byteSize; }
+
+	// Returns false if the stream had errors
+	bool Execute(const CommandStream& stream);
+
+	const NULL_BACKEND_STATS& Stats() const { return m_stats; }
+	void ResetStats() { m_stats = NULL_BACKEND_STATS(); }
+
+	// Messages of every stream executed so far
+	const std::vector<std::string>& Errors() const { return m_errors; }
+	void ClearErrors() { m_errors.clear(); }
+
+	static const char* CommandName(uint16_t type);
+
+private:
+	void error(uint32_t index, uint16_t type, const char* message);
+
+	std::unordered_map<GPU_HANDLE, uint32_t> m_states;
+	std::unordered_map<GPU_HANDLE, uint64_t> m_bufferSizes;
+
+	NULL_BACKEND_STATS m_stats;
+	std::vector<std::string> m_errors;
+};
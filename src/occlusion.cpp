@@ -0,0 +1,457 @@
+/*****************************************************************//**
+ * \file   occlusion.cpp
+ * \brief  Definition of OcclusionCuller
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include <cmath>
+
+#include "occlusion.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define OCCLUSION_SSE
+#include <immintrin.h>
+#endif
+
+// Setup is split between threads only for large occluders
+static const size_t MinTrianglesPerThread = 1024;
+
+// Clip-space w below this is treated as crossing the near plane
+static const float MinClipW = 1e-4f;
+
+OCCLUDER_MESH BuildHeightfieldOccluder(const uint8_t* heights, uint32_t rows, uint32_t cols,
+    uint32_t rowPitch, uint32_t step,
+    float originX, float originZ, float dx, float dz,
+    float heightScale, float heightOffset)
+{
+    OCCLUDER_MESH mesh;
+    if (rows < 2 || cols < 2 || step == 0) return mesh;
+
+    // Sample rows and columns, the last one is always included
+    std::vector<uint32_t> sampleRows, sampleCols;
+    for (uint32_t r = 0; r < rows - 1; r += step) sampleRows.push_back(r);
+    sampleRows.push_back(rows - 1);
+    for (uint32_t c = 0; c < cols - 1; c += step) sampleCols.push_back(c);
+    sampleCols.push_back(cols - 1);
+
+    for (uint32_t r : sampleRows)
+    {
+        for (uint32_t c : sampleCols)
+        {
+            // Lowest sample within a step around the vertex, so that the
+            // coarse surface is below every triangle of the fine one
+            uint32_t r0 = r >= step ? r - step : 0;
+            uint32_t c0 = c >= step ? c - step : 0;
+            uint32_t r1 = r + step < rows ? r + step : rows - 1;
+            uint32_t c1 = c + step < cols ? c + step : cols - 1;
+
+            uint8_t lowest = 255;
+            for (uint32_t i = r0; i <= r1; i++)
+            {
+                for (uint32_t j = c0; j <= c1; j++)
+                {
+                    uint8_t h = heights[i * rowPitch + j];
+                    if (h < lowest) lowest = h;
+                }
+            }
+
+            mesh.Positions.push_back(originX + c * dx);
+            mesh.Positions.push_back(lowest * heightScale + heightOffset);
+            mesh.Positions.push_back(originZ - r * dz);
+        }
+    }
+
+    const uint32_t n = static_cast<uint32_t>(sampleCols.size());
+    for (uint32_t i = 0; i + 1 < sampleRows.size(); i++)
+    {
+        for (uint32_t j = 0; j + 1 < n; j++)
+        {
+            mesh.Indices.push_back(j + i * n);
+            mesh.Indices.push_back((j + 1) + i * n);
+            mesh.Indices.push_back(j + (i + 1) * n);
+
+            mesh.Indices.push_back((j + 1) + i * n);
+            mesh.Indices.push_back((j + 1) + (i + 1) * n);
+            mesh.Indices.push_back(j + (i + 1) * n);
+        }
+    }
+    return mesh;
+}
+
+OcclusionCuller::OcclusionCuller(uint32_t width, uint32_t height, JobSystem* pJobs)
+    : m_pJobs(pJobs)
+{
+    m_tilesX = (width + TileSize - 1) / TileSize;
+    m_tilesY = (height + TileSize - 1) / TileSize;
+    if (m_tilesX == 0) m_tilesX = 1;
+    if (m_tilesY == 0) m_tilesY = 1;
+    m_width = m_tilesX * TileSize;
+    m_height = m_tilesY * TileSize;
+
+    // Pyramid down to a single texel
+    uint32_t levelWidth = m_width;
+    uint32_t levelHeight = m_height;
+    while (true)
+    {
+        Level level;
+        level.Width = levelWidth;
+        level.Height = levelHeight;
+        level.Depth.assign(static_cast<size_t>(levelWidth) * levelHeight, 1.0f);
+        m_levels.push_back(std::move(level));
+
+        if (levelWidth == 1 && levelHeight == 1) break;
+        levelWidth = (levelWidth + 1) / 2;
+        levelHeight = (levelHeight + 1) / 2;
+    }
+}
+
+// Transforms a point by a row-major matrix in row-vector convention
+static inline void transform_point(const float m[16], float x, float y, float z, float clip[4])
+{
+    for (int j = 0; j < 4; j++)
+    {
+        clip[j] = x * m[j] + y * m[4 + j] + z * m[8 + j] + m[12 + j];
+    }
+}
+
+void OcclusionCuller::setup_triangles(size_t begin, size_t end, unsigned bin)
+{
+    std::vector<Triangle>& triangles = m_triangles[bin];
+    std::vector<std::vector<uint32_t>>& bins = m_bins[bin];
+
+    triangles.clear();
+    for (std::vector<uint32_t>& tileBin : bins) tileBin.clear();
+
+    const float* positions = m_occluder.Positions.data();
+    const uint32_t* indices = m_occluder.Indices.data();
+    const float halfWidth = 0.5f * m_width;
+    const float halfHeight = 0.5f * m_height;
+
+    for (size_t t = begin; t < end; t++)
+    {
+        float x[3], y[3], z[3];
+        bool crossesNear = false;
+
+        for (int v = 0; v < 3; v++)
+        {
+            const float* p = positions + 3 * static_cast<size_t>(indices[3 * t + v]);
+            float clip[4];
+            transform_point(m_viewProj, p[0], p[1], p[2], clip);
+
+            // Dropping an occluder is always safe, clipping is not worth it here
+            if (clip[3] < MinClipW)
+            {
+                crossesNear = true;
+                break;
+            }
+
+            float invW = 1.0f / clip[3];
+            x[v] = (clip[0] * invW + 1.0f) * halfWidth;
+            y[v] = (1.0f - clip[1] * invW) * halfHeight;
+            z[v] = clip[2] * invW;
+        }
+        if (crossesNear) continue;
+
+        float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+        if (std::fabs(area) < 1e-8f) continue;
+
+        Triangle tri;
+
+        float minX = x[0], maxX = x[0], minY = y[0], maxY = y[0];
+        for (int v = 1; v < 3; v++)
+        {
+            if (x[v] < minX) minX = x[v];
+            if (x[v] > maxX) maxX = x[v];
+            if (y[v] < minY) minY = y[v];
+            if (y[v] > maxY) maxY = y[v];
+        }
+        if (maxX < 0.0f || maxY < 0.0f || minX >= m_width || minY >= m_height) continue;
+
+        tri.MinX = minX > 0.0f ? static_cast<int>(minX) : 0;
+        tri.MinY = minY > 0.0f ? static_cast<int>(minY) : 0;
+        tri.MaxX = maxX < m_width - 1 ? static_cast<int>(maxX) : static_cast<int>(m_width) - 1;
+        tri.MaxY = maxY < m_height - 1 ? static_cast<int>(maxY) : static_cast<int>(m_height) - 1;
+
+        // Edge i goes from vertex i to the next one. Either winding is
+        // accepted, the sign of the area turns the inside positive.
+        float sign = area > 0.0f ? 1.0f : -1.0f;
+        for (int e = 0; e < 3; e++)
+        {
+            int n = (e + 1) % 3;
+            tri.A[e] = sign * (y[e] - y[n]);
+            tri.B[e] = sign * (x[n] - x[e]);
+            tri.C[e] = sign * (x[e] * y[n] - x[n] * y[e]);
+        }
+
+        tri.ZdX = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) / area;
+        tri.ZdY = ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) / area;
+        tri.Z0 = z[0] - tri.ZdX * x[0] - tri.ZdY * y[0];
+
+        uint32_t index = static_cast<uint32_t>(triangles.size());
+        triangles.push_back(tri);
+
+        // Bin by bounding rectangle
+        for (uint32_t ty = tri.MinY / TileSize; ty <= tri.MaxY / TileSize; ty++)
+        {
+            for (uint32_t tx = tri.MinX / TileSize; tx <= tri.MaxX / TileSize; tx++)
+            {
+                bins[ty * m_tilesX + tx].push_back(index);
+            }
+        }
+    }
+}
+
+void OcclusionCuller::rasterize_tile(uint32_t tile)
+{
+    const int tileX0 = static_cast<int>((tile % m_tilesX) * TileSize);
+    const int tileY0 = static_cast<int>((tile / m_tilesX) * TileSize);
+    const int tileX1 = tileX0 + TileSize - 1;
+    const int tileY1 = tileY0 + TileSize - 1;
+
+    float* depth = m_levels[0].Depth.data();
+
+    for (int y = tileY0; y <= tileY1; y++)
+    {
+        float* row = depth + static_cast<size_t>(y) * m_width;
+        for (int x = tileX0; x <= tileX1; x++) row[x] = 1.0f;
+    }
+
+    for (size_t bin = 0; bin < m_bins.size(); bin++)
+    {
+        const std::vector<Triangle>& triangles = m_triangles[bin];
+
+        for (uint32_t index : m_bins[bin][tile])
+        {
+            const Triangle& tri = triangles[index];
+
+            int x0 = tri.MinX > tileX0 ? tri.MinX : tileX0;
+            int x1 = tri.MaxX < tileX1 ? tri.MaxX : tileX1;
+            int y0 = tri.MinY > tileY0 ? tri.MinY : tileY0;
+            int y1 = tri.MaxY < tileY1 ? tri.MaxY : tileY1;
+
+#ifdef OCCLUSION_SSE
+            // Tiles are 4-aligned, so groups of 4 never leave the tile
+            const int groupX0 = x0 & ~3;
+
+            const __m128 laneOffset = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+            const __m128 spanMin = _mm_set1_ps(static_cast<float>(x0));
+            const __m128 spanMax = _mm_set1_ps(static_cast<float>(x1 + 1));
+            const __m128 zero = _mm_setzero_ps();
+
+            for (int y = y0; y <= y1; y++)
+            {
+                float* row = depth + static_cast<size_t>(y) * m_width;
+                const __m128 py = _mm_set1_ps(y + 0.5f);
+
+                // Row-constant parts of the edge and depth equations
+                __m128 rowE0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(tri.B[0]), py), _mm_set1_ps(tri.C[0]));
+                __m128 rowE1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(tri.B[1]), py), _mm_set1_ps(tri.C[1]));
+                __m128 rowE2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(tri.B[2]), py), _mm_set1_ps(tri.C[2]));
+                __m128 rowZ = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(tri.ZdY), py), _mm_set1_ps(tri.Z0));
+
+                for (int x = groupX0; x <= x1; x += 4)
+                {
+                    __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), laneOffset);
+
+                    __m128 e0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(tri.A[0]), px), rowE0);
+                    __m128 e1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(tri.A[1]), px), rowE1);
+                    __m128 e2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(tri.A[2]), px), rowE2);
+
+                    __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)),
+                        _mm_cmpge_ps(e2, zero));
+                    inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmpge_ps(px, spanMin), _mm_cmplt_ps(px, spanMax)));
+
+                    if (_mm_movemask_ps(inside) == 0) continue;
+
+                    __m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(tri.ZdX), px), rowZ);
+                    __m128 current = _mm_loadu_ps(row + x);
+                    __m128 nearest = _mm_min_ps(current, z);
+
+                    // Keep the current depth where the pixel is not covered
+                    __m128 result = _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, current));
+                    _mm_storeu_ps(row + x, result);
+                }
+            }
+#else
+            for (int y = y0; y <= y1; y++)
+            {
+                float* row = depth + static_cast<size_t>(y) * m_width;
+                float py = y + 0.5f;
+                for (int x = x0; x <= x1; x++)
+                {
+                    float px = x + 0.5f;
+                    bool inside = true;
+                    for (int e = 0; e < 3; e++)
+                    {
+                        inside = inside && tri.A[e] * px + tri.B[e] * py + tri.C[e] >= 0.0f;
+                    }
+                    if (!inside) continue;
+
+                    float z = tri.Z0 + tri.ZdX * px + tri.ZdY * py;
+                    if (z < row[x]) row[x] = z;
+                }
+            }
+#endif
+        }
+    }
+}
+
+void OcclusionCuller::build_pyramid()
+{
+    for (size_t l = 1; l < m_levels.size(); l++)
+    {
+        const Level& fine = m_levels[l - 1];
+        Level& coarse = m_levels[l];
+
+        for (uint32_t y = 0; y < coarse.Height; y++)
+        {
+            uint32_t fy0 = 2 * y;
+            uint32_t fy1 = fy0 + 1 < fine.Height ? fy0 + 1 : fy0;
+
+            for (uint32_t x = 0; x < coarse.Width; x++)
+            {
+                uint32_t fx0 = 2 * x;
+                uint32_t fx1 = fx0 + 1 < fine.Width ? fx0 + 1 : fx0;
+
+                // Farthest of the four
+                float d = fine.Depth[fy0 * fine.Width + fx0];
+                float d1 = fine.Depth[fy0 * fine.Width + fx1];
+                float d2 = fine.Depth[fy1 * fine.Width + fx0];
+                float d3 = fine.Depth[fy1 * fine.Width + fx1];
+                if (d1 > d) d = d1;
+                if (d2 > d) d = d2;
+                if (d3 > d) d = d3;
+
+                coarse.Depth[y * coarse.Width + x] = d;
+            }
+        }
+    }
+}
+
+void OcclusionCuller::Render(const float viewProj[16])
+{
+    for (int i = 0; i < 16; i++) m_viewProj[i] = viewProj[i];
+
+    const size_t triangleCount = m_occluder.Indices.size() / 3;
+    const uint32_t tileCount = m_tilesX * m_tilesY;
+
+    const unsigned threadCount = m_pJobs != nullptr ? m_pJobs->ThreadCount() : 1;
+    size_t setupRanges = triangleCount / MinTrianglesPerThread;
+    if (setupRanges > threadCount) setupRanges = threadCount;
+    if (setupRanges < 1) setupRanges = 1;
+
+    m_triangles.resize(setupRanges);
+    m_bins.resize(setupRanges);
+    for (std::vector<std::vector<uint32_t>>& bins : m_bins) bins.resize(tileCount);
+
+    // Transform and bin, each job a contiguous range of triangles
+    const size_t rangeSize = (triangleCount + setupRanges - 1) / setupRanges;
+    auto setupRange = [this, rangeSize, triangleCount](uint32_t first, uint32_t last)
+    {
+        for (uint32_t r = first; r < last; r++)
+        {
+            size_t begin = r * rangeSize;
+            size_t end = begin + rangeSize < triangleCount ? begin + rangeSize : triangleCount;
+            setup_triangles(begin, end, r);
+        }
+    };
+
+    // Rasterize, tiles are independent
+    auto rasterizeTiles = [this](uint32_t first, uint32_t last)
+    {
+        for (uint32_t tile = first; tile < last; tile++) rasterize_tile(tile);
+    };
+
+    if (m_pJobs != nullptr)
+    {
+        m_pJobs->ParallelFor(0, static_cast<uint32_t>(setupRanges), 1, setupRange);
+        m_pJobs->ParallelFor(0, tileCount, 1, rasterizeTiles);
+    }
+    else
+    {
+        setupRange(0, static_cast<uint32_t>(setupRanges));
+        rasterizeTiles(0, tileCount);
+    }
+
+    build_pyramid();
+}
+
+bool OcclusionCuller::test_bounds(const float center[3], const float extents[3]) const
+{
+    float minX = 1e30f, minY = 1e30f, maxX = -1e30f, maxY = -1e30f;
+    float minZ = 1.0f;
+
+    for (int corner = 0; corner < 8; corner++)
+    {
+        float clip[4];
+        transform_point(m_viewProj,
+            center[0] + ((corner & 1) ? extents[0] : -extents[0]),
+            center[1] + ((corner & 2) ? extents[1] : -extents[1]),
+            center[2] + ((corner & 4) ? extents[2] : -extents[2]), clip);
+
+        // Bounds reach behind the camera
+        if (clip[3] < MinClipW) return true;
+
+        float invW = 1.0f / clip[3];
+        float x = (clip[0] * invW + 1.0f) * 0.5f * m_width;
+        float y = (1.0f - clip[1] * invW) * 0.5f * m_height;
+        float z = clip[2] * invW;
+
+        if (x < minX) minX = x;
+        if (x > maxX) maxX = x;
+        if (y < minY) minY = y;
+        if (y > maxY) maxY = y;
+        if (z < minZ) minZ = z;
+    }
+
+    if (minZ <= 0.0f) return true;
+
+    // Off screen: nothing to test against, leave it to frustum culling
+    if (maxX < 0.0f || maxY < 0.0f || minX >= m_width || minY >= m_height) return true;
+
+    int x0 = minX > 0.0f ? static_cast<int>(minX) : 0;
+    int y0 = minY > 0.0f ? static_cast<int>(minY) : 0;
+    int x1 = maxX < m_width - 1 ? static_cast<int>(maxX) : static_cast<int>(m_width) - 1;
+    int y1 = maxY < m_height - 1 ? static_cast<int>(maxY) : static_cast<int>(m_height) - 1;
+
+    // Coarsest level where the rectangle covers at most 2x2 texels
+    uint32_t level = 0;
+    while (level + 1 < m_levels.size()
+        && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1))
+    {
+        level++;
+    }
+
+    const Level& hiz = m_levels[level];
+    float farthest = 0.0f;
+    for (int y = y0 >> level; y <= (y1 >> level); y++)
+    {
+        for (int x = x0 >> level; x <= (x1 >> level); x++)
+        {
+            float d = hiz.Depth[y * hiz.Width + x];
+            if (d > farthest) farthest = d;
+        }
+    }
+
+    // Visible unless even the nearest point is behind every occluder texel
+    return minZ <= farthest;
+}
+
+bool OcclusionCuller::IsVisible(const MESH_BOUNDS& bounds) const
+{
+    return test_bounds(bounds.Center, bounds.Extents);
+}
+
+void OcclusionCuller::Cull(const CullingBounds& bounds, std::vector<uint32_t>& visible) const
+{
+    size_t kept = 0;
+    for (uint32_t index : visible)
+    {
+        const float center[3] = { bounds.CenterX()[index], bounds.CenterY()[index], bounds.CenterZ()[index] };
+        const float extents[3] = { bounds.ExtentX()[index], bounds.ExtentY()[index], bounds.ExtentZ()[index] };
+
+        if (test_bounds(center, extents)) visible[kept++] = index;
+    }
+    visible.resize(kept);
+}
@@ -0,0 +1,117 @@
+/*****************************************************************//**
+ * \file   occlusion.h
+ * \brief  CPU occlusion culling against a software-rasterized occluder
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "bounds.h"
+#include "frustum_cull.h"
+#include "job_system.h"
+
+// Occluder triangles in world space
+struct OCCLUDER_MESH
+{
+	std::vector<float> Positions;		// x, y, z per vertex
+	std::vector<uint32_t> Indices;		// Three per triangle
+};
+
+/**
+ * Builds a coarse occluder from a heightfield laid out like the terrain mesh:
+ * sample (row, col) is at x = originX + col * dx, z = originZ - row * dz,
+ * y = heights[row * rowPitch + col] * heightScale + heightOffset.
+ *
+ * Every step-th sample becomes a vertex, with the lowest height of the samples
+ * around it, so the occluder never rises above the real surface.
+ */
+OCCLUDER_MESH BuildHeightfieldOccluder(const uint8_t* heights, uint32_t rows, uint32_t cols,
+	uint32_t rowPitch, uint32_t step,
+	float originX, float originZ, float dx, float dz,
+	float heightScale, float heightOffset);
+
+/**
+ * Rasterizes occluders into a small depth buffer on the CPU and tests bounds
+ * against a hierarchical-Z pyramid built from it.
+ *
+ * The buffer is split into 32x32 tiles. Triangles are binned to the tiles they
+ * touch, and tiles are rasterized in parallel, 4 pixels at a time with SSE.
+ * Triangles crossing the near plane are dropped, and bounds crossing it are
+ * reported visible, so both errors stay on the conservative side.
+ *
+ * Depth is D3D post-projection z in [0, 1], smaller is nearer. Each pyramid level
+ * keeps the farthest depth of the 2x2 texels below it.
+ */
+class OcclusionCuller
+{
+public:
+	static const uint32_t TileSize = 32;
+
+	// width and height are rounded up to a multiple of TileSize. Without a
+	// job system, renders on the calling thread alone.
+	OcclusionCuller(uint32_t width, uint32_t height, JobSystem* pJobs = nullptr);
+
+	void SetOccluder(const OCCLUDER_MESH& occluder) { m_occluder = occluder; }
+
+	/**
+	 * Clears and redraws the depth buffer and rebuilds the pyramid.
+	 *
+	 * \param viewProj 4x4 row-major view-projection, row-vector convention
+	 */
+	void Render(const float viewProj[16]);
+
+	// Tests world-space bounds against the last rendered frame
+	bool IsVisible(const MESH_BOUNDS& bounds) const;
+
+	// Removes occluded entries from a list of indices into bounds
+	void Cull(const CullingBounds& bounds, std::vector<uint32_t>& visible) const;
+
+	uint32_t Width() const { return m_width; }
+	uint32_t Height() const { return m_height; }
+	uint32_t LevelCount() const { return static_cast<uint32_t>(m_levels.size()); }
+
+	// Depth of a pyramid level, level 0 is the rasterized buffer. Rows top to bottom.
+	const float* LevelDepth(uint32_t level) const { return m_levels[level].Depth.data(); }
+	uint32_t LevelWidth(uint32_t level) const { return m_levels[level].Width; }
+	uint32_t LevelHeight(uint32_t level) const { return m_levels[level].Height; }
+
+private:
+	// Screen-space triangle ready for rasterization
+	struct Triangle
+	{
+		float A[3], B[3], C[3];	// Edge functions, positive inside
+		float Z0, ZdX, ZdY;		// Depth plane: z = Z0 + ZdX * x + ZdY * y
+		int MinX, MinY, MaxX, MaxY;
+	};
+
+	struct Level
+	{
+		uint32_t Width = 0;
+		uint32_t Height = 0;
+		std::vector<float> Depth;
+	};
+
+	void setup_triangles(size_t begin, size_t end, unsigned bin);
+	void rasterize_tile(uint32_t tile);
+	void build_pyramid();
+	bool test_bounds(const float center[3], const float extents[3]) const;
+
+	uint32_t m_width = 0;
+	uint32_t m_height = 0;
+	uint32_t m_tilesX = 0;
+	uint32_t m_tilesY = 0;
+	JobSystem* m_pJobs = nullptr;
+
+	OCCLUDER_MESH m_occluder;
+	float m_viewProj[16] = { };
+
+	// Setup is split in ranges, each with its own triangles and bins
+	std::vector<std::vector<Triangle>> m_triangles;			// [setup range]
+	std::vector<std::vector<std::vector<uint32_t>>> m_bins;	// [setup range][tile] -> triangles
+
+	std::vector<Level> m_levels;
+};
@@ -0,0 +1,75 @@
+/*****************************************************************//**
+ * \file   parallel_record.cpp
+ * \brief  Definition of ParallelRecorder
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include <exception>
+
+#include "parallel_record.h"
+
+ParallelRecorder::ParallelRecorder(uint32_t maxWorkers, JobSystem* pJobs)
+    : m_pJobs(pJobs)
+{
+    uint32_t threadCount = pJobs != nullptr ? pJobs->ThreadCount() : 1;
+    if (threadCount > maxWorkers) threadCount = maxWorkers;
+    m_workerCount = threadCount > 0 ? threadCount : 1;
+    m_streams.resize(m_workerCount);
+}
+
+std::vector<RECORD_RANGE> ParallelRecorder::Partition(uint32_t batchCount, uint32_t workerCount, uint32_t minBatches)
+{
+    if (minBatches == 0) minBatches = 1;
+
+    uint32_t ranges = batchCount / minBatches;
+    if (ranges > workerCount) ranges = workerCount;
+    if (ranges == 0) ranges = 1;
+
+    // Sizes differ by at most one, larger ranges first
+    std::vector<RECORD_RANGE> partition(ranges);
+    uint32_t first = 0;
+    for (uint32_t i = 0; i < ranges; i++)
+    {
+        uint32_t count = batchCount / ranges + (i < batchCount % ranges ? 1 : 0);
+        partition[i] = { first, count };
+        first += count;
+    }
+    return partition;
+}
+
+uint32_t ParallelRecorder::Record(uint32_t batchCount, uint32_t minBatches, const RecordFn& record)
+{
+    m_ranges = Partition(batchCount, m_workerCount, minBatches);
+    const uint32_t count = static_cast<uint32_t>(m_ranges.size());
+
+    for (uint32_t i = 0; i < count; i++) m_streams[i].Reset();
+
+    // Exceptions of a worker are rethrown on the calling thread after all
+    // workers are done, the first range taking precedence
+    std::vector<std::exception_ptr> errors(count);
+    auto work = [this, &record, &errors](uint32_t first, uint32_t last)
+    {
+        for (uint32_t i = first; i < last; i++)
+        {
+            try
+            {
+                record(i, m_ranges[i], m_streams[i]);
+            }
+            catch (...)
+            {
+                errors[i] = std::current_exception();
+            }
+        }
+    };
+
+    // The calling thread records the first range
+    if (m_pJobs != nullptr) m_pJobs->ParallelFor(0, count, 1, work);
+    else work(0, count);
+
+    for (const std::exception_ptr& error : errors)
+    {
+        if (error) std::rethrow_exception(error);
+    }
+    return count;
+}
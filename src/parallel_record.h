@@ -0,0 +1,63 @@
+/*****************************************************************//**
+ * \file   parallel_record.h
+ * \brief  Splits a frame's draws across threads recording command streams
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "command_stream.h"
+#include "job_system.h"
+
+// Batches [First, First + Count) of the render queue, recorded by one worker
+struct RECORD_RANGE
+{
+	uint32_t First;
+	uint32_t Count;
+};
+
+// Records the batches of a range into the worker's stream
+typedef std::function<void(uint32_t worker, const RECORD_RANGE& range, CommandStream& stream)> RecordFn;
+
+/**
+ * Records the batches of a frame into one command stream per worker, as
+ * jobs, for submission as consecutive command lists.
+ *
+ * Batches are split into contiguous ranges in queue order, so submitting
+ * streams in order draws exactly what a single stream would. Each range
+ * holds at least minBatches batches, as every extra command list costs state
+ * setup and submission; a small frame is recorded by the calling thread
+ * alone. Streams start with no state, so the callback binds whatever its
+ * draws need. An exception thrown by the callback on any worker is rethrown
+ * by Record once all workers have finished.
+ */
+class ParallelRecorder
+{
+public:
+	// One worker per thread of the job system, up to maxWorkers. Without a
+	// job system, records a single stream on the calling thread.
+	ParallelRecorder(uint32_t maxWorkers, JobSystem* pJobs = nullptr);
+
+	// At least one range, even for no batches, so the frame still gets a stream
+	static std::vector<RECORD_RANGE> Partition(uint32_t batchCount, uint32_t workerCount, uint32_t minBatches);
+
+	// Returns the number of streams recorded, see Stream
+	uint32_t Record(uint32_t batchCount, uint32_t minBatches, const RecordFn& record);
+
+	// Streams of the last Record, in submission order
+	const CommandStream& Stream(uint32_t worker) const { return m_streams[worker]; }
+	const std::vector<RECORD_RANGE>& Ranges() const { return m_ranges; }
+
+	uint32_t MaxWorkers() const { return m_workerCount; }
+
+private:
+	JobSystem* m_pJobs = nullptr;
+	uint32_t m_workerCount = 1;
+	std::vector<CommandStream> m_streams;
+	std::vector<RECORD_RANGE> m_ranges;
+};
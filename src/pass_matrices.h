@@ -0,0 +1,52 @@
+/*****************************************************************//**
+ * \file   pass_matrices.h
+ * \brief  Camera matrices of a render pass and their inverses
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+
+#include <DirectXMath.h>
+
+// Transposed, as HLSL reads constant buffers column-major
+struct PASS_MATRICES
+{
+	DirectX::XMFLOAT4X4 View;
+	DirectX::XMFLOAT4X4 InvView;
+	DirectX::XMFLOAT4X4 Proj;
+	DirectX::XMFLOAT4X4 InvProj;
+	DirectX::XMFLOAT4X4 ViewProj;
+	DirectX::XMFLOAT4X4 InvViewProj;
+};
+
+// Combines view and projection and inverts all three. viewProj receives
+// the combined matrix as the CPU uses it, untransposed.
+inline void ComputePassMatrices(const DirectX::XMFLOAT4X4& view4x4, const DirectX::XMFLOAT4X4& proj4x4,
+	PASS_MATRICES& matrices, DirectX::XMFLOAT4X4& viewProj4x4)
+{
+	using namespace DirectX;
+
+	XMMATRIX view = XMLoadFloat4x4(&view4x4);
+	XMMATRIX proj = XMLoadFloat4x4(&proj4x4);
+
+	XMMATRIX viewProj = XMMatrixMultiply(view, proj);
+
+	XMVECTOR viewDet = XMMatrixDeterminant(view);
+	XMMATRIX invView = XMMatrixInverse(&viewDet, view);
+
+	XMVECTOR projDet = XMMatrixDeterminant(proj);
+	XMMATRIX invProj = XMMatrixInverse(&projDet, proj);
+
+	XMVECTOR viewProjDet = XMMatrixDeterminant(viewProj);
+	XMMATRIX invViewProj = XMMatrixInverse(&viewProjDet, viewProj);
+
+	XMStoreFloat4x4(&viewProj4x4, viewProj);
+
+	XMStoreFloat4x4(&matrices.View, XMMatrixTranspose(view));
+	XMStoreFloat4x4(&matrices.Proj, XMMatrixTranspose(proj));
+	XMStoreFloat4x4(&matrices.ViewProj, XMMatrixTranspose(viewProj));
+	XMStoreFloat4x4(&matrices.InvView, XMMatrixTranspose(invView));
+	XMStoreFloat4x4(&matrices.InvProj, XMMatrixTranspose(invProj));
+	XMStoreFloat4x4(&matrices.InvViewProj, XMMatrixTranspose(invViewProj));
+}
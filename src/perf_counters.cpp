@@ -0,0 +1,266 @@
+/*****************************************************************//**
+ * \file   perf_counters.cpp
+ * \brief  Definition of PerfCounters, PerfProfiler and PerfZone
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include <cstring>
+#include <iomanip>
+
+#include "perf_counters.h"
+
+#if defined(__linux__)
+#include <cerrno>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static const char* const perf_counter_names[PERF_COUNTER_COUNT] =
+{
+    "cycles",
+    "instructions",
+    "cache_misses",
+    "branch_misses",
+};
+
+const char* PerfCounterName(PERF_COUNTER counter)
+{
+    if (counter < 0 || counter >= PERF_COUNTER_COUNT) return "unknown";
+    return perf_counter_names[counter];
+}
+
+#if defined(__linux__)
+static const uint64_t perf_counter_configs[PERF_COUNTER_COUNT] =
+{
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES,
+};
+
+// Layout of a read of the group leader with the read_format below
+struct perf_group_read
+{
+    uint64_t Count;
+    uint64_t TimeEnabled;
+    uint64_t TimeRunning;
+    uint64_t Values[PERF_COUNTER_COUNT];
+};
+#endif
+
+PerfCounters::~PerfCounters()
+{
+#if defined(__linux__)
+    for (int fd : m_fds)
+    {
+        if (fd >= 0) close(fd);
+    }
+#endif
+}
+
+bool PerfCounters::Open()
+{
+    if (Available()) return true;
+
+#if defined(__linux__)
+    for (int counter = 0; counter < PERF_COUNTER_COUNT; counter++)
+    {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = perf_counter_configs[counter];
+        attr.disabled = counter == 0 ? 1 : 0;       // The leader starts the group
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        // This thread, any CPU
+        long fd = syscall(__NR_perf_event_open, &attr, 0, -1, counter == 0 ? -1 : m_fds[0], 0);
+        if (fd < 0)
+        {
+            m_error = std::string("perf_event_open failed for ") +
+                PerfCounterName(static_cast<PERF_COUNTER>(counter)) + ": " + strerror(errno);
+            for (int opened = 0; opened < counter; opened++)
+            {
+                close(m_fds[opened]);
+                m_fds[opened] = -1;
+            }
+            return false;
+        }
+        m_fds[counter] = static_cast<int>(fd);
+    }
+
+    ioctl(m_fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(m_fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    m_error.clear();
+    return true;
+#else
+    m_error = "hardware counters are only read on Linux";
+    return false;
+#endif
+}
+
+bool PerfCounters::Read(PERF_COUNTER_VALUES& values)
+{
+    if (!Available()) return false;
+
+#if defined(__linux__)
+    perf_group_read group;
+    if (read(m_fds[0], &group, sizeof(group)) != static_cast<ssize_t>(sizeof(group))) return false;
+    if (group.Count != PERF_COUNTER_COUNT || group.TimeRunning == 0) return false;
+
+    // Multiplexed groups count part of the time only
+    double scale = static_cast<double>(group.TimeEnabled) / group.TimeRunning;
+    for (int counter = 0; counter < PERF_COUNTER_COUNT; counter++)
+    {
+        values.Values[counter] = group.TimeRunning == group.TimeEnabled ? group.Values[counter] :
+            static_cast<uint64_t>(group.Values[counter] * scale);
+    }
+    return true;
+#else
+    (void)values;
+    return false;
+#endif
+}
+
+PerfCounters* PerfProfiler::ThreadCounters()
+{
+    thread_local PerfCounters counters;
+    thread_local bool tried = false;
+
+    if (!tried)
+    {
+        tried = true;
+        if (!counters.Open())
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_error.empty()) m_error = counters.Error();
+        }
+    }
+    return counters.Available() ? &counters : nullptr;
+}
+
+void PerfProfiler::Add(const char* name, uint64_t elements, uint64_t nanoseconds,
+    const PERF_COUNTER_VALUES& delta)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Few zones, a search is cheaper than hashing their names
+    PERF_ZONE_STATS* zone = nullptr;
+    for (PERF_ZONE_STATS& existing : m_zones)
+    {
+        if (existing.Name == name)
+        {
+            zone = &existing;
+            break;
+        }
+    }
+    if (zone == nullptr)
+    {
+        PERF_ZONE_STATS added = { };
+        added.Name = name;
+        m_zones.push_back(added);
+        zone = &m_zones.back();
+    }
+
+    zone->Calls++;
+    zone->Elements += elements;
+    zone->Nanoseconds += nanoseconds;
+    for (int counter = 0; counter < PERF_COUNTER_COUNT; counter++)
+    {
+        zone->Counters.Values[counter] += delta.Values[counter];
+    }
+}
+
+std::vector<PERF_ZONE_STATS> PerfProfiler::Zones() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_zones;
+}
+
+void PerfProfiler::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_zones.clear();
+}
+
+std::string PerfProfiler::Error() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_error;
+}
+
+void PerfProfiler::WriteReport(std::ostream& stream) const
+{
+    std::vector<PERF_ZONE_STATS> zones = Zones();
+    std::string error = Error();
+    if (zones.empty())
+    {
+        stream << "No counted zones" << (error.empty() ? "" : ": ") << error << '\n';
+        return;
+    }
+
+    std::ios::fmtflags flags = stream.flags();
+    stream << std::left << std::setw(24) << "zone" << std::right <<
+        std::setw(8) << "calls" << std::setw(12) << "ms" << std::setw(14) << "elements" <<
+        std::setw(8) << "IPC" << std::setw(14) << "cycles/elem" <<
+        std::setw(14) << "cache/elem" << std::setw(14) << "branch/elem" << '\n';
+
+    stream << std::fixed;
+    for (const PERF_ZONE_STATS& zone : zones)
+    {
+        const uint64_t* counters = zone.Counters.Values;
+        double elements = zone.Elements > 0 ? static_cast<double>(zone.Elements) : 1.0;
+        double ipc = counters[PERF_COUNTER_CYCLES] > 0 ?
+            static_cast<double>(counters[PERF_COUNTER_INSTRUCTIONS]) / counters[PERF_COUNTER_CYCLES] : 0.0;
+
+        stream << std::left << std::setw(24) << zone.Name << std::right <<
+            std::setw(8) << zone.Calls <<
+            std::setw(12) << std::setprecision(3) << zone.Nanoseconds * 1e-6 <<
+            std::setw(14) << zone.Elements <<
+            std::setw(8) << std::setprecision(2) << ipc <<
+            std::setw(14) << std::setprecision(2) << counters[PERF_COUNTER_CYCLES] / elements <<
+            std::setw(14) << std::setprecision(4) << counters[PERF_COUNTER_CACHE_MISSES] / elements <<
+            std::setw(14) << std::setprecision(4) << counters[PERF_COUNTER_BRANCH_MISSES] / elements << '\n';
+    }
+    stream.flags(flags);
+}
+
+PerfZone::PerfZone(const char* name, uint64_t elements)
+    : m_name(name), m_elements(elements), m_counters(nullptr)
+{
+    PerfProfiler& profiler = PerfProfiler::Instance();
+    if (!profiler.Enabled()) return;
+
+    m_counters = profiler.ThreadCounters();
+    if (m_counters == nullptr) return;
+
+    if (!m_counters->Read(m_startValues))
+    {
+        m_counters = nullptr;
+        return;
+    }
+    m_start = Clock::Now();
+}
+
+PerfZone::~PerfZone()
+{
+    if (m_counters == nullptr) return;
+
+    uint64_t end = Clock::Now();
+    PERF_COUNTER_VALUES values;
+    if (!m_counters->Read(values)) return;
+
+    PERF_COUNTER_VALUES delta;
+    for (int counter = 0; counter < PERF_COUNTER_COUNT; counter++)
+    {
+        // Scaled values of a multiplexed group can step back slightly
+        delta.Values[counter] = values.Values[counter] > m_startValues.Values[counter] ?
+            values.Values[counter] - m_startValues.Values[counter] : 0;
+    }
+    PerfProfiler::Instance().Add(m_name, m_elements, Clock::ToNanoseconds(end - m_start), delta);
+}
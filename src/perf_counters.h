@@ -0,0 +1,143 @@
+/*****************************************************************//**
+ * \file   perf_counters.h
+ * \brief  Hardware performance counters around selected zones, on Linux
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "clock.h"
+
+enum PERF_COUNTER
+{
+	PERF_COUNTER_CYCLES = 0,
+	PERF_COUNTER_INSTRUCTIONS,
+	PERF_COUNTER_CACHE_MISSES,				// Last level cache
+	PERF_COUNTER_BRANCH_MISSES,
+	PERF_COUNTER_COUNT
+};
+
+const char* PerfCounterName(PERF_COUNTER counter);
+
+struct PERF_COUNTER_VALUES
+{
+	uint64_t Values[PERF_COUNTER_COUNT];
+};
+
+/**
+ * Counters of the calling thread, through perf_event_open.
+ *
+ * The counters are opened as one group, so they count over the same time.
+ * If the kernel multiplexed the group with other events, values are scaled
+ * up to the whole time it was enabled. Kernel time is excluded, so the
+ * default perf_event_paranoid setting allows them.
+ *
+ * Counters are often unavailable: on other systems than Linux, in
+ * containers and virtual machines without access to the PMU, or when
+ * paranoid forbids them. Open then returns false and Error tells why.
+ */
+class PerfCounters
+{
+public:
+	PerfCounters() = default;
+	~PerfCounters();
+
+	PerfCounters(const PerfCounters&) = delete;
+	PerfCounters& operator=(const PerfCounters&) = delete;
+
+	bool Open();
+	bool Available() const { return m_fds[0] >= 0; }
+	const std::string& Error() const { return m_error; }
+
+	// Totals since Open
+	bool Read(PERF_COUNTER_VALUES& values);
+
+private:
+	int m_fds[PERF_COUNTER_COUNT] = { -1, -1, -1, -1 };
+	std::string m_error;
+};
+
+// Counter totals of one zone over all its runs
+struct PERF_ZONE_STATS
+{
+	std::string Name;
+	uint64_t Calls;
+	uint64_t Elements;						// Work items the zone processed, pixels or vertices
+	uint64_t Nanoseconds;
+	PERF_COUNTER_VALUES Counters;
+};
+
+/**
+ * Totals of counters per named zone, across threads.
+ *
+ * A zone counts only the thread it runs on. Work it hands to the job system
+ * counts where it runs: inside zones of the worker threads, or not at all.
+ *
+ * Off by default, since opening counters costs system calls on every thread.
+ * Off or without counters, a zone only checks the flag.
+ */
+class PerfProfiler
+{
+public:
+	static PerfProfiler& Instance()
+	{
+		static PerfProfiler profiler;
+		return profiler;
+	}
+
+	void SetEnabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+	bool Enabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+	// Counters of the calling thread, opened on first use, null if unavailable
+	PerfCounters* ThreadCounters();
+
+	void Add(const char* name, uint64_t elements, uint64_t nanoseconds, const PERF_COUNTER_VALUES& delta);
+	std::vector<PERF_ZONE_STATS> Zones() const;
+	void Clear();
+
+	// Why counters could not be opened, empty if they were or never tried
+	std::string Error() const;
+
+	// Table of the zones with instructions per cycle and misses per element
+	void WriteReport(std::ostream& stream) const;
+
+private:
+	PerfProfiler() = default;
+	PerfProfiler(const PerfProfiler&) = delete;
+	PerfProfiler& operator=(const PerfProfiler&) = delete;
+
+	std::atomic<bool> m_enabled{ false };
+
+	mutable std::mutex m_mutex;
+	std::vector<PERF_ZONE_STATS> m_zones;
+	std::string m_error;
+};
+
+// Adds the counters of its lifetime on the calling thread to a zone
+class PerfZone
+{
+public:
+	explicit PerfZone(const char* name, uint64_t elements = 0);
+	~PerfZone();
+
+	PerfZone(const PerfZone&) = delete;
+	PerfZone& operator=(const PerfZone&) = delete;
+
+	// For zones that learn their size as they run
+	void SetElements(uint64_t elements) { m_elements = elements; }
+
+private:
+	const char* m_name;
+	uint64_t m_elements;
+	PerfCounters* m_counters;
+	uint64_t m_start = 0;
+	PERF_COUNTER_VALUES m_startValues;
+};
@@ -0,0 +1,86 @@
+/*****************************************************************//**
+ * \file   pipeline_library.cpp
+ * \brief  Definition of PipelineLibrary
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include "pipeline_library.h"
+#include "shader_cache.h"
+#include "d3dUtil.h"
+
+using Microsoft::WRL::ComPtr;
+
+PipelineLibrary::PipelineLibrary(ID3D12Device* pDevice, const std::string& filename)
+	: mDevice(pDevice), mFilename(filename)
+{
+	// Pipeline libraries need ID3D12Device1
+	if (FAILED(mDevice.As(&mDevice1))) return;
+
+	if (ReadFileBytes(mFilename, mFileData) && !mFileData.empty())
+	{
+		// Fails after driver or adapter changes, the library is then rebuilt
+		HRESULT hr = mDevice1->CreatePipelineLibrary(mFileData.data(), mFileData.size(),
+			IID_PPV_ARGS(mLibrary.GetAddressOf()));
+		if (SUCCEEDED(hr)) return;
+	}
+
+	CreateEmptyLibrary();
+}
+
+void PipelineLibrary::CreateEmptyLibrary()
+{
+	mLibrary.Reset();
+	mFileData.clear();
+
+	// DXGI_ERROR_UNSUPPORTED leaves mLibrary empty, PSOs are then created directly
+	mDevice1->CreatePipelineLibrary(nullptr, 0, IID_PPV_ARGS(mLibrary.GetAddressOf()));
+	mDirty = true;
+}
+
+ComPtr<ID3D12PipelineState> PipelineLibrary::CreateGraphicsPipeline(const std::wstring& name,
+	const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc)
+{
+	ComPtr<ID3D12PipelineState> pso = nullptr;
+
+	if (mLibrary != nullptr &&
+		SUCCEEDED(mLibrary->LoadGraphicsPipeline(name.c_str(), &desc, IID_PPV_ARGS(pso.GetAddressOf()))))
+	{
+		mLoaded++;
+		mPipelines.push_back({ name, pso });
+		return pso;
+	}
+
+	ThrowIfFailed(mDevice->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(pso.GetAddressOf())));
+	mCreated++;
+
+	if (mLibrary != nullptr)
+	{
+		// The name is taken by a PSO with a different description: start over
+		// with the PSOs of this run only, dropping stale ones
+		if (mLibrary->StorePipeline(name.c_str(), pso.Get()) == E_INVALIDARG)
+		{
+			CreateEmptyLibrary();
+			for (const auto& pipeline : mPipelines)
+			{
+				if (mLibrary != nullptr) mLibrary->StorePipeline(pipeline.first.c_str(), pipeline.second.Get());
+			}
+			if (mLibrary != nullptr) mLibrary->StorePipeline(name.c_str(), pso.Get());
+		}
+		mDirty = true;
+	}
+
+	mPipelines.push_back({ name, pso });
+	return pso;
+}
+
+void PipelineLibrary::Save()
+{
+	if (mLibrary == nullptr || !mDirty) return;
+
+	std::vector<uint8_t> data(mLibrary->GetSerializedSize());
+	if (FAILED(mLibrary->Serialize(data.data(), data.size()))) return;
+
+	// Not fatal, PSOs are compiled again on the next start
+	if (WriteFileBytes(mFilename, data.data(), data.size())) mDirty = false;
+}
@@ -0,0 +1,57 @@
+/*****************************************************************//**
+ * \file   pipeline_library.h
+ * \brief  PSOs persisted between runs through ID3D12PipelineLibrary
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+
+#include <cstdint>
+#include <d3d12.h>
+#include <string>
+#include <utility>
+#include <vector>
+#include <wrl.h>
+
+/**
+ * Creates graphics PSOs through a pipeline library loaded from disk, so that
+ * on a warm start the driver skips compiling them.
+ *
+ * Names should change together with the shaders, e.g. by including their cache
+ * keys. A PSO whose description no longer matches its stored name is created
+ * again and the library is started over. Without library support (older
+ * runtimes, some drivers) PSOs are created directly.
+ */
+class PipelineLibrary
+{
+public:
+	PipelineLibrary(ID3D12Device* pDevice, const std::string& filename);
+
+	Microsoft::WRL::ComPtr<ID3D12PipelineState> CreateGraphicsPipeline(const std::wstring& name,
+		const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc);
+
+	// Writes the library to disk if new PSOs were stored
+	void Save();
+
+	UINT Loaded() const { return mLoaded; }
+	UINT Created() const { return mCreated; }
+
+private:
+	void CreateEmptyLibrary();
+
+	Microsoft::WRL::ComPtr<ID3D12Device>			mDevice = nullptr;
+	Microsoft::WRL::ComPtr<ID3D12Device1>			mDevice1 = nullptr;
+	Microsoft::WRL::ComPtr<ID3D12PipelineLibrary>	mLibrary = nullptr;
+
+	// Every PSO handed out, to store again when the library starts over
+	std::vector<std::pair<std::wstring, Microsoft::WRL::ComPtr<ID3D12PipelineState>>> mPipelines;
+
+	// The library reads from this memory for its whole lifetime
+	std::vector<uint8_t>							mFileData;
+	std::string										mFilename;
+
+	bool											mDirty = false;
+	UINT											mLoaded = 0;
+	UINT											mCreated = 0;
+};
@@ -0,0 +1,165 @@
+/*****************************************************************//**
+ * \file   profiler.cpp
+ * \brief  Definition of ProfileRing and Profiler
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include <fstream>
+
+#include "profiler.h"
+
+thread_local ProfileRing* Profiler::t_ring = nullptr;
+
+ProfileRing::ProfileRing(uint32_t threadId, const std::string& threadName)
+    : m_entries(new Entry[SlotCount]), m_threadId(threadId), m_threadName(threadName)
+{
+}
+
+void ProfileRing::Copy(std::vector<PROFILE_ZONE_RECORD>& records) const
+{
+    uint64_t head = m_head.load(std::memory_order_acquire);
+    uint64_t first = m_tail.load(std::memory_order_relaxed);
+    if (head > Capacity && head - Capacity > first) first = head - Capacity;
+
+    size_t copied = records.size();
+    for (uint64_t i = first; i < head; i++)
+    {
+        const Entry& entry = m_entries[i & (SlotCount - 1)];
+        PROFILE_ZONE_RECORD record;
+        record.Name = entry.Name.load(std::memory_order_relaxed);
+        record.Start = entry.Start.load(std::memory_order_relaxed);
+        record.End = entry.End.load(std::memory_order_relaxed);
+        records.push_back(record);
+    }
+
+    // The owner kept pushing meanwhile. Entries up to the one it may be
+    // writing now were overwritten, possibly halfway. Without new pushes,
+    // that one is the spare slot and nothing is dropped.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t headAfter = m_head.load(std::memory_order_relaxed);
+    if (headAfter + 1 > first + SlotCount)
+    {
+        uint64_t overwritten = headAfter + 1 - SlotCount - first;
+        if (overwritten > head - first) overwritten = head - first;
+        records.erase(records.begin() + copied, records.begin() + copied + static_cast<size_t>(overwritten));
+    }
+}
+
+std::string ProfileRing::ThreadName() const
+{
+    std::lock_guard<std::mutex> lock(m_nameMutex);
+    return m_threadName;
+}
+
+void ProfileRing::SetThreadName(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(m_nameMutex);
+    m_threadName = name;
+}
+
+ProfileRing& Profiler::register_thread()
+{
+    std::lock_guard<std::mutex> lock(m_ringMutex);
+    uint32_t threadId = static_cast<uint32_t>(m_rings.size());
+    m_rings.push_back(std::unique_ptr<ProfileRing>(
+        new ProfileRing(threadId, "thread " + std::to_string(threadId))));
+    return *m_rings.back();
+}
+
+void Profiler::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_ringMutex);
+    for (const std::unique_ptr<ProfileRing>& ring : m_rings) ring->Clear();
+}
+
+// Zone names are literals in code, but may still hold quotes or backslashes
+static void write_json_string(std::ostream& stream, const std::string& text)
+{
+    stream << '"';
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\') stream << '\\' << c;
+        else if (static_cast<unsigned char>(c) < 0x20) stream << ' ';
+        else stream << c;
+    }
+    stream << '"';
+}
+
+static void write_microseconds(std::ostream& stream, uint64_t ticks)
+{
+    uint64_t ns = Clock::ToNanoseconds(ticks);
+    char fraction[4] = { };
+    uint64_t rest = ns % 1000;
+    fraction[0] = static_cast<char>('0' + rest / 100);
+    fraction[1] = static_cast<char>('0' + rest / 10 % 10);
+    fraction[2] = static_cast<char>('0' + rest % 10);
+    stream << ns / 1000 << '.' << fraction;
+}
+
+void Profiler::WriteChromeTrace(std::ostream& stream) const
+{
+    std::vector<PROFILE_ZONE_RECORD> records;
+    std::vector<size_t> ringEnds;
+    std::vector<uint32_t> threadIds;
+    std::vector<std::string> threadNames;
+    {
+        std::lock_guard<std::mutex> lock(m_ringMutex);
+        for (const std::unique_ptr<ProfileRing>& ring : m_rings)
+        {
+            ring->Copy(records);
+            ringEnds.push_back(records.size());
+            threadIds.push_back(ring->ThreadId());
+            threadNames.push_back(ring->ThreadName());
+        }
+    }
+
+    uint64_t origin = 0;
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        if (i == 0 || records[i].Start < origin) origin = records[i].Start;
+    }
+
+    stream << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    bool first = true;
+    for (size_t ring = 0; ring < threadIds.size(); ring++)
+    {
+        if (!first) stream << ",\n";
+        first = false;
+        stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << threadIds[ring] <<
+            ",\"args\":{\"name\":";
+        write_json_string(stream, threadNames[ring]);
+        stream << "}}";
+    }
+
+    size_t begin = 0;
+    for (size_t ring = 0; ring < threadIds.size(); ring++)
+    {
+        for (size_t i = begin; i < ringEnds[ring]; i++)
+        {
+            const PROFILE_ZONE_RECORD& record = records[i];
+            if (record.Name == nullptr) continue;
+
+            if (!first) stream << ",\n";
+            first = false;
+            stream << "{\"name\":";
+            write_json_string(stream, record.Name);
+            stream << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << threadIds[ring] << ",\"ts\":";
+            write_microseconds(stream, record.Start - origin);
+            stream << ",\"dur\":";
+            write_microseconds(stream, record.End - record.Start);
+            stream << "}";
+        }
+        begin = ringEnds[ring];
+    }
+    stream << "\n]}\n";
+}
+
+bool Profiler::WriteChromeTrace(const std::string& filename) const
+{
+    std::ofstream file(filename, std::ios::out | std::ios::trunc);
+    if (!file) return false;
+
+    WriteChromeTrace(file);
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,169 @@
+/*****************************************************************//**
+ * \file   profiler.h
+ * \brief  Scoped CPU zones recorded per thread, exported as a Chrome trace
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "clock.h"
+
+// A zone that ended, in Clock ticks
+struct PROFILE_ZONE_RECORD
+{
+	const char* Name;
+	uint64_t Start;
+	uint64_t End;
+};
+
+/**
+ * Ring of the latest zones of one thread.
+ *
+ * Only the owning thread writes, without locks: an entry, then the count of
+ * entries written. Readers copy the entries behind the count and drop those
+ * the owner may have overwritten meanwhile. Older zones are lost once the
+ * ring is full.
+ */
+class ProfileRing
+{
+public:
+	// Zones a ring holds. One more slot is kept for the entry the owner may
+	// be writing while a reader copies the others.
+	static const uint32_t Capacity = (1 << 16) - 1;
+
+	ProfileRing(uint32_t threadId, const std::string& threadName);
+
+	void Push(const char* name, uint64_t start, uint64_t end)
+	{
+		uint64_t head = m_head.load(std::memory_order_relaxed);
+		Entry& entry = m_entries[head & (SlotCount - 1)];
+		entry.Name.store(name, std::memory_order_relaxed);
+		entry.Start.store(start, std::memory_order_relaxed);
+		entry.End.store(end, std::memory_order_relaxed);
+		m_head.store(head + 1, std::memory_order_release);
+	}
+
+	// Appends the zones still in the ring since the last Clear, oldest first
+	void Copy(std::vector<PROFILE_ZONE_RECORD>& records) const;
+	void Clear() { m_tail.store(m_head.load(std::memory_order_acquire), std::memory_order_relaxed); }
+
+	uint32_t ThreadId() const { return m_threadId; }
+	std::string ThreadName() const;
+	void SetThreadName(const std::string& name);
+
+	// Zones pushed, including those overwritten
+	uint64_t Pushed() const { return m_head.load(std::memory_order_relaxed); }
+
+private:
+	static const uint32_t SlotCount = Capacity + 1;
+
+	struct Entry
+	{
+		std::atomic<const char*> Name;
+		std::atomic<uint64_t> Start;
+		std::atomic<uint64_t> End;
+	};
+
+	std::unique_ptr<Entry[]> m_entries;
+	std::atomic<uint64_t> m_head{ 0 };
+	std::atomic<uint64_t> m_tail{ 0 };		// Zones before are cleared
+
+	uint32_t m_threadId;
+	mutable std::mutex m_nameMutex;
+	std::string m_threadName;
+};
+
+/**
+ * Collects zones from every thread that records one.
+ *
+ * A thread gets its ring on its first zone; rings live as long as the
+ * profiler, so zones of threads that exited can still be exported. Zone
+ * names must outlive the profiler too, string literals in practice.
+ *
+ * Recording is on by default. Turned off, a zone costs a relaxed load.
+ */
+class Profiler
+{
+public:
+	static Profiler& Instance()
+	{
+		static Profiler profiler;
+		return profiler;
+	}
+
+	void SetEnabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+	bool Enabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+	// Ring of the calling thread
+	ProfileRing& ThreadRing()
+	{
+		if (t_ring == nullptr) t_ring = &register_thread();
+		return *t_ring;
+	}
+
+	// Names the calling thread in exported traces
+	void SetThreadName(const std::string& name) { ThreadRing().SetThreadName(name); }
+
+	// Forgets all recorded zones
+	void Clear();
+
+	// Chrome trace event JSON, loads in chrome://tracing and Perfetto.
+	// Times are microseconds since the earliest zone.
+	void WriteChromeTrace(std::ostream& stream) const;
+	bool WriteChromeTrace(const std::string& filename) const;
+
+private:
+	Profiler() = default;
+	Profiler(const Profiler&) = delete;
+	Profiler& operator=(const Profiler&) = delete;
+
+	ProfileRing& register_thread();
+
+	static thread_local ProfileRing* t_ring;
+
+	std::atomic<bool> m_enabled{ true };
+
+	mutable std::mutex m_ringMutex;
+	std::vector<std::unique_ptr<ProfileRing>> m_rings;
+};
+
+// Records the time between its construction and destruction as a zone
+class ProfileZone
+{
+public:
+	explicit ProfileZone(const char* name)
+		: m_name(name)
+	{
+		Profiler& profiler = Profiler::Instance();
+		m_ring = profiler.Enabled() ? &profiler.ThreadRing() : nullptr;
+		m_start = m_ring != nullptr ? Clock::Now() : 0;
+	}
+	~ProfileZone()
+	{
+		if (m_ring != nullptr) m_ring->Push(m_name, m_start, Clock::Now());
+	}
+
+	ProfileZone(const ProfileZone&) = delete;
+	ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+	const char* m_name;
+	ProfileRing* m_ring;
+	uint64_t m_start;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+// Zone lasting until the end of the enclosing scope
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_ZONE(__FUNCTION__)
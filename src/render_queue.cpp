@@ -0,0 +1,134 @@
+/*****************************************************************//**
+ * \file   render_queue.cpp
+ * \brief  Definition of RenderQueue and packet radix sort
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include "render_queue.h"
+
+static inline uint64_t field(uint32_t value, uint32_t bits)
+{
+    return static_cast<uint64_t>(value) & ((static_cast<uint64_t>(1) << bits) - 1);
+}
+
+static inline uint32_t quantize_depth(float depth)
+{
+    if (!(depth > 0.0f)) return 0;      // Also catches NaN
+    if (depth >= 1.0f) return (1u << RenderQueue::DepthBits) - 1;
+    return static_cast<uint32_t>(depth * static_cast<float>((1u << RenderQueue::DepthBits) - 1));
+}
+
+uint64_t RenderQueue::OpaqueKey(uint32_t layer, uint32_t pipeline, uint32_t texture,
+    uint32_t drawable, float depth, uint32_t material)
+{
+    uint64_t key = field(layer, LayerBits);
+    key = (key << PipelineBits) | field(pipeline, PipelineBits);
+    key = (key << TextureBits) | field(texture, TextureBits);
+    key = (key << DrawableBits) | field(drawable, DrawableBits);
+    key = (key << DepthBits) | quantize_depth(depth);
+    key = (key << MaterialBits) | field(material, MaterialBits);
+    return key;
+}
+
+uint64_t RenderQueue::TransparentKey(uint32_t layer, uint32_t pipeline, uint32_t texture,
+    uint32_t drawable, float depth, uint32_t material)
+{
+    // Far first: larger depth gives a smaller key
+    uint32_t invertedDepth = ((1u << DepthBits) - 1) - quantize_depth(depth);
+
+    uint64_t key = field(layer, LayerBits);
+    key = (key << DepthBits) | invertedDepth;
+    key = (key << PipelineBits) | field(pipeline, PipelineBits);
+    key = (key << TextureBits) | field(texture, TextureBits);
+    key = (key << DrawableBits) | field(drawable, DrawableBits);
+    key = (key << MaterialBits) | field(material, MaterialBits);
+    return key;
+}
+
+void RadixSortPackets(std::vector<RENDER_PACKET>& packets, std::vector<RENDER_PACKET>& scratch)
+{
+    const size_t count = packets.size();
+    if (count < 2) return;
+
+    // Histograms of all 8 digits in one read of the data
+    uint32_t histograms[8][256] = { };
+    for (const RENDER_PACKET& packet : packets)
+    {
+        for (int pass = 0; pass < 8; pass++)
+        {
+            histograms[pass][(packet.Key >> (pass * 8)) & 0xFF]++;
+        }
+    }
+
+    scratch.resize(count);
+    RENDER_PACKET* pSrc = packets.data();
+    RENDER_PACKET* pDst = scratch.data();
+
+    for (int pass = 0; pass < 8; pass++)
+    {
+        uint32_t* histogram = histograms[pass];
+        const int shift = pass * 8;
+
+        // All keys share this digit: the pass would not move anything
+        if (histogram[(pSrc[0].Key >> shift) & 0xFF] == count) continue;
+
+        // Exclusive prefix sum gives the first slot of every digit
+        uint32_t offset = 0;
+        for (int digit = 0; digit < 256; digit++)
+        {
+            uint32_t digitCount = histogram[digit];
+            histogram[digit] = offset;
+            offset += digitCount;
+        }
+
+        for (size_t i = 0; i < count; i++)
+        {
+            pDst[histogram[(pSrc[i].Key >> shift) & 0xFF]++] = pSrc[i];
+        }
+
+        RENDER_PACKET* pTemp = pSrc;
+        pSrc = pDst;
+        pDst = pTemp;
+    }
+
+    // After an odd number of passes the result is in scratch
+    if (pSrc != packets.data())
+    {
+        packets.swap(scratch);
+    }
+}
+
+void RenderQueue::Begin()
+{
+    m_packets.clear();
+    m_instanceObjects.clear();
+    m_batches.clear();
+    m_batchLightMasks.clear();
+}
+
+void RenderQueue::Sort()
+{
+    RadixSortPackets(m_packets, m_scratch);
+
+    m_instanceObjects.resize(m_packets.size());
+    m_batches.clear();
+    m_batchLightMasks.clear();
+
+    for (uint32_t i = 0; i < static_cast<uint32_t>(m_packets.size()); i++)
+    {
+        const RENDER_PACKET& packet = m_packets[i];
+        m_instanceObjects[i] = packet.ObjectIndex;
+
+        if (!m_batches.empty() && m_batches.back().DrawableIndex == packet.DrawableIndex)
+        {
+            m_batches.back().InstanceCount++;
+            m_batchLightMasks.back() |= packet.LightMask;
+        }
+        else
+        {
+            m_batches.push_back({ packet.DrawableIndex, i, 1 });
+            m_batchLightMasks.push_back(packet.LightMask);
+        }
+    }
+}
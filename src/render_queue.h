@@ -0,0 +1,103 @@
+/*****************************************************************//**
+ * \file   render_queue.h
+ * \brief  Sorted queue of draw packets
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// One instanced draw: InstanceCount objects drawn with the same drawable.
+// Object indices of the batch are InstanceObjects()[FirstInstance, FirstInstance + InstanceCount).
+struct INSTANCE_BATCH
+{
+	uint32_t DrawableIndex;
+	uint32_t FirstInstance;
+	uint32_t InstanceCount;
+};
+
+// One render item submitted for the frame
+struct RENDER_PACKET
+{
+	uint64_t Key;
+	uint32_t DrawableIndex;
+	uint32_t ObjectIndex;
+	uint32_t LightMask;		// Bit per light slot reaching the item
+};
+
+/**
+ * Sorts a frame's render items by a 64-bit key so that draws sharing pipeline
+ * state end up next to each other.
+ *
+ * Opaque key, from the most significant bits:
+ *   layer (2) | PSO (6) | texture (10) | drawable (16) | depth (24) | material (6)
+ * Transparent key:
+ *   layer (2) | inverted depth (24) | PSO (6) | texture (10) | drawable (16) | material (6)
+ *
+ * Opaque draws are grouped by state and go front-to-back within a drawable,
+ * transparent ones go strictly back-to-front. Materials are indexed per object
+ * from a structured buffer, so they cost no state change and only break ties.
+ *
+ * Runs of packets with the same drawable form instanced batches. Their objects
+ * are listed in sorted order in InstanceObjects(), which the GPU reads as a
+ * structured buffer indexed by SV_InstanceID. The class does not depend on D3D.
+ */
+class RenderQueue
+{
+public:
+	static const uint32_t LayerBits = 2;
+	static const uint32_t PipelineBits = 6;
+	static const uint32_t TextureBits = 10;
+	static const uint32_t DrawableBits = 16;
+	static const uint32_t DepthBits = 24;
+	static const uint32_t MaterialBits = 6;
+
+	// depth is view distance normalized to [0, 1], clamped
+	static uint64_t OpaqueKey(uint32_t layer, uint32_t pipeline, uint32_t texture,
+		uint32_t drawable, float depth, uint32_t material);
+	static uint64_t TransparentKey(uint32_t layer, uint32_t pipeline, uint32_t texture,
+		uint32_t drawable, float depth, uint32_t material);
+
+	// Extracts the layer from either kind of key
+	static uint32_t KeyLayer(uint64_t key) { return static_cast<uint32_t>(key >> (64 - LayerBits)); }
+
+	// Clears packets of the previous frame, keeps the memory
+	void Begin();
+
+	void Submit(uint64_t key, uint32_t drawableIndex, uint32_t objectIndex, uint32_t lightMask = 0)
+	{
+		m_packets.push_back({ key, drawableIndex, objectIndex, lightMask });
+	}
+
+	// Sorts packets by key and merges runs of one drawable into batches
+	void Sort();
+
+	const std::vector<RENDER_PACKET>& Packets() const { return m_packets; }
+	const std::vector<uint32_t>& InstanceObjects() const { return m_instanceObjects; }
+	const std::vector<INSTANCE_BATCH>& Batches() const { return m_batches; }
+
+	// Lights reaching any instance of each batch, parallel to Batches()
+	const std::vector<uint32_t>& BatchLightMasks() const { return m_batchLightMasks; }
+
+private:
+	std::vector<RENDER_PACKET> m_packets;
+	std::vector<RENDER_PACKET> m_scratch;
+
+	std::vector<uint32_t> m_instanceObjects;
+	std::vector<INSTANCE_BATCH> m_batches;
+	std::vector<uint32_t> m_batchLightMasks;
+};
+
+/**
+ * Stable LSD radix sort of packets by key, 8 bits per pass. Passes where all
+ * keys share the same byte are skipped, so keys using few distinct bits sort
+ * in fewer passes.
+ *
+ * \param packets data to sort, sorted on return
+ * \param scratch temporary storage, resized as needed
+ */
+void RadixSortPackets(std::vector<RENDER_PACKET>& packets, std::vector<RENDER_PACKET>& scratch);
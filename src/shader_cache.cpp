@@ -0,0 +1,241 @@
+/*****************************************************************//**
+ * \file   shader_cache.cpp
+ * \brief  Definition of ShaderCache
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#include "shader_cache.h"
+
+// Bump when the entry format or the hashed fields change
+static const uint32_t CacheFormatVersion = 2;
+
+// Precedes the bytecode in an entry. A truncated or overwritten entry fails
+// the checks and is compiled again, rather than handed to the driver.
+struct CACHE_ENTRY_HEADER
+{
+    uint32_t Magic;
+    uint32_t Version;
+    uint64_t Key;                   // Of the inputs, as in the file name
+    uint64_t BytecodeSize;
+    uint64_t BytecodeHash;
+};
+
+static const uint32_t CacheEntryMagic = 0x43534850;    // "PHSC"
+
+uint64_t HashBytes(const void* pData, size_t size, uint64_t seed)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(pData);
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// Strings are hashed with their length, so that ("ab", "c") and ("a", "bc") differ
+static uint64_t hash_string(const std::string& str, uint64_t seed)
+{
+    uint64_t length = str.size();
+    seed = HashBytes(&length, sizeof(length), seed);
+    return HashBytes(str.data(), str.size(), seed);
+}
+
+static std::string directory_of(const std::string& filename)
+{
+    size_t slash = filename.find_last_of("/\\");
+    return slash == std::string::npos ? std::string() : filename.substr(0, slash + 1);
+}
+
+bool ReadFileBytes(const std::string& filename, std::vector<uint8_t>& data)
+{
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file) return false;
+
+    std::streamoff size = file.tellg();
+    if (size < 0) return false;
+
+    data.resize(static_cast<size_t>(size));
+    file.seekg(0);
+    return size == 0 || static_cast<bool>(file.read(reinterpret_cast<char*>(data.data()), size));
+}
+
+bool WriteFileBytes(const std::string& filename, const void* pData, size_t size)
+{
+    std::string temporary = filename + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file) return false;
+        file.write(static_cast<const char*>(pData), static_cast<std::streamsize>(size));
+        if (!file) return false;
+    }
+
+    // rename does not replace an existing file on Windows
+    std::remove(filename.c_str());
+    if (std::rename(temporary.c_str(), filename.c_str()) != 0)
+    {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool EnsureDirectory(const std::string& directory)
+{
+#ifdef _WIN32
+    int result = _mkdir(directory.c_str());
+#else
+    int result = mkdir(directory.c_str(), 0755);
+#endif
+    return result == 0 || errno == EEXIST;
+}
+
+ShaderCache::ShaderCache(const std::string& directory, ShaderCompileFn compiler, const std::string& compilerTag)
+    : m_directory(directory), m_compiler(std::move(compiler)), m_compilerTag(compilerTag)
+{
+    if (!m_directory.empty() && m_directory.back() != '/' && m_directory.back() != '\\')
+    {
+        m_directory += '/';
+    }
+    EnsureDirectory(m_directory.substr(0, m_directory.size() - 1));
+}
+
+bool ShaderCache::hash_file(const std::string& filename, uint64_t& hash,
+    std::vector<std::string>& visited) const
+{
+    // Each file counts once, which also stops include cycles
+    if (std::find(visited.begin(), visited.end(), filename) != visited.end()) return true;
+    visited.push_back(filename);
+
+    std::vector<uint8_t> source;
+    if (!ReadFileBytes(filename, source)) return false;
+
+    hash = hash_string(filename, hash);
+    uint64_t size = source.size();
+    hash = HashBytes(&size, sizeof(size), hash);
+    hash = HashBytes(source.data(), source.size(), hash);
+
+    // Follow #include "file" lines, in the order they appear
+    const std::string text(source.begin(), source.end());
+    const std::string directory = directory_of(filename);
+    size_t pos = 0;
+    while ((pos = text.find("#include", pos)) != std::string::npos)
+    {
+        pos += 8;
+        size_t lineEnd = text.find('\n', pos);
+        size_t open = text.find('"', pos);
+        if (open == std::string::npos || open > lineEnd) continue;
+        size_t close = text.find('"', open + 1);
+        if (close == std::string::npos || close > lineEnd) continue;
+
+        if (!hash_file(directory + text.substr(open + 1, close - open - 1), hash, visited)) return false;
+    }
+    return true;
+}
+
+bool ShaderCache::ComputeKey(const SHADER_DESC& desc, uint64_t& key) const
+{
+    uint64_t hash = HashBytes(&CacheFormatVersion, sizeof(CacheFormatVersion));
+    hash = hash_string(m_compilerTag, hash);
+
+    std::vector<std::string> visited;
+    if (!hash_file(desc.Filename, hash, visited)) return false;
+
+    uint64_t defineCount = desc.Defines.size();
+    hash = HashBytes(&defineCount, sizeof(defineCount), hash);
+    for (const auto& define : desc.Defines)
+    {
+        hash = hash_string(define.first, hash);
+        hash = hash_string(define.second, hash);
+    }
+
+    hash = hash_string(desc.EntryPoint, hash);
+    hash = hash_string(desc.Target, hash);
+
+    key = hash;
+    return true;
+}
+
+std::string ShaderCache::EntryPath(uint64_t key) const
+{
+    char name[17];
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(key));
+    return m_directory + name + ".cso";
+}
+
+// Bytecode of an entry, false if the entry is missing or damaged
+static bool read_entry(const std::string& path, uint64_t key, std::vector<uint8_t>& bytecode)
+{
+    std::vector<uint8_t> data;
+    if (!ReadFileBytes(path, data) || data.size() <= sizeof(CACHE_ENTRY_HEADER)) return false;
+
+    CACHE_ENTRY_HEADER header;
+    memcpy(&header, data.data(), sizeof(header));
+    const uint8_t* pBytecode = data.data() + sizeof(header);
+    if (header.Magic != CacheEntryMagic || header.Version != CacheFormatVersion ||
+        header.Key != key || header.BytecodeSize != data.size() - sizeof(header) ||
+        header.BytecodeHash != HashBytes(pBytecode, data.size() - sizeof(header)))
+    {
+        return false;
+    }
+
+    bytecode.assign(data.begin() + sizeof(header), data.end());
+    return true;
+}
+
+static bool write_entry(const std::string& path, uint64_t key, const std::vector<uint8_t>& bytecode)
+{
+    CACHE_ENTRY_HEADER header;
+    header.Magic = CacheEntryMagic;
+    header.Version = CacheFormatVersion;
+    header.Key = key;
+    header.BytecodeSize = bytecode.size();
+    header.BytecodeHash = HashBytes(bytecode.data(), bytecode.size());
+
+    std::vector<uint8_t> data(sizeof(header) + bytecode.size());
+    memcpy(data.data(), &header, sizeof(header));
+    if (!bytecode.empty()) memcpy(data.data() + sizeof(header), bytecode.data(), bytecode.size());
+    return WriteFileBytes(path, data.data(), data.size());
+}
+
+bool ShaderCache::Get(const SHADER_DESC& desc, std::vector<uint8_t>& bytecode, uint64_t* key)
+{
+    m_errors.clear();
+
+    uint64_t entryKey = 0;
+    if (!ComputeKey(desc, entryKey))
+    {
+        m_errors = "Cannot read " + desc.Filename + " or one of its includes";
+        return false;
+    }
+    if (key) *key = entryKey;
+
+    const std::string path = EntryPath(entryKey);
+    if (read_entry(path, entryKey, bytecode))
+    {
+        m_hits++;
+        return true;
+    }
+
+    m_misses++;
+    bytecode.clear();
+    if (!m_compiler(desc, bytecode, m_errors)) return false;
+
+    // A failed write only costs a compilation next time
+    write_entry(path, entryKey, bytecode);
+    return true;
+}
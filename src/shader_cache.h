@@ -0,0 +1,90 @@
+/*****************************************************************//**
+ * \file   shader_cache.h
+ * \brief  Content-addressed disk cache of compiled shaders
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// 64-bit FNV-1a, continue a running hash by passing it as seed
+uint64_t HashBytes(const void* pData, size_t size, uint64_t seed = 0xcbf29ce484222325ull);
+
+// Everything that decides the output of a shader compilation
+struct SHADER_DESC
+{
+	std::string Filename;
+	std::vector<std::pair<std::string, std::string>> Defines;
+	std::string EntryPoint;
+	std::string Target;
+};
+
+// Compiles a shader, returns false and fills errors on failure
+typedef std::function<bool(const SHADER_DESC& desc,
+	std::vector<uint8_t>& bytecode, std::string& errors)> ShaderCompileFn;
+
+/**
+ * Stores compiled shaders on disk under the hash of their inputs: the source
+ * file and every file it includes, defines, entry point and target. A shader
+ * whose inputs did not change is read back instead of being compiled. Entries
+ * carry a checksum of the bytecode; a damaged entry counts as a miss and is
+ * compiled and written again.
+ *
+ * Includes are found by scanning for #include "file" relative to the including
+ * file; system includes in angle brackets are not followed.
+ *
+ * The compiler is a callback, so the cache does not depend on D3D. The compiler
+ * tag is hashed into every key and should change with anything the callback
+ * decides on its own, such as the compiler version and flags.
+ */
+class ShaderCache
+{
+public:
+	ShaderCache(const std::string& directory, ShaderCompileFn compiler, const std::string& compilerTag);
+
+	/**
+	 * Gets the bytecode of a shader from the cache, compiling and storing it on a miss.
+	 *
+	 * \param key receives the cache key, if not null
+	 * \return false if the source could not be read or the compiler failed
+	 */
+	bool Get(const SHADER_DESC& desc, std::vector<uint8_t>& bytecode, uint64_t* key = nullptr);
+
+	// Hash of the shader's inputs, false if a source file is missing
+	bool ComputeKey(const SHADER_DESC& desc, uint64_t& key) const;
+
+	// Path of the cache entry for a key
+	std::string EntryPath(uint64_t key) const;
+
+	const std::string& Errors() const { return m_errors; }
+	uint32_t Hits() const { return m_hits; }
+	uint32_t Misses() const { return m_misses; }
+
+private:
+	bool hash_file(const std::string& filename, uint64_t& hash,
+		std::vector<std::string>& visited) const;
+
+	std::string m_directory;
+	ShaderCompileFn m_compiler;
+	std::string m_compilerTag;
+
+	std::string m_errors;
+	uint32_t m_hits = 0;
+	uint32_t m_misses = 0;
+};
+
+// Whole-file helpers, also used for the pipeline library
+bool ReadFileBytes(const std::string& filename, std::vector<uint8_t>& data);
+
+// Writes through a temporary file, so a crash never leaves a partial file behind
+bool WriteFileBytes(const std::string& filename, const void* pData, size_t size);
+
+// Creates the directory if it does not exist, not its parents
+bool EnsureDirectory(const std::string& directory);
@@ -0,0 +1,103 @@
+/*****************************************************************//**
+ * \file   shader_permutations.cpp
+ * \brief  Definition of ShaderPermutations
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include "shader_permutations.h"
+
+uint32_t ShaderPermutations::add_axis(const std::string& define, uint32_t maxValue, bool flag)
+{
+    uint32_t bits = 1;
+    while (bits < 32 && (maxValue >> bits) != 0) bits++;
+
+    // Keys are 32 bits; axes that do not fit are a programming error
+    if (m_usedBits + bits > 32) return UINT32_MAX;
+
+    m_axes.push_back({ define, maxValue, m_usedBits, bits, flag });
+    m_usedBits += bits;
+    return static_cast<uint32_t>(m_axes.size() - 1);
+}
+
+uint32_t ShaderPermutations::AddCount(const std::string& define, uint32_t maxValue)
+{
+    return add_axis(define, maxValue, false);
+}
+
+uint32_t ShaderPermutations::AddFlag(const std::string& define)
+{
+    return add_axis(define, 1, true);
+}
+
+uint32_t ShaderPermutations::Set(uint32_t key, uint32_t axis, uint32_t value) const
+{
+    const Axis& a = m_axes[axis];
+    if (value > a.MaxValue) value = a.MaxValue;
+
+    uint32_t mask = ((a.Bits < 32 ? (1u << a.Bits) : 0u) - 1) << a.Shift;
+    return (key & ~mask) | (value << a.Shift);
+}
+
+uint32_t ShaderPermutations::Get(uint32_t key, uint32_t axis) const
+{
+    const Axis& a = m_axes[axis];
+    return (key >> a.Shift) & ((a.Bits < 32 ? (1u << a.Bits) : 0u) - 1);
+}
+
+std::vector<std::pair<std::string, std::string>> ShaderPermutations::Defines(uint32_t key) const
+{
+    std::vector<std::pair<std::string, std::string>> defines;
+    for (uint32_t axis = 0; axis < m_axes.size(); axis++)
+    {
+        uint32_t value = Get(key, axis);
+        if (m_axes[axis].Flag)
+        {
+            if (value) defines.push_back({ m_axes[axis].Define, "1" });
+        }
+        else
+        {
+            defines.push_back({ m_axes[axis].Define, std::to_string(value) });
+        }
+    }
+    return defines;
+}
+
+std::string ShaderPermutations::Name(uint32_t key) const
+{
+    std::string name;
+    for (uint32_t axis = 0; axis < m_axes.size(); axis++)
+    {
+        uint32_t value = Get(key, axis);
+        if (m_axes[axis].Flag && !value) continue;
+
+        if (!name.empty()) name += ' ';
+        name += m_axes[axis].Define;
+        if (!m_axes[axis].Flag) name += '=' + std::to_string(value);
+    }
+    return name;
+}
+
+DRAW_LIGHTS PackDrawLights(uint32_t lightMask,
+    uint32_t directionalCount, uint32_t pointCount, uint32_t spotCount)
+{
+    DRAW_LIGHTS lights = { };
+
+    const uint32_t typeCounts[3] = { directionalCount, pointCount, spotCount };
+    uint32_t* drawCounts[3] = { &lights.Directional, &lights.Point, &lights.Spot };
+
+    uint32_t slot = 0;
+    uint32_t packed = 0;
+    for (int type = 0; type < 3; type++)
+    {
+        for (uint32_t i = 0; i < typeCounts[type] && slot < 16; i++, slot++)
+        {
+            if (!(lightMask & (1u << slot))) continue;
+
+            lights.Indices[packed / 8] |= slot << ((packed % 8) * 4);
+            packed++;
+            (*drawCounts[type])++;
+        }
+    }
+    return lights;
+}
@@ -0,0 +1,75 @@
+/*****************************************************************//**
+ * \file   shader_permutations.h
+ * \brief  Feature axes of shader variants and their bitmask keys
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Describes the compile-time features a shader is specialized on and packs one
+ * value per feature into a 32-bit variant key.
+ *
+ * A count axis takes values [0, maxValue] and is always defined, e.g.
+ * NUM_POINT_LIGHTS=2. A flag axis is defined as 1 when set and left undefined
+ * otherwise, so shaders can test it with #ifdef. Variants are compiled from the
+ * defines of their key, which also serves as the key of the caller's variant
+ * table.
+ */
+class ShaderPermutations
+{
+public:
+	uint32_t AddCount(const std::string& define, uint32_t maxValue);
+	uint32_t AddFlag(const std::string& define);
+
+	// Values above the maximum of the axis are clamped
+	uint32_t Set(uint32_t key, uint32_t axis, uint32_t value) const;
+	uint32_t Get(uint32_t key, uint32_t axis) const;
+
+	uint32_t MaxValue(uint32_t axis) const { return m_axes[axis].MaxValue; }
+	uint32_t AxisCount() const { return static_cast<uint32_t>(m_axes.size()); }
+
+	// Defines of a variant, to pass to the compiler along with the fixed ones
+	std::vector<std::pair<std::string, std::string>> Defines(uint32_t key) const;
+
+	// Readable form such as "NUM_DIR_LIGHTS=1 NUM_POINT_LIGHTS=0 FOG"
+	std::string Name(uint32_t key) const;
+
+private:
+	struct Axis
+	{
+		std::string Define;
+		uint32_t MaxValue;
+		uint32_t Shift;
+		uint32_t Bits;
+		bool Flag;
+	};
+
+	uint32_t add_axis(const std::string& define, uint32_t maxValue, bool flag);
+
+	std::vector<Axis> m_axes;
+	uint32_t m_usedBits = 0;
+};
+
+// Lights of one draw: how many of each type, and their slots in the light array
+struct DRAW_LIGHTS
+{
+	uint32_t Directional;
+	uint32_t Point;
+	uint32_t Spot;
+	uint32_t Indices[2];	// Slots, 4 bits each, directional first, then point, then spot
+};
+
+/**
+ * Compacts the lights of a draw into a slot list for the shader. Lights are
+ * stored directional, point, spot in an array of at most 16; bit i of lightMask
+ * marks slot i as affecting the draw.
+ */
+DRAW_LIGHTS PackDrawLights(uint32_t lightMask,
+	uint32_t directionalCount, uint32_t pointCount, uint32_t spotCount);
@@ -0,0 +1,98 @@
+/*****************************************************************//**
+ * \file   stall_stats.cpp
+ * \brief  Definition of stall histograms
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include "stall_stats.h"
+
+static const char* const stall_site_names[STALL_SITE_COUNT] =
+{
+    "FlushCommandQueue",
+    "NextFrameResource",
+    "ConstructGeometry"
+};
+
+const char* StallSiteName(STALL_SITE site)
+{
+    if (site < 0 || site >= STALL_SITE_COUNT) return "Unknown";
+    return stall_site_names[site];
+}
+
+StallHistogram::StallHistogram()
+{
+    Reset();
+}
+
+void StallHistogram::Reset()
+{
+    for (int i = 0; i < BucketCount; i++)
+    {
+        m_buckets[i].store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_totalNs.store(0, std::memory_order_relaxed);
+    m_maxNs.store(0, std::memory_order_relaxed);
+}
+
+int StallHistogram::bucket_index(uint64_t nanoseconds)
+{
+    uint64_t us = nanoseconds / 1000;
+
+    // Position of the highest set bit + 1, 0 for sub-microsecond stalls
+    int bucket = 0;
+    while (us != 0 && bucket < BucketCount - 1)
+    {
+        us >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+uint64_t StallHistogram::BucketUpperBoundNs(int bucket)
+{
+    return (1ull << bucket) * 1000ull;
+}
+
+void StallHistogram::Record(uint64_t nanoseconds)
+{
+    m_buckets[bucket_index(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_totalNs.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+    uint64_t prevMax = m_maxNs.load(std::memory_order_relaxed);
+    while (nanoseconds > prevMax
+        && !m_maxNs.compare_exchange_weak(prevMax, nanoseconds, std::memory_order_relaxed))
+    {
+    }
+}
+
+uint64_t StallHistogram::PercentileNs(double p) const
+{
+    uint64_t count = Count();
+    if (count == 0) return 0;
+
+    if (p < 0.0) p = 0.0;
+    if (p > 1.0) p = 1.0;
+
+    // Rank of the requested sample, at least the first one
+    uint64_t rank = (uint64_t)(p * (double)count + 0.5);
+    if (rank == 0) rank = 1;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < BucketCount; i++)
+    {
+        seen += BucketValue(i);
+        if (seen >= rank) return BucketUpperBoundNs(i);
+    }
+    return MaxNanoseconds();
+}
+
+void StallRecorder::Reset()
+{
+    for (int i = 0; i < STALL_SITE_COUNT; i++)
+    {
+        m_sites[i].Reset();
+    }
+}
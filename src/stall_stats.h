@@ -0,0 +1,75 @@
+/*****************************************************************//**
+ * \file   stall_stats.h
+ * \brief  Histograms of CPU stall time per call site
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Places in the program where the CPU may block waiting for the GPU
+enum STALL_SITE
+{
+	STALL_SITE_FLUSH_COMMAND_QUEUE = 0,		// D3DBase::FlushCommandQueue
+	STALL_SITE_FRAME_RESOURCE,				// DynamicResources::NextFrameResource
+	STALL_SITE_GEOMETRY_UPLOAD,				// StaticGeometryUploader::ConstructGeometry
+	STALL_SITE_COUNT
+};
+
+const char* StallSiteName(STALL_SITE site);
+
+/**
+ * Histogram of stall durations with logarithmic buckets.
+ *
+ * Bucket 0 counts stalls shorter than 1 us, bucket i > 0 counts stalls
+ * in [2^(i-1), 2^i) us. Recording is lock-free and can be done from any thread.
+ */
+class StallHistogram
+{
+public:
+	static const int BucketCount = 32;
+
+	StallHistogram();
+
+	// Forbid copying
+	StallHistogram(StallHistogram& other) = delete;
+	StallHistogram& operator=(StallHistogram& rhs) = delete;
+
+	void Record(uint64_t nanoseconds);
+	void Reset();
+
+	uint64_t Count() const { return m_count.load(std::memory_order_relaxed); }
+	uint64_t TotalNanoseconds() const { return m_totalNs.load(std::memory_order_relaxed); }
+	uint64_t MaxNanoseconds() const { return m_maxNs.load(std::memory_order_relaxed); }
+	uint64_t BucketValue(int bucket) const { return m_buckets[bucket].load(std::memory_order_relaxed); }
+
+	// Upper bound of bucket in nanoseconds
+	static uint64_t BucketUpperBoundNs(int bucket);
+
+	// Upper bound (ns) of the bucket containing the given fraction of stalls, p in [0, 1]
+	uint64_t PercentileNs(double p) const;
+
+private:
+	static int bucket_index(uint64_t nanoseconds);
+
+	std::atomic<uint64_t> m_buckets[BucketCount];
+	std::atomic<uint64_t> m_count;
+	std::atomic<uint64_t> m_totalNs;
+	std::atomic<uint64_t> m_maxNs;
+};
+
+// Stall histograms for every call site
+class StallRecorder
+{
+public:
+	void Record(STALL_SITE site, uint64_t nanoseconds) { m_sites[site].Record(nanoseconds); }
+
+	const StallHistogram& Get(STALL_SITE site) const { return m_sites[site]; }
+	void Reset();
+
+private:
+	StallHistogram m_sites[STALL_SITE_COUNT];
+};
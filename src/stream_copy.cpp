@@ -0,0 +1,130 @@
+/*****************************************************************//**
+ * \file   stream_copy.cpp
+ * \brief  Non-temporal copy kernels for write-combined memory
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include <cstring>
+#include <cstdint>
+
+#include "stream_copy.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define STREAM_COPY_SSE2
+#include <immintrin.h>
+#endif
+
+#ifdef STREAM_COPY_SSE2
+
+// Streams lineCount whole lines. dst is 64-byte aligned, src may be unaligned.
+static inline void stream_lines(uint8_t* dst, const uint8_t* src, size_t lineCount)
+{
+    for (size_t i = 0; i < lineCount; i++)
+    {
+#ifdef __AVX__
+        __m256i a = _mm256_loadu_si256((const __m256i*)src);
+        __m256i b = _mm256_loadu_si256((const __m256i*)(src + 32));
+        _mm256_stream_si256((__m256i*)dst, a);
+        _mm256_stream_si256((__m256i*)(dst + 32), b);
+#else
+        __m128i a = _mm_loadu_si128((const __m128i*)src);
+        __m128i b = _mm_loadu_si128((const __m128i*)(src + 16));
+        __m128i c = _mm_loadu_si128((const __m128i*)(src + 32));
+        __m128i d = _mm_loadu_si128((const __m128i*)(src + 48));
+        _mm_stream_si128((__m128i*)dst, a);
+        _mm_stream_si128((__m128i*)(dst + 16), b);
+        _mm_stream_si128((__m128i*)(dst + 32), c);
+        _mm_stream_si128((__m128i*)(dst + 48), d);
+#endif
+        dst += StreamLineSize;
+        src += StreamLineSize;
+    }
+}
+
+// Streams the last, partial line. The source is not read past its end,
+// the missing bytes are written as zeros.
+static inline void stream_tail_line(uint8_t* dst, const uint8_t* src, size_t byteSize)
+{
+    alignas(64) uint8_t line[StreamLineSize] = { };
+    memcpy(line, src, byteSize);
+    stream_lines(dst, line, 1);
+}
+
+#endif
+
+void StreamCopy(void* dst, const void* src, size_t byteSize)
+{
+    uint8_t* pDst = (uint8_t*)dst;
+    const uint8_t* pSrc = (const uint8_t*)src;
+
+#ifdef STREAM_COPY_SSE2
+    size_t head = (StreamLineSize - (reinterpret_cast<uintptr_t>(pDst) & (StreamLineSize - 1))) & (StreamLineSize - 1);
+    if (head < byteSize)
+    {
+        memcpy(pDst, pSrc, head);
+        pDst += head;
+        pSrc += head;
+        byteSize -= head;
+
+        size_t lineCount = byteSize / StreamLineSize;
+        stream_lines(pDst, pSrc, lineCount);
+        pDst += lineCount * StreamLineSize;
+        pSrc += lineCount * StreamLineSize;
+        byteSize -= lineCount * StreamLineSize;
+    }
+#endif
+    memcpy(pDst, pSrc, byteSize);
+}
+
+void StreamCopyLines(void* dst, const void* src, size_t byteSize)
+{
+    uint8_t* pDst = (uint8_t*)dst;
+    const uint8_t* pSrc = (const uint8_t*)src;
+    size_t lineCount = byteSize / StreamLineSize;
+    size_t tail = byteSize - lineCount * StreamLineSize;
+
+#ifdef STREAM_COPY_SSE2
+    stream_lines(pDst, pSrc, lineCount);
+    if (tail > 0)
+    {
+        stream_tail_line(pDst + lineCount * StreamLineSize, pSrc + lineCount * StreamLineSize, tail);
+    }
+#else
+    memcpy(pDst, pSrc, byteSize);
+    if (tail > 0) memset(pDst + byteSize, 0, StreamLineSize - tail);
+#endif
+}
+
+void StreamScatter(void* dst, size_t dstStride,
+    const void* src, size_t srcStride,
+    size_t elementSize, size_t count)
+{
+    uint8_t* pDst = (uint8_t*)dst;
+    const uint8_t* pSrc = (const uint8_t*)src;
+
+    if (CanStreamLines(dst, elementSize, dstStride))
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            StreamCopyLines(pDst, pSrc, elementSize);
+            pDst += dstStride;
+            pSrc += srcStride;
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        StreamCopy(pDst, pSrc, elementSize);
+        pDst += dstStride;
+        pSrc += srcStride;
+    }
+}
+
+void StreamFence()
+{
+#ifdef STREAM_COPY_SSE2
+    _mm_sfence();
+#endif
+}
@@ -0,0 +1,56 @@
+/*****************************************************************//**
+ * \file   stream_copy.h
+ * \brief  Copy routines for write-combined upload memory
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+
+#include <cstddef>
+
+/**
+ * Upload heap memory is write-combined: the CPU never reads it back and partial
+ * or unaligned writes flush half-filled combining buffers. These routines write
+ * whole aligned 64-byte lines with non-temporal (streaming) stores, which bypass
+ * the cache and fill combining buffers completely.
+ *
+ * A streamed line that is only partly written costs far more than a cached
+ * write, so bytes that do not make up a whole line are either padded out to the
+ * line, where the destination has room, or written with plain stores.
+ *
+ * Streaming stores are weakly ordered, so a batch of copies must be finished with
+ * StreamFence() before the GPU is allowed to read the memory.
+ */
+
+// Size of a cache line and of a write-combining buffer
+const size_t StreamLineSize = 64;
+
+// Copies byteSize bytes from src to dst. Whole aligned lines of dst are
+// streamed, the bytes before the first and after the last one are copied.
+// Exactly byteSize bytes of dst are written.
+void StreamCopy(void* dst, const void* src, size_t byteSize);
+
+// Copies byteSize bytes from src to dst and zeroes the rest of the last line.
+// dst must be 64-byte aligned, AlignUp(byteSize, 64) bytes of it are written.
+void StreamCopyLines(void* dst, const void* src, size_t byteSize);
+
+// Copies count elements of elementSize bytes from src, where they are srcStride
+// bytes apart, into dst, where they are dstStride bytes apart (e.g. 256-byte CB slots).
+// If CanStreamLines holds, every element is padded out to whole lines as by
+// StreamCopyLines, otherwise each is copied as by StreamCopy.
+void StreamScatter(void* dst, size_t dstStride,
+	const void* src, size_t srcStride,
+	size_t elementSize, size_t count);
+
+// Makes all preceding streaming stores globally visible. Call once per batch.
+void StreamFence();
+
+// Whether every element of a scatter starts on a line and has room to be
+// padded out to whole lines
+inline bool CanStreamLines(const void* dst, size_t elementSize, size_t dstStride)
+{
+	return (reinterpret_cast<size_t>(dst) & (StreamLineSize - 1)) == 0
+		&& (dstStride & (StreamLineSize - 1)) == 0
+		&& ((elementSize + StreamLineSize - 1) & ~(StreamLineSize - 1)) <= dstStride;
+}
@@ -4,20 +4,22 @@
 #include <DirectXMath.h>
 
 #include "MathHelper.h"
+#include "bounds.h"
+#include "mesh_gen.h"
 
-// Structure describing vertex buffer element format
-struct Vertex
-{
-	DirectX::XMFLOAT3 Pos;		// Position in non-homogeneous coordinates
-	DirectX::XMFLOAT3 Normal;	// Vertex normal
-	DirectX::XMFLOAT2 TexC;		// Texture coordinates
-};
-
+// Per-object data, read by shaders from a structured buffer
 struct ObjectConstants
 {
 	DirectX::XMFLOAT4X4 World = MathHelper::Identity4x4();
+	UINT MaterialIndex = 0;
+	UINT _pad0 = 0;
+	UINT _pad1 = 0;
+	UINT _pad2 = 0;
 };
 
+// Size of the light array, MaxLights in util.hlsl
+#define MAX_LIGHTS 16
+
 struct Light
 {
 	DirectX::XMFLOAT3 Strength; // Light color
@@ -28,6 +30,7 @@ struct Light
 	float SpotPower; // spot light only
 };
 
+// Camera and timing, changes every frame
 struct PassConstants
 {
 	DirectX::XMFLOAT4X4 View = MathHelper::Identity4x4();
@@ -44,7 +47,11 @@ struct PassConstants
 	float TotalTime = 0;
 	float DeltaTime = 0;
 	float _pad0 = 0;
+};
 
+// Lighting and fog, changes rarely
+struct EnvironmentConstants
+{
 	DirectX::XMFLOAT4 AmbientLight = { };
 
 	DirectX::XMFLOAT4 FogColor = { };
@@ -54,7 +61,18 @@ struct PassConstants
 	float _pad1 = 0;
 	float _pad2 = 0;
 
-	Light Lights[16];
+	Light Lights[MAX_LIGHTS];	// Directional, then point, then spot lights
+
+	// Light clusters, used when point and spot lights do not fit in Lights.
+	// Cluster of a pixel is its position times ClusterTileScale, and the
+	// slice of view depth z is log2(z) * ClusterSliceScale + ClusterSliceBias.
+	DirectX::XMFLOAT2 ClusterTileScale = { };
+	float ClusterSliceScale = 0;
+	float ClusterSliceBias = 0;
+	UINT ClusterTilesX = 0;
+	UINT ClusterTilesY = 0;
+	UINT ClusterSlices = 0;
+	UINT _pad3 = 0;
 };
 
 struct MaterialConstants
@@ -71,6 +89,8 @@ struct SubmeshGeometry
 	UINT IndexCount = 0;            // How many indices to draw
 	UINT StartIndexLocation = 0;    // From which to start
 	INT BaseVertexLocation = 0;     // Padding of the indices
+
+	MESH_BOUNDS Bounds;             // In object space
 };
 
 struct Shader
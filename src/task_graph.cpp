@@ -0,0 +1,230 @@
+/*****************************************************************//**
+ * \file   task_graph.cpp
+ * \brief  Definition of TaskGraph
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include <algorithm>
+
+#include "task_graph.h"
+
+static const uint32_t NoTask = ~0u;
+
+uint32_t TaskGraph::AddResource(const char* name)
+{
+    m_resources.push_back(name);
+    m_built = false;
+    return static_cast<uint32_t>(m_resources.size() - 1);
+}
+
+uint32_t TaskGraph::AddTask(const char* name, JobFn task,
+    std::initializer_list<uint32_t> reads, std::initializer_list<uint32_t> writes)
+{
+    Task entry;
+    entry.Name = name;
+    entry.Fn = std::move(task);
+    entry.Reads.assign(reads.begin(), reads.end());
+    entry.Writes.assign(writes.begin(), writes.end());
+    m_tasks.push_back(std::move(entry));
+    m_built = false;
+    return static_cast<uint32_t>(m_tasks.size() - 1);
+}
+
+bool TaskGraph::Build()
+{
+    m_errors.clear();
+    m_order.clear();
+    m_built = false;
+
+    const uint32_t taskCount = TaskCount();
+    const uint32_t resourceCount = static_cast<uint32_t>(m_resources.size());
+
+    // Single writer per resource
+    std::vector<uint32_t> writers(resourceCount, NoTask);
+    for (uint32_t t = 0; t < taskCount; t++)
+    {
+        for (uint32_t resource : m_tasks[t].Writes)
+        {
+            if (resource >= resourceCount)
+            {
+                m_errors.push_back("task " + m_tasks[t].Name + " writes an unknown resource");
+                continue;
+            }
+            if (writers[resource] != NoTask && writers[resource] != t)
+            {
+                m_errors.push_back("resource " + m_resources[resource] + " is written by both " +
+                    m_tasks[writers[resource]].Name + " and " + m_tasks[t].Name);
+                continue;
+            }
+            writers[resource] = t;
+        }
+    }
+
+    // Readers depend on the writer. Reading what the task writes itself is
+    // part of updating it, not a dependency.
+    for (uint32_t t = 0; t < taskCount; t++)
+    {
+        Task& task = m_tasks[t];
+        task.Dependencies.clear();
+        task.Dependents.clear();
+        for (uint32_t resource : task.Reads)
+        {
+            if (resource >= resourceCount)
+            {
+                m_errors.push_back("task " + task.Name + " reads an unknown resource");
+                continue;
+            }
+            uint32_t writer = writers[resource];
+            if (writer != NoTask && writer != t) task.Dependencies.push_back(writer);
+        }
+        std::sort(task.Dependencies.begin(), task.Dependencies.end());
+        task.Dependencies.erase(std::unique(task.Dependencies.begin(), task.Dependencies.end()),
+            task.Dependencies.end());
+    }
+    for (uint32_t t = 0; t < taskCount; t++)
+    {
+        for (uint32_t dependency : m_tasks[t].Dependencies) m_tasks[dependency].Dependents.push_back(t);
+    }
+
+    // Topological order, tasks left waiting are on or behind a cycle
+    std::vector<uint32_t> waiting(taskCount);
+    for (uint32_t t = 0; t < taskCount; t++)
+    {
+        waiting[t] = static_cast<uint32_t>(m_tasks[t].Dependencies.size());
+        if (waiting[t] == 0) m_order.push_back(t);
+    }
+    for (size_t i = 0; i < m_order.size(); i++)
+    {
+        for (uint32_t dependent : m_tasks[m_order[i]].Dependents)
+        {
+            if (--waiting[dependent] == 0) m_order.push_back(dependent);
+        }
+    }
+    if (m_order.size() < taskCount) report_cycle(waiting);
+
+    if (!m_errors.empty()) return false;
+
+    m_pending.reset(new std::atomic<uint32_t>[taskCount]);
+    m_timings.assign(taskCount, TASK_TIMING());
+    m_built = true;
+    return true;
+}
+
+void TaskGraph::report_cycle(const std::vector<uint32_t>& waiting)
+{
+    // Walk back through dependencies that are still waiting until a task
+    // repeats. Every waiting task has one, so the walk ends on a cycle.
+    uint32_t task = 0;
+    while (waiting[task] == 0) task++;
+
+    std::vector<uint32_t> visitedAt(TaskCount(), NoTask);
+    std::vector<uint32_t> path;
+    while (visitedAt[task] == NoTask)
+    {
+        visitedAt[task] = static_cast<uint32_t>(path.size());
+        path.push_back(task);
+        for (uint32_t dependency : m_tasks[task].Dependencies)
+        {
+            if (waiting[dependency] > 0)
+            {
+                task = dependency;
+                break;
+            }
+        }
+    }
+
+    // Path runs against the dependencies, print it in execution order
+    std::string message = "cycle: ";
+    for (size_t i = path.size(); i-- > visitedAt[task];)
+    {
+        message += m_tasks[path[i]].Name + " -> ";
+    }
+    message += m_tasks[path.back()].Name;
+    m_errors.push_back(message);
+}
+
+bool TaskGraph::Execute(JobSystem* pJobs)
+{
+    if (!m_built) return false;
+
+    m_start = std::chrono::steady_clock::now();
+
+    if (pJobs == nullptr)
+    {
+        for (uint32_t task : m_order) run_task(task);
+    }
+    else
+    {
+        for (uint32_t t = 0; t < TaskCount(); t++)
+        {
+            m_pending[t].store(static_cast<uint32_t>(m_tasks[t].Dependencies.size()));
+        }
+
+        JobGroup group;
+        for (uint32_t t = 0; t < TaskCount(); t++)
+        {
+            if (m_tasks[t].Dependencies.empty()) launch(pJobs, group, t);
+        }
+        pJobs->Wait(group);
+    }
+
+    m_wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+    find_critical_path();
+    return true;
+}
+
+void TaskGraph::launch(JobSystem* pJobs, JobGroup& group, uint32_t task)
+{
+    pJobs->Run(group, [this, pJobs, &group, task]()
+        {
+            run_task(task);
+
+            // The last dependency to finish starts the dependent
+            for (uint32_t dependent : m_tasks[task].Dependents)
+            {
+                if (m_pending[dependent].fetch_sub(1) == 1) launch(pJobs, group, dependent);
+            }
+        });
+}
+
+void TaskGraph::run_task(uint32_t task)
+{
+    TASK_TIMING& timing = m_timings[task];
+    timing.Start = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+    timing.End = timing.Start;
+
+    m_tasks[task].Fn();
+
+    timing.End = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+}
+
+void TaskGraph::find_critical_path()
+{
+    const uint32_t taskCount = TaskCount();
+
+    // Longest chain of durations ending at each task
+    std::vector<double> finish(taskCount, 0.0);
+    std::vector<uint32_t> previous(taskCount, NoTask);
+    uint32_t last = NoTask;
+
+    for (uint32_t task : m_order)
+    {
+        double before = 0.0;
+        for (uint32_t dependency : m_tasks[task].Dependencies)
+        {
+            if (finish[dependency] > before || previous[task] == NoTask)
+            {
+                before = finish[dependency];
+                previous[task] = dependency;
+            }
+        }
+        finish[task] = before + (m_timings[task].End - m_timings[task].Start);
+        if (last == NoTask || finish[task] > finish[last]) last = task;
+    }
+
+    m_criticalPath.clear();
+    m_criticalPathSeconds = last != NoTask ? finish[last] : 0.0;
+    for (uint32_t task = last; task != NoTask; task = previous[task]) m_criticalPath.push_back(task);
+    std::reverse(m_criticalPath.begin(), m_criticalPath.end());
+}
@@ -0,0 +1,110 @@
+/*****************************************************************//**
+ * \file   task_graph.h
+ * \brief  Graph of tasks ordered by the resources they read and write
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "job_system.h"
+
+// Seconds since the start of TaskGraph::Execute
+struct TASK_TIMING
+{
+	double Start = 0.0;
+	double End = 0.0;
+};
+
+/**
+ * Runs a set of tasks in an order derived from the resources they declare,
+ * for example the tasks of a frame: camera, culling, constant upload and
+ * recording.
+ *
+ * A resource is anything tasks share: the camera, the visible items, the
+ * constants of the frame. Each resource is written by at most one task, and
+ * every task reading it runs after that writer. Resources no task writes are
+ * inputs, ready from the start. Build checks the graph once: a resource
+ * with two writers, or reads that loop back to the task itself, are errors,
+ * reported as messages.
+ *
+ * Execute runs every task once as a job as soon as the tasks it reads from
+ * are done, so independent tasks overlap. Each execution records when the
+ * tasks started and ended, and the critical path: the chain of dependent
+ * tasks with the largest total duration, which bounds the time of the graph
+ * on any number of threads.
+ */
+class TaskGraph
+{
+public:
+	uint32_t AddResource(const char* name);
+	uint32_t AddTask(const char* name, JobFn task,
+		std::initializer_list<uint32_t> reads, std::initializer_list<uint32_t> writes);
+
+	// Derives dependencies and checks the graph. Returns false if it has
+	// errors, see Errors.
+	bool Build();
+
+	// Runs all tasks, on the calling thread alone without a job system.
+	// Returns false without running anything if the graph was not built.
+	// An exception thrown by a task is rethrown once the running tasks are
+	// done; tasks that depend on it are skipped.
+	bool Execute(JobSystem* pJobs);
+
+	uint32_t TaskCount() const { return static_cast<uint32_t>(m_tasks.size()); }
+	const std::string& TaskName(uint32_t task) const { return m_tasks[task].Name; }
+	const std::string& ResourceName(uint32_t resource) const { return m_resources[resource]; }
+
+	// Tasks each task waits for, valid after Build
+	const std::vector<uint32_t>& Dependencies(uint32_t task) const { return m_tasks[task].Dependencies; }
+
+	// Tasks in an order that respects dependencies, valid after Build
+	const std::vector<uint32_t>& Order() const { return m_order; }
+
+	// Of the last Execute
+	const TASK_TIMING& Timing(uint32_t task) const { return m_timings[task]; }
+	double WallSeconds() const { return m_wallSeconds; }
+	double CriticalPathSeconds() const { return m_criticalPathSeconds; }
+	const std::vector<uint32_t>& CriticalPath() const { return m_criticalPath; }	// First task first
+
+	const std::vector<std::string>& Errors() const { return m_errors; }
+
+private:
+	struct Task
+	{
+		std::string Name;
+		JobFn Fn;
+		std::vector<uint32_t> Reads;
+		std::vector<uint32_t> Writes;
+		std::vector<uint32_t> Dependencies;
+		std::vector<uint32_t> Dependents;
+	};
+
+	void launch(JobSystem* pJobs, JobGroup& group, uint32_t task);
+	void run_task(uint32_t task);
+	void find_critical_path();
+	void report_cycle(const std::vector<uint32_t>& waiting);
+
+	std::vector<std::string> m_resources;
+	std::vector<Task> m_tasks;
+	std::vector<uint32_t> m_order;
+	bool m_built = false;
+
+	// Execution state
+	std::unique_ptr<std::atomic<uint32_t>[]> m_pending;	// Dependencies not done yet, per task
+	std::chrono::steady_clock::time_point m_start;
+	std::vector<TASK_TIMING> m_timings;
+	double m_wallSeconds = 0.0;
+	double m_criticalPathSeconds = 0.0;
+	std::vector<uint32_t> m_criticalPath;
+
+	std::vector<std::string> m_errors;
+};
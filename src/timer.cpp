@@ -1,43 +1,44 @@
 #include "Timer.h"
 
-// Initializes member variables and gets amount of counts per second
+// Initializes member variables
 Timer::Timer()
-	: mSecondsPerCount(0.0), mDeltaTime(-1.0), mBaseTime(0),
+	: mDeltaTicks(0), mBaseTime(0),
 mPausedTime(0), mPrevTime(0), mCurrTime(0), mStopped(false), mStopTime(0)
 {
-	__int64 countsPerSec = 0;
-	QueryPerformanceFrequency((LARGE_INTEGER*)&countsPerSec);
-	mSecondsPerCount = 1.0 / (double)countsPerSec;
 }
 
-float Timer::TotalTime() const
+uint64_t Timer::TotalTicks() const
 {
 	if (mStopped)
 	{
-		return (float)(((mStopTime - mPausedTime) - mBaseTime)
-			* mSecondsPerCount);
+		return (mStopTime - mPausedTime) - mBaseTime;
 	}
 	else
 	{
-		return (float)((mCurrTime - mPausedTime - mBaseTime)
-			* mSecondsPerCount);
+		return mCurrTime - mPausedTime - mBaseTime;
 	}
 }
 
+float Timer::TotalTime() const
+{
+	return (float)Clock::ToSeconds(TotalTicks());
+}
+
 // Time between frames
 float Timer::DeltaTime() const
 {
-	return (float)mDeltaTime;
+	return (float)Clock::ToSeconds(mDeltaTicks);
 }
 
 // Called once before the loop
 void Timer::Reset()
 {
-	__int64 currTime = 0;
-	QueryPerformanceCounter((LARGE_INTEGER*)&currTime);
+	uint64_t currTime = Clock::Now();
 
 	mBaseTime = currTime;
 	mPrevTime = currTime;
+	mCurrTime = currTime;
+	mPausedTime = 0;
 	mStopTime = 0;
 	mStopped = false;
 }
@@ -45,8 +46,7 @@ void Timer::Reset()
 // Start the timer
 void Timer::Start()
 {
-	__int64 startTime = 0;
-	QueryPerformanceCounter((LARGE_INTEGER*)&startTime);
+	uint64_t startTime = Clock::Now();
 
 	if (mStopped)
 	{
@@ -65,9 +65,7 @@ void Timer::Stop()
 {
 	if (!mStopped)
 	{
-		__int64 currTime;
-		QueryPerformanceCounter((LARGE_INTEGER*)&currTime);
-		mStopTime = currTime;
+		mStopTime = Clock::Now();
 		mStopped = true;
 	}
 }
@@ -77,23 +75,18 @@ void Timer::Tick()
 {
 	// If stopped, do nothing
 	if (mStopped) {
-		mDeltaTime = 0;
+		mDeltaTicks = 0;
 		return;
 	}
 
 	// Get current time
-	__int64 currTime;
-	QueryPerformanceCounter((LARGE_INTEGER*)&currTime);
+	uint64_t currTime = Clock::Now();
 	mCurrTime = currTime;
 
-	// Delta time - time passed between frames in seconds
-	mDeltaTime = (mCurrTime - mPrevTime) * mSecondsPerCount;
+	// Delta time - time passed between frames. The clock is monotonic, so
+	// it is never negative.
+	mDeltaTicks = mCurrTime - mPrevTime;
 
 	// Set current time as previous for the next frame
 	mPrevTime = mCurrTime;
-
-	// Force non-negative value
-	if (mDeltaTime < 0.0) {
-		mDeltaTime = 0.0;
-	}
 }
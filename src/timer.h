@@ -1,7 +1,10 @@
 #pragma once
 
-#include <Windows.h>
+#include <cstdint>
 
+#include "clock.h"
+
+// Game time that stops while paused, in Clock ticks
 class Timer
 {
 public:
@@ -10,21 +13,25 @@ public:
 	float TotalTime() const;
 	float DeltaTime() const;
 
+	// Integer forms, without conversion to seconds
+	uint64_t TotalTicks() const;
+	uint64_t DeltaTicks() const { return mDeltaTicks; }
+	uint64_t TotalNanoseconds() const { return Clock::ToNanoseconds(TotalTicks()); }
+	uint64_t DeltaNanoseconds() const { return Clock::ToNanoseconds(mDeltaTicks); }
+
 	void Reset(); // Call before message loop
 	void Start(); // Call when unpaused
 	void Stop(); // Call when paused
 	void Tick(); // Call every frame
 
 private:
-	double mSecondsPerCount;
-	double mDeltaTime;
+	uint64_t mDeltaTicks;
 
-	__int64 mBaseTime;
-	__int64 mPausedTime;
-	__int64 mStopTime;
-	__int64 mPrevTime;
-	__int64 mCurrTime;
+	uint64_t mBaseTime;
+	uint64_t mPausedTime;
+	uint64_t mStopTime;
+	uint64_t mPrevTime;
+	uint64_t mCurrTime;
 
 	bool mStopped = false;
 };
-
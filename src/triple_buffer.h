@@ -0,0 +1,64 @@
+/*****************************************************************//**
+ * \file   triple_buffer.h
+ * \brief  Lock-free exchange of the latest value between two threads
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Hands values from one producer thread to one consumer thread, the consumer
+ * always getting the latest complete one.
+ *
+ * Of the three buffers, the producer owns one to write into and the consumer
+ * one to read from. The third is exchanged: Publish swaps the written buffer
+ * in, Acquire swaps it out if it is newer than what the consumer has. Both
+ * are a single atomic exchange, so neither thread ever waits for the other,
+ * and a value is never read while it is written. Values the consumer was too
+ * slow to see are dropped.
+ *
+ * Buffers are reused, so the producer overwrites every field of Write().
+ */
+template<typename T>
+class TripleBuffer
+{
+public:
+	TripleBuffer() = default;
+
+	// Producer: buffer to fill, then Publish
+	T& Write() { return m_buffers[m_write]; }
+	void Publish()
+	{
+		// Release makes the written value visible to the Acquire that takes it
+		uint8_t previous = m_exchange.exchange(static_cast<uint8_t>(m_write | FreshBit), std::memory_order_acq_rel);
+		m_write = previous & IndexMask;
+	}
+
+	// Consumer: takes the latest published value, returns false if there is
+	// none since the last Acquire and Read() is unchanged
+	bool Acquire()
+	{
+		if ((m_exchange.load(std::memory_order_relaxed) & FreshBit) == 0) return false;
+
+		uint8_t previous = m_exchange.exchange(m_read, std::memory_order_acq_rel);
+		m_read = previous & IndexMask;
+		return true;
+	}
+	const T& Read() const { return m_buffers[m_read]; }
+
+private:
+	TripleBuffer(const TripleBuffer&) = delete;
+	TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+	static const uint8_t IndexMask = 0x3;
+	static const uint8_t FreshBit = 0x4;	// Exchanged buffer was published and not acquired
+
+	T m_buffers[3] = { };
+	uint8_t m_write = 0;					// Producer only
+	uint8_t m_read = 1;						// Consumer only
+	std::atomic<uint8_t> m_exchange{ 2 };
+};
@@ -0,0 +1,49 @@
+/*****************************************************************//**
+ * \file   test.h
+ * \brief  Minimal test registry and checks of the test executable
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+
+#include <sstream>
+#include <string>
+
+typedef void (*TestFn)();
+
+// Adds a test to the registry, called by TEST before main
+struct TestRegistration
+{
+	TestRegistration(const char* name, TestFn fn);
+};
+
+// Reports a failed check of the running test
+void TestFailure(const char* file, int line, const std::string& message);
+
+/**
+ * Defines a test. Names are "suite/case", as in the benchmarks, and the
+ * executable runs those containing its first argument.
+ *
+ *     TEST(stall_stats_buckets, "stall_stats/buckets") { CHECK(...); }
+ */
+#define TEST(fn, name) \
+	static void fn(); \
+	static TestRegistration fn##_registration(name, fn); \
+	static void fn()
+
+// Failed checks are reported and the test goes on
+#define CHECK(condition) \
+	do { if (!(condition)) TestFailure(__FILE__, __LINE__, #condition); } while (0)
+
+#define CHECK_EQ(actual, expected) \
+	do { \
+		const auto& checkActual = (actual); \
+		const auto& checkExpected = (expected); \
+		if (!(checkActual == checkExpected)) \
+		{ \
+			std::ostringstream checkMessage; \
+			checkMessage << #actual << " == " << #expected << " (" << checkActual << " vs " << checkExpected << ")"; \
+			TestFailure(__FILE__, __LINE__, checkMessage.str()); \
+		} \
+	} while (0)
@@ -0,0 +1,121 @@
+/*****************************************************************//**
+ * \file   test_clock.cpp
+ * \brief  Tests of Clock readings and conversions, on both sources
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "clock.h"
+#include "test.h"
+
+// Readings never go back, on this thread or on any other
+static void check_monotonic()
+{
+    uint32_t backwards = 0;
+    uint64_t previous = Clock::Now();
+    for (uint32_t i = 0; i < 1000000; i++)
+    {
+        uint64_t now = Clock::Now();
+        backwards += now < previous;
+        previous = now;
+    }
+    CHECK_EQ(backwards, 0u);
+
+    std::atomic<uint32_t> threadBackwards{ 0 };
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < 4; t++)
+    {
+        threads.emplace_back([&threadBackwards]()
+            {
+                uint64_t last = Clock::Now();
+                for (uint32_t i = 0; i < 100000; i++)
+                {
+                    uint64_t now = Clock::Now();
+                    if (now < last) threadBackwards++;
+                    last = now;
+                }
+            });
+    }
+    for (std::thread& thread : threads) thread.join();
+    CHECK_EQ(threadBackwards.load(), 0u);
+}
+
+// Clock over a sleep, in nanoseconds, less what steady_clock measured over
+// the same sleep. Clock readings enclose steady_clock ones, so the
+// difference is the cost of the inner readings plus any error of the rate.
+static int64_t sleep_difference(uint32_t sleepMs)
+{
+    typedef std::chrono::steady_clock Steady;
+
+    uint64_t start = Clock::Now();
+    Steady::time_point steadyStart = Steady::now();
+    std::this_thread::sleep_for(std::chrono::milliseconds(sleepMs));
+    Steady::time_point steadyEnd = Steady::now();
+    uint64_t end = Clock::Now();
+
+    int64_t steady = std::chrono::duration_cast<std::chrono::nanoseconds>(steadyEnd - steadyStart).count();
+    return static_cast<int64_t>(Clock::ToNanoseconds(end - start)) - steady;
+}
+
+// Within 0.5% and 200 us of steady_clock. A thread descheduled between
+// paired readings only makes Clock longer, so the best of a few tries counts.
+static void check_against_steady()
+{
+    const uint32_t SleepMs = 50;
+    const int64_t Tolerance = SleepMs * 1000000 / 200 + 200000;
+
+    int64_t best = INT64_MAX;
+    for (int attempt = 0; attempt < 5; attempt++)
+    {
+        int64_t difference = sleep_difference(SleepMs);
+        if (difference < 0) difference = -difference;
+        if (difference < best) best = difference;
+    }
+    CHECK(best <= Tolerance);
+
+    // Conversions back and forth agree to a nanosecond, plus one per second
+    // for the fixed point rate
+    for (uint64_t nanoseconds : { 0ull, 1000ull, 16666667ull, 1000000000ull, 3600000000000ull })
+    {
+        uint64_t ticks = Clock::FromNanoseconds(nanoseconds);
+        int64_t back = static_cast<int64_t>(Clock::ToNanoseconds(ticks));
+        int64_t error = back - static_cast<int64_t>(nanoseconds);
+        int64_t allowed = 1 + static_cast<int64_t>(nanoseconds / 1000000000ull);
+        CHECK(error <= allowed && error >= -allowed);
+    }
+    CHECK(Clock::ToSeconds(Clock::FromNanoseconds(250000000ull)) > 0.249999);
+    CHECK(Clock::ToSeconds(Clock::FromNanoseconds(250000000ull)) < 0.250001);
+}
+
+// Steady first: the time stamp counter, once enabled, stays the source for
+// the rest of the run, as it does in the application
+TEST(clock_sources, "clock/sources")
+{
+    CHECK_EQ(Clock::Source(), CLOCK_SOURCE_STEADY);
+    CHECK_EQ(Clock::TicksPerSecond(), 1000000000ull);
+    CHECK_EQ(Clock::ToNanoseconds(123456789ull), 123456789ull);
+    check_monotonic();
+    check_against_steady();
+
+    if (!Clock::EnableTsc())
+    {
+        // No invariant counter here, steady_clock stays
+        CHECK_EQ(Clock::Source(), CLOCK_SOURCE_STEADY);
+        return;
+    }
+    CHECK_EQ(Clock::Source(), CLOCK_SOURCE_TSC);
+    CHECK(Clock::TicksPerSecond() >= 1000000000ull);
+    check_monotonic();
+    check_against_steady();
+
+    // Conversion of large tick counts does not overflow: a day of ticks
+    uint64_t day = Clock::TicksPerSecond() * 86400ull;
+    double seconds = Clock::ToSeconds(day);
+    CHECK(seconds > 86399.9 && seconds < 86400.1);
+}
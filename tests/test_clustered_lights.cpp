@@ -0,0 +1,320 @@
+/*****************************************************************//**
+ * \file   test_clustered_lights.cpp
+ * \brief  Tests of LightClusterer against a brute-force reference
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "clustered_lights.h"
+#include "job_system.h"
+#include "test.h"
+
+// The application's grid and projection
+static const uint32_t TilesX = 16;
+static const uint32_t TilesY = 8;
+static const uint32_t Slices = 24;
+static const float NearZ = 1.0f;
+static const float FarZ = 1000.0f;
+static const float ScaleY = 1.0f / std::tan(0.125f * 3.14159265f);
+static const float ScaleX = ScaleY / (16.0f / 9.0f);
+
+class TestRandom
+{
+public:
+    float Uniform(float lo, float hi)
+    {
+        m_state = m_state * 1103515245u + 12345u;
+        return lo + (hi - lo) * static_cast<float>(m_state >> 8) / 16777216.0f;
+    }
+
+private:
+    uint32_t m_state = 12345;
+};
+
+// Turned 30 degrees around y and moved, so lights go through a real transform.
+// Row-vector convention: view = p * m.
+static void test_view(float m[16])
+{
+    const float c = std::cos(0.5236f), s = std::sin(0.5236f);
+    const float view[16] =
+    {
+        c, 0.0f, s, 0.0f,
+        0.0f, 1.0f, 0.0f, 0.0f,
+        -s, 0.0f, c, 0.0f,
+        10.0f, -5.0f, 20.0f, 1.0f,
+    };
+    for (int i = 0; i < 16; i++) m[i] = view[i];
+}
+
+static void to_view(const float m[16], const float p[3], float w, float out[3])
+{
+    for (int k = 0; k < 3; k++) out[k] = p[0] * m[k] + p[1] * m[4 + k] + p[2] * m[8 + k] + w * m[12 + k];
+}
+
+// Point and spot lights in and around the view volume, some behind the camera
+static std::vector<CLUSTER_LIGHT> random_lights(uint32_t count)
+{
+    const float c = std::cos(0.5236f), s = std::sin(0.5236f);
+
+    TestRandom random;
+    std::vector<CLUSTER_LIGHT> lights(count);
+    for (CLUSTER_LIGHT& light : lights)
+    {
+        // Chosen in view space, then taken back to world space
+        float z = random.Uniform(-20.0f, 300.0f);
+        float x = random.Uniform(-1.0f, 1.0f) * (std::fabs(z) + 5.0f) - 10.0f;
+        float y = random.Uniform(-0.6f, 0.6f) * (std::fabs(z) + 5.0f) + 5.0f;
+        z -= 20.0f;
+        light.Position[0] = x * c + z * s;
+        light.Position[1] = y;
+        light.Position[2] = z * c - x * s;
+        light.Range = random.Uniform(0.5f, 30.0f);
+
+        float d[3] = { random.Uniform(-1.0f, 1.0f), random.Uniform(-1.0f, 1.0f), random.Uniform(-1.0f, 1.0f) };
+        float length = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+        for (int k = 0; k < 3; k++) light.Direction[k] = d[k] / length;
+        light.SpotAngle = random.Uniform(0.0f, 1.0f) < 0.5f ? random.Uniform(0.1f, 1.4f) : 0.0f;
+    }
+    return lights;
+}
+
+// Light list of every cluster
+static std::vector<std::vector<uint32_t>> cluster_lists(const LightClusterer& clusterer)
+{
+    std::vector<std::vector<uint32_t>> lists(clusterer.ClusterCount());
+    for (uint32_t c = 0; c < clusterer.ClusterCount(); c++)
+    {
+        const CLUSTER_RANGE& range = clusterer.Ranges()[c];
+        lists[c].assign(clusterer.LightIndices().begin() + range.Offset,
+            clusterer.LightIndices().begin() + range.Offset + range.Count);
+    }
+    return lists;
+}
+
+static std::vector<std::vector<uint32_t>> build(JobSystem* pJobs, bool useSSE,
+    const std::vector<CLUSTER_LIGHT>& lights)
+{
+    float view[16];
+    test_view(view);
+
+    LightClusterer clusterer(pJobs);
+    clusterer.SetUseSSE(useSSE);
+    clusterer.SetGrid(TilesX, TilesY, Slices, ScaleX, ScaleY, NearZ, FarZ);
+    clusterer.Build(view, lights.data(), static_cast<uint32_t>(lights.size()));
+    return cluster_lists(clusterer);
+}
+
+// View-space box and bounding sphere of a cluster, derived from the grid
+// definition in the header rather than from the implementation
+struct REFERENCE_CLUSTER
+{
+    float Min[3], Max[3];
+    float Center[3], Radius;
+};
+
+static REFERENCE_CLUSTER reference_cluster(uint32_t x, uint32_t y, uint32_t z)
+{
+    float zNear = NearZ * std::pow(FarZ / NearZ, static_cast<float>(z) / Slices);
+    float zFar = NearZ * std::pow(FarZ / NearZ, static_cast<float>(z + 1) / Slices);
+    float ndcX[2] = { -1.0f + 2.0f * x / TilesX, -1.0f + 2.0f * (x + 1) / TilesX };
+    float ndcY[2] = { 1.0f - 2.0f * (y + 1) / TilesY, 1.0f - 2.0f * y / TilesY };
+
+    REFERENCE_CLUSTER cluster;
+    cluster.Min[0] = cluster.Min[1] = 1e30f;
+    cluster.Max[0] = cluster.Max[1] = -1e30f;
+    for (float depth : { zNear, zFar })
+    {
+        for (int i = 0; i < 2; i++)
+        {
+            float px = ndcX[i] * depth / ScaleX, py = ndcY[i] * depth / ScaleY;
+            if (px < cluster.Min[0]) cluster.Min[0] = px;
+            if (px > cluster.Max[0]) cluster.Max[0] = px;
+            if (py < cluster.Min[1]) cluster.Min[1] = py;
+            if (py > cluster.Max[1]) cluster.Max[1] = py;
+        }
+    }
+    cluster.Min[2] = zNear;
+    cluster.Max[2] = zFar;
+
+    float radiusSq = 0.0f;
+    for (int k = 0; k < 3; k++)
+    {
+        float half = (cluster.Max[k] - cluster.Min[k]) * 0.5f;
+        cluster.Center[k] = cluster.Min[k] + half;
+        radiusSq += half * half;
+    }
+    cluster.Radius = std::sqrt(radiusSq);
+    return cluster;
+}
+
+// Sphere against box, and for spot lights cone against the cluster sphere
+static bool reference_touches(const REFERENCE_CLUSTER& cluster, const float position[3],
+    const float direction[3], float range, float spotAngle)
+{
+    float distSq = 0.0f;
+    for (int k = 0; k < 3; k++)
+    {
+        float e = cluster.Min[k] - position[k] > position[k] - cluster.Max[k]
+            ? cluster.Min[k] - position[k] : position[k] - cluster.Max[k];
+        if (e > 0.0f) distSq += e * e;
+    }
+    if (distSq > range * range) return false;
+    if (spotAngle <= 0.0f) return true;
+
+    float angle = spotAngle > 1.57079632679f ? 1.57079632679f : spotAngle;
+    float v[3], along = 0.0f, lengthSq = 0.0f;
+    for (int k = 0; k < 3; k++)
+    {
+        v[k] = cluster.Center[k] - position[k];
+        along += v[k] * direction[k];
+        lengthSq += v[k] * v[k];
+    }
+    float acrossSq = lengthSq - along * along;
+    float across = std::sqrt(acrossSq > 0.0f ? acrossSq : 0.0f);
+    float side = std::cos(angle) * across - along * std::sin(angle);
+    return !(side > cluster.Radius || along > cluster.Radius + range || along < -cluster.Radius);
+}
+
+TEST(clustered_lights_sse_matches_scalar, "clustered_lights/sse_matches_scalar")
+{
+    std::vector<CLUSTER_LIGHT> lights = random_lights(3000);
+    std::vector<std::vector<uint32_t>> sse = build(nullptr, true, lights);
+    std::vector<std::vector<uint32_t>> scalar = build(nullptr, false, lights);
+
+    size_t differing = 0;
+    for (size_t c = 0; c < sse.size(); c++) differing += sse[c] != scalar[c];
+    CHECK_EQ(differing, 0u);
+}
+
+TEST(clustered_lights_threads, "clustered_lights/threads")
+{
+    std::vector<CLUSTER_LIGHT> lights = random_lights(3000);
+    std::vector<std::vector<uint32_t>> expected = build(nullptr, true, lights);
+
+    for (unsigned threads : { 1u, 2u, 3u, 8u })
+    {
+        JobSystem jobs(threads);
+        for (int run = 0; run < 3; run++)
+        {
+            std::vector<std::vector<uint32_t>> lists = build(&jobs, true, lights);
+            size_t differing = 0;
+            for (size_t c = 0; c < lists.size(); c++) differing += lists[c] != expected[c];
+            CHECK_EQ(differing, 0u);
+        }
+    }
+}
+
+/**
+ * Brute force over every cluster and light with the same tests. The
+ * implementation first bounds each light to the tiles its sphere projects to,
+ * which drops some clusters whose box the sphere still touches, so its lists
+ * are a subset of the reference. Lights must also reach every cluster that
+ * holds a point lit by them, which is checked by sampling.
+ */
+TEST(clustered_lights_brute_force, "clustered_lights/brute_force")
+{
+    std::vector<CLUSTER_LIGHT> lights = random_lights(2000);
+    std::vector<std::vector<uint32_t>> lists = build(nullptr, true, lights);
+
+    float view[16];
+    test_view(view);
+
+    std::vector<CLUSTER_LIGHT> viewLights = lights;
+    for (size_t i = 0; i < lights.size(); i++)
+    {
+        to_view(view, lights[i].Position, 1.0f, viewLights[i].Position);
+        to_view(view, lights[i].Direction, 0.0f, viewLights[i].Direction);
+    }
+
+    // Every listed light touches its cluster, lists are sorted
+    size_t extra = 0;
+    size_t unsorted = 0;
+    size_t referencePairs = 0;
+    size_t listedPairs = 0;
+    for (uint32_t z = 0; z < Slices; z++)
+    {
+        for (uint32_t y = 0; y < TilesY; y++)
+        {
+            for (uint32_t x = 0; x < TilesX; x++)
+            {
+                REFERENCE_CLUSTER cluster = reference_cluster(x, y, z);
+                const std::vector<uint32_t>& list = lists[x + TilesX * (y + TilesY * z)];
+
+                std::vector<bool> touched(lights.size());
+                for (size_t i = 0; i < lights.size(); i++)
+                {
+                    const CLUSTER_LIGHT& light = viewLights[i];
+                    touched[i] = reference_touches(cluster, light.Position, light.Direction,
+                        light.Range, light.SpotAngle);
+                    referencePairs += touched[i];
+                }
+
+                for (size_t j = 0; j < list.size(); j++)
+                {
+                    if (!touched[list[j]]) extra++;
+                    if (j > 0 && list[j - 1] >= list[j]) unsorted++;
+                }
+                listedPairs += list.size();
+            }
+        }
+    }
+    CHECK_EQ(extra, 0u);
+    CHECK_EQ(unsorted, 0u);
+    CHECK(listedPairs > 0);
+    CHECK(listedPairs <= referencePairs);
+
+    // Points lit by a light are in clusters that list it. Points close to a
+    // cluster border are skipped, their cluster depends on rounding.
+    TestRandom random;
+    size_t samples = 0;
+    size_t missing = 0;
+    const float sliceScale = Slices / std::log2(FarZ / NearZ);
+    for (size_t i = 0; i < viewLights.size(); i++)
+    {
+        const CLUSTER_LIGHT& light = viewLights[i];
+        for (int n = 0; n < 64; n++)
+        {
+            float offset[3] = { random.Uniform(-1.0f, 1.0f), random.Uniform(-1.0f, 1.0f), random.Uniform(-1.0f, 1.0f) };
+            float lengthSq = offset[0] * offset[0] + offset[1] * offset[1] + offset[2] * offset[2];
+            if (lengthSq > 1.0f || lengthSq < 1e-6f) continue;
+
+            float p[3];
+            float along = 0.0f;
+            for (int k = 0; k < 3; k++)
+            {
+                p[k] = light.Position[k] + offset[k] * light.Range;
+                along += offset[k] * light.Direction[k];
+            }
+            if (light.SpotAngle > 0.0f && along < std::sqrt(lengthSq) * std::cos(light.SpotAngle)) continue;
+            if (p[2] <= NearZ || p[2] >= FarZ) continue;
+
+            float tileX = (p[0] * ScaleX / p[2] + 1.0f) * 0.5f * TilesX;
+            float tileY = (1.0f - p[1] * ScaleY / p[2]) * 0.5f * TilesY;
+            float slice = std::log2(p[2] / NearZ) * sliceScale;
+            if (tileX <= 0.0f || tileX >= TilesX || tileY <= 0.0f || tileY >= TilesY) continue;
+
+            bool border = false;
+            for (float t : { tileX, tileY, slice })
+            {
+                float fraction = t - std::floor(t);
+                if (fraction < 1e-3f || fraction > 1.0f - 1e-3f) border = true;
+            }
+            if (border) continue;
+
+            uint32_t cluster = static_cast<uint32_t>(tileX) +
+                TilesX * (static_cast<uint32_t>(tileY) + TilesY * static_cast<uint32_t>(slice));
+            const std::vector<uint32_t>& list = lists[cluster];
+
+            samples++;
+            bool found = false;
+            for (uint32_t index : list) found = found || index == i;
+            if (!found) missing++;
+        }
+    }
+    CHECK(samples > 10000);
+    CHECK_EQ(missing, 0u);
+}
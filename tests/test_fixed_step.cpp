@@ -0,0 +1,141 @@
+/*****************************************************************//**
+ * \file   test_fixed_step.cpp
+ * \brief  Tests of FixedStepClock steps, clamping and blend factor
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include <cmath>
+#include <cstdint>
+
+#include "fixed_step.h"
+#include "test.h"
+
+class TestRandom
+{
+public:
+    double Uniform(double lo, double hi)
+    {
+        m_state = m_state * 6364136223846793005ull + 1442695040888963407ull;
+        return lo + (hi - lo) * static_cast<double>(m_state >> 11) / 9007199254740992.0;
+    }
+
+private:
+    uint64_t m_state = 12345;
+};
+
+// Frames of a 60 Hz display each run exactly four 240 Hz steps, and no time
+// is lost or left over beyond rounding
+TEST(fixed_step_steady, "fixed_step/steady")
+{
+    FixedStepClock clock;
+    CHECK_EQ(clock.StepSeconds(), 1.0 / 240.0);
+
+    const uint32_t Frames = 6000;
+    uint32_t wrongFrames = 0;
+    for (uint32_t frame = 0; frame < Frames; frame++)
+    {
+        wrongFrames += clock.Advance(1.0 / 60.0) != 4;
+    }
+    CHECK_EQ(wrongFrames, 0u);
+    CHECK_EQ(clock.StepCount(), 4ull * Frames);
+    CHECK(std::fabs(clock.SimulatedSeconds() - Frames / 60.0) < 1e-9);
+    CHECK_EQ(clock.DroppedSeconds(), 0.0);
+    CHECK(clock.Alpha() < 1e-6);
+
+    // Faster than the step, steps come every few frames
+    FixedStepClock fast;
+    uint64_t steps = 0;
+    for (uint32_t frame = 0; frame < 1000; frame++) steps += fast.Advance(1.0 / 1000.0);
+    CHECK_EQ(steps, 240u);
+    CHECK_EQ(fast.DroppedSeconds(), 0.0);
+}
+
+// A debugger break counts as MaxElapsedSeconds, the rest is dropped
+TEST(fixed_step_long_gap, "fixed_step/long_gap")
+{
+    FIXED_STEP_PARAMS params;
+    params.StepSeconds = 0.01;
+    params.MaxSubsteps = 100;
+    params.MaxElapsedSeconds = 0.25;
+    FixedStepClock clock(params);
+
+    CHECK_EQ(clock.Advance(5.0), 25u);
+    CHECK(std::fabs(clock.DroppedSeconds() - 4.75) < 1e-12);
+    CHECK(std::fabs(clock.SimulatedSeconds() - 0.25) < 1e-12);
+
+    // Gaps up to the limit are kept whole
+    CHECK_EQ(clock.Advance(0.25), 25u);
+    CHECK(std::fabs(clock.DroppedSeconds() - 4.75) < 1e-12);
+
+    // Nothing happens for no time, negative time or NaN
+    CHECK_EQ(clock.Advance(0.0), 0u);
+    CHECK_EQ(clock.Advance(-1.0), 0u);
+    CHECK_EQ(clock.Advance(std::nan("")), 0u);
+    CHECK_EQ(clock.StepCount(), 50u);
+}
+
+// Behind by more than MaxSubsteps, whole steps are dropped and the
+// fraction of a step is carried into the next call. Times are exact in
+// binary, so the counts do not depend on rounding.
+TEST(fixed_step_max_substeps, "fixed_step/max_substeps")
+{
+    FIXED_STEP_PARAMS params;
+    params.StepSeconds = 1.0 / 128.0;
+    params.MaxSubsteps = 4;
+    params.MaxElapsedSeconds = 1.0;
+    FixedStepClock clock(params);
+
+    // 10.25 steps: 4 run, 6 dropped, a quarter kept
+    CHECK_EQ(clock.Advance(10.25 / 128.0), 4u);
+    CHECK_EQ(clock.DroppedSeconds(), 6.0 / 128.0);
+    CHECK_EQ(clock.Alpha(), 0.25);
+
+    // The quarter and three more make one step, with nothing dropped
+    CHECK_EQ(clock.Advance(0.75 / 128.0), 1u);
+    CHECK_EQ(clock.DroppedSeconds(), 6.0 / 128.0);
+    CHECK_EQ(clock.Alpha(), 0.0);
+
+    // Simulated and dropped time add up to the time fed in
+    TestRandom random;
+    double fed = 11.0 / 128.0;
+    for (int frame = 0; frame < 1000; frame++)
+    {
+        double elapsed = random.Uniform(0.0, 0.1);
+        fed += elapsed;
+        CHECK(clock.Advance(elapsed) <= 4u);
+    }
+    double accounted = clock.SimulatedSeconds() + clock.DroppedSeconds() + clock.Alpha() * clock.StepSeconds();
+    CHECK(std::fabs(accounted - fed) < 1e-9);
+}
+
+// Whatever the feed, the blend factor is a fraction of a step
+TEST(fixed_step_alpha, "fixed_step/alpha")
+{
+    TestRandom random;
+    for (double step : { 1.0 / 240.0, 1.0 / 60.0, 0.1 })
+    {
+        FIXED_STEP_PARAMS params;
+        params.StepSeconds = step;
+        FixedStepClock clock(params);
+
+        uint32_t outside = 0;
+        for (int frame = 0; frame < 100000; frame++)
+        {
+            // Mostly around the step, sometimes exact multiples of it
+            double elapsed = frame % 7 == 0 ? step * (frame % 5) : random.Uniform(0.0, 3.0 * step);
+            clock.Advance(elapsed);
+            outside += !(clock.Alpha() >= 0.0 && clock.Alpha() < 1.0);
+        }
+        CHECK_EQ(outside, 0u);
+    }
+
+    // Invalid tuning falls back to usable values
+    FIXED_STEP_PARAMS invalid;
+    invalid.StepSeconds = 0.0;
+    invalid.MaxSubsteps = 0;
+    FixedStepClock fallback(invalid);
+    CHECK(fallback.StepSeconds() > 0.0);
+    CHECK_EQ(fallback.Advance(0.1), 1u);
+    CHECK(fallback.Alpha() >= 0.0 && fallback.Alpha() < 1.0);
+}
@@ -0,0 +1,202 @@
+/*****************************************************************//**
+ * \file   test_frame_stats.cpp
+ * \brief  Tests of QuantileSketch accuracy, FrameStatsCollector windows and
+ *         stutters, and the CSV log
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "frame_stats.h"
+#include "test.h"
+
+class TestRandom
+{
+public:
+    double Uniform(double lo, double hi)
+    {
+        m_state = m_state * 6364136223846793005ull + 1442695040888963407ull;
+        return lo + (hi - lo) * static_cast<double>(m_state >> 11) / 9007199254740992.0;
+    }
+
+    // Spread over orders of magnitude, as frame and stall times are
+    uint64_t LogUniform(double lo, double hi)
+    {
+        return static_cast<uint64_t>(std::exp(Uniform(std::log(lo), std::log(hi))));
+    }
+
+private:
+    uint64_t m_state = 12345;
+};
+
+// Value at fraction p of the sorted durations, ranked as QuantileSketch ranks
+static uint64_t exact_quantile(std::vector<uint64_t> values, double p)
+{
+    std::sort(values.begin(), values.end());
+    return values[static_cast<size_t>(p * (values.size() - 1))];
+}
+
+static FRAME_SAMPLE frame(uint64_t cpu, uint64_t stall, uint64_t interval)
+{
+    FRAME_SAMPLE sample;
+    sample.Nanoseconds[FRAME_METRIC_CPU] = cpu;
+    sample.Nanoseconds[FRAME_METRIC_FENCE_STALL] = stall;
+    sample.Nanoseconds[FRAME_METRIC_PRESENT_INTERVAL] = interval;
+    return sample;
+}
+
+TEST(frame_stats_quantiles, "frame_stats/quantiles")
+{
+    for (double accuracy : { 0.01, 0.05 })
+    {
+        for (uint32_t count : { 1u, 10u, 1000u, 20000u })
+        {
+            TestRandom random;
+            QuantileSketch sketch(accuracy);
+            std::vector<uint64_t> values;
+            for (uint32_t i = 0; i < count; i++)
+            {
+                uint64_t value = random.LogUniform(2e3, 2e8);
+                values.push_back(value);
+                sketch.Add(value);
+            }
+            CHECK_EQ(sketch.Count(), static_cast<uint64_t>(count));
+
+            // Within the accuracy, and a nanosecond of rounding
+            for (double p : { 0.0, 0.5, 0.95, 0.99, 1.0 })
+            {
+                double exact = static_cast<double>(exact_quantile(values, p));
+                double estimate = static_cast<double>(sketch.Quantile(p));
+                CHECK(std::fabs(estimate - exact) <= accuracy * exact + 1.0);
+            }
+        }
+    }
+
+    // Below the first bound reads as zero, above the last as the last bucket
+    QuantileSketch sketch;
+    sketch.Add(10);
+    CHECK_EQ(sketch.Quantile(0.5), 0u);
+    sketch.Clear();
+    sketch.Add(QuantileSketch::MaxNanoseconds * 10);
+    CHECK(sketch.Quantile(0.5) >= static_cast<uint64_t>(QuantileSketch::MaxNanoseconds * 0.99));
+    CHECK_EQ(QuantileSketch().Quantile(0.5), 0u);
+}
+
+// Frames that left the window leave no trace: the summary is the one of
+// the frames still in it alone
+TEST(frame_stats_window, "frame_stats/window")
+{
+    FRAME_STATS_PARAMS params;
+    params.WindowFrames = 100;
+    FrameStatsCollector rolling(params);
+    FrameStatsCollector fresh(params);
+
+    // Slow frames, then fast ones past a full window and partly into the next
+    TestRandom random;
+    for (uint32_t i = 0; i < 250; i++)
+    {
+        rolling.AddFrame(frame(random.LogUniform(3e7, 9e7), random.LogUniform(1e6, 3e7), 50000000));
+    }
+    std::vector<FRAME_SAMPLE> fast;
+    for (uint32_t i = 0; i < 130; i++)
+    {
+        fast.push_back(frame(random.LogUniform(2e6, 8e6), random.LogUniform(2e3, 1e6), 16666667));
+    }
+    for (const FRAME_SAMPLE& sample : fast) rolling.AddFrame(sample);
+    for (size_t i = fast.size() - params.WindowFrames; i < fast.size(); i++) fresh.AddFrame(fast[i]);
+
+    FRAME_STATS_SUMMARY a = rolling.Summary();
+    FRAME_STATS_SUMMARY b = fresh.Summary();
+    CHECK_EQ(a.Frame, 380u);
+    CHECK_EQ(a.WindowFrames, 100u);
+    CHECK_EQ(rolling.FrameCount(), 380u);
+    for (int metric = 0; metric < FRAME_METRIC_COUNT; metric++)
+    {
+        CHECK(std::fabs(a.Metrics[metric].MeanMs - b.Metrics[metric].MeanMs) < 1e-9);
+        CHECK_EQ(a.Metrics[metric].P50Ms, b.Metrics[metric].P50Ms);
+        CHECK_EQ(a.Metrics[metric].P95Ms, b.Metrics[metric].P95Ms);
+        CHECK_EQ(a.Metrics[metric].P99Ms, b.Metrics[metric].P99Ms);
+        CHECK_EQ(a.Metrics[metric].MaxMs, b.Metrics[metric].MaxMs);
+    }
+
+    // Adding and removing the same values restores every count
+    QuantileSketch sketch;
+    for (uint64_t value : { 5000ull, 16666667ull, 16666667ull, 33333333ull }) sketch.Add(value);
+    uint64_t before[3] = { sketch.Quantile(0.0), sketch.Quantile(0.5), sketch.Quantile(1.0) };
+    std::vector<uint64_t> passing;
+    for (uint32_t i = 0; i < 1000; i++) passing.push_back(random.LogUniform(2e3, 2e8));
+    for (uint64_t value : passing) sketch.Add(value);
+    for (uint64_t value : passing) sketch.Remove(value);
+    CHECK_EQ(sketch.Count(), 4u);
+    CHECK_EQ(sketch.Quantile(0.0), before[0]);
+    CHECK_EQ(sketch.Quantile(0.5), before[1]);
+    CHECK_EQ(sketch.Quantile(1.0), before[2]);
+
+    // An empty collector reports zeros
+    rolling.Clear();
+    FRAME_STATS_SUMMARY empty = rolling.Summary();
+    CHECK_EQ(empty.WindowFrames, 0u);
+    CHECK_EQ(empty.Stutters, 0u);
+    CHECK_EQ(empty.Metrics[FRAME_METRIC_CPU].P99Ms, 0.0);
+}
+
+TEST(frame_stats_stutters, "frame_stats/stutters")
+{
+    FRAME_STATS_PARAMS params;
+    params.WindowFrames = 100;
+    params.StutterFactor = 2.0;
+    params.MinStutterFrames = 30;
+    FrameStatsCollector collector(params);
+
+    // Too early to judge: a spike among the first frames is not counted
+    for (uint32_t i = 0; i < 10; i++) collector.AddFrame(frame(5000000, 0, 16666667));
+    collector.AddFrame(frame(5000000, 0, 100000000));
+    CHECK_EQ(collector.Summary().Stutters, 0u);
+
+    // A single spike of three intervals, and one just below the factor
+    for (uint32_t i = 0; i < 40; i++) collector.AddFrame(frame(5000000, 0, 16666667));
+    collector.AddFrame(frame(5000000, 0, 50000000));
+    collector.AddFrame(frame(5000000, 0, 16666667));
+    collector.AddFrame(frame(5000000, 0, 32000000));
+    for (uint32_t i = 0; i < 20; i++) collector.AddFrame(frame(5000000, 0, 16666667));
+    CHECK_EQ(collector.Summary().Stutters, 1u);
+
+    // Counted while in the window only
+    for (uint32_t i = 0; i < 100; i++) collector.AddFrame(frame(5000000, 0, 16666667));
+    CHECK_EQ(collector.Summary().Stutters, 0u);
+}
+
+TEST(frame_stats_csv, "frame_stats/csv")
+{
+    std::ostringstream header;
+    FrameStatsLog::WriteCsvHeader(header);
+    CHECK_EQ(header.str(), std::string(
+        "seconds,frame,window_frames,stutters,"
+        "cpu_mean_ms,cpu_p50_ms,cpu_p95_ms,cpu_p99_ms,cpu_max_ms,"
+        "fence_stall_mean_ms,fence_stall_p50_ms,fence_stall_p95_ms,fence_stall_p99_ms,fence_stall_max_ms,"
+        "present_interval_mean_ms,present_interval_p50_ms,present_interval_p95_ms,present_interval_p99_ms,"
+        "present_interval_max_ms\n"));
+
+    FRAME_STATS_SUMMARY summary = { };
+    summary.Frame = 1200;
+    summary.WindowFrames = 1000;
+    summary.Stutters = 3;
+    summary.Metrics[FRAME_METRIC_CPU] = { 4.5, 4.25, 7.5, 9.0, 12.0 };
+    summary.Metrics[FRAME_METRIC_FENCE_STALL] = { 0.125, 0.0, 1.0, 2.5, 3.0 };
+    summary.Metrics[FRAME_METRIC_PRESENT_INTERVAL] = { 16.75, 16.5, 17.0, 33.5, 50.0 };
+
+    std::ostringstream row;
+    FrameStatsLog::WriteCsvRow(row, summary, 20.5);
+    CHECK_EQ(row.str(), std::string("20.5,1200,1000,3,4.5,4.25,7.5,9,12,0.125,0,1,2.5,3,16.75,16.5,17,33.5,50\n"));
+
+    // Same number of columns as the header
+    const std::string headerText = header.str();
+    const std::string rowText = row.str();
+    CHECK_EQ(std::count(rowText.begin(), rowText.end(), ','), std::count(headerText.begin(), headerText.end(), ','));
+}
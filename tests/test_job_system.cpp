@@ -0,0 +1,215 @@
+/*****************************************************************//**
+ * \file   test_job_system.cpp
+ * \brief  Tests of JobSystem loops, fork/join and error propagation, also
+ *         built with ThreadSanitizer
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "job_system.h"
+#include "test.h"
+
+// Every index in [begin, end) once, in ranges of at most grain
+static void check_parallel_for(JobSystem& jobs, uint32_t begin, uint32_t end, uint32_t grain)
+{
+    std::unique_ptr<std::atomic<uint32_t>[]> visits(new std::atomic<uint32_t>[end + 1]);
+    for (uint32_t i = 0; i <= end; i++) visits[i].store(0);
+    std::atomic<uint32_t> badRanges{ 0 };
+
+    jobs.ParallelFor(begin, end, grain, [&](uint32_t first, uint32_t last)
+        {
+            if (first >= last || last - first > (grain > 0 ? grain : 1) || first < begin || last > end)
+            {
+                badRanges++;
+                return;
+            }
+            for (uint32_t i = first; i < last; i++) visits[i]++;
+        });
+
+    CHECK_EQ(badRanges.load(), 0u);
+    size_t wrong = 0;
+    for (uint32_t i = 0; i <= end; i++) wrong += visits[i].load() != (i >= begin && i < end ? 1u : 0u);
+    CHECK_EQ(wrong, 0u);
+}
+
+TEST(job_system_parallel_for, "job_system/parallel_for")
+{
+    for (unsigned threads : { 1u, 2u, 4u, 7u })
+    {
+        JobSystem jobs(threads);
+        CHECK_EQ(jobs.ThreadCount(), threads);
+
+        for (uint32_t grain : { 0u, 1u, 16u, 64u })
+        {
+            for (uint32_t size : { 0u, 1u, 15u, 16u, 17u, 63u, 64u, 65u, 1000u, 4097u })
+            {
+                check_parallel_for(jobs, 0, size, grain);
+                check_parallel_for(jobs, 5, 5 + size, grain);
+            }
+        }
+
+        // Empty and reversed ranges do nothing
+        bool called = false;
+        jobs.ParallelFor(10, 10, 4, [&](uint32_t, uint32_t) { called = true; });
+        jobs.ParallelFor(10, 3, 4, [&](uint32_t, uint32_t) { called = true; });
+        CHECK(!called);
+    }
+}
+
+// Sum of [begin, end) by recursive fork/join, every level waiting on its children
+static uint64_t fork_sum(JobSystem& jobs, uint32_t begin, uint32_t end)
+{
+    if (end - begin <= 8)
+    {
+        uint64_t sum = 0;
+        for (uint32_t i = begin; i < end; i++) sum += i;
+        return sum;
+    }
+
+    uint32_t middle = begin + (end - begin) / 2;
+    uint64_t upper = 0;
+    JobGroup group;
+    jobs.Run(group, [&]() { upper = fork_sum(jobs, middle, end); });
+    uint64_t lower = fork_sum(jobs, begin, middle);
+    jobs.Wait(group);
+    return lower + upper;
+}
+
+// Jobs that wait run other jobs meanwhile, so nesting never runs out of threads
+TEST(job_system_nested, "job_system/nested")
+{
+    for (unsigned threads : { 1u, 2u, 4u })
+    {
+        JobSystem jobs(threads);
+
+        CHECK_EQ(fork_sum(jobs, 0, 10000), 10000ull * 9999 / 2);
+
+        // A loop in every iteration of a loop, more loops than threads
+        std::vector<uint64_t> sums(16, 0);
+        jobs.ParallelFor(0, 16, 1, [&](uint32_t first, uint32_t last)
+            {
+                for (uint32_t outer = first; outer < last; outer++)
+                {
+                    std::atomic<uint64_t> sum{ 0 };
+                    jobs.ParallelFor(0, 1000, 10, [&](uint32_t b, uint32_t e)
+                        {
+                            for (uint32_t i = b; i < e; i++) sum += i * (outer + 1);
+                        });
+                    sums[outer] = sum.load();
+                }
+            });
+        for (uint32_t outer = 0; outer < 16; outer++) CHECK_EQ(sums[outer], 499500ull * (outer + 1));
+
+        // Threads outside the system may fork and wait as well
+        uint64_t outside = 0;
+        std::thread thread([&]() { outside = fork_sum(jobs, 0, 1000); });
+        thread.join();
+        CHECK_EQ(outside, 1000ull * 999 / 2);
+    }
+}
+
+TEST(job_system_exception, "job_system/exception")
+{
+    for (unsigned threads : { 1u, 4u })
+    {
+        JobSystem jobs(threads);
+
+        // The waiter gets the error once every job of the group has run
+        std::atomic<uint32_t> ran{ 0 };
+        std::string message;
+        {
+            JobGroup group;
+            for (uint32_t i = 0; i < 32; i++)
+            {
+                jobs.Run(group, [&ran, i]()
+                    {
+                        ran++;
+                        if (i == 17) throw std::runtime_error("job 17");
+                    });
+            }
+            try
+            {
+                jobs.Wait(group);
+            }
+            catch (const std::runtime_error& e)
+            {
+                message = e.what();
+            }
+            CHECK(group.Done());
+        }
+        CHECK_EQ(message, std::string("job 17"));
+        CHECK_EQ(ran.load(), 32u);
+
+        // Also from a loop, including the range the caller runs itself
+        for (uint32_t failing : { 0u, 999u })
+        {
+            std::atomic<uint32_t> visited{ 0 };
+            bool thrown = false;
+            try
+            {
+                jobs.ParallelFor(0, 1000, 10, [&](uint32_t first, uint32_t last)
+                    {
+                        visited += last - first;
+                        if (first <= failing && failing < last) throw std::logic_error("range");
+                    });
+            }
+            catch (const std::logic_error&)
+            {
+                thrown = true;
+            }
+            CHECK(thrown);
+            CHECK_EQ(visited.load(), 1000u);
+        }
+
+        // A failed group leaves the system usable
+        check_parallel_for(jobs, 0, 1000, 7);
+    }
+}
+
+// Tiny jobs forked from every thread, so deques are stolen from all the time.
+// Plain stores to separate slots: a job run twice or racing shows up as a
+// wrong count, and as a report under ThreadSanitizer.
+TEST(job_system_steal_stress, "job_system/steal_stress")
+{
+    const uint32_t Rounds = 50;
+    const uint32_t Outer = 64;
+    const uint32_t Inner = 64;
+
+    JobSystem jobs(4);
+    jobs.ResetStats();
+
+    std::vector<uint32_t> counts(Outer * Inner, 0);
+    for (uint32_t round = 0; round < Rounds; round++)
+    {
+        jobs.ParallelFor(0, Outer, 1, [&](uint32_t first, uint32_t last)
+            {
+                for (uint32_t outer = first; outer < last; outer++)
+                {
+                    JobGroup group;
+                    for (uint32_t inner = 0; inner < Inner; inner++)
+                    {
+                        uint32_t* pCount = &counts[outer * Inner + inner];
+                        jobs.Run(group, [pCount]() { (*pCount)++; });
+                    }
+                    jobs.Wait(group);
+                }
+            });
+    }
+
+    size_t wrong = 0;
+    for (uint32_t count : counts) wrong += count != Rounds;
+    CHECK_EQ(wrong, 0u);
+
+    // Every job is counted once, wherever it ran
+    JOB_SYSTEM_STATS stats = jobs.Stats();
+    CHECK(stats.Jobs >= static_cast<uint64_t>(Rounds) * Outer * Inner);
+    CHECK(stats.Steals <= stats.Jobs);
+}
@@ -0,0 +1,171 @@
+/*****************************************************************//**
+ * \file   test_latency_controller.cpp
+ * \brief  Tests of FrameLatencyController on synthetic timing traces
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "latency_controller.h"
+#include "test.h"
+
+// CPU and GPU milliseconds of frame i
+typedef std::function<double(uint32_t frame)> FrameCostFn;
+
+/**
+ * Runs frames through a model of the CPU-GPU pipeline and feeds the
+ * controller what the application would measure.
+ *
+ * Frame i may start on the CPU once the GPU has finished frame i - N, N being
+ * the frames in flight. The CPU then works and submits; the GPU starts the
+ * frame once it is submitted and the previous one is done.
+ *
+ * \return frames in flight after every frame
+ */
+static std::vector<uint32_t> run_trace(FrameLatencyController& controller, uint32_t frameCount,
+    const FrameCostFn& cpuMs, const FrameCostFn& gpuMs)
+{
+    std::vector<double> gpuEnd;
+    std::vector<uint32_t> history;
+    double cpuTime = 0.0;
+
+    for (uint32_t i = 0; i < frameCount; i++)
+    {
+        uint32_t inFlight = controller.FramesInFlight();
+
+        double stall = 0.0;
+        if (i >= inFlight && gpuEnd[i - inFlight] > cpuTime)
+        {
+            stall = gpuEnd[i - inFlight] - cpuTime;
+        }
+        double frameStart = cpuTime;
+        cpuTime += stall + cpuMs(i);
+
+        double previousEnd = i > 0 ? gpuEnd[i - 1] : 0.0;
+        double idle = cpuTime > previousEnd ? cpuTime - previousEnd : 0.0;
+        gpuEnd.push_back((cpuTime > previousEnd ? cpuTime : previousEnd) + gpuMs(i));
+
+        history.push_back(controller.AddFrame((cpuTime - frameStart) * 1e-3, stall * 1e-3, idle * 1e-3));
+    }
+    return history;
+}
+
+// Count the controller settled on: the same over the last `tail` frames
+static bool settled(const std::vector<uint32_t>& history, uint32_t tail, uint32_t& frames)
+{
+    frames = history.back();
+    for (size_t i = history.size() - tail; i < history.size(); i++)
+    {
+        if (history[i] != frames) return false;
+    }
+    return true;
+}
+
+static FRAME_LATENCY_PARAMS test_params()
+{
+    FRAME_LATENCY_PARAMS params;
+    params.MinFrames = 2;
+    params.MaxFrames = 4;
+    return params;
+}
+
+// The GPU waits for a slow CPU. More frames cannot feed it, so the count drops.
+TEST(latency_controller_cpu_bound, "latency_controller/cpu_bound")
+{
+    for (uint32_t initial = 2; initial <= 4; initial++)
+    {
+        FrameLatencyController controller(initial, test_params());
+        std::vector<uint32_t> history = run_trace(controller, 3000,
+            [](uint32_t) { return 16.0; },
+            [](uint32_t) { return 8.0; });
+
+        uint32_t frames = 0;
+        CHECK(settled(history, 1000, frames));
+        CHECK_EQ(frames, 2u);
+    }
+}
+
+// The CPU waits for the GPU, which never idles: queued frames are only latency
+TEST(latency_controller_gpu_bound, "latency_controller/gpu_bound")
+{
+    for (uint32_t initial = 2; initial <= 4; initial++)
+    {
+        FrameLatencyController controller(initial, test_params());
+        std::vector<uint32_t> history = run_trace(controller, 3000,
+            [](uint32_t) { return 5.0; },
+            [](uint32_t) { return 16.0; });
+
+        uint32_t frames = 0;
+        CHECK(settled(history, 1000, frames));
+        CHECK_EQ(frames, 2u);
+    }
+}
+
+// GPU-bound on average, with a CPU spike every 10th frame that drains the
+// queue. Two frames in flight let the GPU run dry, three hide most of the
+// spike, and the fourth frame is only latency.
+TEST(latency_controller_mixed, "latency_controller/mixed")
+{
+    FrameCostFn spikyCpu = [](uint32_t i) { return i % 10 == 9 ? 30.0 : 8.0; };
+    FrameCostFn gpu = [](uint32_t) { return 14.0; };
+
+    for (uint32_t initial = 2; initial <= 4; initial++)
+    {
+        FrameLatencyController controller(initial, test_params());
+        std::vector<uint32_t> history = run_trace(controller, 3000, spikyCpu, gpu);
+
+        uint32_t frames = 0;
+        CHECK(settled(history, 1000, frames));
+        CHECK_EQ(frames, 3u);
+    }
+}
+
+// CPU-bound, with a GPU spike every 10th frame that blocks the CPU below
+// four frames in flight. Once four stop the stalls, their absence must not
+// take the count back down.
+TEST(latency_controller_gpu_spikes, "latency_controller/gpu_spikes")
+{
+    FrameCostFn cpu = [](uint32_t) { return 16.0; };
+    FrameCostFn spikyGpu = [](uint32_t i) { return i % 10 == 9 ? 40.0 : 8.0; };
+
+    for (uint32_t initial = 2; initial <= 4; initial++)
+    {
+        FrameLatencyController controller(initial, test_params());
+        std::vector<uint32_t> history = run_trace(controller, 3000, cpu, spikyGpu);
+
+        uint32_t frames = 0;
+        CHECK(settled(history, 2000, frames));
+        CHECK_EQ(frames, 4u);
+    }
+}
+
+// Decisions wait for a full window and hold off during the cooldown
+TEST(latency_controller_window, "latency_controller/window")
+{
+    FRAME_LATENCY_PARAMS params = test_params();
+    params.WindowFrames = 10;
+    params.CooldownFrames = 20;
+    params.HoldFrames = 40;
+    FrameLatencyController controller(3, params);
+
+    // Stall and idle in the same window
+    for (uint32_t i = 0; i < 9; i++) CHECK_EQ(controller.AddFrame(0.016, 0.004, 0.004), 3u);
+    CHECK_EQ(controller.AddFrame(0.016, 0.004, 0.004), 4u);
+
+    // Ignored while cooling down, and no stalls do not undo the raise
+    // before the hold is over
+    for (uint32_t i = 0; i < 30; i++) CHECK_EQ(controller.AddFrame(0.016, 0.0, 0.008), 4u);
+    for (uint32_t i = 0; i < 9; i++) CHECK_EQ(controller.AddFrame(0.016, 0.0, 0.008), 4u);
+    CHECK_EQ(controller.AddFrame(0.016, 0.0, 0.008), 3u);
+
+    // Stall without idle is neither
+    for (uint32_t i = 0; i < 20; i++) controller.AddFrame(0.016, 0.0, 0.0);
+    for (uint32_t i = 0; i < 10; i++) CHECK_EQ(controller.AddFrame(0.016, 0.001, 0.0), 3u);
+
+    // Initial counts are clamped to the bounds
+    CHECK_EQ(FrameLatencyController(1, params).FramesInFlight(), 2u);
+    CHECK_EQ(FrameLatencyController(9, params).FramesInFlight(), 4u);
+}
@@ -0,0 +1,60 @@
+/*****************************************************************//**
+ * \file   test_main.cpp
+ * \brief  Entry point of the test executable
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "test.h"
+
+struct TEST_ENTRY
+{
+    const char* Name;
+    TestFn Fn;
+};
+
+// Function-local, so registrations in other files may run first
+static std::vector<TEST_ENTRY>& registry()
+{
+    static std::vector<TEST_ENTRY> tests;
+    return tests;
+}
+
+static int failed_checks = 0;
+
+TestRegistration::TestRegistration(const char* name, TestFn fn)
+{
+    registry().push_back({ name, fn });
+}
+
+void TestFailure(const char* file, int line, const std::string& message)
+{
+    std::cout << "  " << file << ":" << line << ": failed " << message << '\n';
+    failed_checks++;
+}
+
+// phys-sim-tests [filter]: runs the tests whose name contains filter
+int main(int argc, char* argv[])
+{
+    std::string filter = argc > 1 ? argv[1] : "";
+
+    int run = 0;
+    int failed = 0;
+    for (const TEST_ENTRY& test : registry())
+    {
+        if (std::string(test.Name).find(filter) == std::string::npos) continue;
+
+        std::cout << test.Name << '\n';
+        int before = failed_checks;
+        test.Fn();
+        run++;
+        if (failed_checks != before) failed++;
+    }
+
+    std::cout << run << " test(s), " << failed << " failed\n";
+    return failed == 0 && run > 0 ? 0 : 1;
+}
@@ -0,0 +1,246 @@
+/*****************************************************************//**
+ * \file   test_null_backend.cpp
+ * \brief  Tests of the rules NullCommandBackend checks, one stream breaking
+ *         each
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include <cstdint>
+#include <string>
+
+#include "command_stream.h"
+#include "null_backend.h"
+#include "test.h"
+
+static const GPU_HANDLE Pipeline = 2;
+static const GPU_HANDLE RootSignature = 1;
+static const GPU_HANDLE BackBuffer = 0x1000;
+static const GPU_HANDLE DepthBuffer = 0x2000;
+static const GPU_HANDLE IndexBuffer = 0x3000;
+static const GPU_HANDLE VertexBuffer = 0x4000;
+static const GPU_HANDLE UploadBuffer = 0x5000;
+static const uint32_t StatePresent = 0;
+static const uint32_t StateRenderTarget = 4;
+static const uint32_t IndexCount = 36;
+
+// Which binds state_for_draw leaves out
+enum TEST_MISSING
+{
+    TEST_MISSING_NONE,
+    TEST_MISSING_PIPELINE,
+    TEST_MISSING_ROOT_SIGNATURE,
+    TEST_MISSING_INDEX_BUFFER,
+};
+
+// Everything a draw needs, but the one bind left out
+static void state_for_draw(CommandStream& stream, TEST_MISSING missing)
+{
+    if (missing != TEST_MISSING_ROOT_SIGNATURE) stream.SetRootSignature(RootSignature);
+    if (missing != TEST_MISSING_PIPELINE) stream.SetPipeline(Pipeline);
+    stream.SetViewport(0.0f, 0.0f, 1280.0f, 720.0f, 0.0f, 1.0f);
+    stream.SetScissor(0, 0, 1280, 720);
+    stream.SetRenderTarget(BackBuffer, DepthBuffer);
+    stream.SetTopology(4);
+    stream.SetVertexBuffer(VertexBuffer, 24 * 32, 32);
+    if (missing != TEST_MISSING_INDEX_BUFFER) stream.SetIndexBuffer(IndexBuffer, IndexCount * 2, 2);
+}
+
+// The stream fails with exactly one message, naming the command and rule
+static void check_one_error(NullCommandBackend& backend, const CommandStream& stream, const std::string& expected)
+{
+    backend.ClearErrors();
+    CHECK(!backend.Execute(stream));
+    CHECK_EQ(backend.Errors().size(), 1u);
+    if (!backend.Errors().empty()) CHECK_EQ(backend.Errors()[0], expected);
+}
+
+TEST(null_backend_draw_state, "null_backend/draw_state")
+{
+    NullCommandBackend backend;
+
+    // With every bind the draw is valid
+    CommandStream stream;
+    state_for_draw(stream, TEST_MISSING_NONE);
+    stream.DrawIndexed(IndexCount, 1, 0, 0, 0);
+    CHECK(backend.Execute(stream));
+    CHECK(backend.Errors().empty());
+
+    // With one bind left out, the draw is command 7
+    stream.Reset();
+    state_for_draw(stream, TEST_MISSING_PIPELINE);
+    stream.DrawIndexed(IndexCount, 1, 0, 0, 0);
+    check_one_error(backend, stream, "command 7 (DrawIndexed): no pipeline");
+
+    stream.Reset();
+    state_for_draw(stream, TEST_MISSING_ROOT_SIGNATURE);
+    stream.DrawIndexed(IndexCount, 1, 0, 0, 0);
+    check_one_error(backend, stream, "command 7 (DrawIndexed): no root signature");
+
+    stream.Reset();
+    state_for_draw(stream, TEST_MISSING_INDEX_BUFFER);
+    stream.DrawIndexed(IndexCount, 1, 0, 0, 0);
+    check_one_error(backend, stream, "command 7 (DrawIndexed): no index buffer");
+
+    // State does not carry over from the previous stream
+    CommandStream bare;
+    bare.DrawIndexed(IndexCount, 1, 0, 0, 0);
+    backend.ClearErrors();
+    CHECK(!backend.Execute(bare));
+    CHECK_EQ(backend.Errors().size(), 7u);
+
+    // Root arguments need a root signature too
+    stream.Reset();
+    stream.SetRootCBV(0, 0x9000);
+    check_one_error(backend, stream, "command 0 (SetRootCBV): no root signature");
+}
+
+TEST(null_backend_index_range, "null_backend/index_range")
+{
+    NullCommandBackend backend;
+
+    // Up to the last index of the buffer is fine
+    CommandStream stream;
+    state_for_draw(stream, TEST_MISSING_NONE);
+    stream.DrawIndexed(IndexCount, 1, 0, 0, 0);
+    stream.DrawIndexed(1, 1, IndexCount - 1, 0, 0);
+    CHECK(backend.Execute(stream));
+
+    stream.Reset();
+    state_for_draw(stream, TEST_MISSING_NONE);
+    stream.DrawIndexed(IndexCount, 1, 1, 0, 0);
+    check_one_error(backend, stream, "command 8 (DrawIndexed): indices past the end of the index buffer");
+
+    // Also when start and count wrap around 32 bits
+    stream.Reset();
+    state_for_draw(stream, TEST_MISSING_NONE);
+    stream.DrawIndexed(2, 1, 0xFFFFFFFFu, 0, 0);
+    check_one_error(backend, stream, "command 8 (DrawIndexed): indices past the end of the index buffer");
+
+    // The same count of 32-bit indices needs twice the bytes
+    stream.Reset();
+    state_for_draw(stream, TEST_MISSING_NONE);
+    stream.SetIndexBuffer(IndexBuffer, IndexCount * 2, 4);
+    stream.DrawIndexed(IndexCount, 1, 0, 0, 0);
+    check_one_error(backend, stream, "command 9 (DrawIndexed): indices past the end of the index buffer");
+}
+
+TEST(null_backend_barrier_state, "null_backend/barrier_state")
+{
+    NullCommandBackend backend;
+    backend.SetResourceState(BackBuffer, StatePresent);
+
+    // From the wrong state on a registered resource
+    CommandStream stream;
+    stream.Barrier(BackBuffer, StateRenderTarget, StatePresent);
+    check_one_error(backend, stream, "command 0 (Barrier): resource is not in the before state");
+
+    // The state carries over between streams, as on a queue: open and close
+    // alternate, and open twice in a row starts from the wrong state
+    backend.SetResourceState(BackBuffer, StatePresent);
+    CommandStream open;
+    open.Barrier(BackBuffer, StatePresent, StateRenderTarget);
+    CommandStream close;
+    close.Barrier(BackBuffer, StateRenderTarget, StatePresent);
+    backend.ClearErrors();
+    CHECK(backend.Execute(open));
+    CHECK(backend.Execute(close));
+    CHECK(backend.Execute(open));
+    check_one_error(backend, open, "command 0 (Barrier): resource is not in the before state");
+
+    // Unregistered resources are trusted once, then tracked
+    CommandStream texture;
+    texture.Barrier(0x7000, 1, 2);
+    backend.ClearErrors();
+    CHECK(backend.Execute(texture));
+    check_one_error(backend, texture, "command 0 (Barrier): resource is not in the before state");
+
+    // A transition to the state the resource is already in
+    backend.SetResourceState(BackBuffer, StatePresent);
+    stream.Reset();
+    stream.Barrier(BackBuffer, StatePresent, StatePresent);
+    check_one_error(backend, stream, "command 0 (Barrier): transition to the same state");
+}
+
+TEST(null_backend_copy_overlap, "null_backend/copy_overlap")
+{
+    NullCommandBackend backend;
+    backend.SetBufferSize(UploadBuffer, 256);
+
+    // Separate ranges of one buffer, touching at one end, are fine
+    CommandStream stream;
+    stream.CopyBuffer(UploadBuffer, 128, UploadBuffer, 0, 128);
+    stream.CopyBuffer(UploadBuffer, 0, UploadBuffer, 64, 64);
+    CHECK(backend.Execute(stream));
+
+    // Overlapping from either side, or in place
+    const uint64_t overlaps[][2] = { { 32, 0 }, { 0, 32 }, { 16, 16 } };
+    for (const uint64_t* offsets : overlaps)
+    {
+        stream.Reset();
+        stream.CopyBuffer(UploadBuffer, offsets[0], UploadBuffer, offsets[1], 64);
+        check_one_error(backend, stream, "command 0 (CopyBuffer): source and destination overlap");
+    }
+
+    // The same ranges of different buffers do not overlap
+    stream.Reset();
+    stream.CopyBuffer(UploadBuffer, 16, IndexBuffer, 16, 64);
+    backend.ClearErrors();
+    CHECK(backend.Execute(stream));
+
+    // Past the end of a registered buffer
+    stream.Reset();
+    stream.CopyBuffer(IndexBuffer, 0, UploadBuffer, 200, 64);
+    check_one_error(backend, stream, "command 0 (CopyBuffer): past the end of the source");
+}
+
+// A header the backend cannot trust: the message names it, and nothing
+// after it is read, not even the draw that would have its own errors
+TEST(null_backend_malformed, "null_backend/malformed")
+{
+    NullCommandBackend backend;
+
+    struct CORRUPTION
+    {
+        uint16_t Type;
+        uint16_t Size;
+        const char* Message;
+    };
+    const CORRUPTION corruptions[] =
+    {
+        { COMMAND_SET_PIPELINE, 8, "command 1 (SetPipeline): malformed command, stopping" },
+        { COMMAND_SET_PIPELINE, sizeof(CMD_SET_HANDLE) + 4, "command 1 (SetPipeline): malformed command, stopping" },
+        { COMMAND_DRAW_INDEXED, sizeof(CMD_SET_HANDLE), "command 1 (DrawIndexed): malformed command, stopping" },
+        { COMMAND_TYPE_COUNT, sizeof(CMD_SET_HANDLE), "command 1 (Unknown): malformed command, stopping" },
+    };
+    for (const CORRUPTION& corruption : corruptions)
+    {
+        CommandStream stream;
+        stream.SetRootSignature(RootSignature);
+        stream.SetPipeline(Pipeline);
+        stream.DrawIndexed(IndexCount, 1, 0, 0, 0);
+
+        // Backends only ever see streams as recorded, so break one in place
+        COMMAND_HEADER* pHeader = const_cast<COMMAND_HEADER*>(stream.Next(stream.First()));
+        pHeader->Type = corruption.Type;
+        pHeader->Size = corruption.Size;
+
+        backend.ResetStats();
+        check_one_error(backend, stream, corruption.Message);
+        CHECK_EQ(backend.Stats().Draws, 0u);
+        CHECK_EQ(backend.Stats().Commands[COMMAND_SET_ROOT_SIGNATURE], 1u);
+    }
+
+    // Root constants claiming more values than the command holds
+    CommandStream stream;
+    const uint32_t values[2] = { 1, 2 };
+    stream.SetRootSignature(RootSignature);
+    stream.SetRootConstants(0, 2, values);
+    stream.DrawIndexed(IndexCount, 1, 0, 0, 0);
+    const COMMAND_HEADER* pConstants = stream.Next(stream.First());
+    const_cast<CMD_SET_ROOT_CONSTANTS*>(reinterpret_cast<const CMD_SET_ROOT_CONSTANTS*>(pConstants))->Count = 64;
+
+    backend.ResetStats();
+    check_one_error(backend, stream, "command 1 (SetRootConstants): values past the end of the command, stopping");
+    CHECK_EQ(backend.Stats().Draws, 0u);
+}
@@ -0,0 +1,256 @@
+/*****************************************************************//**
+ * \file   test_occlusion.cpp
+ * \brief  Tests of OcclusionCuller against an analytic reference
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "job_system.h"
+#include "occlusion.h"
+#include "test.h"
+
+// The application's buffer size, with a 90 degree vertical field of view
+static const uint32_t Width = 256;
+static const uint32_t Height = 128;
+static const float NearZ = 1.0f;
+static const float FarZ = 1000.0f;
+static const float ScaleY = 1.0f;
+static const float ScaleX = 0.5f;
+
+// A wall facing the camera, which sits at the origin looking down +z
+static const float WallZ = 20.0f;
+static const float WallHalfX = 19.3f;
+static const float WallHalfY = 9.1f;
+static const uint32_t WallCells = 64;
+
+// Rasterization samples pixel centers, so an edge may cover up to a pixel
+// more than the wall. One pixel, in world units at the wall.
+static const float PixelAtWall = 2.0f / Width * WallZ / ScaleX;
+
+class TestRandom
+{
+public:
+    float Uniform(float lo, float hi)
+    {
+        m_state = m_state * 1103515245u + 12345u;
+        return lo + (hi - lo) * static_cast<float>(m_state >> 8) / 16777216.0f;
+    }
+
+private:
+    uint32_t m_state = 12345;
+};
+
+// D3D perspective in row-vector convention, with an identity view
+static void test_view_proj(float m[16])
+{
+    for (int i = 0; i < 16; i++) m[i] = 0.0f;
+    m[0] = ScaleX;
+    m[5] = ScaleY;
+    m[10] = FarZ / (FarZ - NearZ);
+    m[11] = 1.0f;
+    m[14] = -NearZ * FarZ / (FarZ - NearZ);
+}
+
+// Split in enough triangles that setup runs on several threads
+static OCCLUDER_MESH wall_occluder()
+{
+    OCCLUDER_MESH mesh;
+    for (uint32_t row = 0; row <= WallCells; row++)
+    {
+        for (uint32_t col = 0; col <= WallCells; col++)
+        {
+            mesh.Positions.push_back(-WallHalfX + 2.0f * WallHalfX * col / WallCells);
+            mesh.Positions.push_back(WallHalfY - 2.0f * WallHalfY * row / WallCells);
+            mesh.Positions.push_back(WallZ);
+        }
+    }
+
+    const uint32_t n = WallCells + 1;
+    for (uint32_t row = 0; row < WallCells; row++)
+    {
+        for (uint32_t col = 0; col < WallCells; col++)
+        {
+            uint32_t i = row * n + col;
+            uint32_t quad[6] = { i, i + 1, i + n, i + 1, i + n + 1, i + n };
+            mesh.Indices.insert(mesh.Indices.end(), quad, quad + 6);
+        }
+    }
+    return mesh;
+}
+
+// Behind the wall as seen from the camera, the wall grown by margin
+static bool behind_wall(float x, float y, float z, float margin)
+{
+    if (z <= WallZ) return false;
+    float scale = WallZ / z;
+    return std::fabs(x * scale) <= WallHalfX + margin && std::fabs(y * scale) <= WallHalfY + margin;
+}
+
+// The region hidden by the wall is convex, so a box is hidden when its corners are
+static bool box_behind_wall(const MESH_BOUNDS& bounds, float margin)
+{
+    for (int corner = 0; corner < 8; corner++)
+    {
+        float x = bounds.Center[0] + ((corner & 1) ? bounds.Extents[0] : -bounds.Extents[0]);
+        float y = bounds.Center[1] + ((corner & 2) ? bounds.Extents[1] : -bounds.Extents[1]);
+        float z = bounds.Center[2] + ((corner & 4) ? bounds.Extents[2] : -bounds.Extents[2]);
+        if (!behind_wall(x, y, z, margin)) return false;
+    }
+    return true;
+}
+
+static MESH_BOUNDS box(float x, float y, float z, float extent)
+{
+    MESH_BOUNDS bounds;
+    bounds.Center[0] = x;
+    bounds.Center[1] = y;
+    bounds.Center[2] = z;
+    for (int k = 0; k < 3; k++) bounds.Extents[k] = extent;
+    bounds.Radius = extent * std::sqrt(3.0f);
+    return bounds;
+}
+
+// Culls nothing that the wall does not hide, and most of what it does
+TEST(occlusion_reference, "occlusion/reference")
+{
+    float viewProj[16];
+    test_view_proj(viewProj);
+
+    OcclusionCuller culler(Width, Height);
+    culler.SetOccluder(wall_occluder());
+    culler.Render(viewProj);
+
+    // Behind the middle, in front, beside, straddling the edge and behind the camera
+    CHECK(!culler.IsVisible(box(0.0f, 0.0f, 40.0f, 1.0f)));
+    CHECK(culler.IsVisible(box(0.0f, 0.0f, 10.0f, 1.0f)));
+    CHECK(culler.IsVisible(box(0.0f, 0.0f, 19.5f, 1.0f)));
+    CHECK(culler.IsVisible(box(60.0f, 0.0f, 40.0f, 1.0f)));
+    CHECK(culler.IsVisible(box(2.0f * WallHalfX, 0.0f, 40.0f, 1.0f)));
+    CHECK(culler.IsVisible(box(0.0f, 0.0f, -10.0f, 1.0f)));
+
+    TestRandom random;
+    CullingBounds bounds;
+    std::vector<MESH_BOUNDS> boxes;
+    for (uint32_t i = 0; i < 20000; i++)
+    {
+        MESH_BOUNDS b = box(random.Uniform(-60.0f, 60.0f), random.Uniform(-30.0f, 30.0f),
+            random.Uniform(2.0f, 80.0f), random.Uniform(0.1f, 4.0f));
+        boxes.push_back(b);
+        bounds.Add(b);
+    }
+
+    std::vector<uint32_t> visible(boxes.size());
+    for (uint32_t i = 0; i < visible.size(); i++) visible[i] = i;
+    culler.Cull(bounds, visible);
+
+    std::vector<bool> kept(boxes.size(), false);
+    for (uint32_t index : visible) kept[index] = true;
+
+    size_t wrongCulls = 0;
+    size_t hidden = 0;
+    size_t hiddenCulled = 0;
+    for (uint32_t i = 0; i < boxes.size(); i++)
+    {
+        CHECK_EQ(culler.IsVisible(boxes[i]), static_cast<bool>(kept[i]));
+        if (!kept[i] && !box_behind_wall(boxes[i], PixelAtWall)) wrongCulls++;
+        if (box_behind_wall(boxes[i], 0.0f))
+        {
+            hidden++;
+            hiddenCulled += !kept[i];
+        }
+    }
+    CHECK_EQ(wrongCulls, 0u);
+
+    // Hidden boxes near the edge may stay, through coarse pyramid levels
+    CHECK(hidden > 1000);
+    CHECK(hiddenCulled * 4 >= hidden * 3);
+}
+
+// Tiles and setup ranges do not change a single texel
+TEST(occlusion_threads, "occlusion/threads")
+{
+    float viewProj[16];
+    test_view_proj(viewProj);
+    OCCLUDER_MESH occluder = wall_occluder();
+
+    OcclusionCuller single(Width, Height);
+    single.SetOccluder(occluder);
+    single.Render(viewProj);
+
+    for (unsigned threads : { 1u, 2u, 4u })
+    {
+        JobSystem jobs(threads);
+        OcclusionCuller culler(Width, Height, &jobs);
+        culler.SetOccluder(occluder);
+        culler.Render(viewProj);
+
+        CHECK_EQ(culler.LevelCount(), single.LevelCount());
+        size_t differences = 0;
+        for (uint32_t level = 0; level < single.LevelCount(); level++)
+        {
+            size_t texels = static_cast<size_t>(single.LevelWidth(level)) * single.LevelHeight(level);
+            for (size_t i = 0; i < texels; i++)
+            {
+                differences += culler.LevelDepth(level)[i] != single.LevelDepth(level)[i];
+            }
+        }
+        CHECK_EQ(differences, 0u);
+    }
+}
+
+// The coarse occluder stays below every sample of the heightfield
+TEST(occlusion_heightfield, "occlusion/heightfield")
+{
+    const uint32_t Rows = 37;
+    const uint32_t Cols = 29;
+    const float OriginX = -14.0f, OriginZ = 18.0f, Dx = 1.0f, Dz = 1.0f;
+    const float HeightScale = 0.1f, HeightOffset = -5.0f;
+
+    TestRandom random;
+    std::vector<uint8_t> heights(Rows * Cols);
+    for (uint8_t& h : heights) h = static_cast<uint8_t>(random.Uniform(0.0f, 255.0f));
+
+    for (uint32_t step : { 1u, 4u, 5u })
+    {
+        OCCLUDER_MESH mesh = BuildHeightfieldOccluder(heights.data(), Rows, Cols, Cols, step,
+            OriginX, OriginZ, Dx, Dz, HeightScale, HeightOffset);
+        CHECK(!mesh.Indices.empty());
+
+        size_t uncovered = 0;
+        size_t above = 0;
+        for (uint32_t row = 0; row < Rows; row++)
+        {
+            for (uint32_t col = 0; col < Cols; col++)
+            {
+                const float x = OriginX + col * Dx;
+                const float z = OriginZ - row * Dz;
+                const float y = heights[row * Cols + col] * HeightScale + HeightOffset;
+
+                // Occluder height over the sample, from every triangle containing it
+                bool covered = false;
+                for (size_t t = 0; t < mesh.Indices.size(); t += 3)
+                {
+                    const float* p0 = &mesh.Positions[3 * mesh.Indices[t]];
+                    const float* p1 = &mesh.Positions[3 * mesh.Indices[t + 1]];
+                    const float* p2 = &mesh.Positions[3 * mesh.Indices[t + 2]];
+
+                    float area = (p1[0] - p0[0]) * (p2[2] - p0[2]) - (p2[0] - p0[0]) * (p1[2] - p0[2]);
+                    float w1 = ((x - p0[0]) * (p2[2] - p0[2]) - (p2[0] - p0[0]) * (z - p0[2])) / area;
+                    float w2 = ((p1[0] - p0[0]) * (z - p0[2]) - (x - p0[0]) * (p1[2] - p0[2])) / area;
+                    float w0 = 1.0f - w1 - w2;
+                    if (w0 < -1e-5f || w1 < -1e-5f || w2 < -1e-5f) continue;
+
+                    covered = true;
+                    if (w0 * p0[1] + w1 * p1[1] + w2 * p2[1] > y + 1e-4f) above++;
+                }
+                uncovered += !covered;
+            }
+        }
+        CHECK_EQ(uncovered, 0u);
+        CHECK_EQ(above, 0u);
+    }
+}
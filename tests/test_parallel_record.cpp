@@ -0,0 +1,211 @@
+/*****************************************************************//**
+ * \file   test_parallel_record.cpp
+ * \brief  Tests of splitting recording across workers, replayed on the
+ *         null backend
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "command_stream.h"
+#include "job_system.h"
+#include "null_backend.h"
+#include "parallel_record.h"
+#include "test.h"
+
+// Backend values of the test frame, as D3D12 would use them
+static const GPU_HANDLE BackBuffer = 0x1000;
+static const GPU_HANDLE DepthBuffer = 0x2000;
+static const GPU_HANDLE IndexBuffer = 0x3000;
+static const GPU_HANDLE VertexBuffer = 0x4000;
+static const uint32_t StatePresent = 0;
+static const uint32_t StateRenderTarget = 4;
+static const uint32_t IndexCount = 36;
+
+TEST(parallel_record_partition, "parallel_record/partition")
+{
+    for (uint32_t batches = 0; batches <= 200; batches += 7)
+    {
+        for (uint32_t workers = 1; workers <= 9; workers++)
+        {
+            for (uint32_t minBatches : { 0u, 1u, 16u, 64u })
+            {
+                std::vector<RECORD_RANGE> ranges = ParallelRecorder::Partition(batches, workers, minBatches);
+                CHECK(!ranges.empty());
+                CHECK(ranges.size() <= workers);
+
+                // Contiguous, in order, covering every batch once
+                uint32_t next = 0;
+                for (size_t i = 0; i < ranges.size(); i++)
+                {
+                    CHECK_EQ(ranges[i].First, next);
+                    next += ranges[i].Count;
+
+                    // Balanced, larger ranges first, none below the minimum
+                    // unless the frame is too small to split at all
+                    CHECK(ranges[i].Count <= ranges[0].Count);
+                    CHECK(ranges[0].Count - ranges[i].Count <= 1);
+                    if (i > 0) CHECK(ranges[i].Count <= ranges[i - 1].Count);
+                    if (ranges.size() > 1) CHECK(ranges[i].Count >= minBatches);
+                }
+                CHECK_EQ(next, batches);
+            }
+        }
+    }
+
+    // Small frames stay on one worker
+    CHECK_EQ(ParallelRecorder::Partition(100, 4, 64).size(), 1u);
+    CHECK_EQ(ParallelRecorder::Partition(128, 4, 64).size(), 2u);
+    CHECK_EQ(ParallelRecorder::Partition(1000, 4, 64).size(), 4u);
+}
+
+// What a worker records: full state, as streams start with none, then one
+// draw per batch carrying the batch index as its first instance
+static void record_batches(const RECORD_RANGE& range, uint32_t rangeIndex, uint32_t rangeCount,
+    CommandStream& stream)
+{
+    if (rangeIndex == 0) stream.Barrier(BackBuffer, StatePresent, StateRenderTarget);
+
+    stream.SetRootSignature(1);
+    stream.SetPipeline(2);
+    stream.SetViewport(0.0f, 0.0f, 1280.0f, 720.0f, 0.0f, 1.0f);
+    stream.SetScissor(0, 0, 1280, 720);
+    stream.SetRenderTarget(BackBuffer, DepthBuffer);
+    stream.SetTopology(4);
+    stream.SetVertexBuffer(VertexBuffer, 24 * 32, 32);
+    stream.SetIndexBuffer(IndexBuffer, IndexCount * 2, 2);
+
+    for (uint32_t batch = range.First; batch < range.First + range.Count; batch++)
+    {
+        stream.DrawIndexed(IndexCount, 1 + batch % 3, 0, 0, batch);
+    }
+
+    if (rangeIndex == rangeCount - 1) stream.Barrier(BackBuffer, StateRenderTarget, StatePresent);
+}
+
+// First instances of the draws of streams in submission order
+static std::vector<uint32_t> draw_order(const ParallelRecorder& recorder, uint32_t streamCount)
+{
+    std::vector<uint32_t> order;
+    for (uint32_t i = 0; i < streamCount; i++)
+    {
+        const CommandStream& stream = recorder.Stream(i);
+        for (const COMMAND_HEADER* p = stream.First(); p; p = stream.Next(p))
+        {
+            if (p->Type == COMMAND_DRAW_INDEXED)
+            {
+                order.push_back(reinterpret_cast<const CMD_DRAW_INDEXED*>(p)->StartInstance);
+            }
+        }
+    }
+    return order;
+}
+
+// 1000 batches over 4 streams replay as one stream would, in order
+TEST(parallel_record_replay, "parallel_record/replay")
+{
+    const uint32_t BatchCount = 1000;
+
+    JobSystem jobs(4);
+    ParallelRecorder recorder(4, &jobs);
+    CHECK_EQ(recorder.MaxWorkers(), 4u);
+
+    for (int frame = 0; frame < 20; frame++)
+    {
+        std::vector<uint32_t> workers(BatchCount);
+        uint32_t streamCount = recorder.Record(BatchCount, 64,
+            [&](uint32_t worker, const RECORD_RANGE& range, CommandStream& stream)
+            {
+                for (uint32_t b = range.First; b < range.First + range.Count; b++) workers[b] = worker;
+                record_batches(range, worker, static_cast<uint32_t>(recorder.Ranges().size()), stream);
+            });
+        CHECK_EQ(streamCount, 4u);
+
+        // Each range was recorded by its own worker index
+        for (uint32_t i = 0; i < streamCount; i++)
+        {
+            const RECORD_RANGE& range = recorder.Ranges()[i];
+            for (uint32_t b = range.First; b < range.First + range.Count; b++) CHECK_EQ(workers[b], i);
+        }
+
+        std::vector<uint32_t> order = draw_order(recorder, streamCount);
+        CHECK_EQ(order.size(), static_cast<size_t>(BatchCount));
+        size_t outOfOrder = 0;
+        for (uint32_t i = 0; i < order.size(); i++) outOfOrder += order[i] != i;
+        CHECK_EQ(outOfOrder, 0u);
+
+        // Valid on their own, and the barrier pair only matches in order
+        NullCommandBackend backend;
+        backend.SetResourceState(BackBuffer, StatePresent);
+        backend.SetBufferSize(IndexBuffer, IndexCount * 2);
+        for (uint32_t i = 0; i < streamCount; i++) CHECK(backend.Execute(recorder.Stream(i)));
+        CHECK(backend.Errors().empty());
+        CHECK_EQ(backend.Stats().Draws, BatchCount);
+        CHECK_EQ(backend.Stats().Commands[COMMAND_BARRIER], 2u);
+
+        uint64_t instances = 0;
+        for (uint32_t b = 0; b < BatchCount; b++) instances += 1 + b % 3;
+        CHECK_EQ(backend.Stats().Instances, instances);
+    }
+
+    // Submitted in the wrong order, the back buffer is not in the state the
+    // last stream expects
+    NullCommandBackend backend;
+    backend.SetResourceState(BackBuffer, StatePresent);
+    backend.SetBufferSize(IndexBuffer, IndexCount * 2);
+    CHECK(!backend.Execute(recorder.Stream(3)));
+}
+
+// The same draws, whether recorded by the job system or the calling thread
+TEST(parallel_record_single_stream, "parallel_record/single_stream")
+{
+    const uint32_t BatchCount = 1000;
+
+    ParallelRecorder single(4);
+    CHECK_EQ(single.MaxWorkers(), 1u);
+    uint32_t streamCount = single.Record(BatchCount, 64,
+        [](uint32_t worker, const RECORD_RANGE& range, CommandStream& stream)
+        {
+            record_batches(range, worker, 1, stream);
+        });
+    CHECK_EQ(streamCount, 1u);
+
+    std::vector<uint32_t> order = draw_order(single, streamCount);
+    CHECK_EQ(order.size(), static_cast<size_t>(BatchCount));
+    for (uint32_t i = 0; i < order.size(); i++) CHECK_EQ(order[i], i);
+
+    NullCommandBackend backend;
+    backend.SetResourceState(BackBuffer, StatePresent);
+    CHECK(backend.Execute(single.Stream(0)));
+    CHECK_EQ(backend.Stats().Draws, BatchCount);
+}
+
+TEST(parallel_record_exception, "parallel_record/exception")
+{
+    JobSystem jobs(4);
+    ParallelRecorder recorder(4, &jobs);
+
+    std::vector<uint32_t> recorded(4, 0);
+    bool thrown = false;
+    try
+    {
+        recorder.Record(1000, 64, [&](uint32_t worker, const RECORD_RANGE& range, CommandStream& stream)
+            {
+                record_batches(range, worker, 4, stream);
+                recorded[worker] = 1;
+                if (worker == 2) throw std::runtime_error("worker 2");
+            });
+    }
+    catch (const std::runtime_error& e)
+    {
+        thrown = std::string(e.what()) == "worker 2";
+    }
+    CHECK(thrown);
+
+    // Every other worker still finished its range
+    for (uint32_t worker = 0; worker < 4; worker++) CHECK_EQ(recorded[worker], 1u);
+}
@@ -0,0 +1,328 @@
+/*****************************************************************//**
+ * \file   test_profiler.cpp
+ * \brief  Tests of ProfileRing wraparound and of the Chrome trace output
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "profiler.h"
+#include "test.h"
+
+TEST(profiler_ring, "profiler/ring")
+{
+    const uint32_t capacity = ProfileRing::Capacity;
+    ProfileRing ring(7, "ring");
+    CHECK_EQ(ring.ThreadId(), 7u);
+    CHECK_EQ(ring.ThreadName(), std::string("ring"));
+
+    // Below capacity, everything in order
+    for (uint64_t i = 0; i < 10; i++) ring.Push("zone", i, i + 1);
+    std::vector<PROFILE_ZONE_RECORD> records;
+    ring.Copy(records);
+    CHECK_EQ(records.size(), 10u);
+    for (uint64_t i = 0; i < records.size(); i++) CHECK_EQ(records[i].Start, i);
+
+    // Past capacity, exactly the last Capacity zones, oldest first
+    const uint64_t total = capacity + 1000;
+    for (uint64_t i = 10; i < total; i++) ring.Push("zone", i, i + 1);
+    CHECK_EQ(ring.Pushed(), total);
+    records.clear();
+    ring.Copy(records);
+    CHECK_EQ(records.size(), static_cast<size_t>(capacity));
+    size_t wrong = 0;
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        wrong += records[i].Start != total - capacity + i || records[i].End != records[i].Start + 1;
+    }
+    CHECK_EQ(wrong, 0u);
+
+    // Copy appends
+    ring.Copy(records);
+    CHECK_EQ(records.size(), 2 * static_cast<size_t>(capacity));
+
+    // Clear hides what was pushed before it, but not what comes after
+    ring.Clear();
+    records.clear();
+    ring.Copy(records);
+    CHECK(records.empty());
+
+    for (uint64_t i = 0; i < 3; i++) ring.Push("after", 100 + i, 200 + i);
+    ring.Copy(records);
+    CHECK_EQ(records.size(), 3u);
+    for (uint64_t i = 0; i < records.size(); i++)
+    {
+        CHECK_EQ(records[i].Start, 100 + i);
+        CHECK_EQ(std::string(records[i].Name), std::string("after"));
+    }
+    CHECK_EQ(ring.Pushed(), total + 3);
+}
+
+// Just enough JSON to read a trace back: objects, arrays, strings with
+// escapes, numbers and literals
+struct TEST_JSON
+{
+    enum TYPE { NONE, OBJECT, ARRAY, STRING, NUMBER, LITERAL };
+
+    TYPE Type = NONE;
+    std::string Text;                       // String, or the literal
+    double Number = 0.0;
+    std::vector<TEST_JSON> Items;           // Array items, or object values
+    std::vector<std::string> Keys;          // Object keys
+
+    const TEST_JSON* Find(const std::string& key) const
+    {
+        for (size_t i = 0; i < Keys.size(); i++)
+        {
+            if (Keys[i] == key) return &Items[i];
+        }
+        return nullptr;
+    }
+};
+
+class TestJsonParser
+{
+public:
+    explicit TestJsonParser(const std::string& text) : m_text(text) { }
+
+    // Whole text as one value, false on any syntax error
+    bool Parse(TEST_JSON& value)
+    {
+        if (!parse_value(value)) return false;
+        skip_space();
+        return m_pos == m_text.size();
+    }
+
+private:
+    void skip_space()
+    {
+        while (m_pos < m_text.size() && (m_text[m_pos] == ' ' || m_text[m_pos] == '\n' ||
+            m_text[m_pos] == '\r' || m_text[m_pos] == '\t')) m_pos++;
+    }
+
+    bool expect(char c)
+    {
+        skip_space();
+        if (m_pos >= m_text.size() || m_text[m_pos] != c) return false;
+        m_pos++;
+        return true;
+    }
+
+    bool parse_string(std::string& text)
+    {
+        if (!expect('"')) return false;
+        while (m_pos < m_text.size() && m_text[m_pos] != '"')
+        {
+            char c = m_text[m_pos++];
+            if (static_cast<unsigned char>(c) < 0x20) return false;
+            if (c == '\\')
+            {
+                if (m_pos >= m_text.size()) return false;
+                char escaped = m_text[m_pos++];
+                if (escaped == 'n') c = '\n';
+                else if (escaped == 't') c = '\t';
+                else if (escaped == '"' || escaped == '\\' || escaped == '/') c = escaped;
+                else return false;
+            }
+            text += c;
+        }
+        return expect('"');
+    }
+
+    bool parse_value(TEST_JSON& value)
+    {
+        skip_space();
+        if (m_pos >= m_text.size()) return false;
+
+        char c = m_text[m_pos];
+        if (c == '{')
+        {
+            value.Type = TEST_JSON::OBJECT;
+            m_pos++;
+            if (expect('}')) return true;
+            do
+            {
+                value.Keys.emplace_back();
+                value.Items.emplace_back();
+                if (!parse_string(value.Keys.back()) || !expect(':') || !parse_value(value.Items.back())) return false;
+            } while (expect(','));
+            return expect('}');
+        }
+        if (c == '[')
+        {
+            value.Type = TEST_JSON::ARRAY;
+            m_pos++;
+            if (expect(']')) return true;
+            do
+            {
+                value.Items.emplace_back();
+                if (!parse_value(value.Items.back())) return false;
+            } while (expect(','));
+            return expect(']');
+        }
+        if (c == '"')
+        {
+            value.Type = TEST_JSON::STRING;
+            return parse_string(value.Text);
+        }
+        for (const char* literal : { "true", "false", "null" })
+        {
+            if (m_text.compare(m_pos, strlen(literal), literal) == 0)
+            {
+                value.Type = TEST_JSON::LITERAL;
+                value.Text = literal;
+                m_pos += strlen(literal);
+                return true;
+            }
+        }
+
+        const char* pBegin = m_text.c_str() + m_pos;
+        char* pEnd = nullptr;
+        value.Type = TEST_JSON::NUMBER;
+        value.Number = std::strtod(pBegin, &pEnd);
+        if (pEnd == pBegin) return false;
+        m_pos += pEnd - pBegin;
+        return true;
+    }
+
+    const std::string& m_text;
+    size_t m_pos = 0;
+};
+
+// Zones of the calling thread with known durations, one tick apart
+static void push_zones(const char* name, uint32_t count, uint64_t start, uint64_t duration)
+{
+    ProfileRing& ring = Profiler::Instance().ThreadRing();
+    for (uint32_t i = 0; i < count; i++) ring.Push(name, start + i, start + i + duration);
+}
+
+TEST(profiler_chrome_trace, "profiler/chrome_trace")
+{
+    Profiler& profiler = Profiler::Instance();
+
+    // Zones recorded before Clear do not show up
+    push_zones("before clear", 5, Clock::Now(), 10);
+    profiler.Clear();
+
+    const uint64_t start = Clock::Now();
+    const uint64_t duration = Clock::FromNanoseconds(2500);
+    profiler.SetThreadName("main \"test\" thread");
+    push_zones("main zone", 20, start, duration);
+    {
+        PROFILE_ZONE("scoped zone");
+    }
+
+    // Rings outlive their threads
+    std::thread worker([&]()
+        {
+            Profiler::Instance().SetThreadName("worker\\1");
+            push_zones("worker zone", 30, start + 100, duration);
+        });
+    worker.join();
+    std::thread unnamed([&]() { push_zones("unnamed zone", 1, start + 200, duration); });
+    unnamed.join();
+
+    std::ostringstream stream;
+    profiler.WriteChromeTrace(stream);
+    const std::string trace = stream.str();
+
+    TEST_JSON root;
+    TestJsonParser parser(trace);
+    CHECK(parser.Parse(root));
+    CHECK(root.Type == TEST_JSON::OBJECT);
+    const TEST_JSON* pEvents = root.Find("traceEvents");
+    CHECK(pEvents != nullptr && pEvents->Type == TEST_JSON::ARRAY);
+    if (pEvents == nullptr) return;
+
+    // Zone counts by name and thread, thread names by id
+    std::map<std::string, uint32_t> zones;
+    std::map<std::string, double> zoneThreads;
+    std::map<double, std::string> threadNames;
+    uint32_t nameRecords = 0;
+    uint32_t malformed = 0;
+    uint32_t wrongDurations = 0;
+    double earliest = 1e300;
+    for (const TEST_JSON& event : pEvents->Items)
+    {
+        const TEST_JSON* pName = event.Find("name");
+        const TEST_JSON* pPhase = event.Find("ph");
+        const TEST_JSON* pTid = event.Find("tid");
+        if (pName == nullptr || pPhase == nullptr || pTid == nullptr || pTid->Type != TEST_JSON::NUMBER)
+        {
+            malformed++;
+            continue;
+        }
+
+        if (pPhase->Text == "M")
+        {
+            const TEST_JSON* pArgs = event.Find("args");
+            const TEST_JSON* pThreadName = pArgs != nullptr ? pArgs->Find("name") : nullptr;
+            if (pName->Text != "thread_name" || pThreadName == nullptr || threadNames.count(pTid->Number) > 0)
+            {
+                malformed++;
+                continue;
+            }
+            threadNames[pTid->Number] = pThreadName->Text;
+            nameRecords++;
+        }
+        else if (pPhase->Text == "X")
+        {
+            const TEST_JSON* pTs = event.Find("ts");
+            const TEST_JSON* pDur = event.Find("dur");
+            if (pTs == nullptr || pDur == nullptr)
+            {
+                malformed++;
+                continue;
+            }
+            zones[pName->Text]++;
+            zoneThreads[pName->Text] = pTid->Number;
+            if (pTs->Number < earliest) earliest = pTs->Number;
+            if (pName->Text != "scoped zone" && std::fabs(pDur->Number - 2.5) > 0.0015) wrongDurations++;
+        }
+        else
+        {
+            malformed++;
+        }
+    }
+    CHECK_EQ(malformed, 0u);
+    CHECK_EQ(wrongDurations, 0u);
+
+    // One "X" event per zone since Clear, on the thread that recorded it
+    CHECK_EQ(zones.size(), 4u);
+    CHECK_EQ(zones["main zone"], 20u);
+    CHECK_EQ(zones["scoped zone"], 1u);
+    CHECK_EQ(zones["worker zone"], 30u);
+    CHECK_EQ(zones["unnamed zone"], 1u);
+    CHECK_EQ(zones.count("before clear"), 0u);
+    CHECK_EQ(earliest, 0.0);
+
+    // One thread_name record per ring, named as set, escapes and all
+    CHECK(nameRecords >= 3);
+    for (const auto& zone : zoneThreads) CHECK_EQ(threadNames.count(zone.second), 1u);
+    CHECK_EQ(threadNames[zoneThreads["main zone"]], std::string("main \"test\" thread"));
+    CHECK_EQ(threadNames[zoneThreads["worker zone"]], std::string("worker\\1"));
+    CHECK_EQ(zoneThreads["scoped zone"], zoneThreads["main zone"]);
+    CHECK(threadNames[zoneThreads["unnamed zone"]].compare(0, 7, "thread ") == 0);
+    CHECK(zoneThreads["worker zone"] != zoneThreads["main zone"]);
+    CHECK(zoneThreads["unnamed zone"] != zoneThreads["worker zone"]);
+
+    // Disabled, zones cost nothing and record nothing
+    profiler.Clear();
+    profiler.SetEnabled(false);
+    {
+        PROFILE_ZONE("disabled zone");
+    }
+    profiler.SetEnabled(true);
+    std::vector<PROFILE_ZONE_RECORD> records;
+    profiler.ThreadRing().Copy(records);
+    CHECK(records.empty());
+}
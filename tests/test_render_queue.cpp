@@ -0,0 +1,380 @@
+/*****************************************************************//**
+ * \file   test_render_queue.cpp
+ * \brief  Tests of RenderQueue keys, sorting and instanced batches
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "command_stream.h"
+#include "null_backend.h"
+#include "render_queue.h"
+#include "test.h"
+
+static const uint32_t LayerOpaque = 0;
+static const uint32_t LayerTransparent = 1;
+
+class TestRandom
+{
+public:
+    uint32_t Next()
+    {
+        m_state ^= m_state << 13;
+        m_state ^= m_state >> 7;
+        m_state ^= m_state << 17;
+        return static_cast<uint32_t>(m_state >> 32);
+    }
+
+    uint64_t Next64() { return (static_cast<uint64_t>(Next()) << 32) | Next(); }
+
+private:
+    uint64_t m_state = 0x9E3779B97F4A7C15ull;
+};
+
+// What an item was submitted with, looked up by its object index
+struct TEST_ITEM
+{
+    uint32_t Pipeline;
+    uint32_t Texture;
+    uint32_t Drawable;
+    float Depth;
+};
+
+// A drawable has one PSO and texture, as in the application. Depths are on
+// a grid coarse enough that quantization keeps them apart.
+static std::vector<TEST_ITEM> random_items(uint32_t count)
+{
+    TestRandom random;
+    std::vector<TEST_ITEM> items(count);
+    for (TEST_ITEM& item : items)
+    {
+        item.Drawable = random.Next() % 40;
+        item.Pipeline = item.Drawable * 7 % 4;
+        item.Texture = item.Drawable * 5 % 3;
+        item.Depth = static_cast<float>(random.Next() % 1000) / 1000.0f;
+    }
+    return items;
+}
+
+// Terrain chunks are render items of their own, all of object 0. The
+// instance list gets an entry per item, more than there are objects.
+TEST(render_queue_shared_object, "render_queue/shared_object")
+{
+    const uint32_t ChunkCount = 65;
+
+    RenderQueue queue;
+    queue.Begin();
+    for (uint32_t chunk = 0; chunk < ChunkCount; chunk++)
+    {
+        queue.Submit(RenderQueue::OpaqueKey(0, 0, 0, chunk, 0.5f, 0), chunk, 0);
+    }
+    // Water
+    queue.Submit(RenderQueue::TransparentKey(1, 1, 1, ChunkCount, 0.5f, 1), ChunkCount, 1);
+    queue.Sort();
+
+    CHECK_EQ(queue.InstanceObjects().size(), static_cast<size_t>(ChunkCount + 1));
+    CHECK_EQ(queue.Batches().size(), static_cast<size_t>(ChunkCount + 1));
+
+    for (uint32_t i = 0; i < queue.Batches().size(); i++)
+    {
+        const INSTANCE_BATCH& batch = queue.Batches()[i];
+        CHECK_EQ(batch.FirstInstance, i);
+        CHECK_EQ(batch.InstanceCount, 1u);
+        CHECK_EQ(queue.InstanceObjects()[i], i < ChunkCount ? 0u : 1u);
+    }
+}
+
+TEST(render_queue_opaque_order, "render_queue/opaque_order")
+{
+    std::vector<TEST_ITEM> items = random_items(5000);
+
+    RenderQueue queue;
+    queue.Begin();
+    for (uint32_t i = 0; i < items.size(); i++)
+    {
+        const TEST_ITEM& item = items[i];
+        queue.Submit(RenderQueue::OpaqueKey(LayerOpaque, item.Pipeline, item.Texture, item.Drawable,
+            item.Depth, i % 2), item.Drawable, i);
+    }
+    queue.Sort();
+
+    // Grouped by PSO, then texture, then drawable, front-to-back within a drawable
+    size_t misordered = 0;
+    const std::vector<RENDER_PACKET>& packets = queue.Packets();
+    for (size_t i = 1; i < packets.size(); i++)
+    {
+        const TEST_ITEM& a = items[packets[i - 1].ObjectIndex];
+        const TEST_ITEM& b = items[packets[i].ObjectIndex];
+
+        if (a.Pipeline != b.Pipeline) misordered += a.Pipeline > b.Pipeline;
+        else if (a.Texture != b.Texture) misordered += a.Texture > b.Texture;
+        else if (a.Drawable != b.Drawable) misordered += a.Drawable > b.Drawable;
+        else misordered += a.Depth > b.Depth;
+    }
+    CHECK_EQ(misordered, 0u);
+
+    // So every drawable is one batch
+    std::vector<uint32_t> batchesPerDrawable(40, 0);
+    for (const INSTANCE_BATCH& batch : queue.Batches()) batchesPerDrawable[batch.DrawableIndex]++;
+    for (uint32_t count : batchesPerDrawable) CHECK(count <= 1);
+}
+
+TEST(render_queue_transparent_order, "render_queue/transparent_order")
+{
+    std::vector<TEST_ITEM> items = random_items(5000);
+
+    RenderQueue queue;
+    queue.Begin();
+    for (uint32_t i = 0; i < items.size(); i++)
+    {
+        const TEST_ITEM& item = items[i];
+        uint64_t key = i % 3 == 0
+            ? RenderQueue::OpaqueKey(LayerOpaque, item.Pipeline, item.Texture, item.Drawable, item.Depth, 0)
+            : RenderQueue::TransparentKey(LayerTransparent, item.Pipeline, item.Texture, item.Drawable,
+                item.Depth, 0);
+        queue.Submit(key, item.Drawable, i);
+    }
+    queue.Sort();
+
+    // Opaque first, then transparent strictly back-to-front, whatever the state
+    const std::vector<RENDER_PACKET>& packets = queue.Packets();
+    size_t opaque = 0;
+    while (opaque < packets.size() && RenderQueue::KeyLayer(packets[opaque].Key) == LayerOpaque) opaque++;
+    CHECK_EQ(opaque, static_cast<size_t>((items.size() + 2) / 3));
+
+    size_t misordered = 0;
+    for (size_t i = opaque; i < packets.size(); i++)
+    {
+        CHECK_EQ(RenderQueue::KeyLayer(packets[i].Key), LayerTransparent);
+        if (i > opaque) misordered += items[packets[i - 1].ObjectIndex].Depth < items[packets[i].ObjectIndex].Depth;
+    }
+    CHECK_EQ(misordered, 0u);
+}
+
+TEST(render_queue_depth_clamp, "render_queue/depth_clamp")
+{
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const float infinity = std::numeric_limits<float>::infinity();
+
+    // Out of range depths sort as the nearest or farthest and leave other fields alone
+    CHECK_EQ(RenderQueue::OpaqueKey(0, 3, 5, 7, nan, 2), RenderQueue::OpaqueKey(0, 3, 5, 7, 0.0f, 2));
+    CHECK_EQ(RenderQueue::OpaqueKey(0, 3, 5, 7, -1.0f, 2), RenderQueue::OpaqueKey(0, 3, 5, 7, 0.0f, 2));
+    CHECK_EQ(RenderQueue::OpaqueKey(0, 3, 5, 7, 2.0f, 2), RenderQueue::OpaqueKey(0, 3, 5, 7, 1.0f, 2));
+    CHECK_EQ(RenderQueue::OpaqueKey(0, 3, 5, 7, infinity, 2), RenderQueue::OpaqueKey(0, 3, 5, 7, 1.0f, 2));
+    CHECK_EQ(RenderQueue::TransparentKey(1, 3, 5, 7, nan, 2), RenderQueue::TransparentKey(1, 3, 5, 7, 0.0f, 2));
+    CHECK_EQ(RenderQueue::TransparentKey(1, 3, 5, 7, -infinity, 2),
+        RenderQueue::TransparentKey(1, 3, 5, 7, 0.0f, 2));
+    CHECK_EQ(RenderQueue::TransparentKey(1, 3, 5, 7, 5.0f, 2), RenderQueue::TransparentKey(1, 3, 5, 7, 1.0f, 2));
+
+    CHECK(RenderQueue::OpaqueKey(0, 3, 5, 7, 0.0f, 2) < RenderQueue::OpaqueKey(0, 3, 5, 7, 1.0f, 2));
+    CHECK(RenderQueue::TransparentKey(1, 3, 5, 7, 1.0f, 2) < RenderQueue::TransparentKey(1, 3, 5, 7, 0.0f, 2));
+    CHECK_EQ(RenderQueue::KeyLayer(RenderQueue::OpaqueKey(2, 63, 1023, 65535, nan, 63)), 2u);
+    CHECK_EQ(RenderQueue::KeyLayer(RenderQueue::TransparentKey(3, 63, 1023, 65535, -1.0f, 63)), 3u);
+}
+
+// Same order as std::stable_sort, ties kept in submission order
+static void check_radix_sort(const std::vector<uint64_t>& keys)
+{
+    std::vector<RENDER_PACKET> packets;
+    for (uint32_t i = 0; i < keys.size(); i++) packets.push_back({ keys[i], i % 7, i, 0 });
+
+    std::vector<RENDER_PACKET> expected = packets;
+    std::stable_sort(expected.begin(), expected.end(),
+        [](const RENDER_PACKET& a, const RENDER_PACKET& b) { return a.Key < b.Key; });
+
+    std::vector<RENDER_PACKET> scratch;
+    RadixSortPackets(packets, scratch);
+
+    CHECK_EQ(packets.size(), expected.size());
+    size_t different = 0;
+    for (size_t i = 0; i < packets.size(); i++)
+    {
+        different += packets[i].Key != expected[i].Key || packets[i].ObjectIndex != expected[i].ObjectIndex;
+    }
+    CHECK_EQ(different, 0u);
+}
+
+TEST(render_queue_radix_sort, "render_queue/radix_sort")
+{
+    TestRandom random;
+
+    for (uint32_t count : { 0u, 1u, 2u, 255u, 10000u })
+    {
+        // Every byte differs, all eight passes run
+        std::vector<uint64_t> keys(count);
+        for (uint64_t& key : keys) key = random.Next64();
+        check_radix_sort(keys);
+
+        // Few distinct keys in one or three bytes, so most passes are skipped
+        // and the result ends up in either buffer
+        for (uint64_t& key : keys) key = static_cast<uint64_t>(random.Next() % 5) << 24;
+        check_radix_sort(keys);
+        for (uint64_t& key : keys)
+        {
+            key = (static_cast<uint64_t>(random.Next() % 3) << 56) | (static_cast<uint64_t>(random.Next() % 3) << 8)
+                | (random.Next() % 3);
+        }
+        check_radix_sort(keys);
+
+        // All the same, nothing moves
+        for (uint64_t& key : keys) key = 0x0123456789ABCDEFull;
+        check_radix_sort(keys);
+    }
+
+    // Real keys: few pipelines, textures and drawables
+    std::vector<TEST_ITEM> items = random_items(10000);
+    std::vector<uint64_t> keys;
+    for (const TEST_ITEM& item : items)
+    {
+        keys.push_back(RenderQueue::OpaqueKey(LayerOpaque, item.Pipeline, item.Texture, item.Drawable,
+            item.Depth, 0));
+    }
+    check_radix_sort(keys);
+}
+
+// Drawables submitted interleaved. Back-to-front order splits one of them
+// into two batches around another.
+TEST(render_queue_batches, "render_queue/batches")
+{
+    RenderQueue queue;
+
+    // Opaque drawables 0 and 1, each object with its own light
+    queue.Begin();
+    for (uint32_t object = 0; object < 8; object++)
+    {
+        uint32_t drawable = object % 2;
+        queue.Submit(RenderQueue::OpaqueKey(LayerOpaque, 0, 0, drawable, 0.9f - object * 0.1f, 0),
+            drawable, object, 1u << object);
+    }
+
+    // Transparent drawable 2 far and near, drawable 3 between
+    queue.Submit(RenderQueue::TransparentKey(LayerTransparent, 0, 0, 2, 0.2f, 0), 2, 20, 1u << 20);
+    queue.Submit(RenderQueue::TransparentKey(LayerTransparent, 0, 0, 3, 0.5f, 0), 3, 21, 1u << 21);
+    queue.Submit(RenderQueue::TransparentKey(LayerTransparent, 0, 0, 2, 0.8f, 0), 2, 22, 1u << 22);
+    queue.Sort();
+
+    const std::vector<INSTANCE_BATCH>& batches = queue.Batches();
+    const std::vector<uint32_t>& objects = queue.InstanceObjects();
+    const std::vector<uint32_t>& masks = queue.BatchLightMasks();
+
+    CHECK_EQ(batches.size(), 5u);
+    CHECK_EQ(masks.size(), batches.size());
+    CHECK_EQ(objects.size(), 11u);
+
+    // Batches cover the instance list in order
+    uint32_t next = 0;
+    for (const INSTANCE_BATCH& batch : batches)
+    {
+        CHECK_EQ(batch.FirstInstance, next);
+        next += batch.InstanceCount;
+    }
+    CHECK_EQ(next, 11u);
+
+    // Front-to-back within each drawable
+    CHECK_EQ(batches[0].DrawableIndex, 0u);
+    CHECK_EQ(batches[0].InstanceCount, 4u);
+    CHECK(objects[0] == 6 && objects[1] == 4 && objects[2] == 2 && objects[3] == 0);
+    CHECK_EQ(masks[0], 0x55u);
+
+    CHECK_EQ(batches[1].DrawableIndex, 1u);
+    CHECK_EQ(batches[1].InstanceCount, 4u);
+    CHECK(objects[4] == 7 && objects[5] == 5 && objects[6] == 3 && objects[7] == 1);
+    CHECK_EQ(masks[1], 0xAAu);
+
+    // Back-to-front across drawables
+    CHECK(batches[2].DrawableIndex == 2 && batches[2].InstanceCount == 1 && objects[8] == 22);
+    CHECK(batches[3].DrawableIndex == 3 && batches[3].InstanceCount == 1 && objects[9] == 21);
+    CHECK(batches[4].DrawableIndex == 2 && batches[4].InstanceCount == 1 && objects[10] == 20);
+    CHECK_EQ(masks[2], 1u << 22);
+    CHECK_EQ(masks[4], 1u << 20);
+
+    // Begin forgets the previous frame
+    queue.Begin();
+    queue.Sort();
+    CHECK(queue.Batches().empty() && queue.InstanceObjects().empty() && queue.BatchLightMasks().empty());
+}
+
+// Records the batches as DrawRenderItems does, one instanced draw each.
+// Drawable d draws 6 indices from 6 * d.
+static void record_batches(const RenderQueue& queue, CommandStream& stream)
+{
+    const uint32_t InstanceBaseSlot = 5;
+
+    stream.SetRootSignature(1);
+    stream.SetPipeline(2);
+    stream.SetViewport(0.0f, 0.0f, 1280.0f, 720.0f, 0.0f, 1.0f);
+    stream.SetScissor(0, 0, 1280, 720);
+    stream.SetRenderTarget(0x1000, 0x2000);
+    stream.SetTopology(4);
+    stream.SetVertexBuffer(0x4000, 64 * 32, 32);
+    stream.SetIndexBuffer(0x3000, 64 * 6 * 2, 2);
+
+    for (const INSTANCE_BATCH& batch : queue.Batches())
+    {
+        stream.DrawInstances(InstanceBaseSlot, 6, 6 * batch.DrawableIndex, 0,
+            batch.FirstInstance, batch.InstanceCount);
+    }
+}
+
+TEST(render_queue_instanced_draws, "render_queue/instanced_draws")
+{
+    std::vector<TEST_ITEM> items = random_items(3000);
+
+    RenderQueue queue;
+    queue.Begin();
+    for (uint32_t i = 0; i < items.size(); i++)
+    {
+        const TEST_ITEM& item = items[i];
+        queue.Submit(RenderQueue::OpaqueKey(LayerOpaque, item.Pipeline, item.Texture, item.Drawable,
+            item.Depth, 0), item.Drawable, i);
+    }
+    queue.Sort();
+    const std::vector<INSTANCE_BATCH>& batches = queue.Batches();
+    CHECK_EQ(batches.size(), 40u);
+
+    CommandStream stream;
+    record_batches(queue, stream);
+
+    NullCommandBackend backend;
+    CHECK(backend.Execute(stream));
+    CHECK(backend.Errors().empty());
+    CHECK_EQ(backend.Stats().Draws, static_cast<uint32_t>(batches.size()));
+    CHECK_EQ(backend.Stats().Instances, static_cast<uint64_t>(items.size()));
+    CHECK_EQ(backend.Stats().Indices, 6u * items.size());
+
+    // One draw per batch, each preceded by its instance base
+    size_t draw = 0;
+    uint32_t instanceBase = ~0u;
+    for (const COMMAND_HEADER* p = stream.First(); p; p = stream.Next(p))
+    {
+        if (p->Type == COMMAND_SET_ROOT_CONSTANTS)
+        {
+            const CMD_SET_ROOT_CONSTANTS* pCommand = reinterpret_cast<const CMD_SET_ROOT_CONSTANTS*>(p);
+            CHECK(pCommand->Slot == 5 && pCommand->Count == 1 && pCommand->Offset == 0);
+            instanceBase = CommandStream::RootConstantValues(pCommand)[0];
+        }
+        if (p->Type != COMMAND_DRAW_INDEXED) continue;
+
+        const CMD_DRAW_INDEXED* pCommand = reinterpret_cast<const CMD_DRAW_INDEXED*>(p);
+        CHECK(draw < batches.size());
+        if (draw >= batches.size()) break;
+
+        const INSTANCE_BATCH& batch = batches[draw++];
+        CHECK_EQ(pCommand->InstanceCount, batch.InstanceCount);
+        CHECK_EQ(pCommand->StartInstance, batch.FirstInstance);
+        CHECK_EQ(instanceBase, batch.FirstInstance);
+        CHECK_EQ(pCommand->StartIndex, 6 * batch.DrawableIndex);
+
+        // The instances it draws are the objects of its drawable
+        for (uint32_t i = 0; i < batch.InstanceCount; i++)
+        {
+            CHECK_EQ(items[queue.InstanceObjects()[batch.FirstInstance + i]].Drawable, batch.DrawableIndex);
+        }
+    }
+    CHECK_EQ(draw, batches.size());
+}
@@ -0,0 +1,180 @@
+/*****************************************************************//**
+ * \file   test_shader_cache.cpp
+ * \brief  Tests of the shader disk cache with a fake compiler
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "shader_cache.h"
+#include "test.h"
+
+static const std::string SourceDirectory = "test_shader_sources";
+static const std::string CacheDirectory = "test_shader_cache";
+static const std::string MainFile = SourceDirectory + "/main.hlsl";
+static const std::string IncludeFile = SourceDirectory + "/common.hlsl";
+
+static void write_text(const std::string& filename, const std::string& text)
+{
+    WriteFileBytes(filename, text.data(), text.size());
+}
+
+// Stands in for D3DCompileFromFile: bytecode names the entry point and
+// the compilation it came from
+class FakeCompiler
+{
+public:
+    uint32_t Compilations = 0;
+    bool Fail = false;
+
+    ShaderCompileFn Fn()
+    {
+        return [this](const SHADER_DESC& desc, std::vector<uint8_t>& bytecode, std::string& errors)
+            {
+                Compilations++;
+                if (Fail)
+                {
+                    errors = "error X3000: syntax error";
+                    return false;
+                }
+                std::string text = desc.EntryPoint + "/" + desc.Target + "#" + std::to_string(Compilations);
+                bytecode.assign(text.begin(), text.end());
+                return true;
+            };
+    }
+};
+
+static std::string as_text(const std::vector<uint8_t>& bytecode)
+{
+    return std::string(bytecode.begin(), bytecode.end());
+}
+
+// Fresh sources, and no entry left over from an earlier run
+static SHADER_DESC set_up(ShaderCache& cache)
+{
+    EnsureDirectory(SourceDirectory);
+    write_text(MainFile, "#include \"common.hlsl\"\nfloat4 VS() : SV_Position { return Offset; }\n");
+    write_text(IncludeFile, "static const float4 Offset = 0;\n");
+
+    SHADER_DESC desc;
+    desc.Filename = MainFile;
+    desc.Defines = { { "CLUSTERED", "1" } };
+    desc.EntryPoint = "VS";
+    desc.Target = "vs_5_1";
+
+    uint64_t key = 0;
+    if (cache.ComputeKey(desc, key)) std::remove(cache.EntryPath(key).c_str());
+    return desc;
+}
+
+TEST(shader_cache_hit_miss, "shader_cache/hit_miss")
+{
+    FakeCompiler compiler;
+    ShaderCache cache(CacheDirectory, compiler.Fn(), "fake 1.0");
+    SHADER_DESC desc = set_up(cache);
+
+    std::vector<uint8_t> bytecode;
+    CHECK(cache.Get(desc, bytecode));
+    CHECK_EQ(as_text(bytecode), std::string("VS/vs_5_1#1"));
+    CHECK_EQ(cache.Misses(), 1u);
+    CHECK_EQ(cache.Hits(), 0u);
+
+    // Read back, also by a new cache on the same directory
+    bytecode.clear();
+    CHECK(cache.Get(desc, bytecode));
+    CHECK_EQ(as_text(bytecode), std::string("VS/vs_5_1#1"));
+    CHECK_EQ(cache.Hits(), 1u);
+
+    ShaderCache reopened(CacheDirectory, compiler.Fn(), "fake 1.0");
+    CHECK(reopened.Get(desc, bytecode));
+    CHECK_EQ(reopened.Hits(), 1u);
+    CHECK_EQ(compiler.Compilations, 1u);
+
+    // Every other input is part of the key
+    SHADER_DESC other = desc;
+    other.Defines[0].second = "0";
+    uint64_t key = 0;
+    uint64_t otherKey = 0;
+    CHECK(cache.ComputeKey(desc, key));
+    CHECK(cache.ComputeKey(other, otherKey));
+    CHECK(key != otherKey);
+
+    ShaderCache newCompiler(CacheDirectory, compiler.Fn(), "fake 2.0");
+    CHECK(newCompiler.ComputeKey(desc, otherKey));
+    CHECK(key != otherKey);
+}
+
+TEST(shader_cache_include_change, "shader_cache/include_change")
+{
+    FakeCompiler compiler;
+    ShaderCache cache(CacheDirectory, compiler.Fn(), "fake 1.0");
+    SHADER_DESC desc = set_up(cache);
+
+    std::vector<uint8_t> bytecode;
+    uint64_t before = 0;
+    CHECK(cache.Get(desc, bytecode, &before));
+
+    // Only the included file changes
+    write_text(IncludeFile, "static const float4 Offset = 1;\n");
+    uint64_t after = 0;
+    CHECK(cache.Get(desc, bytecode, &after));
+    CHECK(before != after);
+    CHECK_EQ(compiler.Compilations, 2u);
+    CHECK_EQ(as_text(bytecode), std::string("VS/vs_5_1#2"));
+    std::remove(cache.EntryPath(after).c_str());
+
+    // A missing include fails without calling the compiler
+    std::remove(IncludeFile.c_str());
+    CHECK(!cache.Get(desc, bytecode));
+    CHECK(!cache.Errors().empty());
+    CHECK_EQ(compiler.Compilations, 2u);
+}
+
+TEST(shader_cache_corrupt_entry, "shader_cache/corrupt_entry")
+{
+    FakeCompiler compiler;
+    ShaderCache cache(CacheDirectory, compiler.Fn(), "fake 1.0");
+    SHADER_DESC desc = set_up(cache);
+
+    std::vector<uint8_t> bytecode;
+    uint64_t key = 0;
+    CHECK(cache.Get(desc, bytecode, &key));
+    const std::string path = cache.EntryPath(key);
+
+    std::vector<uint8_t> entry;
+    CHECK(ReadFileBytes(path, entry));
+
+    // Truncated, garbled and empty entries are compiled again and rewritten
+    std::vector<std::vector<uint8_t>> damaged;
+    damaged.push_back(std::vector<uint8_t>(entry.begin(), entry.end() - 1));
+    damaged.push_back(entry);
+    damaged.back().back() ^= 0xFF;
+    damaged.push_back(std::vector<uint8_t>(entry.begin(), entry.begin() + 8));
+    damaged.push_back(std::vector<uint8_t>());
+
+    for (const std::vector<uint8_t>& data : damaged)
+    {
+        uint32_t compilations = compiler.Compilations;
+        WriteFileBytes(path, data.data(), data.size());
+
+        bytecode.clear();
+        CHECK(cache.Get(desc, bytecode));
+        CHECK_EQ(compiler.Compilations, compilations + 1);
+        CHECK_EQ(as_text(bytecode), "VS/vs_5_1#" + std::to_string(compiler.Compilations));
+
+        CHECK(cache.Get(desc, bytecode));
+        CHECK_EQ(compiler.Compilations, compilations + 1);
+    }
+
+    // A failed compilation leaves no entry behind
+    std::remove(path.c_str());
+    compiler.Fail = true;
+    CHECK(!cache.Get(desc, bytecode));
+    CHECK_EQ(cache.Errors(), std::string("error X3000: syntax error"));
+    CHECK(!ReadFileBytes(path, entry));
+    std::remove(IncludeFile.c_str());
+    std::remove(MainFile.c_str());
+}
@@ -0,0 +1,90 @@
+/*****************************************************************//**
+ * \file   test_stall_stats.cpp
+ * \brief  Tests of the stall histograms
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include "stall_stats.h"
+#include "test.h"
+
+// Bucket 0 is below 1 us, bucket i covers [2^(i-1), 2^i) us
+TEST(stall_stats_buckets, "stall_stats/buckets")
+{
+    struct { uint64_t Ns; int Bucket; } cases[] =
+    {
+        { 0, 0 }, { 999, 0 },
+        { 1000, 1 }, { 1999, 1 },
+        { 2000, 2 }, { 3999, 2 },
+        { 4000, 3 },
+        { 1000000, 10 },            // 1 ms is in [512, 1024) us
+        { 1024000, 11 },
+        { ~0ull, StallHistogram::BucketCount - 1 },
+    };
+
+    for (const auto& c : cases)
+    {
+        StallHistogram histogram;
+        histogram.Record(c.Ns);
+        CHECK_EQ(histogram.BucketValue(c.Bucket), 1u);
+        CHECK_EQ(histogram.Count(), 1u);
+    }
+
+    // Upper bounds agree with the buckets they close
+    CHECK_EQ(StallHistogram::BucketUpperBoundNs(0), 1000u);
+    CHECK_EQ(StallHistogram::BucketUpperBoundNs(1), 2000u);
+    CHECK_EQ(StallHistogram::BucketUpperBoundNs(10), 1024000u);
+}
+
+TEST(stall_stats_totals, "stall_stats/totals")
+{
+    StallHistogram histogram;
+    histogram.Record(500);
+    histogram.Record(3000);
+    histogram.Record(1500);
+
+    CHECK_EQ(histogram.Count(), 3u);
+    CHECK_EQ(histogram.TotalNanoseconds(), 5000u);
+    CHECK_EQ(histogram.MaxNanoseconds(), 3000u);
+
+    histogram.Reset();
+    CHECK_EQ(histogram.Count(), 0u);
+    CHECK_EQ(histogram.TotalNanoseconds(), 0u);
+    CHECK_EQ(histogram.MaxNanoseconds(), 0u);
+    for (int i = 0; i < StallHistogram::BucketCount; i++) CHECK_EQ(histogram.BucketValue(i), 0u);
+}
+
+TEST(stall_stats_percentiles, "stall_stats/percentiles")
+{
+    StallHistogram histogram;
+    CHECK_EQ(histogram.PercentileNs(0.5), 0u);
+
+    // 90 short stalls and 10 around 5 ms
+    for (int i = 0; i < 90; i++) histogram.Record(500);
+    for (int i = 0; i < 10; i++) histogram.Record(5000000);
+
+    CHECK_EQ(histogram.PercentileNs(0.0), 1000u);
+    CHECK_EQ(histogram.PercentileNs(0.5), 1000u);
+    CHECK_EQ(histogram.PercentileNs(0.9), 1000u);
+    CHECK_EQ(histogram.PercentileNs(0.95), StallHistogram::BucketUpperBoundNs(13));
+    CHECK_EQ(histogram.PercentileNs(1.0), StallHistogram::BucketUpperBoundNs(13));
+    CHECK_EQ(histogram.PercentileNs(2.0), StallHistogram::BucketUpperBoundNs(13));
+}
+
+TEST(stall_stats_sites, "stall_stats/sites")
+{
+    StallRecorder recorder;
+    recorder.Record(STALL_SITE_FRAME_RESOURCE, 2500);
+    recorder.Record(STALL_SITE_FRAME_RESOURCE, 2500);
+    recorder.Record(STALL_SITE_GEOMETRY_UPLOAD, 100);
+
+    CHECK_EQ(recorder.Get(STALL_SITE_FLUSH_COMMAND_QUEUE).Count(), 0u);
+    CHECK_EQ(recorder.Get(STALL_SITE_FRAME_RESOURCE).BucketValue(2), 2u);
+    CHECK_EQ(recorder.Get(STALL_SITE_GEOMETRY_UPLOAD).BucketValue(0), 1u);
+
+    recorder.Reset();
+    CHECK_EQ(recorder.Get(STALL_SITE_FRAME_RESOURCE).Count(), 0u);
+
+    CHECK_EQ(std::string(StallSiteName(STALL_SITE_FRAME_RESOURCE)), std::string("NextFrameResource"));
+    CHECK_EQ(std::string(StallSiteName(STALL_SITE_COUNT)), std::string("Unknown"));
+}
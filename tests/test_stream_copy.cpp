@@ -0,0 +1,163 @@
+/*****************************************************************//**
+ * \file   test_stream_copy.cpp
+ * \brief  Tests of the streaming copy routines against memcpy
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "stream_copy.h"
+#include "test.h"
+
+static const uint8_t Guard = 0xCD;
+
+// Source bytes, so that a shifted or misplaced copy shows
+class TestRandom
+{
+public:
+    uint8_t Next()
+    {
+        m_state ^= m_state << 13;
+        m_state ^= m_state >> 17;
+        m_state ^= m_state << 5;
+        return static_cast<uint8_t>(m_state >> 24);
+    }
+
+private:
+    uint32_t m_state = 2463534242u;
+};
+
+// Guard-filled buffer with a 64-byte aligned base
+class TestBuffer
+{
+public:
+    explicit TestBuffer(size_t byteSize) : m_storage(byteSize + StreamLineSize, Guard) { }
+
+    uint8_t* Base()
+    {
+        uintptr_t address = reinterpret_cast<uintptr_t>(m_storage.data());
+        return m_storage.data() + ((StreamLineSize - (address & (StreamLineSize - 1))) & (StreamLineSize - 1));
+    }
+
+private:
+    std::vector<uint8_t> m_storage;
+};
+
+static std::vector<uint8_t> random_bytes(size_t byteSize)
+{
+    TestRandom random;
+    std::vector<uint8_t> bytes(byteSize);
+    for (uint8_t& b : bytes) b = random.Next();
+    return bytes;
+}
+
+// Every destination alignment and size around line boundaries, from every
+// source alignment: exactly the bytes memcpy writes, nothing around them
+TEST(stream_copy_copy, "stream_copy/copy")
+{
+    const size_t Margin = 2 * StreamLineSize;
+    std::vector<uint8_t> source = random_bytes(4096 + 2 * StreamLineSize);
+
+    std::vector<size_t> sizes;
+    for (size_t size = 0; size <= 3 * StreamLineSize + 1; size++) sizes.push_back(size);
+    sizes.push_back(1000);
+    sizes.push_back(4096);
+    sizes.push_back(4096 + 17);
+
+    size_t mismatches = 0;
+    for (size_t size : sizes)
+    {
+        for (size_t dstOffset = 0; dstOffset < StreamLineSize; dstOffset++)
+        {
+            for (size_t srcOffset : { 0u, 1u, 7u, 32u, 63u })
+            {
+                TestBuffer actual(Margin + size + Margin);
+                TestBuffer expected(Margin + size + Margin);
+                StreamCopy(actual.Base() + Margin + dstOffset, source.data() + srcOffset, size);
+                StreamFence();
+                memcpy(expected.Base() + Margin + dstOffset, source.data() + srcOffset, size);
+
+                mismatches += memcmp(actual.Base(), expected.Base(), Margin + size + Margin) != 0;
+            }
+        }
+    }
+    CHECK_EQ(mismatches, 0u);
+}
+
+// Whole lines from an aligned destination: the data, then zeros to the end
+// of the last line, and nothing past it
+TEST(stream_copy_lines, "stream_copy/lines")
+{
+    std::vector<uint8_t> source = random_bytes(1024);
+
+    size_t mismatches = 0;
+    for (size_t size = 0; size <= 5 * StreamLineSize; size++)
+    {
+        for (size_t srcOffset : { 0u, 1u, 5u, 60u })
+        {
+            const size_t padded = (size + StreamLineSize - 1) & ~(StreamLineSize - 1);
+            TestBuffer actual(padded + StreamLineSize);
+            StreamCopyLines(actual.Base(), source.data() + srcOffset, size);
+            StreamFence();
+
+            std::vector<uint8_t> expected(padded + StreamLineSize, Guard);
+            memcpy(expected.data(), source.data() + srcOffset, size);
+            memset(expected.data() + size, 0, padded - size);
+
+            mismatches += memcmp(actual.Base(), expected.data(), expected.size()) != 0;
+        }
+    }
+    CHECK_EQ(mismatches, 0u);
+}
+
+// Constant buffer slots, which are padded out, and tight or unaligned
+// strides, which are not
+TEST(stream_copy_scatter, "stream_copy/scatter")
+{
+    struct LAYOUT
+    {
+        size_t DstOffset;
+        size_t DstStride;
+        size_t ElementSize;
+        bool Lines;
+    };
+    const LAYOUT layouts[] =
+    {
+        { 0, 256, 80, true },
+        { 0, 256, 256, true },
+        { 0, 64, 64, true },
+        { 0, 256, 12, true },
+        { 0, 80, 80, false },
+        { 0, 160, 129, false },
+        { 4, 256, 80, false },
+        { 0, 12, 12, false },
+    };
+    const size_t Count = 9;
+    const size_t SrcStride = 300;
+    std::vector<uint8_t> source = random_bytes(SrcStride * Count);
+
+    for (const LAYOUT& layout : layouts)
+    {
+        const size_t byteSize = layout.DstOffset + layout.DstStride * Count + StreamLineSize;
+        TestBuffer actual(byteSize);
+        uint8_t* pDst = actual.Base() + layout.DstOffset;
+        CHECK_EQ(CanStreamLines(pDst, layout.ElementSize, layout.DstStride), layout.Lines);
+
+        StreamScatter(pDst, layout.DstStride, source.data(), SrcStride, layout.ElementSize, Count);
+        StreamFence();
+
+        // Padded elements have zeros up to their line, the rest stays untouched
+        std::vector<uint8_t> expected(byteSize, Guard);
+        const size_t padded = (layout.ElementSize + StreamLineSize - 1) & ~(StreamLineSize - 1);
+        for (size_t i = 0; i < Count; i++)
+        {
+            uint8_t* pElement = expected.data() + layout.DstOffset + layout.DstStride * i;
+            if (layout.Lines) memset(pElement, 0, padded);
+            memcpy(pElement, source.data() + SrcStride * i, layout.ElementSize);
+        }
+        CHECK(memcmp(actual.Base(), expected.data(), byteSize) == 0);
+    }
+}
@@ -0,0 +1,272 @@
+/*****************************************************************//**
+ * \file   test_task_graph.cpp
+ * \brief  Tests of TaskGraph checks, ordering and critical path
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "job_system.h"
+#include "task_graph.h"
+#include "test.h"
+
+static bool has_error(const TaskGraph& graph, const char* text)
+{
+    for (const std::string& error : graph.Errors())
+    {
+        if (error.find(text) != std::string::npos) return true;
+    }
+    return false;
+}
+
+TEST(task_graph_two_writers, "task_graph/two_writers")
+{
+    bool ran = false;
+    TaskGraph graph;
+    uint32_t input = graph.AddResource("input");
+    uint32_t visible = graph.AddResource("visible");
+    graph.AddTask("cull", [&]() { ran = true; }, { input }, { visible });
+    graph.AddTask("occlude", [&]() { ran = true; }, { input }, { visible });
+
+    CHECK(!graph.Build());
+    CHECK_EQ(graph.Errors().size(), 1u);
+    CHECK(has_error(graph, "visible is written by both cull and occlude"));
+
+    // A graph that failed to build runs nothing
+    JobSystem jobs(2);
+    CHECK(!graph.Execute(&jobs));
+    CHECK(!graph.Execute(nullptr));
+    CHECK(!ran);
+
+    // Ordering the second writer after the first does not make it valid,
+    // one task owns each resource
+    TaskGraph ordered;
+    uint32_t a = ordered.AddResource("a");
+    uint32_t b = ordered.AddResource("b");
+    ordered.AddTask("first", []() {}, {}, { a, b });
+    ordered.AddTask("second", []() {}, { a }, { b });
+    CHECK(!ordered.Build());
+    CHECK(has_error(ordered, "b is written by both first and second"));
+
+    // Reading and writing the same resource is an update, not a conflict
+    TaskGraph update;
+    uint32_t camera = update.AddResource("camera");
+    update.AddTask("move", []() {}, { camera }, { camera });
+    CHECK(update.Build());
+    CHECK(update.Errors().empty());
+    CHECK(update.Dependencies(0).empty());
+}
+
+TEST(task_graph_cycle, "task_graph/cycle")
+{
+    bool ran = false;
+    TaskGraph graph;
+    uint32_t input = graph.AddResource("input");
+    uint32_t a = graph.AddResource("a");
+    uint32_t b = graph.AddResource("b");
+    uint32_t c = graph.AddResource("c");
+    uint32_t d = graph.AddResource("d");
+    graph.AddTask("start", [&]() { ran = true; }, { input }, { a });
+    graph.AddTask("x", [&]() { ran = true; }, { a, d }, { b });
+    graph.AddTask("y", [&]() { ran = true; }, { b }, { c });
+    graph.AddTask("z", [&]() { ran = true; }, { c }, { d });
+    graph.AddTask("after", [&]() { ran = true; }, { d }, {});
+
+    CHECK(!graph.Build());
+    CHECK_EQ(graph.Errors().size(), 1u);
+    CHECK(has_error(graph, "cycle: "));
+    CHECK(has_error(graph, "x -> y -> z -> x") || has_error(graph, "y -> z -> x -> y") ||
+        has_error(graph, "z -> x -> y -> z"));
+    CHECK(!has_error(graph, "start"));
+    CHECK(!has_error(graph, "after"));
+
+    JobSystem jobs(2);
+    CHECK(!graph.Execute(&jobs));
+    CHECK(!ran);
+
+    // A task reading what another task derives from its own output
+    TaskGraph pair;
+    uint32_t p = pair.AddResource("p");
+    uint32_t q = pair.AddResource("q");
+    pair.AddTask("left", []() {}, { q }, { p });
+    pair.AddTask("right", []() {}, { p }, { q });
+    CHECK(!pair.Build());
+    CHECK(has_error(pair, "cycle: "));
+
+    // Removing the back edge makes the same chain valid
+    TaskGraph chain;
+    a = chain.AddResource("a");
+    b = chain.AddResource("b");
+    c = chain.AddResource("c");
+    chain.AddTask("x", []() {}, { a }, { b });
+    chain.AddTask("y", []() {}, { b }, { c });
+    chain.AddTask("z", []() {}, { c }, {});
+    CHECK(chain.Build());
+    CHECK_EQ(chain.Order().size(), 3u);
+}
+
+// Producers, then tasks combining neighbouring products, then a total. Plain
+// stores: a reader running before its writer sees a stale value, and a race
+// under ThreadSanitizer.
+TEST(task_graph_readers_after_writers, "task_graph/readers_after_writers")
+{
+    const uint32_t Width = 8;
+    const uint32_t Rounds = 200;
+
+    for (unsigned threads : { 1u, 2u, 4u })
+    {
+        JobSystem jobs(threads);
+
+        std::vector<uint64_t> products(Width, 0);
+        std::vector<uint64_t> combined(Width, 0);
+        uint64_t total = 0;
+        uint64_t round = 0;
+
+        // Order of starts and ends, across threads
+        std::atomic<uint32_t> sequence{ 0 };
+        std::vector<uint32_t> started(2 * Width + 1, 0);
+        std::vector<uint32_t> ended(2 * Width + 1, 0);
+
+        TaskGraph graph;
+        uint32_t frame = graph.AddResource("frame");
+        std::vector<uint32_t> productResources(Width);
+        std::vector<uint32_t> combinedResources(Width);
+        for (uint32_t i = 0; i < Width; i++)
+        {
+            productResources[i] = graph.AddResource(("product " + std::to_string(i)).c_str());
+            combinedResources[i] = graph.AddResource(("combined " + std::to_string(i)).c_str());
+        }
+        uint32_t totalResource = graph.AddResource("total");
+
+        // Combiners are added first, so the order of addition is not the order of execution
+        std::vector<uint32_t> combiners(Width);
+        for (uint32_t i = 0; i < Width; i++)
+        {
+            uint32_t next = (i + 1) % Width;
+            combiners[i] = graph.AddTask("combine", [&, i, next]()
+                {
+                    started[Width + i] = sequence++;
+                    std::this_thread::sleep_for(std::chrono::microseconds((i * 37) % 50));
+                    combined[i] = products[i] + products[next];
+                    ended[Width + i] = sequence++;
+                }, { productResources[i], productResources[next] }, { combinedResources[i] });
+        }
+        std::vector<uint32_t> producers(Width);
+        for (uint32_t i = 0; i < Width; i++)
+        {
+            producers[i] = graph.AddTask("produce", [&, i]()
+                {
+                    started[i] = sequence++;
+                    std::this_thread::sleep_for(std::chrono::microseconds((i * 53) % 50));
+                    products[i] = round * 100 + i;
+                    ended[i] = sequence++;
+                }, { frame }, { productResources[i] });
+        }
+        uint32_t totalTask = graph.AddTask("total", [&]()
+            {
+                started[2 * Width] = sequence++;
+                total = 0;
+                for (uint64_t value : combined) total += value;
+                ended[2 * Width] = sequence++;
+            }, { combinedResources[0], combinedResources[1], combinedResources[2],
+                combinedResources[3], combinedResources[4], combinedResources[5],
+                combinedResources[6], combinedResources[7] }, { totalResource });
+
+        CHECK(graph.Build());
+        CHECK(graph.Errors().empty());
+        CHECK_EQ(graph.Dependencies(totalTask).size(), static_cast<size_t>(Width));
+        for (uint32_t i = 0; i < Width; i++)
+        {
+            CHECK(graph.Dependencies(producers[i]).empty());
+            CHECK_EQ(graph.Dependencies(combiners[i]).size(), 2u);
+        }
+
+        size_t wrongOrder = 0;
+        size_t wrongValues = 0;
+        for (round = 1; round <= Rounds; round++)
+        {
+            CHECK(graph.Execute(&jobs));
+
+            for (uint32_t i = 0; i < Width; i++)
+            {
+                uint32_t next = (i + 1) % Width;
+                wrongOrder += started[Width + i] < ended[i] || started[Width + i] < ended[next];
+                wrongOrder += started[2 * Width] < ended[Width + i];
+                wrongValues += combined[i] != 2 * round * 100 + i + next;
+            }
+            wrongValues += total != 2 * Width * round * 100 + Width * (Width - 1);
+        }
+        CHECK_EQ(wrongOrder, 0u);
+        CHECK_EQ(wrongValues, 0u);
+
+        // Recorded timings agree with the order
+        for (uint32_t i = 0; i < Width; i++)
+        {
+            CHECK(graph.Timing(combiners[i]).Start >= graph.Timing(producers[i]).End);
+            CHECK(graph.Timing(totalTask).Start >= graph.Timing(combiners[i]).End);
+        }
+    }
+}
+
+// A splits into a slow B and a fast C, which join in D: the critical path
+// is A, B, D however the tasks were scheduled
+TEST(task_graph_critical_path, "task_graph/critical_path")
+{
+    TaskGraph graph;
+    uint32_t input = graph.AddResource("input");
+    uint32_t ra = graph.AddResource("a");
+    uint32_t rb = graph.AddResource("b");
+    uint32_t rc = graph.AddResource("c");
+    uint32_t rd = graph.AddResource("d");
+
+    // Added out of order, so the path does not follow task indices
+    uint32_t d = graph.AddTask("D", []() { std::this_thread::sleep_for(std::chrono::milliseconds(10)); },
+        { rb, rc }, { rd });
+    uint32_t c = graph.AddTask("C", []() { std::this_thread::sleep_for(std::chrono::milliseconds(2)); },
+        { ra }, { rc });
+    uint32_t b = graph.AddTask("B", []() { std::this_thread::sleep_for(std::chrono::milliseconds(40)); },
+        { ra }, { rb });
+    uint32_t a = graph.AddTask("A", []() { std::this_thread::sleep_for(std::chrono::milliseconds(20)); },
+        { input }, { ra });
+    CHECK(graph.Build());
+
+    CHECK(graph.Dependencies(a).empty());
+    CHECK(graph.Dependencies(b) == std::vector<uint32_t>{ a });
+    CHECK(graph.Dependencies(c) == std::vector<uint32_t>{ a });
+    CHECK(graph.Dependencies(d) == (std::vector<uint32_t>{ c, b }));
+    CHECK(graph.Order().front() == a);
+    CHECK(graph.Order().back() == d);
+
+    JobSystem jobs(4);
+    for (JobSystem* pJobs : { static_cast<JobSystem*>(nullptr), &jobs })
+    {
+        CHECK(graph.Execute(pJobs));
+
+        CHECK(graph.CriticalPath() == (std::vector<uint32_t>{ a, b, d }));
+
+        double path = 0.0;
+        for (uint32_t task : { a, b, d }) path += graph.Timing(task).End - graph.Timing(task).Start;
+        CHECK(std::fabs(graph.CriticalPathSeconds() - path) < 1e-9);
+        CHECK(graph.CriticalPathSeconds() >= 0.070);
+
+        // Bounds the wall time, which on one thread also pays for C
+        CHECK(graph.WallSeconds() >= graph.CriticalPathSeconds());
+        if (pJobs == nullptr) CHECK(graph.WallSeconds() >= 0.072);
+    }
+
+    // One task alone is its own critical path
+    TaskGraph single;
+    uint32_t only = single.AddTask("only", []() { std::this_thread::sleep_for(std::chrono::milliseconds(5)); },
+        {}, {});
+    CHECK(single.Build());
+    CHECK(single.Execute(nullptr));
+    CHECK(single.CriticalPath() == std::vector<uint32_t>{ only });
+    CHECK(single.CriticalPathSeconds() >= 0.005);
+}
@@ -0,0 +1,107 @@
+/*****************************************************************//**
+ * \file   test_triple_buffer.cpp
+ * \brief  Stress test of TripleBuffer with the producer and the consumer
+ *         racing, also built with ThreadSanitizer
+ *
+ * \author Mikalai Varapai
+ * \date   October 2026
+ *********************************************************************/
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include "test.h"
+#include "triple_buffer.h"
+
+// Large enough that a torn copy would show as fields from different values
+struct STRESS_VALUE
+{
+    uint64_t Sequence;
+    uint64_t Fields[15];
+};
+
+static uint64_t field_value(uint64_t sequence, int field)
+{
+    return sequence * 31 + static_cast<uint64_t>(field);
+}
+
+TEST(triple_buffer_single_thread, "triple_buffer/single_thread")
+{
+    TripleBuffer<STRESS_VALUE> buffer;
+    CHECK(!buffer.Acquire());
+
+    buffer.Write().Sequence = 1;
+    buffer.Publish();
+    buffer.Write().Sequence = 2;
+    buffer.Publish();
+
+    // Only the latest value is seen, and only once
+    CHECK(buffer.Acquire());
+    CHECK_EQ(buffer.Read().Sequence, 2u);
+    CHECK(!buffer.Acquire());
+    CHECK_EQ(buffer.Read().Sequence, 2u);
+
+    buffer.Write().Sequence = 3;
+    buffer.Publish();
+    CHECK(buffer.Acquire());
+    CHECK_EQ(buffer.Read().Sequence, 3u);
+}
+
+TEST(triple_buffer_stress, "triple_buffer/stress")
+{
+    const uint64_t PublishCount = 200000;
+
+    TripleBuffer<STRESS_VALUE> buffer;
+    std::atomic<bool> done{ false };
+
+    std::thread producer([&]()
+        {
+            for (uint64_t sequence = 1; sequence <= PublishCount; sequence++)
+            {
+                STRESS_VALUE& value = buffer.Write();
+                value.Sequence = sequence;
+                for (int i = 0; i < 15; i++) value.Fields[i] = field_value(sequence, i);
+                buffer.Publish();
+            }
+            done.store(true, std::memory_order_release);
+        });
+
+    // Checks are counted here and reported after the join, so a failure
+    // does not print from a racing thread
+    uint64_t last = 0;
+    uint64_t acquired = 0;
+    uint64_t torn = 0;
+    uint64_t stale = 0;
+    uint64_t changedWithoutAcquire = 0;
+
+    auto consume = [&]()
+        {
+            bool fresh = buffer.Acquire();
+            const STRESS_VALUE& value = buffer.Read();
+            if (!fresh)
+            {
+                if (value.Sequence != last) changedWithoutAcquire++;
+                return;
+            }
+
+            acquired++;
+            if (value.Sequence <= last) stale++;
+            for (int i = 0; i < 15; i++)
+            {
+                if (value.Fields[i] != field_value(value.Sequence, i)) torn++;
+            }
+            last = value.Sequence;
+        };
+
+    while (!done.load(std::memory_order_acquire)) consume();
+    consume();
+    producer.join();
+
+    CHECK_EQ(torn, 0u);
+    CHECK_EQ(stale, 0u);
+    CHECK_EQ(changedWithoutAcquire, 0u);
+    CHECK(acquired > 0);
+
+    // The last value is never lost
+    CHECK_EQ(last, PublishCount);
+}